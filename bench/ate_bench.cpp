@@ -0,0 +1,324 @@
+// ate_bench：儀器通訊層的效能基準
+// 對本機 SCPI 替身（LoopbackScpiServer）量測，結果以 JSON 輸出，方便比對各版本差異
+//
+//   ate_bench [--out result.json] [--channels N] [--iterations N] [--max-block-mb N]
+//             [--resource SIM::<log>]   改用紀錄檔重播（只跑 query_rtt / apply_load_frame）
+//             [--async-sessions N]      async_query_fanout 同時查詢的替身數量
+
+#include "loopbackscpiserver.h"
+#include "asyncinstrumentio.h"
+#include "communicationfactory.h"
+#include "icommunication.h"
+#include "instrumentsessionpool.h"
+#include "instrumentwithcommbase.h"
+#include "scpicommandbatch.h"
+#include "chroma6310.h"
+#include "chromaload6310spec.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFuture>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QVector>
+#include <QDebug>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// 只為了從外部呼叫 protected 查詢
+class BenchInstrument : public InstrumentWithCommBase
+{
+public:
+    explicit BenchInstrument(ICommunication* comm) : InstrumentWithCommBase(comm) {}
+    QString model() const override { return "Bench"; }
+    QString vendor() const override { return "Loopback"; }
+
+    using InstrumentWithCommBase::queryDouble;
+    using InstrumentWithCommBase::queryBinary;
+};
+
+struct Samples
+{
+    QVector<qint64> ns;
+
+    double percentileUs(double p) const {
+        if (ns.isEmpty()) return 0;
+        QVector<qint64> sorted = ns;
+        std::sort(sorted.begin(), sorted.end());
+        const int idx = qBound(0, static_cast<int>(p * (sorted.size() - 1) + 0.5), sorted.size() - 1);
+        return sorted[idx] / 1000.0;
+    }
+    double meanUs() const {
+        if (ns.isEmpty()) return 0;
+        qint64 sum = 0;
+        for (qint64 v : ns) sum += v;
+        return sum / 1000.0 / ns.size();
+    }
+    qint64 totalNs() const {
+        qint64 sum = 0;
+        for (qint64 v : ns) sum += v;
+        return sum;
+    }
+};
+
+QJsonObject makeResult(const QString& name, const QJsonObject& params, const Samples& s,
+                       qint64 bytesPerIteration = 0)
+{
+    QJsonObject o{
+        {"name", name},
+        {"params", params},
+        {"iterations", s.ns.size()},
+        {"mean_us", s.meanUs()},
+        {"p50_us", s.percentileUs(0.50)},
+        {"p99_us", s.percentileUs(0.99)},
+        {"min_us", s.percentileUs(0.0)},
+        {"max_us", s.percentileUs(1.0)},
+    };
+    const qint64 total = s.totalNs();
+    if (total > 0) {
+        o["ops_per_s"] = s.ns.size() * 1e9 / total;
+        if (bytesPerIteration > 0)
+            o["throughput_mb_s"] = double(bytesPerIteration) * s.ns.size() / (1 << 20) / (total / 1e9);
+    }
+    qInfo().noquote() << QString("%1 %2: p50 %3 us, p99 %4 us")
+                             .arg(name, QString::fromUtf8(QJsonDocument(params).toJson(QJsonDocument::Compact)))
+                             .arg(s.percentileUs(0.50), 0, 'f', 1)
+                             .arg(s.percentileUs(0.99), 0, 'f', 1);
+    return o;
+}
+
+// 查詢往返時間：寫入到完整回應
+QJsonObject benchQueryRtt(ICommunication* comm, int iterations)
+{
+    BenchInstrument inst(comm);
+    Samples s;
+    s.ns.reserve(iterations);
+    double value = 0;
+    QElapsedTimer t;
+    for (int i = 0; i < iterations; ++i) {
+        t.start();
+        if (!inst.queryDouble("MEAS:VOLT?", value)) break;
+        s.ns.append(t.nsecsElapsed());
+    }
+    return makeResult("query_rtt", QJsonObject{{"command", "MEAS:VOLT?"}}, s);
+}
+
+// queryBinary 吞吐量：1 KB ~ maxBytes，每次 ×4
+QJsonArray benchQueryBinary(ICommunication* comm, qint64 maxBytes)
+{
+    QJsonArray results;
+    BenchInstrument inst(comm);
+    std::unique_ptr<char[]> buffer(new char[static_cast<size_t>(maxBytes)]);
+
+    for (qint64 size = 1024; size <= maxBytes; size *= 4) {
+        // 小區塊多跑幾次，大區塊至少 3 次
+        const int iterations = static_cast<int>(qBound<qint64>(3, (64LL << 20) / size, 500));
+        Samples s;
+        QElapsedTimer t;
+        for (int i = 0; i < iterations; ++i) {
+            qint64 written = 0;
+            t.start();
+            if (!inst.queryBinary(QString("BENCH:BLOCK? %1").arg(size), buffer.get(), maxBytes, written)
+                || written != size) {
+                qWarning() << "[ate_bench] queryBinary failed at" << size << "bytes";
+                break;
+            }
+            s.ns.append(t.nsecsElapsed());
+        }
+        results.append(makeResult("query_binary", QJsonObject{{"bytes", double(size)}}, s, size));
+    }
+    return results;
+}
+
+// 與 Page3ViewModel::applyLoadSettings + runBatchedPerMainframe 相同的指令序列：
+// 每個通道 CHAN / Von / CCH、CCL 斜率 / 電流（含檔位選擇），整台 mainframe 一個 batch + *OPC?
+QJsonObject benchApplyLoadFrame(ICommunication* comm, int channels, int iterations, bool batched)
+{
+    QVector<Chroma6310*> loads;
+    for (int i = 0; i < channels; ++i) {
+        auto* load = new Chroma6310("63102", comm);
+        load->setRealChannel(i + 1);
+        loads.append(load);
+    }
+
+    StaticCurrentParam param;
+    param.levels = {1.0, 1.0};
+    param.enabledMask = {true, true};
+    param.expectedVoltage = 12.0;
+
+    Samples s;
+    QElapsedTimer t;
+    for (int it = 0; it < iterations; ++it) {
+        t.start();
+        ScpiCommandBatch batch(comm, loads.first()->maxBatchMessageLength());
+        for (Chroma6310* load : loads) {
+            if (batched) load->attachBatch(&batch);
+            load->setChannel(load->realChannel());
+            load->setVon(1.0);
+            load->setLoadMode("CCH");
+            load->setStaticRiseSlope(2.5);
+            load->setStaticFallSlope(2.5);
+            load->setLoadMode("CCL");
+            load->setStaticRiseSlope(0.25);
+            load->setStaticFallSlope(0.25);
+            load->setStaticCurrent(param);
+            if (batched) load->detachBatch();
+        }
+        if (batched && !batch.flush(true)) {
+            qWarning() << "[ate_bench] Batch flush failed:" << batch.lastError();
+            break;
+        }
+        s.ns.append(t.nsecsElapsed());
+    }
+
+    qDeleteAll(loads);
+    return makeResult("apply_load_frame", QJsonObject{{"channels", channels}, {"batched", batched}}, s);
+}
+
+// AsyncInstrumentIo 扇出：每輪對 sessions 台替身各送一個查詢，全部回應到齊才算一輪
+// 所有 TCP 連線都在同一條 I/O 執行緒上推進
+QJsonObject benchAsyncFanout(int sessions, int iterations)
+{
+    std::vector<std::unique_ptr<LoopbackScpiServer>> servers;
+    std::vector<InstrumentSessionLease> leases;
+    for (int i = 0; i < sessions; ++i) {
+        auto server = std::make_unique<LoopbackScpiServer>();
+        if (!server->start()) break;
+        InstrumentSessionLease lease = InstrumentSessionPool::instance().acquire(
+            QString("TCPIP::127.0.0.1:%1").arg(server->port()));
+        if (!lease.isValid()) {
+            qWarning() << "[ate_bench] Acquire failed:" << lease.errorString();
+            break;
+        }
+        servers.push_back(std::move(server));
+        leases.push_back(std::move(lease));
+    }
+
+    Samples s;
+    QElapsedTimer t;
+    QVector<QFuture<AsyncReply>> pending;
+    pending.reserve(static_cast<int>(leases.size()));
+    for (int it = 0; it < iterations && !leases.empty(); ++it) {
+        t.start();
+        pending.clear();
+        for (const InstrumentSessionLease& lease : leases)
+            pending.append(AsyncInstrumentIo::instance().query(lease, "MEAS:VOLT?", 1000));
+        bool ok = true;
+        for (QFuture<AsyncReply>& f : pending) ok = f.result().ok && ok;
+        if (!ok) {
+            qWarning() << "[ate_bench] Async query failed";
+            break;
+        }
+        s.ns.append(t.nsecsElapsed());
+    }
+
+    // 替身關閉前先丟棄連線，之後的 acquire 不會拿到對端已關閉的 socket
+    for (const InstrumentSessionLease& lease : leases)
+        InstrumentSessionPool::instance().invalidate(lease.resource());
+    leases.clear();
+    return makeResult("async_query_fanout", QJsonObject{{"sessions", static_cast<int>(servers.size())}}, s);
+}
+
+// selectOptimalLoadMode 每秒呼叫次數
+QJsonObject benchSelectMode(int iterations)
+{
+    static const QStringList models = {"63101", "63102", "63103", "63105", "63106", "63108", "63112"};
+    Samples s;
+    QElapsedTimer t;
+    int sink = 0;
+    const int callsPerSample = 1000;
+    for (int it = 0; it < iterations; ++it) {
+        t.start();
+        for (int i = 0; i < callsPerSample; ++i) {
+            const QString& model = models[i % models.size()];
+            const double current = 0.05 * (i % 400);
+            sink += selectOptimalLoadMode(model, current, 5.0 + (i % 50)).size();
+        }
+        s.ns.append(t.nsecsElapsed() / callsPerSample);
+    }
+    Q_UNUSED(sink);
+    return makeResult("select_optimal_load_mode", QJsonObject{{"models", models.size()}}, s);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ate_bench");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption outOpt("out", "JSON output file (default: stdout).", "file");
+    QCommandLineOption channelsOpt("channels", "DC load channels per apply frame.", "n", "8");
+    QCommandLineOption iterOpt("iterations", "Iterations for latency benchmarks.", "n", "2000");
+    QCommandLineOption blockOpt("max-block-mb", "Largest queryBinary block in MB.", "mb", "256");
+    QCommandLineOption resourceOpt("resource", "Use this resource instead of the loopback stand-in.", "res");
+    QCommandLineOption asyncOpt("async-sessions", "Loopback stand-ins queried at once by async_query_fanout.", "n", "16");
+    parser.addOptions({outOpt, channelsOpt, iterOpt, blockOpt, resourceOpt, asyncOpt});
+    parser.process(app);
+
+    const int channels = qMax(1, parser.value(channelsOpt).toInt());
+    const int iterations = qMax(1, parser.value(iterOpt).toInt());
+    const qint64 maxBlock = qMax<qint64>(1024, parser.value(blockOpt).toLongLong() << 20);
+
+    LoopbackScpiServer server;
+    QString resource = parser.value(resourceOpt);
+    const bool loopback = resource.isEmpty();
+    if (loopback) {
+        if (!server.start()) return 1;
+        resource = QString("TCPIP::127.0.0.1:%1").arg(server.port());
+    }
+
+    std::unique_ptr<ICommunication> comm(CommunicationFactory::create(resource));
+    if (!comm || !comm->open()) {
+        qCritical() << "[ate_bench] Cannot open" << resource << (comm ? comm->lastError() : QString());
+        return 1;
+    }
+    comm->setTimeout(10000);
+
+    QJsonArray results;
+    results.append(benchQueryRtt(comm.get(), iterations));
+    if (loopback) {
+        for (const QJsonValue& v : benchQueryBinary(comm.get(), maxBlock))
+            results.append(v);
+        results.append(benchAsyncFanout(qMax(1, parser.value(asyncOpt).toInt()), qMax(1, iterations / 10)));
+    }
+    results.append(benchApplyLoadFrame(comm.get(), channels, qMax(1, iterations / 10), true));
+    results.append(benchApplyLoadFrame(comm.get(), channels, qMax(1, iterations / 10), false));
+    results.append(benchSelectMode(qMax(10, iterations / 10)));
+
+    comm->close();
+
+    QJsonObject report{
+        {"tool", "ate_bench"},
+        {"timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+        {"qt_version", QString(qVersion())},
+        {"host", QSysInfo::machineHostName()},
+        {"cpu", QSysInfo::currentCpuArchitecture()},
+        {"resource", loopback ? QString("loopback") : resource},
+        {"results", results},
+    };
+    const QByteArray json = QJsonDocument(report).toJson();
+
+    const QString outPath = parser.value(outOpt);
+    if (outPath.isEmpty()) {
+        QTextStream(stdout) << json;
+    } else {
+        QFile f(outPath);
+        if (!f.open(QIODevice::WriteOnly) || f.write(json) != json.size()) {
+            qCritical() << "[ate_bench] Write failed:" << outPath;
+            return 1;
+        }
+    }
+    return 0;
+}
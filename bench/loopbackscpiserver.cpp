@@ -0,0 +1,158 @@
+#include "loopbackscpiserver.h"
+#include <QHostAddress>
+#include <QList>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QDebug>
+
+namespace {
+const int patternSize = 1 << 20;          // 每次寫入 1 MB
+const qint64 maxQueued = 8LL << 20;       // socket 待送資料上限，避免 256 MB 區塊整個進記憶體
+}
+
+LoopbackScpiServer::LoopbackScpiServer()
+    : m_pattern(patternSize, Qt::Uninitialized)
+{
+    for (int i = 0; i < m_pattern.size(); ++i)
+        m_pattern[i] = static_cast<char>(i * 31 + 7);
+}
+
+LoopbackScpiServer::~LoopbackScpiServer()
+{
+    stop();
+}
+
+bool LoopbackScpiServer::start()
+{
+    if (m_thread) return true;
+
+    m_thread = new QThread();
+    m_thread->setObjectName("LoopbackScpi");
+    moveToThread(m_thread);
+    m_thread->start();
+
+    bool ok = false;
+    QMetaObject::invokeMethod(this, [this, &ok]() { ok = listen(); }, Qt::BlockingQueuedConnection);
+    if (!ok) stop();
+    return ok;
+}
+
+void LoopbackScpiServer::stop()
+{
+    if (!m_thread) return;
+    QMetaObject::invokeMethod(this, [this]() {
+        const QList<QTcpSocket*> sockets = m_clients.keys();
+        m_clients.clear();
+        for (QTcpSocket* s : sockets) {
+            s->disconnect(this);
+            delete s;
+        }
+        delete m_server;
+        m_server = nullptr;
+        moveToThread(nullptr);
+    }, Qt::BlockingQueuedConnection);
+    m_thread->quit();
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+bool LoopbackScpiServer::listen()
+{
+    m_server = new QTcpServer();
+    if (!m_server->listen(QHostAddress::LocalHost, 0)) {
+        qWarning() << "[LoopbackScpi] Listen failed:" << m_server->errorString();
+        return false;
+    }
+    m_port = m_server->serverPort();
+    connect(m_server, &QTcpServer::newConnection, this, &LoopbackScpiServer::onNewConnection);
+    return true;
+}
+
+void LoopbackScpiServer::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        socket->setParent(nullptr);
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        m_clients.insert(socket, Client());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::bytesWritten, this, [this, socket]() { pump(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_clients.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void LoopbackScpiServer::onReadyRead(QTcpSocket* socket)
+{
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end()) return;
+    Client& client = it.value();
+    client.rx.append(socket->readAll());
+
+    // 指令不一定帶 LF：沒有後續資料時剩下的內容當成一筆訊息
+    while (!client.rx.isEmpty()) {
+        int idx = client.rx.indexOf('\n');
+        if (idx < 0) {
+            if (socket->bytesAvailable() > 0) break;
+            idx = client.rx.size() - 1;
+        }
+        const QByteArray message = client.rx.left(idx + 1).trimmed();
+        client.rx.remove(0, idx + 1);
+        if (!message.isEmpty()) handleMessage(socket, client, message);
+    }
+}
+
+void LoopbackScpiServer::handleMessage(QTcpSocket* socket, Client& client, const QByteArray& message)
+{
+    QList<QByteArray> replies;
+    for (QByteArray unit : message.split(';')) {
+        unit = unit.trimmed();
+        while (unit.startsWith(':')) unit.remove(0, 1);
+        const QByteArray upper = unit.toUpper();
+
+        if (upper.startsWith("BENCH:BLOCK?")) {
+            // 區塊回應必須是訊息中最後一個回應
+            const qint64 n = unit.mid(12).trimmed().toLongLong();
+            QByteArray head;
+            for (const QByteArray& r : replies) head += r + ';';
+            const QByteArray len = QByteArray::number(n);
+            head += '#' + QByteArray::number(len.size()) + len;
+            socket->write(head);
+            client.blockRemain = n;
+            if (n <= 0) socket->write("\n", 1);
+            pump(socket);
+            return;
+        }
+        if (!upper.contains('?')) continue;
+        if (upper == "*IDN?") replies << "BENCH,LOOPBACK,0,1.0";
+        else if (upper == "*OPC?") replies << "1";
+        else replies << "1.234567E+00";
+    }
+
+    if (!replies.isEmpty()) {
+        QByteArray out;
+        for (int i = 0; i < replies.size(); ++i) {
+            if (i) out += ';';
+            out += replies[i];
+        }
+        out += '\n';
+        socket->write(out);
+    }
+}
+
+void LoopbackScpiServer::pump(QTcpSocket* socket)
+{
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end()) return;
+    Client& client = it.value();
+
+    while (client.blockRemain > 0 && socket->bytesToWrite() < maxQueued) {
+        const int n = static_cast<int>(qMin<qint64>(client.blockRemain, m_pattern.size()));
+        socket->write(m_pattern.constData(), n);
+        client.blockRemain -= n;
+        if (client.blockRemain == 0) socket->write("\n", 1);
+    }
+}
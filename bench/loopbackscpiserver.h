@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+
+class QTcpServer;
+class QTcpSocket;
+class QThread;
+
+// ate_bench 用的本機 SCPI 替身（127.0.0.1，隨機 port），跑在自己的執行緒
+//   *IDN?              → 固定字串
+//   *OPC?              → 1
+//   BENCH:BLOCK? <n>   → n bytes 的 IEEE-488.2 定長區塊（分段送出，不一次配置）
+//   其他查詢           → 固定數值；複合訊息中多個查詢以 ';' 串接回應
+//   設定指令           → 不回應
+class LoopbackScpiServer : public QObject
+{
+    Q_OBJECT
+public:
+    LoopbackScpiServer();
+    ~LoopbackScpiServer() override;
+
+    bool start();
+    void stop();
+    quint16 port() const { return m_port; }
+
+private:
+    struct Client {
+        QByteArray rx;
+        qint64 blockRemain = 0;
+    };
+
+    bool listen();
+    void onNewConnection();
+    void onReadyRead(QTcpSocket* socket);
+    void handleMessage(QTcpSocket* socket, Client& client, const QByteArray& message);
+    void pump(QTcpSocket* socket);
+
+    QThread* m_thread = nullptr;
+    QTcpServer* m_server = nullptr;
+    QHash<QTcpSocket*, Client> m_clients;
+    QByteArray m_pattern;       // 區塊內容，重複送出
+    quint16 m_port = 0;
+};
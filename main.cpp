@@ -1,10 +1,16 @@
 #include "mainwindow.h"
+#include "instrumentmetrics.h"
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
 
+    // 設定 ATE_METRICS_DIR 時定期輸出儀器通訊統計（JSON / CSV）
+    const QString metricsDir = qEnvironmentVariable("ATE_METRICS_DIR");
+    if (!metricsDir.isEmpty())
+        InstrumentMetrics::instance().startPeriodicDump(metricsDir);
+
     MainWindow *window = new MainWindow();
     window->show();
 
@@ -1,6 +1,5 @@
 #include "page1model.h"
 #include <QFile>
-#include <QDomDocument>
 #include <QDebug>
 
 Page1Model::Page1Model(QObject *parent)
@@ -13,23 +12,21 @@ void Page1Model::setInstrumentConfigs(const QList<InstrumentConfig>& configs) {
 }
 
 bool Page1Model::loadBaseXml(const QString &fileName) {
-    QDomDocument doc;
-    if (!openAndParseXmlFile(fileName, doc)) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         return false;
     }
 
-    QDomElement root = doc.documentElement();
-    if (root.tagName() != "root") {
+    // 單次串流解析，不建 DOM；範本可能出現在引用它的儀器之後，ref 等整份讀完再解析
+    QXmlStreamReader reader(&file);
+    QList<BaseInstrument> instruments;
+    if (!readBaseInstruments(reader, instruments)) {
+        qWarning() << "[Page1Model] Failed to parse" << fileName << reader.errorString();
         return false;
     }
 
     clearAllMaps();
-
-    QDomElement instsElem = root.firstChildElement("instruments");
-    QDomNodeList nodes = instsElem.elementsByTagName("instrument");
-
-    collectTemplates(nodes);
-    processInstruments(nodes);
+    processInstruments(instruments);
 
     m_config.loadOutputs = 1;
     m_config.relayOutputs = 1;
@@ -39,17 +36,25 @@ bool Page1Model::loadBaseXml(const QString &fileName) {
 }
 
 void Page1Model::writeXml(QXmlStreamWriter& writer) const {
+    writeConfigXml(writer, m_config);
+}
+
+void Page1Model::loadXml(QXmlStreamReader& reader) {
+    applyLoadedConfig(readConfigXml(reader));
+}
+
+void Page1Model::writeConfigXml(QXmlStreamWriter& writer, const Page1Config& config) {
     writer.writeStartElement("Page1");
-    writer.writeTextElement("LoadOutputs", QString::number(m_config.loadOutputs));
-    writer.writeTextElement("RelayOutputs", QString::number(m_config.relayOutputs));
-    writeInstruments(writer);
+    writer.writeTextElement("LoadOutputs", QString::number(config.loadOutputs));
+    writer.writeTextElement("RelayOutputs", QString::number(config.relayOutputs));
+    writeInstruments(writer, config);
     writer.writeEndElement(); // Page1
 }
 
-void Page1Model::loadXml(QXmlStreamReader& reader) {
+Page1Config Page1Model::readConfigXml(QXmlStreamReader& reader) {
     Page1Config config;
 
-    while (!(reader.isEndElement() && reader.name() == "Page1")) {
+    while (!reader.atEnd() && !(reader.isEndElement() && reader.name() == "Page1")) {
         reader.readNext();
 
         if (!reader.isStartElement()) {
@@ -67,25 +72,112 @@ void Page1Model::loadXml(QXmlStreamReader& reader) {
         }
     }
 
+    return config;
+}
+
+void Page1Model::applyLoadedConfig(const Page1Config& config) {
     m_config = config;
     emit configLoaded(m_config);
 }
 
 // ========== Private Helper Methods for loadBaseXml ==========
 
-bool Page1Model::openAndParseXmlFile(const QString& fileName, QDomDocument& doc) {
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+// <root><instruments> 底下所有 <instrument>；只讀第一個 <instruments>
+bool Page1Model::readBaseInstruments(QXmlStreamReader& reader, QList<BaseInstrument>& instruments) {
+    if (!reader.readNextStartElement() || reader.name() != "root") {
         return false;
     }
 
-    if (!doc.setContent(&file)) {
-        file.close();
-        return false;
+    while (reader.readNextStartElement()) {
+        if (reader.name() != "instruments") {
+            reader.skipCurrentElement();
+            continue;
+        }
+
+        int depth = 0;
+        while (!reader.atEnd()) {
+            reader.readNext();
+            if (reader.isEndElement()) {
+                if (depth == 0) break;
+                --depth;
+            }
+            else if (reader.isStartElement()) {
+                if (reader.name() == "instrument") {
+                    instruments.append(readBaseInstrument(reader));
+                } else {
+                    ++depth;
+                }
+            }
+        }
+        break;
     }
 
-    file.close();
-    return true;
+    return !reader.hasError();
+}
+
+Page1Model::BaseInstrument Page1Model::readBaseInstrument(QXmlStreamReader& reader) {
+    BaseInstrument instrument;
+    const QXmlStreamAttributes attrs = reader.attributes();
+    instrument.name = attrs.value("name").toString();
+    instrument.type = attrs.value("type").toString();
+    instrument.hasRef = attrs.hasAttribute("ref");
+    instrument.ref = attrs.value("ref").toString();
+
+    int depth = 0;
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isEndElement()) {
+            if (depth == 0) break;
+            --depth;
+        }
+        else if (reader.isStartElement()) {
+            if (reader.name() == "model") {
+                instrument.models.append(readBaseModel(reader));
+            } else {
+                ++depth;
+            }
+        }
+    }
+
+    return instrument;
+}
+
+// modelName / channels 取第一個直接子元素，subModel 取所有子孫（與原本 DOM 查詢相同）
+Page1Model::BaseModel Page1Model::readBaseModel(QXmlStreamReader& reader) {
+    BaseModel model;
+    bool hasName = false;
+    bool hasChannels = false;
+
+    int depth = 0;
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isEndElement()) {
+            if (depth == 0) break;
+            --depth;
+            continue;
+        }
+        if (!reader.isStartElement()) {
+            continue;
+        }
+
+        if (reader.name() == "subModel") {
+            model.subModels << reader.attributes().value("name").toString();
+        }
+        else if (depth == 0 && reader.name() == "modelName" && !hasName) {
+            model.modelName = reader.readElementText(QXmlStreamReader::IncludeChildElements);
+            hasName = true;
+            continue;   // readElementText 已讀到結束標籤
+        }
+        else if (depth == 0 && reader.name() == "channels" && !hasChannels) {
+            const QString channelsText = reader.readElementText(QXmlStreamReader::IncludeChildElements);
+            model.channels = channelsText.split(",", Qt::SkipEmptyParts);
+            hasChannels = true;
+            continue;
+        }
+        ++depth;
+    }
+
+    return model;
 }
 
 void Page1Model::clearAllMaps() {
@@ -94,35 +186,29 @@ void Page1Model::clearAllMaps() {
     modelNames.clear();
     subModelMap.clear();
     channelsMap.clear();
-    templateMap.clear();
 }
 
-void Page1Model::collectTemplates(const QDomNodeList& nodes) {
-    for (int i = 0; i < nodes.count(); ++i) {
-        QDomElement element = nodes.at(i).toElement();
-        if (element.attribute("type") == "Template") {
-            templateMap[element.attribute("name")] = element;
+void Page1Model::processInstruments(const QList<BaseInstrument>& instruments) {
+    QMap<QString, QList<BaseModel>> templates;
+    for (const auto& instrument : instruments) {
+        if (instrument.type == "Template") {
+            templates[instrument.name] = instrument.models;
         }
     }
-}
 
-void Page1Model::processInstruments(const QDomNodeList& nodes) {
-    for (int i = 0; i < nodes.count(); ++i) {
-        QDomElement element = nodes.at(i).toElement();
-        QString type = element.attribute("type");
-
-        if (type == "Template") {
+    for (const auto& instrument : instruments) {
+        if (instrument.type == "Template") {
             continue;
         }
 
-        InstrumentConfig ic = createInstrumentConfig(element);
-        QList<QDomElement> models = getModelElements(element);
-
-        processModels(models, type, ic.name);
+        InstrumentConfig ic = createInstrumentConfig(instrument);
+        const QList<BaseModel> models = instrument.hasRef ? templates.value(instrument.ref)
+                                                          : instrument.models;
 
         QStringList modelNamesList;
-        for (const auto& modelElement : models) {
-            modelNamesList << modelElement.firstChildElement("modelName").text();
+        for (const auto& model : models) {
+            processModel(model, instrument.type);
+            modelNamesList << model.modelName;
         }
         xmlModelMap[ic.name] = modelNamesList;
 
@@ -130,10 +216,10 @@ void Page1Model::processInstruments(const QDomNodeList& nodes) {
     }
 }
 
-InstrumentConfig Page1Model::createInstrumentConfig(const QDomElement& element) {
+InstrumentConfig Page1Model::createInstrumentConfig(const BaseInstrument& instrument) {
     InstrumentConfig ic;
-    ic.name = element.attribute("name");
-    ic.type = element.attribute("type");
+    ic.name = instrument.name;
+    ic.type = instrument.type;
     ic.modelName = "";
     ic.address = "";
     ic.enabled = true;
@@ -141,76 +227,27 @@ InstrumentConfig Page1Model::createInstrumentConfig(const QDomElement& element)
     return ic;
 }
 
-QList<QDomElement> Page1Model::getModelElements(const QDomElement& element) {
-    QList<QDomElement> models;
-
-    if (element.hasAttribute("ref")) {
-        QString ref = element.attribute("ref");
-        if (templateMap.contains(ref)) {
-            QDomNodeList refModels = templateMap[ref].elementsByTagName("model");
-            for (int i = 0; i < refModels.count(); ++i) {
-                models.append(refModels.at(i).toElement());
-            }
-        }
-    } else {
-        QDomNodeList directModels = element.elementsByTagName("model");
-        for (int i = 0; i < directModels.count(); ++i) {
-            models.append(directModels.at(i).toElement());
-        }
-    }
-
-    return models;
-}
-
-void Page1Model::processModels(const QList<QDomElement>& models, const QString& type, const QString& instrumentName) {
-    for (const auto& modelElement : models) {
-        QString modelName = modelElement.firstChildElement("modelName").text();
-        processModel(modelElement, type, modelName);
-    }
-}
-
-void Page1Model::processModel(const QDomElement& modelElement, const QString& type, const QString& modelName) {
+void Page1Model::processModel(const BaseModel& model, const QString& type) {
     // 更新 modelNames（僅對 "Load" 類型）
-    if (type == "Load" && !modelNames.contains(modelName)) {
-        modelNames.append(modelName);
+    if (type == "Load" && !modelNames.contains(model.modelName)) {
+        modelNames.append(model.modelName);
     }
 
-    // 提取並保存 subModels
-    QStringList subModels = extractSubModels(modelElement);
-    subModelMap[modelName] = subModels;
-
-    // 提取並保存 channels
-    QStringList channels = extractChannels(modelElement);
-    channelsMap[modelName] = channels;
-}
-
-QStringList Page1Model::extractSubModels(const QDomElement& modelElement) {
-    QStringList subModels;
-    QDomNodeList subModelNodes = modelElement.elementsByTagName("subModel");
-
-    for (int i = 0; i < subModelNodes.count(); ++i) {
-        subModels << subModelNodes.at(i).toElement().attribute("name");
-    }
-
-    return subModels;
-}
-
-QStringList Page1Model::extractChannels(const QDomElement& modelElement) {
-    QString channelsText = modelElement.firstChildElement("channels").text();
-    return channelsText.split(",", Qt::SkipEmptyParts);
+    subModelMap[model.modelName] = model.subModels;
+    channelsMap[model.modelName] = model.channels;
 }
 
 // ========== Private Helper Methods for writeXml ==========
 
-void Page1Model::writeInstruments(QXmlStreamWriter& writer) const {
+void Page1Model::writeInstruments(QXmlStreamWriter& writer, const Page1Config& config) {
     writer.writeStartElement("Instruments");
-    for (const auto& ic : m_config.instruments) {
+    for (const auto& ic : config.instruments) {
         writeInstrument(writer, ic);
     }
     writer.writeEndElement(); // Instruments
 }
 
-void Page1Model::writeInstrument(QXmlStreamWriter& writer, const InstrumentConfig& ic) const {
+void Page1Model::writeInstrument(QXmlStreamWriter& writer, const InstrumentConfig& ic) {
     writer.writeStartElement("Instrument");
     writer.writeAttribute("name", ic.name);
     writer.writeAttribute("type", ic.type);
@@ -221,7 +258,7 @@ void Page1Model::writeInstrument(QXmlStreamWriter& writer, const InstrumentConfi
     writer.writeEndElement(); // Instrument
 }
 
-void Page1Model::writeChannels(QXmlStreamWriter& writer, const InstrumentConfig& ic) const {
+void Page1Model::writeChannels(QXmlStreamWriter& writer, const InstrumentConfig& ic) {
     writer.writeStartElement("Channels");
     for (const auto& ch : ic.channels) {
         writer.writeStartElement("Channel");
@@ -235,7 +272,7 @@ void Page1Model::writeChannels(QXmlStreamWriter& writer, const InstrumentConfig&
 // ========== Private Helper Methods for loadXml ==========
 
 void Page1Model::loadInstrumentsFromXml(QXmlStreamReader& reader, Page1Config& config) {
-    while (!(reader.isEndElement() && reader.name() == "Instruments")) {
+    while (!reader.atEnd() && !(reader.isEndElement() && reader.name() == "Instruments")) {
         reader.readNext();
 
         if (reader.isStartElement() && reader.name() == "Instrument") {
@@ -251,7 +288,7 @@ InstrumentConfig Page1Model::loadInstrumentFromXml(QXmlStreamReader& reader) {
     ic.type = reader.attributes().value("type").toString();
     ic.enabled = (reader.attributes().value("enabled") == "true");
 
-    while (!(reader.isEndElement() && reader.name() == "Instrument")) {
+    while (!reader.atEnd() && !(reader.isEndElement() && reader.name() == "Instrument")) {
         reader.readNext();
 
         if (!reader.isStartElement()) {
@@ -273,7 +310,7 @@ InstrumentConfig Page1Model::loadInstrumentFromXml(QXmlStreamReader& reader) {
 }
 
 void Page1Model::loadChannelsFromXml(QXmlStreamReader& reader, InstrumentConfig& ic) {
-    while (!(reader.isEndElement() && reader.name() == "Channels")) {
+    while (!reader.atEnd() && !(reader.isEndElement() && reader.name() == "Channels")) {
         reader.readNext();
 
         if (reader.isStartElement() && reader.name() == "Channel") {
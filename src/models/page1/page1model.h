@@ -4,7 +4,6 @@
 #include <QList>
 #include <QStringList>
 #include <QMap>
-#include <QDomElement>
 #include <QFile>
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
@@ -34,33 +33,47 @@ public:
     void writeXml(QXmlStreamWriter& writer) const;
     void loadXml(QXmlStreamReader& reader);
 
+    // 不碰成員的版本：可在背景執行緒序列化 / 解析，結果再回到 GUI 執行緒套用
+    static void writeConfigXml(QXmlStreamWriter& writer, const Page1Config& config);
+    static Page1Config readConfigXml(QXmlStreamReader& reader);
+    void applyLoadedConfig(const Page1Config& config);
+
 signals:
     void configLoaded(const Page1Config &cfg);
 
 private:
+    // 範本檔（Instrument.xml）單次串流解析的結果
+    struct BaseModel {
+        QString modelName;
+        QStringList subModels;
+        QStringList channels;
+    };
+    struct BaseInstrument {
+        QString name;
+        QString type;
+        QString ref;
+        bool hasRef = false;
+        QList<BaseModel> models;
+    };
+
     // Helper methods for loadBaseXml
-    bool openAndParseXmlFile(const QString& fileName, QDomDocument& doc);
+    static bool readBaseInstruments(QXmlStreamReader& reader, QList<BaseInstrument>& instruments);
+    static BaseInstrument readBaseInstrument(QXmlStreamReader& reader);
+    static BaseModel readBaseModel(QXmlStreamReader& reader);
     void clearAllMaps();
-    void collectTemplates(const QDomNodeList& nodes);
-    void processInstruments(const QDomNodeList& nodes);
-
-    InstrumentConfig createInstrumentConfig(const QDomElement& element);
-    QList<QDomElement> getModelElements(const QDomElement& element);
-    void processModels(const QList<QDomElement>& models, const QString& type, const QString& instrumentName);
-    void processModel(const QDomElement& modelElement, const QString& type, const QString& modelName);
-
-    QStringList extractSubModels(const QDomElement& modelElement);
-    QStringList extractChannels(const QDomElement& modelElement);
+    void processInstruments(const QList<BaseInstrument>& instruments);
+    InstrumentConfig createInstrumentConfig(const BaseInstrument& instrument);
+    void processModel(const BaseModel& model, const QString& type);
 
     // Helper methods for loadXml
-    void loadInstrumentsFromXml(QXmlStreamReader& reader, Page1Config& config);
-    InstrumentConfig loadInstrumentFromXml(QXmlStreamReader& reader);
-    void loadChannelsFromXml(QXmlStreamReader& reader, InstrumentConfig& ic);
+    static void loadInstrumentsFromXml(QXmlStreamReader& reader, Page1Config& config);
+    static InstrumentConfig loadInstrumentFromXml(QXmlStreamReader& reader);
+    static void loadChannelsFromXml(QXmlStreamReader& reader, InstrumentConfig& ic);
 
     // Helper methods for writeXml
-    void writeInstruments(QXmlStreamWriter& writer) const;
-    void writeInstrument(QXmlStreamWriter& writer, const InstrumentConfig& ic) const;
-    void writeChannels(QXmlStreamWriter& writer, const InstrumentConfig& ic) const;
+    static void writeInstruments(QXmlStreamWriter& writer, const Page1Config& config);
+    static void writeInstrument(QXmlStreamWriter& writer, const InstrumentConfig& ic);
+    static void writeChannels(QXmlStreamWriter& writer, const InstrumentConfig& ic);
 
 private:
     Page1Config m_config;
@@ -68,5 +81,4 @@ private:
     QMap<QString, QStringList> xmlModelMap;
     QMap<QString, QStringList> subModelMap;
     QMap<QString, QStringList> channelsMap; //QMap(("6304", QList("1", "2", "3", "4"))("6314", QList("1", "3", "5", "7"))("6334A", QList("1", "3", "5", "7"))("DE-A3000AB", QList())("DPO7000", QList())("Relay_RTU", QList("1", "2", "3", "4")))
-    QMap<QString, QDomElement> templateMap;
 };
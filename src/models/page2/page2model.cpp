@@ -8,25 +8,55 @@ Page2Model::Page2Model(QObject *parent)
 // ========== 主要 XML 操作 ==========
 
 void Page2Model::writeXml(QXmlStreamWriter& writer) const
+{
+    writeTablesXml(writer, tables());
+}
+
+void Page2Model::loadXml(QXmlStreamReader& reader)
+{
+    applyLoadedTables(readTablesXml(reader));
+}
+
+Page2Model::Tables Page2Model::tables() const
+{
+    return { inputRows, relayRows, loadMeta, loadRows, dynamicMeta, dynamicRows };
+}
+
+void Page2Model::applyLoadedTables(const Tables& tables)
+{
+    inputRows = tables.inputRows;
+    relayRows = tables.relayRows;
+    loadMeta = tables.loadMeta;
+    loadRows = tables.loadRows;
+    dynamicMeta = tables.dynamicMeta;
+    dynamicRows = tables.dynamicRows;
+
+    emit configLoaded();
+}
+
+// 共享同一份資料時 QVector 比較只看指標，未變動的存檔檢查是 O(1)
+bool Page2Model::Tables::operator==(const Tables& other) const
+{
+    return inputRows == other.inputRows && relayRows == other.relayRows
+           && loadMeta == other.loadMeta && loadRows == other.loadRows
+           && dynamicMeta == other.dynamicMeta && dynamicRows == other.dynamicRows;
+}
+
+void Page2Model::writeTablesXml(QXmlStreamWriter& writer, const Tables& tables)
 {
     writer.writeStartElement("Page2");
 
-    XmlWriter::writeInputTable(writer, inputRows);
-    XmlWriter::writeRelayTable(writer, relayRows);
-    XmlWriter::writeLoadTable(writer, loadMeta, loadRows);
-    XmlWriter::writeDynamicTable(writer, dynamicMeta, dynamicRows);
+    XmlWriter::writeInputTable(writer, tables.inputRows);
+    XmlWriter::writeRelayTable(writer, tables.relayRows);
+    XmlWriter::writeLoadTable(writer, tables.loadMeta, tables.loadRows);
+    XmlWriter::writeDynamicTable(writer, tables.dynamicMeta, tables.dynamicRows);
 
     writer.writeEndElement(); // Page2
 }
 
-void Page2Model::loadXml(QXmlStreamReader& reader)
+Page2Model::Tables Page2Model::readTablesXml(QXmlStreamReader& reader)
 {
-    inputRows.clear();
-    relayRows.clear();
-    loadMeta = {};
-    loadRows.clear();
-    dynamicMeta = {};
-    dynamicRows.clear();
+    Tables tables;
 
     while (!reader.atEnd()) {
         reader.readNext();
@@ -37,21 +67,21 @@ void Page2Model::loadXml(QXmlStreamReader& reader)
 
         if (reader.isStartElement()) {
             if (reader.name() == "InputTable") {
-                XmlReader::readInputTable(reader, inputRows);
+                XmlReader::readInputTable(reader, tables.inputRows);
             }
             else if (reader.name() == "RelayTable") {
-                XmlReader::readRelayTable(reader, relayRows);
+                XmlReader::readRelayTable(reader, tables.relayRows);
             }
             else if (reader.name() == "LoadTable") {
-                XmlReader::readLoadTable(reader, loadMeta, loadRows);
+                XmlReader::readLoadTable(reader, tables.loadMeta, tables.loadRows);
             }
             else if (reader.name() == "DynamicTable") {
-                XmlReader::readDynamicTable(reader, dynamicMeta, dynamicRows);
+                XmlReader::readDynamicTable(reader, tables.dynamicMeta, tables.dynamicRows);
             }
         }
     }
 
-    emit configLoaded();
+    return tables;
 }
 
 // ========== XML 寫入器實現 ==========
@@ -93,18 +123,18 @@ void Page2Model::XmlWriter::writeLoadTable(QXmlStreamWriter& w, const LoadMetaRo
     w.writeStartElement("Meta");
     writeStringVector(w, "Mode", meta.modes);
     writeStringVector(w, "Name", meta.names);
-    writeStringVector(w, "Vo", meta.vo);
-    writeStringVector(w, "Von", meta.von);
-    writeStringVector(w, "RiseSlopeCCH", meta.riseSlopeCCH);
-    writeStringVector(w, "FallSlopeCCH", meta.fallSlopeCCH);
-    writeStringVector(w, "RiseSlopeCCL", meta.riseSlopeCCL);
-    writeStringVector(w, "FallSlopeCCL", meta.fallSlopeCCL);
+    writeNumericColumn(w, "Vo", meta.vo);
+    writeNumericColumn(w, "Von", meta.von);
+    writeNumericColumn(w, "RiseSlopeCCH", meta.riseSlopeCCH);
+    writeNumericColumn(w, "FallSlopeCCH", meta.fallSlopeCCH);
+    writeNumericColumn(w, "RiseSlopeCCL", meta.riseSlopeCCL);
+    writeNumericColumn(w, "FallSlopeCCL", meta.fallSlopeCCL);
     w.writeEndElement(); // Meta
 
     // Rows
     w.writeStartElement("Rows");
     for (const auto& row : rows) {
-        writeDataRow(w, row.label, row.values);
+        writeDataRow(w, row.label, row.values.toStrings());
     }
     w.writeEndElement(); // Rows
 
@@ -118,12 +148,12 @@ void Page2Model::XmlWriter::writeDynamicTable(QXmlStreamWriter& w, const Dynamic
 
     // Meta
     w.writeStartElement("Meta");
-    writeStringVector(w, "Vo", meta.vo);
-    writeStringVector(w, "Von", meta.von);
-    writeStringVector(w, "RiseSlopeCCDH", meta.riseSlopeCCDH);
-    writeStringVector(w, "FallSlopeCCDH", meta.fallSlopeCCDH);
-    writeStringVector(w, "RiseSlopeCCDL", meta.riseSlopeCCDL);
-    writeStringVector(w, "FallSlopeCCDL", meta.fallSlopeCCDL);
+    writeNumericColumn(w, "Vo", meta.vo);
+    writeNumericColumn(w, "Von", meta.von);
+    writeNumericColumn(w, "RiseSlopeCCDH", meta.riseSlopeCCDH);
+    writeNumericColumn(w, "FallSlopeCCDH", meta.fallSlopeCCDH);
+    writeNumericColumn(w, "RiseSlopeCCDL", meta.riseSlopeCCDL);
+    writeNumericColumn(w, "FallSlopeCCDL", meta.fallSlopeCCDL);
     writeStringVector(w, "T1T2", meta.t1t2);
     w.writeEndElement(); // Meta
 
@@ -162,6 +192,12 @@ void Page2Model::XmlWriter::writeStringVector(QXmlStreamWriter& w, const QString
     w.writeEndElement(); // TagList
 }
 
+void Page2Model::XmlWriter::writeNumericColumn(QXmlStreamWriter& w, const QString& tag,
+                                               const NumericColumn& col)
+{
+    writeStringVector(w, tag, col.toStrings());
+}
+
 // ========== XML 讀取器實現 ==========
 
 void Page2Model::XmlReader::readInputTable(QXmlStreamReader& r, QVector<InputRow>& rows)
@@ -298,7 +334,7 @@ LoadDataRow Page2Model::XmlReader::readLoadDataRow(QXmlStreamReader& r)
         }
 
         if (r.isStartElement() && r.name() == "Index") {
-            row.values << r.readElementText();
+            row.values.appendText(r.readElementText());
         }
     }
 
@@ -344,22 +380,22 @@ void Page2Model::XmlReader::readLoadMeta(QXmlStreamReader& r, LoadMetaRow& meta)
                 meta.names = readStringVector(r, "Name");
             }
             else if (r.name() == "VoList") {
-                meta.vo = readStringVector(r, "Vo");
+                meta.vo = readNumericColumn(r, "Vo");
             }
             else if (r.name() == "VonList") {
-                meta.von = readStringVector(r, "Von");
+                meta.von = readNumericColumn(r, "Von");
             }
             else if (r.name() == "RiseSlopeCCHList") {
-                meta.riseSlopeCCH = readStringVector(r, "RiseSlopeCCH");
+                meta.riseSlopeCCH = readNumericColumn(r, "RiseSlopeCCH");
             }
             else if (r.name() == "FallSlopeCCHList") {
-                meta.fallSlopeCCH = readStringVector(r, "FallSlopeCCH");
+                meta.fallSlopeCCH = readNumericColumn(r, "FallSlopeCCH");
             }
             else if (r.name() == "RiseSlopeCCLList") {
-                meta.riseSlopeCCL = readStringVector(r, "RiseSlopeCCL");
+                meta.riseSlopeCCL = readNumericColumn(r, "RiseSlopeCCL");
             }
             else if (r.name() == "FallSlopeCCLList") {
-                meta.fallSlopeCCL = readStringVector(r, "FallSlopeCCL");
+                meta.fallSlopeCCL = readNumericColumn(r, "FallSlopeCCL");
             }
         }
     }
@@ -376,22 +412,22 @@ void Page2Model::XmlReader::readDynamicMeta(QXmlStreamReader& r, DynamicMetaRow&
 
         if (r.isStartElement()) {
             if (r.name() == "VoList") {
-                meta.vo = readStringVector(r, "Vo");
+                meta.vo = readNumericColumn(r, "Vo");
             }
             else if (r.name() == "VonList") {
-                meta.von = readStringVector(r, "Von");
+                meta.von = readNumericColumn(r, "Von");
             }
             else if (r.name() == "RiseSlopeCCDHList") {
-                meta.riseSlopeCCDH = readStringVector(r, "RiseSlopeCCDH");
+                meta.riseSlopeCCDH = readNumericColumn(r, "RiseSlopeCCDH");
             }
             else if (r.name() == "FallSlopeCCDHList") {
-                meta.fallSlopeCCDH = readStringVector(r, "FallSlopeCCDH");
+                meta.fallSlopeCCDH = readNumericColumn(r, "FallSlopeCCDH");
             }
             else if (r.name() == "RiseSlopeCCDLList") {
-                meta.riseSlopeCCDL = readStringVector(r, "RiseSlopeCCDL");
+                meta.riseSlopeCCDL = readNumericColumn(r, "RiseSlopeCCDL");
             }
             else if (r.name() == "FallSlopeCCDLList") {
-                meta.fallSlopeCCDL = readStringVector(r, "FallSlopeCCDL");
+                meta.fallSlopeCCDL = readNumericColumn(r, "FallSlopeCCDL");
             }
             else if (r.name() == "T1T2List") {
                 meta.t1t2 = readStringVector(r, "T1T2");
@@ -420,6 +456,11 @@ QVector<QString> Page2Model::XmlReader::readStringVector(QXmlStreamReader& r, co
     return result;
 }
 
+NumericColumn Page2Model::XmlReader::readNumericColumn(QXmlStreamReader& r, const QString& tag)
+{
+    return NumericColumn::fromStrings(readStringVector(r, tag));
+}
+
 void Page2Model::XmlReader::skipToEndElement(QXmlStreamReader& r, const QString& elementName)
 {
     while (!r.atEnd()) {
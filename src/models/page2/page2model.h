@@ -11,9 +11,27 @@ class Page2Model : public QObject {
 public:
     explicit Page2Model(QObject *parent = nullptr);
 
+    // 全部表格的副本（QVector 隱式共享，複製成本 O(1)），可帶到背景執行緒序列化 / 解析
+    struct Tables {
+        QVector<InputRow>        inputRows;
+        QVector<RelayDataRow>    relayRows;
+        LoadMetaRow              loadMeta;
+        QVector<LoadDataRow>     loadRows;
+        DynamicMetaRow           dynamicMeta;
+        QVector<DynamicDataRow>  dynamicRows;
+
+        bool operator==(const Tables& other) const;
+        bool operator!=(const Tables& other) const { return !(*this == other); }
+    };
+
     void writeXml(QXmlStreamWriter& writer) const;
     void loadXml(QXmlStreamReader& reader);
 
+    Tables tables() const;
+    void applyLoadedTables(const Tables& tables);
+    static void writeTablesXml(QXmlStreamWriter& writer, const Tables& tables);
+    static Tables readTablesXml(QXmlStreamReader& reader);
+
     QVector<InputRow>        inputRows;
     QVector<RelayDataRow>    relayRows;
     LoadMetaRow              loadMeta;
@@ -40,6 +58,8 @@ private:
                                  const QVector<QString>& values);
         static void writeStringVector(QXmlStreamWriter& w, const QString& tag,
                                       const QVector<QString>& vec);
+        static void writeNumericColumn(QXmlStreamWriter& w, const QString& tag,
+                                       const NumericColumn& col);
     };
 
     // XML 讀取輔助
@@ -62,6 +82,7 @@ private:
         static void readDynamicMeta(QXmlStreamReader& r, DynamicMetaRow& meta);
 
         static QVector<QString> readStringVector(QXmlStreamReader& r, const QString& tag);
+        static NumericColumn readNumericColumn(QXmlStreamReader& r, const QString& tag);
         static void skipToEndElement(QXmlStreamReader& r, const QString& elementName);
     };
 };
@@ -7,28 +7,94 @@ Page3Model::Page3Model(QObject* parent)
 // ========== XML 寫入 ==========
 
 void Page3Model::writeXml(QXmlStreamWriter& writer) const
+{
+    writeStateXml(writer, xmlState());
+}
+
+Page3Model::XmlState Page3Model::xmlState() const
+{
+    XmlState state;
+    state.inputTitles = m_inputTitles;
+    state.loadTitles = m_loadTitles;
+    state.dyloadTitles = m_dyloadTitles;
+    state.relayTitles = m_relayTitles;
+    state.selectedInputIndex = m_selectedInputIndex;
+    state.selectedLoadIndex = m_selectedLoadIndex;
+    state.selectedDyLoadIndex = m_selectedDyLoadIndex;
+    state.selectedRelayIndex = m_selectedRelayIndex;
+    state.selectedInputText = m_selectedInputText;
+    state.selectedLoadText = m_selectedLoadText;
+    state.selectedDyLoadText = m_selectedDyLoadText;
+    state.selectedRelayText = m_selectedRelayText;
+    state.recipe = m_recipe;
+    return state;
+}
+
+void Page3Model::applyXmlState(const XmlState& state)
+{
+    m_inputTitles = state.inputTitles;
+    m_loadTitles = state.loadTitles;
+    m_dyloadTitles = state.dyloadTitles;
+    m_relayTitles = state.relayTitles;
+    setSelectedInputState(state.selectedInputIndex, state.selectedInputText);
+    setSelectedLoadState(state.selectedLoadIndex, state.selectedLoadText);
+    setSelectedDyLoadState(state.selectedDyLoadIndex, state.selectedDyLoadText);
+    setSelectedRelayState(state.selectedRelayIndex, state.selectedRelayText);
+
+    // Page3 區段只有 Load / Dynamic 表格；背景解析期間 Page2 可能已發布新的 Input 表，以目前的快照為底
+    if (!state.recipe) return;
+    RecipeSnapshotPtr recipe = m_recipe;
+    recipe = RecipeSnapshot::withLoadMeta(recipe, state.recipe->loadMeta());
+    recipe = RecipeSnapshot::withLoadRows(recipe, state.recipe->loadRows());
+    recipe = RecipeSnapshot::withDynamicMeta(recipe, state.recipe->dynamicMeta());
+    recipe = RecipeSnapshot::withDynamicRows(recipe, state.recipe->dynamicRows());
+    setRecipeSnapshot(recipe);
+}
+
+bool Page3Model::XmlState::operator==(const XmlState& other) const
+{
+    auto sameRecipe = [&]() {
+        if (recipe == other.recipe) return true;
+        if (!recipe || !other.recipe) return false;
+        for (auto table : { RecipeSnapshot::LoadMetaTable, RecipeSnapshot::LoadRowsTable,
+                            RecipeSnapshot::DynamicMetaTable, RecipeSnapshot::DynamicRowsTable }) {
+            if (recipe->tableVersion(table) != other.recipe->tableVersion(table)) return false;
+        }
+        return true;
+    };
+
+    return inputTitles == other.inputTitles && loadTitles == other.loadTitles
+           && dyloadTitles == other.dyloadTitles && relayTitles == other.relayTitles
+           && selectedInputIndex == other.selectedInputIndex && selectedInputText == other.selectedInputText
+           && selectedLoadIndex == other.selectedLoadIndex && selectedLoadText == other.selectedLoadText
+           && selectedDyLoadIndex == other.selectedDyLoadIndex && selectedDyLoadText == other.selectedDyLoadText
+           && selectedRelayIndex == other.selectedRelayIndex && selectedRelayText == other.selectedRelayText
+           && sameRecipe();
+}
+
+void Page3Model::writeStateXml(QXmlStreamWriter& writer, const XmlState& state)
 {
     writer.writeStartElement("Page3");
 
-    writeComboBoxTitles(writer);
-    writeCurrentSelections(writer);
-    writeLoadData(writer);
-    writeDynamicData(writer);
+    writeComboBoxTitles(writer, state);
+    writeCurrentSelections(writer, state);
+    writeLoadData(writer, *state.recipe);
+    writeDynamicData(writer, *state.recipe);
 
     writer.writeEndElement(); // Page3
 }
 
-void Page3Model::writeComboBoxTitles(QXmlStreamWriter& w) const
+void Page3Model::writeComboBoxTitles(QXmlStreamWriter& w, const XmlState& state)
 {
     w.writeStartElement("ComboBoxTitles");
-    writeTitleList(w, "InputTitles", m_inputTitles);
-    writeTitleList(w, "LoadTitles", m_loadTitles);
-    writeTitleList(w, "DyLoadTitles", m_dyloadTitles);
-    writeTitleList(w, "RelayTitles", m_relayTitles);
+    writeTitleList(w, "InputTitles", state.inputTitles);
+    writeTitleList(w, "LoadTitles", state.loadTitles);
+    writeTitleList(w, "DyLoadTitles", state.dyloadTitles);
+    writeTitleList(w, "RelayTitles", state.relayTitles);
     w.writeEndElement();
 }
 
-void Page3Model::writeCurrentSelections(QXmlStreamWriter& w) const
+void Page3Model::writeCurrentSelections(QXmlStreamWriter& w, const XmlState& state)
 {
     w.writeStartElement("CurrentSelections");
 
@@ -39,54 +105,58 @@ void Page3Model::writeCurrentSelections(QXmlStreamWriter& w) const
         w.writeEndElement();
     };
 
-    writeSelection("InputSelection", m_selectedInputIndex, m_selectedInputText);
-    writeSelection("LoadSelection", m_selectedLoadIndex, m_selectedLoadText);
-    writeSelection("DyLoadSelection", m_selectedDyLoadIndex, m_selectedDyLoadText);
-    writeSelection("RelaySelection", m_selectedRelayIndex, m_selectedRelayText);
+    writeSelection("InputSelection", state.selectedInputIndex, state.selectedInputText);
+    writeSelection("LoadSelection", state.selectedLoadIndex, state.selectedLoadText);
+    writeSelection("DyLoadSelection", state.selectedDyLoadIndex, state.selectedDyLoadText);
+    writeSelection("RelaySelection", state.selectedRelayIndex, state.selectedRelayText);
 
     w.writeEndElement();
 }
 
-void Page3Model::writeLoadData(QXmlStreamWriter& w) const
+void Page3Model::writeLoadData(QXmlStreamWriter& w, const RecipeSnapshot& recipe)
 {
+    const auto& meta = recipe.loadMeta();
+
     // Meta
     w.writeStartElement("LoadMetaData");
-    writeStringList(w, "Modes", "Mode", m_LoadMetaData.modes);
-    writeStringList(w, "Names", "Name", m_LoadMetaData.names);
-    writeStringList(w, "Vo", "Value", m_LoadMetaData.vo);
-    writeStringList(w, "Von", "Value", m_LoadMetaData.von);
-    writeStringList(w, "RiseSlopeCCH", "Value", m_LoadMetaData.riseSlopeCCH);
-    writeStringList(w, "FallSlopeCCH", "Value", m_LoadMetaData.fallSlopeCCH);
-    writeStringList(w, "RiseSlopeCCL", "Value", m_LoadMetaData.riseSlopeCCL);
-    writeStringList(w, "FallSlopeCCL", "Value", m_LoadMetaData.fallSlopeCCL);
+    writeStringList(w, "Modes", "Mode", meta.modes);
+    writeStringList(w, "Names", "Name", meta.names);
+    writeStringList(w, "Vo", "Value", meta.vo.toStrings());
+    writeStringList(w, "Von", "Value", meta.von.toStrings());
+    writeStringList(w, "RiseSlopeCCH", "Value", meta.riseSlopeCCH.toStrings());
+    writeStringList(w, "FallSlopeCCH", "Value", meta.fallSlopeCCH.toStrings());
+    writeStringList(w, "RiseSlopeCCL", "Value", meta.riseSlopeCCL.toStrings());
+    writeStringList(w, "FallSlopeCCL", "Value", meta.fallSlopeCCL.toStrings());
     w.writeEndElement();
 
     // Rows
     w.writeStartElement("LoadRowsData");
-    for (const auto& row : m_LoadRowsData) {
+    for (const auto& row : recipe.loadRows()) {
         w.writeStartElement("LoadRow");
         w.writeAttribute("label", row.label);
-        writeStringList(w, "Values", "Value", row.values);
+        writeStringList(w, "Values", "Value", row.values.toStrings());
         w.writeEndElement();
     }
     w.writeEndElement();
 }
 
-void Page3Model::writeDynamicData(QXmlStreamWriter& w) const
+void Page3Model::writeDynamicData(QXmlStreamWriter& w, const RecipeSnapshot& recipe)
 {
+    const auto& meta = recipe.dynamicMeta();
+
     // Meta
     w.writeStartElement("DynamicMetaData");
-    writeStringList(w, "Vo", "Value", m_DynamicMetaData.vo);
-    writeStringList(w, "Von", "Value", m_DynamicMetaData.von);
-    writeStringList(w, "RiseSlopeCCDH", "Value", m_DynamicMetaData.riseSlopeCCDH);
-    writeStringList(w, "FallSlopeCCDH", "Value", m_DynamicMetaData.fallSlopeCCDH);
-    writeStringList(w, "RiseSlopeCCDL", "Value", m_DynamicMetaData.riseSlopeCCDL);
-    writeStringList(w, "FallSlopeCCDL", "Value", m_DynamicMetaData.fallSlopeCCDL);
+    writeStringList(w, "Vo", "Value", meta.vo.toStrings());
+    writeStringList(w, "Von", "Value", meta.von.toStrings());
+    writeStringList(w, "RiseSlopeCCDH", "Value", meta.riseSlopeCCDH.toStrings());
+    writeStringList(w, "FallSlopeCCDH", "Value", meta.fallSlopeCCDH.toStrings());
+    writeStringList(w, "RiseSlopeCCDL", "Value", meta.riseSlopeCCDL.toStrings());
+    writeStringList(w, "FallSlopeCCDL", "Value", meta.fallSlopeCCDL.toStrings());
     w.writeEndElement();
 
     // Rows
     w.writeStartElement("DynamicRowsData");
-    for (const auto& row : m_DynamicRowsData) {
+    for (const auto& row : recipe.dynamicRows()) {
         w.writeStartElement("DynamicRow");
         w.writeAttribute("label", row.label);
         writeStringList(w, "Values", "Value", row.values);
@@ -99,6 +169,13 @@ void Page3Model::writeDynamicData(QXmlStreamWriter& w) const
 
 void Page3Model::loadXml(QXmlStreamReader& reader)
 {
+    applyXmlState(readStateXml(reader, xmlState()));
+}
+
+Page3Model::XmlState Page3Model::readStateXml(QXmlStreamReader& reader, const XmlState& base)
+{
+    XmlState state = base;
+
     while (!reader.atEnd()) {
         reader.readNext();
 
@@ -108,28 +185,30 @@ void Page3Model::loadXml(QXmlStreamReader& reader)
 
         if (reader.isStartElement()) {
             if (reader.name() == "ComboBoxTitles") {
-                readComboBoxTitles(reader);
+                readComboBoxTitles(reader, state);
             }
             else if (reader.name() == "CurrentSelections") {
-                readCurrentSelections(reader);
+                readCurrentSelections(reader, state);
             }
             else if (reader.name() == "LoadMetaData") {
-                readLoadMetaData(reader);
+                readLoadMetaData(reader, state);
             }
             else if (reader.name() == "LoadRowsData") {
-                readLoadRowsData(reader);
+                readLoadRowsData(reader, state);
             }
             else if (reader.name() == "DynamicMetaData") {
-                readDynamicMetaData(reader);
+                readDynamicMetaData(reader, state);
             }
             else if (reader.name() == "DynamicRowsData") {
-                readDynamicRowsData(reader);
+                readDynamicRowsData(reader, state);
             }
         }
     }
+
+    return state;
 }
 
-void Page3Model::readComboBoxTitles(QXmlStreamReader& r)
+void Page3Model::readComboBoxTitles(QXmlStreamReader& r, XmlState& state)
 {
     while (!r.atEnd()) {
         r.readNext();
@@ -137,22 +216,22 @@ void Page3Model::readComboBoxTitles(QXmlStreamReader& r)
 
         if (r.isStartElement()) {
             if (r.name() == "InputTitles") {
-                m_inputTitles = readTitleList(r, "InputTitles");
+                state.inputTitles = readTitleList(r, "InputTitles");
             }
             else if (r.name() == "LoadTitles") {
-                m_loadTitles = readTitleList(r, "LoadTitles");
+                state.loadTitles = readTitleList(r, "LoadTitles");
             }
             else if (r.name() == "DyLoadTitles") {
-                m_dyloadTitles = readTitleList(r, "DyLoadTitles");
+                state.dyloadTitles = readTitleList(r, "DyLoadTitles");
             }
             else if (r.name() == "RelayTitles") {
-                m_relayTitles = readTitleList(r, "RelayTitles");
+                state.relayTitles = readTitleList(r, "RelayTitles");
             }
         }
     }
 }
 
-void Page3Model::readCurrentSelections(QXmlStreamReader& r)
+void Page3Model::readCurrentSelections(QXmlStreamReader& r, XmlState& state)
 {
     while (!r.atEnd()) {
         r.readNext();
@@ -162,29 +241,29 @@ void Page3Model::readCurrentSelections(QXmlStreamReader& r)
             QXmlStreamAttributes attrs = r.attributes();
 
             if (r.name() == "InputSelection") {
-                m_selectedInputIndex = attrs.value("index").toInt();
-                m_selectedInputText = attrs.value("text").toString();
+                state.selectedInputIndex = attrs.value("index").toInt();
+                state.selectedInputText = attrs.value("text").toString();
             }
             else if (r.name() == "LoadSelection") {
-                m_selectedLoadIndex = attrs.value("index").toInt();
-                m_selectedLoadText = attrs.value("text").toString();
+                state.selectedLoadIndex = attrs.value("index").toInt();
+                state.selectedLoadText = attrs.value("text").toString();
             }
             else if (r.name() == "DyLoadSelection") {
-                m_selectedDyLoadIndex = attrs.value("index").toInt();
-                m_selectedDyLoadText = attrs.value("text").toString();
+                state.selectedDyLoadIndex = attrs.value("index").toInt();
+                state.selectedDyLoadText = attrs.value("text").toString();
             }
             else if (r.name() == "RelaySelection") {
-                m_selectedRelayIndex = attrs.value("index").toInt();
-                m_selectedRelayText = attrs.value("text").toString();
+                state.selectedRelayIndex = attrs.value("index").toInt();
+                state.selectedRelayText = attrs.value("text").toString();
             }
             r.skipCurrentElement();
         }
     }
 }
 
-void Page3Model::readLoadMetaData(QXmlStreamReader& r)
+void Page3Model::readLoadMetaData(QXmlStreamReader& r, XmlState& state)
 {
-    m_LoadMetaData = LoadMetaRow();
+    LoadMetaRow meta;
 
     while (!r.atEnd()) {
         r.readNext();
@@ -192,36 +271,37 @@ void Page3Model::readLoadMetaData(QXmlStreamReader& r)
 
         if (r.isStartElement()) {
             if (r.name() == "Modes") {
-                m_LoadMetaData.modes = readStringList(r, "Modes", "Mode");
+                meta.modes = readStringList(r, "Modes", "Mode");
             }
             else if (r.name() == "Names") {
-                m_LoadMetaData.names = readStringList(r, "Names", "Name");
+                meta.names = readStringList(r, "Names", "Name");
             }
             else if (r.name() == "Vo") {
-                m_LoadMetaData.vo = readStringList(r, "Vo", "Value");
+                meta.vo = NumericColumn::fromStrings(readStringList(r, "Vo", "Value"));
             }
             else if (r.name() == "Von") {
-                m_LoadMetaData.von = readStringList(r, "Von", "Value");
+                meta.von = NumericColumn::fromStrings(readStringList(r, "Von", "Value"));
             }
             else if (r.name() == "RiseSlopeCCH") {
-                m_LoadMetaData.riseSlopeCCH = readStringList(r, "RiseSlopeCCH", "Value");
+                meta.riseSlopeCCH = NumericColumn::fromStrings(readStringList(r, "RiseSlopeCCH", "Value"));
             }
             else if (r.name() == "FallSlopeCCH") {
-                m_LoadMetaData.fallSlopeCCH = readStringList(r, "FallSlopeCCH", "Value");
+                meta.fallSlopeCCH = NumericColumn::fromStrings(readStringList(r, "FallSlopeCCH", "Value"));
             }
             else if (r.name() == "RiseSlopeCCL") {
-                m_LoadMetaData.riseSlopeCCL = readStringList(r, "RiseSlopeCCL", "Value");
+                meta.riseSlopeCCL = NumericColumn::fromStrings(readStringList(r, "RiseSlopeCCL", "Value"));
             }
             else if (r.name() == "FallSlopeCCL") {
-                m_LoadMetaData.fallSlopeCCL = readStringList(r, "FallSlopeCCL", "Value");
+                meta.fallSlopeCCL = NumericColumn::fromStrings(readStringList(r, "FallSlopeCCL", "Value"));
             }
         }
     }
+    state.recipe = RecipeSnapshot::withLoadMeta(state.recipe, meta);
 }
 
-void Page3Model::readLoadRowsData(QXmlStreamReader& r)
+void Page3Model::readLoadRowsData(QXmlStreamReader& r, XmlState& state)
 {
-    m_LoadRowsData.clear();
+    QVector<LoadDataRow> rows;
 
     while (!r.atEnd()) {
         r.readNext();
@@ -236,17 +316,18 @@ void Page3Model::readLoadRowsData(QXmlStreamReader& r)
                 if (r.isEndElement() && r.name() == "LoadRow") break;
 
                 if (r.isStartElement() && r.name() == "Values") {
-                    row.values = readStringList(r, "Values", "Value");
+                    row.values = NumericColumn::fromStrings(readStringList(r, "Values", "Value"));
                 }
             }
-            m_LoadRowsData << row;
+            rows << row;
         }
     }
+    state.recipe = RecipeSnapshot::withLoadRows(state.recipe, rows);
 }
 
-void Page3Model::readDynamicMetaData(QXmlStreamReader& r)
+void Page3Model::readDynamicMetaData(QXmlStreamReader& r, XmlState& state)
 {
-    m_DynamicMetaData = DynamicMetaRow();
+    DynamicMetaRow meta;
 
     while (!r.atEnd()) {
         r.readNext();
@@ -254,30 +335,31 @@ void Page3Model::readDynamicMetaData(QXmlStreamReader& r)
 
         if (r.isStartElement()) {
             if (r.name() == "Vo") {
-                m_DynamicMetaData.vo = readStringList(r, "Vo", "Value");
+                meta.vo = NumericColumn::fromStrings(readStringList(r, "Vo", "Value"));
             }
             if (r.name() == "Von") {
-                m_DynamicMetaData.von = readStringList(r, "Von", "Value");
+                meta.von = NumericColumn::fromStrings(readStringList(r, "Von", "Value"));
             }
             else if (r.name() == "RiseSlopeCCDH") {
-                m_DynamicMetaData.riseSlopeCCDH = readStringList(r, "RiseSlopeCCDH", "Value");
+                meta.riseSlopeCCDH = NumericColumn::fromStrings(readStringList(r, "RiseSlopeCCDH", "Value"));
             }
             else if (r.name() == "FallSlopeCCDH") {
-                m_DynamicMetaData.fallSlopeCCDH = readStringList(r, "FallSlopeCCDH", "Value");
+                meta.fallSlopeCCDH = NumericColumn::fromStrings(readStringList(r, "FallSlopeCCDH", "Value"));
             }
             else if (r.name() == "RiseSlopeCCDL") {
-                m_DynamicMetaData.riseSlopeCCDL = readStringList(r, "RiseSlopeCCDL", "Value");
+                meta.riseSlopeCCDL = NumericColumn::fromStrings(readStringList(r, "RiseSlopeCCDL", "Value"));
             }
             else if (r.name() == "FallSlopeCCDL") {
-                m_DynamicMetaData.fallSlopeCCDL = readStringList(r, "FallSlopeCCDL", "Value");
+                meta.fallSlopeCCDL = NumericColumn::fromStrings(readStringList(r, "FallSlopeCCDL", "Value"));
             }
         }
     }
+    state.recipe = RecipeSnapshot::withDynamicMeta(state.recipe, meta);
 }
 
-void Page3Model::readDynamicRowsData(QXmlStreamReader& r)
+void Page3Model::readDynamicRowsData(QXmlStreamReader& r, XmlState& state)
 {
-    m_DynamicRowsData.clear();
+    QVector<DynamicDataRow> rows;
 
     while (!r.atEnd()) {
         r.readNext();
@@ -295,9 +377,10 @@ void Page3Model::readDynamicRowsData(QXmlStreamReader& r)
                     row.values = readStringList(r, "Values", "Value");
                 }
             }
-            m_DynamicRowsData << row;
+            rows << row;
         }
     }
+    state.recipe = RecipeSnapshot::withDynamicRows(state.recipe, rows);
 }
 
 // ========== 輔助函數 ==========
@@ -6,6 +6,7 @@
 #include <QXmlStreamReader>
 #include "page1config.h"
 #include "page2config.h"
+#include "recipesnapshot.h"
 
 class Page3Model : public QObject {
     Q_OBJECT
@@ -18,12 +19,9 @@ public:
     void setRelayTitles(const QStringList& titles) { m_relayTitles = titles; }
 
     void setPage1ConfigChanged(const Page1Config &cfg) { m_page1Config = cfg; }
-    void setPage2InputDataChanged(const QVector<InputRow>& rows) { m_page2InputData = rows; }
-
-    void setPage2LoadMetaDataChanged(const LoadMetaRow& meta) { m_LoadMetaData = meta; }
-    void setPage2LoadRowsChanged(const QVector<LoadDataRow>& rows) { m_LoadRowsData = rows; }
-    void setPage2DynamicMetaChanged(const DynamicMetaRow& meta) { m_DynamicMetaData = meta; }
-    void setPage2DynamicRowsChanged(const QVector<DynamicDataRow>& rows) { m_DynamicRowsData = rows; }
+    // Page2 配方表格：與 Page2ViewModel / Page3ViewModel 共用同一份快照
+    void setRecipeSnapshot(const RecipeSnapshotPtr& snapshot) { if (snapshot) m_recipe = snapshot; }
+    const RecipeSnapshotPtr& recipeSnapshot() const { return m_recipe; }
 
     void setSelectedInputState(int index, const QString& text) {
         m_selectedInputIndex = index;
@@ -47,10 +45,10 @@ public:
     const QStringList& getLoadTitles() const { return m_loadTitles; }
     const QStringList& getDyLoadTitles() const { return m_dyloadTitles; }
 
-    const LoadMetaRow& getLoadMetaData() const { return m_LoadMetaData; }
-    const QVector<LoadDataRow>& getLoadRowsData() const { return m_LoadRowsData; }
-    const DynamicMetaRow& getDynamicMetaData() const { return m_DynamicMetaData; }
-    const QVector<DynamicDataRow>& getDynamicRowsData() const { return m_DynamicRowsData; }
+    const LoadMetaRow& getLoadMetaData() const { return m_recipe->loadMeta(); }
+    const QVector<LoadDataRow>& getLoadRowsData() const { return m_recipe->loadRows(); }
+    const DynamicMetaRow& getDynamicMetaData() const { return m_recipe->dynamicMeta(); }
+    const QVector<DynamicDataRow>& getDynamicRowsData() const { return m_recipe->dynamicRows(); }
 
     int getSelectedInputIndex() const { return m_selectedInputIndex; }
     QString getSelectedInputText() const { return m_selectedInputText; }
@@ -61,23 +59,52 @@ public:
     int getSelectedRelayIndex() const { return m_selectedRelayIndex; }
     QString getSelectedRelayText() const { return m_selectedRelayText; }
 
+    // 存檔內容的副本：標題與選擇很小，Load / Dynamic 資料直接共用配方快照，可帶到背景執行緒
+    struct XmlState {
+        QStringList inputTitles;
+        QStringList loadTitles;
+        QStringList dyloadTitles;
+        QStringList relayTitles;
+
+        int selectedInputIndex = -1;
+        int selectedLoadIndex = -1;
+        int selectedDyLoadIndex = -1;
+        int selectedRelayIndex = -1;
+        QString selectedInputText;
+        QString selectedLoadText;
+        QString selectedDyLoadText;
+        QString selectedRelayText;
+
+        RecipeSnapshotPtr recipe = RecipeSnapshot::create();
+
+        // 配方只比較 Page3 會寫出的 Load / Dynamic 表格版本
+        bool operator==(const XmlState& other) const;
+        bool operator!=(const XmlState& other) const { return !(*this == other); }
+    };
+
     void writeXml(QXmlStreamWriter& writer) const;
     void loadXml(QXmlStreamReader& reader);
 
+    XmlState xmlState() const;
+    void applyXmlState(const XmlState& state);
+    static void writeStateXml(QXmlStreamWriter& writer, const XmlState& state);
+    // 檔案裡沒有的欄位沿用 base（與直接載入到 Model 的行為相同）
+    static XmlState readStateXml(QXmlStreamReader& reader, const XmlState& base);
+
 private:
     // XML 寫入輔助
-    void writeComboBoxTitles(QXmlStreamWriter& w) const;
-    void writeCurrentSelections(QXmlStreamWriter& w) const;
-    void writeLoadData(QXmlStreamWriter& w) const;
-    void writeDynamicData(QXmlStreamWriter& w) const;
+    static void writeComboBoxTitles(QXmlStreamWriter& w, const XmlState& state);
+    static void writeCurrentSelections(QXmlStreamWriter& w, const XmlState& state);
+    static void writeLoadData(QXmlStreamWriter& w, const RecipeSnapshot& recipe);
+    static void writeDynamicData(QXmlStreamWriter& w, const RecipeSnapshot& recipe);
 
     // XML 讀取輔助
-    void readComboBoxTitles(QXmlStreamReader& r);
-    void readCurrentSelections(QXmlStreamReader& r);
-    void readLoadMetaData(QXmlStreamReader& r);
-    void readLoadRowsData(QXmlStreamReader& r);
-    void readDynamicMetaData(QXmlStreamReader& r);
-    void readDynamicRowsData(QXmlStreamReader& r);
+    static void readComboBoxTitles(QXmlStreamReader& r, XmlState& state);
+    static void readCurrentSelections(QXmlStreamReader& r, XmlState& state);
+    static void readLoadMetaData(QXmlStreamReader& r, XmlState& state);
+    static void readLoadRowsData(QXmlStreamReader& r, XmlState& state);
+    static void readDynamicMetaData(QXmlStreamReader& r, XmlState& state);
+    static void readDynamicRowsData(QXmlStreamReader& r, XmlState& state);
 
     // 通用工具
     static void writeTitleList(QXmlStreamWriter& w, const QString& tag, const QStringList& list);
@@ -94,12 +121,8 @@ private:
     QStringList m_relayTitles;
 
     Page1Config m_page1Config;
-    QVector<InputRow> m_page2InputData;
 
-    LoadMetaRow m_LoadMetaData;
-    QVector<LoadDataRow> m_LoadRowsData;
-    DynamicMetaRow  m_DynamicMetaData;
-    QVector<DynamicDataRow> m_DynamicRowsData;
+    RecipeSnapshotPtr m_recipe = RecipeSnapshot::create();
 
     int m_selectedInputIndex = -1;
     int m_selectedLoadIndex = -1;
@@ -0,0 +1,332 @@
+#include "asyncinstrumentio.h"
+#include "instrumentsessionpool.h"
+#include <QtConcurrent>
+#include <QElapsedTimer>
+#include <QFutureInterface>
+#include <QTimer>
+#include <QDebug>
+#include <atomic>
+
+struct AsyncInstrumentIo::Request
+{
+    RequestType type = RequestType::Query;
+    QString resource;
+    ICommunication* comm = nullptr;     // Session 代理（PooledCommunication），由 Pool 持有
+    QByteArray data;
+    int timeoutMs = ICommunication::defaultTimeoutMs;
+    QElapsedTimer clock;
+    QFutureInterface<AsyncReply> promise;
+
+    // 非阻塞路徑（I/O 執行緒）
+    QRecursiveMutex* lock = nullptr;    // 已取得的交易鎖，finish() 時釋放
+    bool locked = false;
+    bool written = false;
+    int savedTimeoutMs = 0;
+    QByteArray rx;
+
+    // 阻塞路徑（m_blockingPool）
+    bool dispatched = false;
+    std::atomic<bool> done{false};
+    AsyncReply reply;
+
+    int remainingMs() const { return qMax(0, timeoutMs - static_cast<int>(clock.elapsed())); }
+};
+
+namespace {
+
+const int readChunkSize = 4096;
+
+// 回應只取到第一個換行，去掉結尾 CR/LF
+QByteArray trimmedResponse(const QByteArray& rx)
+{
+    const int end = rx.indexOf('\n');
+    QByteArray out = end >= 0 ? rx.left(end) : rx;
+    while (out.endsWith('\r') || out.endsWith('\n')) out.chop(1);
+    return out;
+}
+
+} // namespace
+
+AsyncInstrumentIo& AsyncInstrumentIo::instance()
+{
+    static AsyncInstrumentIo instance;
+    return instance;
+}
+
+AsyncInstrumentIo::AsyncInstrumentIo(QObject* parent)
+    : QObject(parent)
+{
+    // 獨立的 pool：呼叫端可能就在 globalInstance 上等 future，共用會搶到自己的名額
+    m_blockingPool.setMaxThreadCount(defaultMaxBlockingThreads);
+
+    m_context = new QObject;
+    m_tick = new QTimer(m_context);
+    m_tick->setInterval(tickIntervalMs);
+    m_tick->setTimerType(Qt::PreciseTimer);
+    connect(m_tick, &QTimer::timeout, m_context, [this] { processQueues(); });
+    // finished 在 I/O 執行緒發出：交易鎖必須由取得它的執行緒釋放
+    connect(&m_thread, &QThread::finished, m_context,
+            [this] { failAll("AsyncInstrumentIo shut down"); }, Qt::DirectConnection);
+
+    m_context->moveToThread(&m_thread);
+    m_thread.setObjectName("AsyncInstrumentIo");
+    m_thread.start();
+}
+
+AsyncInstrumentIo::~AsyncInstrumentIo()
+{
+    m_blockingPool.waitForDone();
+    m_thread.quit();
+    m_thread.wait();
+    delete m_context;
+}
+
+QFuture<AsyncReply> AsyncInstrumentIo::writeAsync(const InstrumentSessionLease& lease,
+                                                  const QByteArray& data, int timeoutMs)
+{
+    return submit(RequestType::Write, lease.resource(), lease.isValid() ? lease.comm() : nullptr,
+                  data, timeoutMs);
+}
+
+QFuture<AsyncReply> AsyncInstrumentIo::readAsync(const InstrumentSessionLease& lease, int timeoutMs)
+{
+    return submit(RequestType::Read, lease.resource(), lease.isValid() ? lease.comm() : nullptr,
+                  QByteArray(), timeoutMs);
+}
+
+QFuture<AsyncReply> AsyncInstrumentIo::query(const InstrumentSessionLease& lease,
+                                             const QByteArray& command, int timeoutMs)
+{
+    return submit(RequestType::Query, lease.resource(), lease.isValid() ? lease.comm() : nullptr,
+                  command, timeoutMs);
+}
+
+QFuture<AsyncReply> AsyncInstrumentIo::writeAsync(const QString& resource, const QByteArray& data,
+                                                  int timeoutMs)
+{
+    return submit(RequestType::Write, resource,
+                  InstrumentSessionPool::instance().sharedCommunication(resource), data, timeoutMs);
+}
+
+QFuture<AsyncReply> AsyncInstrumentIo::readAsync(const QString& resource, int timeoutMs)
+{
+    return submit(RequestType::Read, resource,
+                  InstrumentSessionPool::instance().sharedCommunication(resource), QByteArray(), timeoutMs);
+}
+
+QFuture<AsyncReply> AsyncInstrumentIo::query(const QString& resource, const QByteArray& command,
+                                             int timeoutMs)
+{
+    return submit(RequestType::Query, resource,
+                  InstrumentSessionPool::instance().sharedCommunication(resource), command, timeoutMs);
+}
+
+QFuture<AsyncReply> AsyncInstrumentIo::submit(RequestType type, const QString& resource,
+                                              ICommunication* comm, const QByteArray& data,
+                                              int timeoutMs)
+{
+    auto request = std::make_shared<Request>();
+    request->type = type;
+    request->resource = resource;
+    request->comm = comm;
+    request->data = data;
+    request->timeoutMs = timeoutMs > 0 ? timeoutMs : ICommunication::defaultTimeoutMs;
+    request->written = (type == RequestType::Read);
+    request->clock.start();
+    request->promise.reportStarted();
+    QFuture<AsyncReply> future = request->promise.future();
+
+    if (!comm) {
+        AsyncReply reply;
+        reply.error = QString("No instrument session for %1").arg(resource);
+        request->promise.reportResult(reply);
+        request->promise.reportFinished();
+        return future;
+    }
+    if (type != RequestType::Read && !request->data.endsWith('\n'))
+        request->data.append('\n');
+
+    QMetaObject::invokeMethod(m_context, [this, request] { enqueue(request); }, Qt::QueuedConnection);
+    return future;
+}
+
+void AsyncInstrumentIo::enqueue(const RequestPtr& request)
+{
+    m_queues[request->comm].enqueue(request);
+    processQueues();
+}
+
+void AsyncInstrumentIo::processQueues()
+{
+    bool polling = false;
+    for (auto it = m_queues.begin(); it != m_queues.end();) {
+        QQueue<RequestPtr>& queue = it.value();
+        while (!queue.isEmpty() && step(queue.head()))
+            queue.dequeue();
+        if (queue.isEmpty()) {
+            it = m_queues.erase(it);
+            continue;
+        }
+        // 阻塞路徑完成時會自行通知，只有等交易鎖 / 等資料的請求需要計時器
+        if (!queue.head()->dispatched) polling = true;
+        ++it;
+    }
+
+    if (polling && !m_tick->isActive()) m_tick->start();
+    else if (!polling && m_tick->isActive()) m_tick->stop();
+}
+
+bool AsyncInstrumentIo::step(const RequestPtr& request)
+{
+    if (request->dispatched) {
+        if (!request->done.load(std::memory_order_acquire)) return false;
+        if (!request->reply.ok) qWarning() << "[AsyncIo]" << request->reply.error;
+        request->reply.elapsedMs = request->clock.elapsed();
+        request->promise.reportResult(request->reply);
+        request->promise.reportFinished();
+        return true;
+    }
+
+    if (!request->locked) {
+        // 交易鎖被同步呼叫端持有時不等待，下一個 tick 再試，其他 session 照常推進
+        QRecursiveMutex* mutex = request->comm->transactionMutex();
+        if (mutex && !mutex->tryLock()) {
+            if (request->remainingMs() > 0) return false;
+            finish(request, false, QString("%1: session busy").arg(request->resource));
+            return true;
+        }
+        request->lock = mutex;
+        request->locked = true;
+
+        if (!request->comm->supportsNonBlockingRead()) {
+            // VISA 只能阻塞讀取：交給 pool 執行緒，交易鎖改由它持有
+            if (request->lock) request->lock->unlock();
+            request->lock = nullptr;
+            request->dispatched = true;
+            QtConcurrent::run(&m_blockingPool, [this, request] { runBlocking(request); });
+            return false;
+        }
+        request->savedTimeoutMs = request->comm->timeout();
+    }
+    return stepNonBlocking(request);
+}
+
+bool AsyncInstrumentIo::stepNonBlocking(const RequestPtr& request)
+{
+    ICommunication* comm = request->comm;
+
+    if (!request->written) {
+        // 寫入仍可能阻塞，上限為這次呼叫剩餘的時間
+        comm->setTimeout(qMax(1, request->remainingMs()));
+        const int n = comm->write(request->data);
+        comm->setTimeout(request->savedTimeoutMs);
+        if (n != request->data.size()) {
+            finish(request, false, QString("%1: write failed: %2").arg(request->resource, comm->lastError()));
+            return true;
+        }
+        request->written = true;
+        if (request->type == RequestType::Write) {
+            finish(request, true, QString());
+            return true;
+        }
+    }
+
+    char chunk[readChunkSize];
+    for (;;) {
+        const int n = comm->readAvailable(chunk, readChunkSize);
+        if (n < 0) {
+            finish(request, false, QString("%1: read failed: %2").arg(request->resource, comm->lastError()));
+            return true;
+        }
+        if (n == 0) break;
+        request->rx.append(chunk, n);
+        if (request->rx.contains('\n')) {
+            finish(request, true, QString());
+            return true;
+        }
+    }
+
+    if (request->remainingMs() > 0) return false;
+
+    // 逾時：丟棄連線，遲到的回應才不會被下一個查詢讀到
+    InstrumentSessionPool::instance().invalidate(request->resource);
+    finish(request, false, QString("%1: read timeout (%2 ms)").arg(request->resource).arg(request->timeoutMs));
+    return true;
+}
+
+void AsyncInstrumentIo::runBlocking(const RequestPtr& request)
+{
+    ICommunication* comm = request->comm;
+    AsyncReply& reply = request->reply;
+    bool ok = true;
+    {
+        CommTransaction transaction(comm);
+        const int savedTimeoutMs = comm->timeout();
+
+        if (!request->written) {
+            comm->setTimeout(qMax(1, request->remainingMs()));
+            if (comm->write(request->data) != request->data.size()) {
+                ok = false;
+                reply.error = QString("%1: write failed: %2").arg(request->resource, comm->lastError());
+            }
+            request->written = ok;
+        }
+
+        if (ok && request->type != RequestType::Write) {
+            char chunk[readChunkSize];
+            QByteArray rx;
+            for (;;) {
+                comm->setTimeout(qMax(1, request->remainingMs()));
+                const int n = comm->readInto(chunk, readChunkSize);
+                if (n < 0) {
+                    ok = false;
+                    reply.error = QString("%1: read failed: %2").arg(request->resource, comm->lastError());
+                    break;
+                }
+                rx.append(chunk, n);
+                if (rx.contains('\n') || comm->lastReadEndedMessage()) break;
+                if (request->remainingMs() == 0) {
+                    ok = false;
+                    reply.error = QString("%1: read timeout (%2 ms)").arg(request->resource).arg(request->timeoutMs);
+                    break;
+                }
+            }
+            if (ok) reply.data = trimmedResponse(rx);
+            else InstrumentSessionPool::instance().invalidate(request->resource);
+        }
+        comm->setTimeout(savedTimeoutMs);
+    }
+    reply.ok = ok;
+
+    request->done.store(true, std::memory_order_release);
+    QMetaObject::invokeMethod(m_context, [this] { processQueues(); }, Qt::QueuedConnection);
+}
+
+void AsyncInstrumentIo::finish(const RequestPtr& request, bool ok, const QString& error)
+{
+    if (request->lock) {
+        request->lock->unlock();
+        request->lock = nullptr;
+    }
+    if (!ok) qWarning() << "[AsyncIo]" << error;
+
+    AsyncReply reply;
+    reply.ok = ok;
+    reply.error = error;
+    if (ok && request->type != RequestType::Write) reply.data = trimmedResponse(request->rx);
+    reply.elapsedMs = request->clock.elapsed();
+    request->promise.reportResult(reply);
+    request->promise.reportFinished();
+}
+
+void AsyncInstrumentIo::failAll(const QString& error)
+{
+    m_tick->stop();
+    for (QQueue<RequestPtr>& queue : m_queues) {
+        for (const RequestPtr& request : queue) {
+            if (request->dispatched && request->done.load(std::memory_order_acquire)) step(request);
+            else finish(request, false, error);
+        }
+    }
+    m_queues.clear();
+}
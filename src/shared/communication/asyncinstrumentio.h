@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFuture>
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QThread>
+#include <QThreadPool>
+#include <memory>
+#include "icommunication.h"
+
+class QTimer;
+class InstrumentSessionLease;
+
+// 非同步 I/O 的結果
+struct AsyncReply
+{
+    bool ok = false;
+    QByteArray data;        // query / read 的回應（已去掉結尾 CR/LF）
+    QString error;
+    qint64 elapsedMs = 0;   // 從排入佇列到完成（含等待交易鎖）
+};
+
+// 儀器非同步 I/O：writeAsync / readAsync / query 立即回傳 QFuture，每次呼叫各自的逾時
+// 連線一律來自 InstrumentSessionPool（lease 或 sharedCommunication），整個交易持有 session 的 transactionMutex()，
+// 與同步呼叫端（儀器驅動、CommTransaction）互斥，回應不會被別人拿走
+//
+// TCP / Serial：全部在一條 I/O 執行緒上以事件迴圈推進（非阻塞讀取），幾十台儀器不需要幾十條執行緒
+// GPIB / 模擬：沒有非阻塞讀取，改在有上限的阻塞 thread pool 上執行
+// 同一個 session 的請求依送出順序執行；不同 session 互不等待
+class AsyncInstrumentIo : public QObject
+{
+    Q_OBJECT
+public:
+    static AsyncInstrumentIo& instance();
+
+    // lease 版本：呼叫端要持有 lease 直到 future 完成
+    QFuture<AsyncReply> writeAsync(const InstrumentSessionLease& lease, const QByteArray& data,
+                                   int timeoutMs = ICommunication::defaultTimeoutMs);
+    QFuture<AsyncReply> readAsync(const InstrumentSessionLease& lease,
+                                  int timeoutMs = ICommunication::defaultTimeoutMs);
+    QFuture<AsyncReply> query(const InstrumentSessionLease& lease, const QByteArray& command,
+                              int timeoutMs = ICommunication::defaultTimeoutMs);
+
+    // 長駐儀器版本：經 sharedCommunication()，不取得 lease
+    QFuture<AsyncReply> writeAsync(const QString& resource, const QByteArray& data,
+                                   int timeoutMs = ICommunication::defaultTimeoutMs);
+    QFuture<AsyncReply> readAsync(const QString& resource,
+                                  int timeoutMs = ICommunication::defaultTimeoutMs);
+    QFuture<AsyncReply> query(const QString& resource, const QByteArray& command,
+                              int timeoutMs = ICommunication::defaultTimeoutMs);
+
+    void setMaxBlockingThreads(int count) { m_blockingPool.setMaxThreadCount(count); }
+    int maxBlockingThreads() const        { return m_blockingPool.maxThreadCount(); }
+
+private:
+    enum class RequestType { Write, Read, Query };
+    struct Request;
+    using RequestPtr = std::shared_ptr<Request>;
+
+    AsyncInstrumentIo(QObject* parent = nullptr);
+    ~AsyncInstrumentIo() override;
+
+    AsyncInstrumentIo(const AsyncInstrumentIo&) = delete;
+    AsyncInstrumentIo& operator=(const AsyncInstrumentIo&) = delete;
+
+    QFuture<AsyncReply> submit(RequestType type, const QString& resource, ICommunication* comm,
+                               const QByteArray& data, int timeoutMs);
+
+    // 以下只在 I/O 執行緒執行
+    void enqueue(const RequestPtr& request);
+    void processQueues();
+    bool step(const RequestPtr& request);            // 回傳 true = 已完成
+    bool stepNonBlocking(const RequestPtr& request);
+    void runBlocking(const RequestPtr& request);     // 在 m_blockingPool 執行
+    void finish(const RequestPtr& request, bool ok, const QString& error);
+    void failAll(const QString& error);
+
+    QThread m_thread;
+    QObject* m_context = nullptr;   // 移到 m_thread，佇列與計時器都掛在它底下
+    QTimer* m_tick = nullptr;       // 有讀取在等資料時才啟動
+    QHash<ICommunication*, QQueue<RequestPtr>> m_queues;   // 每個 session 代理一條 FIFO
+    QThreadPool m_blockingPool;
+
+    static const int defaultMaxBlockingThreads = 4;
+    static const int tickIntervalMs = 1;
+};
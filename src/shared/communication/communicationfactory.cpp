@@ -2,11 +2,99 @@
 #include "gpibcommunication.h"
 #include "tcpcommunication.h"
 #include "serialcommunication.h"
+#include "recordingcommunication.h"
+#include "simulatedcommunication.h"
+#include "scpisimulatorserver.h"
+#include <QDateTime>
+#include <QDir>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QRegularExpression>
 #include <QString>
+#include <QDebug>
+
+namespace {
+QMutex g_recordMutex;
+QString g_recordDir = qEnvironmentVariable("ATE_SCPI_RECORD_DIR");
+int g_recordSequence = 0;   // 同一毫秒內重連同一位址時，檔名仍然不同
+}
+
+void CommunicationFactory::setRecordDirectory(const QString& dir)
+{
+    QMutexLocker locker(&g_recordMutex);
+    g_recordDir = dir;
+}
+
+QString CommunicationFactory::recordDirectory()
+{
+    QMutexLocker locker(&g_recordMutex);
+    return g_recordDir;
+}
 
 ICommunication* CommunicationFactory::create(const QString& resource)
 {
+    ICommunication* comm = createRaw(resource);
+    const QString dir = recordDirectory();
+    // 模擬器本身不再記錄
+    if (!comm || dir.isEmpty() || resource.startsWith("SIM::", Qt::CaseInsensitive))
+        return comm;
+
+    int sequence = 0;
+    {
+        QMutexLocker locker(&g_recordMutex);
+        sequence = ++g_recordSequence;
+    }
+    QString name = resource;
+    name.replace(QRegularExpression("[^A-Za-z0-9_.-]+"), "_");
+    const QString path = QDir(dir).filePath(
+        QString("%1_%2_%3.scpilog")
+            .arg(name, QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss_zzz"))
+            .arg(sequence));
+    return new RecordingCommunication(comm, path, resource);
+}
+
+ICommunication* CommunicationFactory::createSimulated(const QString& spec)
+{
+    // spec：<紀錄檔>::KEY=VALUE::...（Windows 路徑的 "C:" 只有一個冒號，不會被切開）
+    const QStringList parts = spec.split("::");
+    const QString logPath = parts.value(0).trimmed();
+    if (logPath.isEmpty()) return nullptr;
+
+    ScpiReplayTiming timing;
+    int tcpPort = 0;
+    for (int i = 1; i < parts.size(); ++i) {
+        const QString key = parts[i].section('=', 0, 0).trimmed().toUpper();
+        const QString value = parts[i].section('=', 1).trimmed();
+        if (key == "LATENCY") {
+            timing.useRecorded = false;
+            timing.latencyMs = value.toDouble();
+        } else if (key == "JITTER") {
+            timing.jitterMs = value.toDouble();
+        } else if (key == "SEED") {
+            timing.seed = value.toUInt();
+        } else if (key == "TCP") {
+            tcpPort = value.toInt();
+        } else {
+            qWarning() << "[CommunicationFactory] Unknown SIM option:" << parts[i];
+        }
+    }
+
+    if (tcpPort > 0) {
+        QString error;
+        if (!ScpiSimulatorServer::ensureRunning(logPath, static_cast<quint16>(tcpPort), timing, &error)) {
+            qWarning() << "[CommunicationFactory]" << error;
+            return nullptr;
+        }
+        return new TcpCommunication("127.0.0.1", static_cast<quint16>(tcpPort));
+    }
+    return new SimulatedCommunication(logPath, timing);
+}
+
+ICommunication* CommunicationFactory::createRaw(const QString& resource)
+{
+    if (resource.startsWith("SIM::", Qt::CaseInsensitive))
+        return createSimulated(resource.mid(5));
+
     // 新增: 純數字也當作 GPIB
     static const QRegularExpression numberOnly("^[0-9]+$");
     if (numberOnly.match(resource).hasMatch())
@@ -8,5 +8,17 @@ class CommunicationFactory
 {
 public:
     // 解析 resource，回傳對應協議物件（用戶要記得 delete）
+    // SIM::<紀錄檔>[::LATENCY=ms][::JITTER=ms][::SEED=n][::TCP=port]
+    //   依 SCPI 紀錄檔模擬儀器；未指定 LATENCY 時使用紀錄中的實際延遲，
+    //   指定 TCP 時在本機該 port 啟動模擬器並以 TcpCommunication 連線
     static ICommunication* create(const QString& resource);
+
+    // 設定後建立的每個通訊物件都會記錄到 <dir>/<resource>_<時間>_<序號>.scpilog（空字串停用）
+    // 預設取環境變數 ATE_SCPI_RECORD_DIR
+    static void setRecordDirectory(const QString& dir);
+    static QString recordDirectory();
+
+private:
+    static ICommunication* createRaw(const QString& resource);
+    static ICommunication* createSimulated(const QString& spec);
 };
@@ -1,4 +1,5 @@
 #include "gpibcommunication.h"
+#include "instrumentmetrics.h"
 #include <QDebug>
 
 GpibCommunication::GpibCommunication(const QString& resource)
@@ -27,6 +28,7 @@ bool GpibCommunication::open() {
         m_rm = 0;
         return false;
     }
+    viSetAttribute(m_instr, VI_ATTR_TMO_VALUE, static_cast<ViAttrState>(m_timeoutMs));
     m_error.clear();
     m_opened = true;
     return true;
@@ -46,6 +48,7 @@ void GpibCommunication::close() {
     m_instr = 0;
     m_rm = 0;
     m_opened = false;
+    m_srqEnabled = false;    // viClose 會一併關閉事件
     if (!err) m_error.clear();
 }
 
@@ -59,8 +62,10 @@ int GpibCommunication::write(const QByteArray& data) {
     ViStatus st = viWrite(m_instr, (ViBuf)data.constData(), data.size(), &written);
     if (st != VI_SUCCESS) {
         m_error = QString("GPIB viWrite failed, status=%1").arg(st);
+        recordFailure(st);
         return -1;
     }
+    if (m_metrics) m_metrics->addBytesOut(written);
     m_error.clear();
     return written;
 }
@@ -73,16 +78,87 @@ int GpibCommunication::read(QByteArray& data, int maxLen) {
     QByteArray buf(maxLen, Qt::Uninitialized);
     ViUInt32 retCount = 0;
     ViStatus st = viRead(m_instr, (ViBuf)buf.data(), maxLen, &retCount);
-    if (st == VI_SUCCESS || st == VI_SUCCESS_MAX_CNT) {
+    m_readEnded = (st == VI_SUCCESS || st == VI_SUCCESS_TERM_CHAR);
+    if (m_readEnded || st == VI_SUCCESS_MAX_CNT) {
         data = buf.left(retCount);
+        if (m_metrics) m_metrics->addBytesIn(retCount);
         m_error.clear(); // 清空舊錯誤
         return retCount;
     }
     data.clear();
     m_error = QString("GPIB viRead failed, status=%1").arg(st); // <== 寫入最新錯誤
+    recordFailure(st);
     return -1;
 }
 
+int GpibCommunication::readInto(char* buffer, int maxLen) {
+    if (!m_opened) {
+        m_error = "GPIB not opened";
+        return -1;
+    }
+    ViUInt32 retCount = 0;
+    ViStatus st = viRead(m_instr, (ViBuf)buffer, maxLen, &retCount);
+    m_readEnded = (st == VI_SUCCESS || st == VI_SUCCESS_TERM_CHAR);
+    if (m_readEnded || st == VI_SUCCESS_MAX_CNT) {
+        if (m_metrics) m_metrics->addBytesIn(retCount);
+        m_error.clear();
+        return retCount;
+    }
+    m_error = QString("GPIB viRead failed, status=%1").arg(st);
+    recordFailure(st);
+    return -1;
+}
+
+void GpibCommunication::recordFailure(ViStatus st) {
+    if (!m_metrics) return;
+    if (st == VI_ERROR_TMO) m_metrics->addTimeout();
+    else m_metrics->addError();
+}
+
+void GpibCommunication::setTimeout(int ms) {
+    m_timeoutMs = ms > 0 ? ms : defaultTimeoutMs;
+    if (m_opened)
+        viSetAttribute(m_instr, VI_ATTR_TMO_VALUE, static_cast<ViAttrState>(m_timeoutMs));
+}
+
+int GpibCommunication::timeout() const {
+    return m_timeoutMs;
+}
+
 bool GpibCommunication::isOpen() const {
     return m_opened;
 }
+
+int GpibCommunication::waitForServiceRequest(int timeoutMs) {
+    if (!m_opened) {
+        m_error = "GPIB not opened";
+        return -1;
+    }
+    if (!m_srqEnabled) {
+        ViStatus st = viEnableEvent(m_instr, VI_EVENT_SERVICE_REQ, VI_QUEUE, VI_NULL);
+        if (st < VI_SUCCESS) {
+            m_error = QString("GPIB viEnableEvent(SRQ) failed, status=%1").arg(st);
+            recordFailure(st);
+            return -1;
+        }
+        m_srqEnabled = true;
+    }
+
+    ViEventType type = 0;
+    ViEvent event = 0;
+    ViStatus st = viWaitOnEvent(m_instr, VI_EVENT_SERVICE_REQ,
+                                static_cast<ViUInt32>(qMax(0, timeoutMs)), &type, &event);
+    if (st == VI_ERROR_TMO) return 0;     // 沒有事件不算通訊錯誤，不計入統計
+    if (st < VI_SUCCESS) {
+        m_error = QString("GPIB viWaitOnEvent(SRQ) failed, status=%1").arg(st);
+        recordFailure(st);
+        return -1;
+    }
+    viClose(event);
+
+    // serial poll 讀回狀態位元組，清除 RQS，下一次事件才會再觸發 SRQ
+    ViUInt16 stb = 0;
+    viReadSTB(m_instr, &stb);
+    m_error.clear();
+    return 1;
+}
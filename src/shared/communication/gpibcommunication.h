@@ -1,9 +1,12 @@
 #pragma once
 
 #include "icommunication.h"
+
 #include <visa.h>          // NI-VISA 標頭
 #include <QString>
 
+class EndpointMetrics;
+
 class GpibCommunication : public ICommunication
 {
 public:
@@ -14,13 +17,28 @@ public:
     void close() override;
     int write(const QByteArray& data) override;
     int read(QByteArray& data, int maxLen) override;
+    int readInto(char* buffer, int maxLen) override;
+    void setTimeout(int ms) override;
+    int timeout() const override;
+    bool lastReadEndedMessage() const override { return m_readEnded; }
+    bool reportsMessageEnd() const override { return true; }
     bool isOpen() const override;
+    bool supportsServiceRequest() const override { return true; }
+    int waitForServiceRequest(int timeoutMs) override;
     QString lastError() const override { return m_error; }
+    void setMetrics(EndpointMetrics* metrics) override { m_metrics = metrics; }
+    EndpointMetrics* metrics() const override { return m_metrics; }
 
 private:
+    void recordFailure(ViStatus st);
+
     QString m_resource;      // GPIB 資源名稱
     ViSession m_rm = 0;      // VISA Resource Manager
     ViSession m_instr = 0;   // 儀器 Session
     bool m_opened = false;
     QString m_error;
+    int m_timeoutMs = defaultTimeoutMs;
+    bool m_srqEnabled = false;   // 已以 viEnableEvent 開啟 SRQ 事件佇列
+    bool m_readEnded = false;    // viRead 因 END / 終止字元結束（而非緩衝區滿）
+    EndpointMetrics* m_metrics = nullptr;   // 位元組數 / 逾時統計，由 Session Pool 註冊
 };
@@ -2,6 +2,12 @@
 #pragma once
 
 #include <QByteArray>
+#include <QString>
+#include <QRecursiveMutex>
+#include <cstring>
+
+class WrittenStateCache;
+class EndpointMetrics;
 
 class ICommunication {
 public:
@@ -12,4 +18,68 @@ public:
     virtual int read(QByteArray& data, int maxLen) = 0;  // 讀取資料
     virtual bool isOpen() const = 0;                     // 狀態查詢
     virtual QString lastError() const = 0;
+
+    // I/O 逾時（毫秒），之後的 read/write/open 都以此為準；預設 3000
+    virtual void setTimeout(int ms) { (void)ms; }
+    virtual int timeout() const { return defaultTimeoutMs; }
+
+    static constexpr int defaultTimeoutMs = 3000;
+
+    // 上一次 read/readInto 是否已到訊息結尾（GPIB 的 EOI / 終止字元）
+    // 串流類通訊（TCP / Serial）沒有訊息邊界，一律回傳 false，由上層以終止字元判斷
+    virtual bool lastReadEndedMessage() const { return false; }
+    // 是否會回報訊息結尾（lastReadEndedMessage 可信）；不定長度區塊（#0）只能靠它判斷結束
+    virtual bool reportsMessageEnd() const { return false; }
+
+    // IEEE-488.2 Service Request（SRQ）：儀器以 *ESE / *SRE 設定事件後，主動通知而不必輪詢
+    // 回傳 1 = 收到 SRQ（已做 serial poll 清除 RQS）、0 = 逾時、-1 = 此通訊不支援或失敗
+    // 只有 GPIB（VISA）支援；TCP / Serial 沒有帶外通知，使用端應退回輪詢
+    virtual bool supportsServiceRequest() const { return false; }
+    virtual int waitForServiceRequest(int timeoutMs) { (void)timeoutMs; return -1; }
+
+    // 交易鎖：多個執行緒共用同一條連線時，查詢的 write + read 之間要持有，回應才不會被別人拿走
+    // 只有 Session Pool 的長駐連線提供（與單次 I/O 鎖是同一個遞迴鎖），其餘回傳 nullptr
+    virtual QRecursiveMutex* transactionMutex() const { return nullptr; }
+
+    // 跨驅動物件保留的已寫入設定（重送抑制用）；只有 Session Pool 的長駐連線提供，其餘回傳 nullptr（一律送出）
+    virtual WrittenStateCache* writtenState() { return nullptr; }
+
+    // 位元組數 / 逾時統計：Session Pool 在實體連線開啟成功後，以 Pool 的資源 key 註冊
+    // 未註冊（非 Pool 連線）時為 nullptr，不做統計
+    virtual void setMetrics(EndpointMetrics* metrics) { (void)metrics; }
+    virtual EndpointMetrics* metrics() const { return nullptr; }
+
+    // 非阻塞讀取：只取走目前已到達的資料，回傳讀到的 bytes，0 = 尚無資料、-1 = 錯誤
+    // 串流類通訊（TCP / Serial）支援；VISA 沒有非阻塞讀取，由 AsyncInstrumentIo 改用阻塞執行緒
+    virtual bool supportsNonBlockingRead() const { return false; }
+    virtual int readAvailable(char* buffer, int maxLen) { (void)buffer; (void)maxLen; return -1; }
+
+    // 直接讀入呼叫端提供的記憶體（大量二進位傳輸用，省去中間 QByteArray）
+    // 預設以 read() 轉接，各通訊類別可 override 成真正的零複製
+    virtual int readInto(char* buffer, int maxLen) {
+        QByteArray tmp;
+        int n = read(tmp, maxLen);
+        if (n <= 0) return n;
+        n = qMin(n, maxLen);
+        memcpy(buffer, tmp.constData(), n);
+        return n;
+    }
+};
+
+// 交易鎖的 RAII 包裝；通訊不提供交易鎖時不做任何事
+class CommTransaction
+{
+public:
+    explicit CommTransaction(const ICommunication* comm)
+        : m_mutex(comm ? comm->transactionMutex() : nullptr)
+    {
+        if (m_mutex) m_mutex->lock();
+    }
+    ~CommTransaction() { if (m_mutex) m_mutex->unlock(); }
+
+    CommTransaction(const CommTransaction&) = delete;
+    CommTransaction& operator=(const CommTransaction&) = delete;
+
+private:
+    QRecursiveMutex* m_mutex = nullptr;
 };
@@ -0,0 +1,318 @@
+#include "instrumentsessionpool.h"
+#include "pooledcommunication.h"
+#include "communicationfactory.h"
+#include "instrumentmetrics.h"
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QThread>
+#include <QTimer>
+#include <QDebug>
+
+// ===== InstrumentSession =====
+
+InstrumentSession::InstrumentSession(const QString& res)
+    : resource(res)
+    , proxy(new PooledCommunication(this))
+{
+    lastUsed.start();
+}
+
+InstrumentSession::~InstrumentSession()
+{
+    drop();
+}
+
+bool InstrumentSession::ensureOpen()
+{
+    if (comm && comm->isOpen()) return true;
+
+    if (!comm) {
+        comm.reset(CommunicationFactory::create(resource));
+        if (!comm) {
+            lastError = QString("Communication format error: %1").arg(resource);
+            healthy = false;
+            return false;
+        }
+        comm->setTimeout(timeoutMs);
+    }
+
+    if (!comm->open()) {
+        lastError = comm->lastError();
+        healthy = false;
+        // 丟棄失敗的物件，下次重新建立（避免 socket 停在錯誤狀態）
+        comm.reset();
+        return false;
+    }
+
+    // 與 Pool 的 session key 相同：同一台儀器不論位址字串怎麼寫都記在同一筆
+    if (!metrics)
+        metrics = InstrumentMetrics::instance().endpoint(InstrumentSessionPool::normalizeResource(resource));
+    comm->setMetrics(metrics);
+
+    if (everOpened) {
+        reconnectCount++;
+        metrics->addReconnect();
+        qDebug() << "[SessionPool] Reconnected" << resource << "count =" << reconnectCount;
+    }
+    everOpened = true;
+    healthy = true;
+    writtenState.invalidateAll();   // 新的實體連線：儀器狀態未知
+    lastError.clear();
+    lastUsed.restart();
+    return true;
+}
+
+void InstrumentSession::drop()
+{
+    if (comm) {
+        comm->close();
+        comm.reset();
+    }
+    healthy = false;
+    writtenState.invalidateAll();
+}
+
+// ===== InstrumentSessionLease =====
+
+InstrumentSessionLease::~InstrumentSessionLease()
+{
+    release();
+}
+
+InstrumentSessionLease::InstrumentSessionLease(InstrumentSessionLease&& other) noexcept
+    : m_session(std::move(other.m_session))
+    , m_ok(other.m_ok)
+    , m_error(std::move(other.m_error))
+{
+    other.m_ok = false;
+}
+
+InstrumentSessionLease& InstrumentSessionLease::operator=(InstrumentSessionLease&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        m_session = std::move(other.m_session);
+        m_ok = other.m_ok;
+        m_error = std::move(other.m_error);
+        other.m_ok = false;
+    }
+    return *this;
+}
+
+ICommunication* InstrumentSessionLease::comm() const
+{
+    return m_session ? m_session->proxy.get() : nullptr;
+}
+
+QString InstrumentSessionLease::resource() const
+{
+    return m_session ? m_session->resource : QString();
+}
+
+void InstrumentSessionLease::markFailed()
+{
+    if (!m_session) return;
+    QMutexLocker locker(&m_session->mutex);
+    m_session->healthy = false;
+    m_session->writtenState.invalidateAll();
+}
+
+void InstrumentSessionLease::release()
+{
+    if (!m_session) return;
+    {
+        QMutexLocker ioLocker(&m_session->mutex);
+        m_session->lastUsed.restart();
+    }
+    {
+        QMutexLocker locker(&m_session->leaseMutex);
+        m_session->leased = false;
+    }
+    m_session->leaseReleased.wakeOne();
+    m_session.reset();
+    m_ok = false;
+}
+
+// ===== InstrumentSessionPool =====
+
+InstrumentSessionPool& InstrumentSessionPool::instance()
+{
+    static InstrumentSessionPool instance;
+    return instance;
+}
+
+InstrumentSessionPool::InstrumentSessionPool(QObject* parent)
+    : QObject(parent)
+{
+    m_sweepTimer = new QTimer(this);
+    connect(m_sweepTimer, &QTimer::timeout,
+            this, &InstrumentSessionPool::evictIdleSessions);
+
+    // 第一次取用可能在 QtConcurrent 執行緒，閒置回收計時器要跑在主執行緒的事件迴圈
+    if (QCoreApplication* app = QCoreApplication::instance()) {
+        if (thread() != app->thread()) {
+            moveToThread(app->thread());
+        }
+        QMetaObject::invokeMethod(m_sweepTimer, [this]() {
+            m_sweepTimer->start(sweepIntervalMs);
+        }, Qt::QueuedConnection);
+
+        // 程式結束前關閉所有實體連線（QApplication 解構後再關 socket 並不安全）
+        connect(app, &QCoreApplication::aboutToQuit,
+                this, &InstrumentSessionPool::closeAll);
+    }
+}
+
+InstrumentSessionPool::~InstrumentSessionPool()
+{
+    closeAll();
+}
+
+QString InstrumentSessionPool::normalizeResource(const QString& resource)
+{
+    static const QRegularExpression numberOnly("^[0-9]+$");
+    const QString res = resource.trimmed();
+    if (numberOnly.match(res).hasMatch())
+        return "GPIB0::" + res + "::INSTR";
+    return res.toUpper();
+}
+
+std::shared_ptr<InstrumentSession> InstrumentSessionPool::sessionFor(const QString& resource)
+{
+    const QString key = normalizeResource(resource);
+
+    QMutexLocker locker(&m_mapMutex);
+    auto it = m_sessions.find(key);
+    if (it != m_sessions.end())
+        return it.value();
+
+    // 保留使用者原始位址字串給 CommunicationFactory 解析
+    auto session = std::make_shared<InstrumentSession>(resource.trimmed());
+    m_sessions.insert(key, session);
+    return session;
+}
+
+InstrumentSessionLease InstrumentSessionPool::acquire(const QString& resource, int timeoutMs)
+{
+    InstrumentSessionLease lease;
+    if (resource.trimmed().isEmpty()) {
+        lease.m_error = "Empty instrument address";
+        return lease;
+    }
+
+    std::shared_ptr<InstrumentSession> session = sessionFor(resource);
+    {
+        QElapsedTimer clock;
+        clock.start();
+        QMutexLocker locker(&session->leaseMutex);
+        while (session->leased) {
+            if (timeoutMs < 0) {
+                session->leaseReleased.wait(&session->leaseMutex);
+                continue;
+            }
+            const qint64 remaining = timeoutMs - clock.elapsed();
+            if (remaining <= 0) {
+                lease.m_error = QString("Instrument busy: %1").arg(session->resource);
+                qWarning() << "[SessionPool] Acquire timed out:" << session->resource;
+                return lease;
+            }
+            session->leaseReleased.wait(&session->leaseMutex, static_cast<unsigned long>(remaining));
+        }
+        session->leased = true;
+    }
+    lease.m_session = session;
+
+    QMutexLocker ioLocker(&session->mutex);
+
+    // 已有連線：閒置太久或上次出錯時先做健康檢查
+    if (session->comm && session->comm->isOpen()) {
+        bool stale = session->lastUsed.elapsed() > m_healthCheckMs;
+        if ((stale || !session->healthy) && !healthCheck(*session)) {
+            qWarning() << "[SessionPool] Health check failed, reconnecting:" << session->resource;
+            session->drop();
+        }
+    }
+
+    lease.m_ok = session->ensureOpen();
+    if (!lease.m_ok) {
+        lease.m_error = session->lastError;
+        qWarning() << "[SessionPool] Open failed:" << session->resource << lease.m_error;
+    }
+    return lease;
+}
+
+ICommunication* InstrumentSessionPool::sharedCommunication(const QString& resource)
+{
+    if (resource.trimmed().isEmpty()) return nullptr;
+    return sessionFor(resource)->proxy.get();
+}
+
+bool InstrumentSessionPool::healthCheck(InstrumentSession& s)
+{
+    // 閒置或出錯期間前面板可能被操作過，已寫入的設定不再可信
+    s.writtenState.invalidateAll();
+
+    if (s.comm->write(QByteArray("*IDN?")) < 0) {
+        s.lastError = s.comm->lastError();
+        return false;
+    }
+    QByteArray resp;
+    if (s.comm->read(resp, 256) <= 0 || resp.trimmed().isEmpty()) {
+        s.lastError = s.comm->lastError();
+        return false;
+    }
+    s.healthy = true;
+    s.lastUsed.restart();
+    return true;
+}
+
+void InstrumentSessionPool::invalidate(const QString& resource)
+{
+    std::shared_ptr<InstrumentSession> session;
+    {
+        QMutexLocker locker(&m_mapMutex);
+        session = m_sessions.value(normalizeResource(resource));
+    }
+    if (!session) return;
+
+    QMutexLocker sessionLocker(&session->mutex);
+    session->drop();
+}
+
+void InstrumentSessionPool::evictIdleSessions()
+{
+    QList<std::shared_ptr<InstrumentSession>> sessions;
+    {
+        QMutexLocker locker(&m_mapMutex);
+        sessions = m_sessions.values();
+    }
+
+    for (const auto& session : sessions) {
+        // 使用中的 Session 直接跳過，不等待
+        {
+            QMutexLocker locker(&session->leaseMutex);
+            if (session->leased) continue;
+        }
+        if (!session->mutex.tryLock()) continue;
+        if (session->comm && session->lastUsed.elapsed() > m_idleTimeoutMs) {
+            qDebug() << "[SessionPool] Evict idle session:" << session->resource;
+            session->drop();
+        }
+        session->mutex.unlock();
+    }
+}
+
+void InstrumentSessionPool::closeAll()
+{
+    QList<std::shared_ptr<InstrumentSession>> sessions;
+    {
+        QMutexLocker locker(&m_mapMutex);
+        sessions = m_sessions.values();
+    }
+
+    for (const auto& session : sessions) {
+        QMutexLocker sessionLocker(&session->mutex);
+        session->drop();
+    }
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QMap>
+#include <QMutex>
+#include <QRecursiveMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <atomic>
+#include <memory>
+#include "icommunication.h"
+#include "writtenstatecache.h"
+
+class QTimer;
+class PooledCommunication;
+class EndpointMetrics;
+
+// 單一位址的長連線 Session（由 InstrumentSessionPool 持有，不要自行 new/delete）
+struct InstrumentSession
+{
+    explicit InstrumentSession(const QString& res);
+    ~InstrumentSession();
+
+    // 確保實體連線已開啟；已關閉（閒置回收或錯誤）時自動重連
+    bool ensureOpen();
+    // 關閉並丟棄實體連線，下次 ensureOpen() 會重新建立
+    void drop();
+
+    QString resource;
+    std::unique_ptr<ICommunication> comm;        // 實體通訊（GPIB/TCP/Serial）
+    std::unique_ptr<PooledCommunication> proxy;  // 交給儀器物件使用，close() 不會關閉實體連線
+    QRecursiveMutex mutex;                       // 單次 read/write 與開關連線互斥；查詢期間也作為交易鎖持有
+    WrittenStateCache writtenState;              // 上次成功送出的設定；重連 / 錯誤時作廢
+    EndpointMetrics* metrics = nullptr;          // 第一次開啟成功後以 normalizeResource() 的 key 註冊
+
+    // 獨佔使用權：與 I/O 鎖分開，持有 lease 的執行緒可把通訊交給其他 worker 執行緒使用
+    QMutex leaseMutex;
+    QWaitCondition leaseReleased;
+    bool leased = false;
+
+    QElapsedTimer lastUsed;
+    QString lastError;
+    int timeoutMs = ICommunication::defaultTimeoutMs;   // 重連後沿用
+    int reconnectCount = 0;
+    bool everOpened = false;
+    bool healthy = false;
+};
+
+// acquire() 取得的獨佔使用權，解構時自動歸還（只能 move，不能 copy）
+class InstrumentSessionLease
+{
+public:
+    InstrumentSessionLease() = default;
+    ~InstrumentSessionLease();
+
+    InstrumentSessionLease(InstrumentSessionLease&& other) noexcept;
+    InstrumentSessionLease& operator=(InstrumentSessionLease&& other) noexcept;
+    InstrumentSessionLease(const InstrumentSessionLease&) = delete;
+    InstrumentSessionLease& operator=(const InstrumentSessionLease&) = delete;
+
+    bool isValid() const { return m_session && m_ok; }
+    ICommunication* comm() const;      // 交給 Factory 建立儀器用，不要 delete
+    QString resource() const;
+    QString errorString() const { return m_error; }
+
+    // 使用中發生錯誤時呼叫，下次 acquire 會先做 *IDN? 健康檢查
+    void markFailed();
+    void release();
+
+private:
+    friend class InstrumentSessionPool;
+    std::shared_ptr<InstrumentSession> m_session;
+    bool m_ok = false;
+    QString m_error;
+};
+
+// 以位址為 key 的長駐連線池：延遲開啟、跨動作保持連線、*IDN? 健康檢查、自動重連、閒置回收
+// Page3 的 AC Source / DC Load / Oscilloscope 共用同一個 Pool
+class InstrumentSessionPool : public QObject
+{
+    Q_OBJECT
+public:
+    static InstrumentSessionPool& instance();
+
+    static constexpr int defaultAcquireTimeoutMs = 10000;
+
+    // 取得該位址的獨佔使用權（等待其他 lease 歸還，超過 timeoutMs 回傳無效 lease；負數 = 不限時）
+    // 同一位址不可重複 acquire
+    InstrumentSessionLease acquire(const QString& resource, int timeoutMs = defaultAcquireTimeoutMs);
+
+    // 長駐儀器（示波器）使用：不取得 lease，每次 read/write 個別上鎖
+    // 多個執行緒共用時，查詢以 CommTransaction（transactionMutex()）包住 write + read
+    ICommunication* sharedCommunication(const QString& resource);
+
+    // 強制該位址下次使用時重新連線
+    void invalidate(const QString& resource);
+
+    void setIdleTimeout(int ms)         { m_idleTimeoutMs = ms; }
+    int idleTimeout() const             { return m_idleTimeoutMs; }
+    void setHealthCheckInterval(int ms) { m_healthCheckMs = ms; }
+    int healthCheckInterval() const     { return m_healthCheckMs; }
+
+    // 位址正規化（純數字視為 GPIB0::<n>::INSTR，與 CommunicationFactory 一致）
+    static QString normalizeResource(const QString& resource);
+
+public slots:
+    void evictIdleSessions();
+    void closeAll();
+
+private:
+    InstrumentSessionPool(QObject* parent = nullptr);
+    ~InstrumentSessionPool() override;
+
+    InstrumentSessionPool(const InstrumentSessionPool&) = delete;
+    InstrumentSessionPool& operator=(const InstrumentSessionPool&) = delete;
+
+    std::shared_ptr<InstrumentSession> sessionFor(const QString& resource);
+    bool healthCheck(InstrumentSession& s);
+
+    QMutex m_mapMutex;
+    QMap<QString, std::shared_ptr<InstrumentSession>> m_sessions;
+    QTimer* m_sweepTimer = nullptr;
+
+    std::atomic<int> m_idleTimeoutMs{60000};   // 閒置多久後關閉實體連線
+    std::atomic<int> m_healthCheckMs{5000};    // 閒置超過此時間，取用前先 *IDN?
+    static const int sweepIntervalMs = 10000;
+};
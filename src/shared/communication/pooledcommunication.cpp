@@ -0,0 +1,156 @@
+#include "pooledcommunication.h"
+#include "instrumentsessionpool.h"
+#include <QMutexLocker>
+#include <QElapsedTimer>
+
+PooledCommunication::PooledCommunication(InstrumentSession* session)
+    : m_session(session) {}
+
+bool PooledCommunication::open() {
+    QMutexLocker locker(&m_session->mutex);
+    return m_session->ensureOpen();
+}
+
+void PooledCommunication::close() {
+    // 連線由 Pool 持有：儀器解構時的 disconnect() 不關閉實體連線
+    QMutexLocker locker(&m_session->mutex);
+    m_session->lastError.clear();
+}
+
+int PooledCommunication::write(const QByteArray& data) {
+    QMutexLocker locker(&m_session->mutex);
+    if (!m_session->ensureOpen()) return -1;
+
+    int ret = m_session->comm->write(data);
+    m_session->lastUsed.restart();
+    if (ret < 0) {
+        m_session->lastError = m_session->comm->lastError();
+        m_session->healthy = false;
+        return ret;
+    }
+    m_session->lastError.clear();
+    return ret;
+}
+
+int PooledCommunication::read(QByteArray& data, int maxLen) {
+    QMutexLocker locker(&m_session->mutex);
+    if (!m_session->ensureOpen()) return -1;
+
+    int ret = m_session->comm->read(data, maxLen);
+    m_session->lastUsed.restart();
+    if (ret < 0) {
+        m_session->lastError = m_session->comm->lastError();
+        m_session->healthy = false;
+        return ret;
+    }
+    m_session->lastError.clear();
+    return ret;
+}
+
+int PooledCommunication::readInto(char* buffer, int maxLen) {
+    QMutexLocker locker(&m_session->mutex);
+    if (!m_session->ensureOpen()) return -1;
+
+    int ret = m_session->comm->readInto(buffer, maxLen);
+    m_session->lastUsed.restart();
+    if (ret < 0) {
+        m_session->lastError = m_session->comm->lastError();
+        m_session->healthy = false;
+        return ret;
+    }
+    m_session->lastError.clear();
+    return ret;
+}
+
+bool PooledCommunication::supportsNonBlockingRead() const {
+    QMutexLocker locker(&m_session->mutex);
+    return m_session->comm && m_session->comm->supportsNonBlockingRead();
+}
+
+int PooledCommunication::readAvailable(char* buffer, int maxLen) {
+    QMutexLocker locker(&m_session->mutex);
+    if (!m_session->ensureOpen()) return -1;
+
+    int ret = m_session->comm->readAvailable(buffer, maxLen);
+    if (ret < 0) {
+        m_session->lastError = m_session->comm->lastError();
+        m_session->healthy = false;
+        return ret;
+    }
+    if (ret > 0) {
+        m_session->lastUsed.restart();
+        m_session->lastError.clear();
+    }
+    return ret;
+}
+
+void PooledCommunication::setTimeout(int ms) {
+    QMutexLocker locker(&m_session->mutex);
+    m_session->timeoutMs = ms;
+    if (m_session->comm) m_session->comm->setTimeout(ms);
+}
+
+int PooledCommunication::timeout() const {
+    QMutexLocker locker(&m_session->mutex);
+    return m_session->timeoutMs;
+}
+
+bool PooledCommunication::lastReadEndedMessage() const {
+    QMutexLocker locker(&m_session->mutex);
+    return m_session->comm && m_session->comm->lastReadEndedMessage();
+}
+
+bool PooledCommunication::reportsMessageEnd() const {
+    QMutexLocker locker(&m_session->mutex);
+    return m_session->comm && m_session->comm->reportsMessageEnd();
+}
+
+bool PooledCommunication::isOpen() const {
+    QMutexLocker locker(&m_session->mutex);
+    return m_session->comm && m_session->comm->isOpen();
+}
+
+bool PooledCommunication::supportsServiceRequest() const {
+    QMutexLocker locker(&m_session->mutex);
+    return m_session->comm && m_session->comm->supportsServiceRequest();
+}
+
+// 等待期間要持有 I/O 鎖（避免連線被回收），切成短片段等待，其他執行緒的指令最多只延遲一個片段
+int PooledCommunication::waitForServiceRequest(int timeoutMs) {
+    constexpr int sliceMs = 20;
+    QElapsedTimer clock;
+    clock.start();
+    for (;;) {
+        const int remaining = qMax(0, timeoutMs - static_cast<int>(clock.elapsed()));
+        {
+            QMutexLocker locker(&m_session->mutex);
+            if (!m_session->ensureOpen()) return -1;
+            const int ret = m_session->comm->waitForServiceRequest(qMin(remaining, sliceMs));
+            if (ret != 0) {
+                if (ret < 0) m_session->lastError = m_session->comm->lastError();
+                else m_session->lastUsed.restart();
+                return ret;
+            }
+        }
+        if (remaining <= sliceMs) return 0;
+    }
+}
+
+QRecursiveMutex* PooledCommunication::transactionMutex() const {
+    return &m_session->mutex;
+}
+
+WrittenStateCache* PooledCommunication::writtenState() {
+    return &m_session->writtenState;
+}
+
+EndpointMetrics* PooledCommunication::metrics() const {
+    // 實體連線開啟成功前尚未註冊，回傳 nullptr
+    QMutexLocker locker(&m_session->mutex);
+    return m_session->metrics;
+}
+
+QString PooledCommunication::lastError() const {
+    QMutexLocker locker(&m_session->mutex);
+    return m_session->lastError;
+}
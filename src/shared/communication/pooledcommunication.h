@@ -0,0 +1,37 @@
+#pragma once
+
+#include "icommunication.h"
+#include <QString>
+
+struct InstrumentSession;
+
+// Session Pool 交給儀器物件的代理通訊：
+// 轉發 read/write 到實體連線，但 close() 不關閉（連線生命週期由 Pool 管理）
+class PooledCommunication : public ICommunication
+{
+public:
+    explicit PooledCommunication(InstrumentSession* session);
+    ~PooledCommunication() override = default;
+
+    bool open() override;
+    void close() override;
+    int write(const QByteArray& data) override;
+    int read(QByteArray& data, int maxLen) override;
+    int readInto(char* buffer, int maxLen) override;
+    bool supportsNonBlockingRead() const override;
+    int readAvailable(char* buffer, int maxLen) override;
+    void setTimeout(int ms) override;
+    int timeout() const override;
+    bool lastReadEndedMessage() const override;
+    bool reportsMessageEnd() const override;
+    bool isOpen() const override;
+    bool supportsServiceRequest() const override;
+    int waitForServiceRequest(int timeoutMs) override;
+    QRecursiveMutex* transactionMutex() const override;
+    WrittenStateCache* writtenState() override;
+    EndpointMetrics* metrics() const override;
+    QString lastError() const override;
+
+private:
+    InstrumentSession* m_session = nullptr;  // 由 InstrumentSession 持有本物件
+};
@@ -0,0 +1,80 @@
+#include "recordingcommunication.h"
+#include <QDebug>
+
+RecordingCommunication::RecordingCommunication(ICommunication* inner, const QString& logPath,
+                                               const QString& resource)
+    : m_inner(inner)
+{
+    m_clock.start();
+    if (m_log.open(logPath, resource))
+        qDebug() << "[RecordingComm] Recording" << resource << "to" << logPath;
+}
+
+RecordingCommunication::~RecordingCommunication()
+{
+    m_log.close();
+}
+
+void RecordingCommunication::recordError()
+{
+    const QByteArray err = m_inner->lastError().toUtf8();
+    m_log.append(ScpiTrafficRecord::Error, m_clock.nsecsElapsed(), err.constData(), err.size());
+}
+
+bool RecordingCommunication::open()
+{
+    bool ok = m_inner->open();
+    if (!ok) recordError();
+    return ok;
+}
+
+void RecordingCommunication::close()
+{
+    m_inner->close();
+}
+
+int RecordingCommunication::write(const QByteArray& data)
+{
+    // 時間戳記取在送出前，重播時以「寫入 → 第一段回應」計算儀器延遲
+    const qint64 t = m_clock.nsecsElapsed();
+    int ret = m_inner->write(data);
+    if (ret < 0) {
+        recordError();
+    } else {
+        m_log.append(ScpiTrafficRecord::Write, t, data.constData(), data.size());
+    }
+    return ret;
+}
+
+int RecordingCommunication::read(QByteArray& data, int maxLen)
+{
+    int ret = m_inner->read(data, maxLen);
+    if (ret < 0) {
+        recordError();
+    } else {
+        m_log.append(ScpiTrafficRecord::Read, m_clock.nsecsElapsed(), data.constData(), data.size());
+    }
+    return ret;
+}
+
+int RecordingCommunication::readInto(char* buffer, int maxLen)
+{
+    int ret = m_inner->readInto(buffer, maxLen);
+    if (ret < 0) {
+        recordError();
+    } else {
+        m_log.append(ScpiTrafficRecord::Read, m_clock.nsecsElapsed(), buffer, ret);
+    }
+    return ret;
+}
+
+int RecordingCommunication::readAvailable(char* buffer, int maxLen)
+{
+    int ret = m_inner->readAvailable(buffer, maxLen);
+    if (ret < 0) {
+        recordError();
+    } else if (ret > 0) {
+        m_log.append(ScpiTrafficRecord::Read, m_clock.nsecsElapsed(), buffer, ret);
+    }
+    return ret;
+}
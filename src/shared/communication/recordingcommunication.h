@@ -0,0 +1,43 @@
+#pragma once
+
+#include "icommunication.h"
+#include "scpitrafficlog.h"
+#include <QElapsedTimer>
+#include <memory>
+
+// 通訊紀錄 decorator：轉發到實際通訊物件，同時把每次 write / read 連同 ns 時間戳記寫入紀錄檔
+// 紀錄檔可交給 SIM:: 模擬後端重播，沒有實機也能重現整個流程
+class RecordingCommunication : public ICommunication
+{
+public:
+    // 取得 inner 的所有權
+    RecordingCommunication(ICommunication* inner, const QString& logPath, const QString& resource);
+    ~RecordingCommunication() override;
+
+    bool open() override;
+    void close() override;
+    int write(const QByteArray& data) override;
+    int read(QByteArray& data, int maxLen) override;
+    int readInto(char* buffer, int maxLen) override;
+    bool supportsNonBlockingRead() const override { return m_inner->supportsNonBlockingRead(); }
+    int readAvailable(char* buffer, int maxLen) override;
+    void setTimeout(int ms) override { m_inner->setTimeout(ms); }
+    int timeout() const override { return m_inner->timeout(); }
+    bool lastReadEndedMessage() const override { return m_inner->lastReadEndedMessage(); }
+    bool reportsMessageEnd() const override { return m_inner->reportsMessageEnd(); }
+    bool isOpen() const override { return m_inner->isOpen(); }
+    bool supportsServiceRequest() const override { return m_inner->supportsServiceRequest(); }
+    int waitForServiceRequest(int timeoutMs) override { return m_inner->waitForServiceRequest(timeoutMs); }
+    QRecursiveMutex* transactionMutex() const override { return m_inner->transactionMutex(); }
+    WrittenStateCache* writtenState() override { return m_inner->writtenState(); }
+    void setMetrics(EndpointMetrics* metrics) override { m_inner->setMetrics(metrics); }
+    EndpointMetrics* metrics() const override { return m_inner->metrics(); }
+    QString lastError() const override { return m_inner->lastError(); }
+
+private:
+    void recordError();
+
+    std::unique_ptr<ICommunication> m_inner;
+    ScpiTrafficLog m_log;
+    QElapsedTimer m_clock;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "scpitrafficlog.h"
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <random>
+
+// 回應延遲設定
+struct ScpiReplayTiming
+{
+    bool useRecorded = true;    // 使用紀錄中「寫入 → 回應」的實際延遲
+    double latencyMs = 0.0;     // useRecorded = false 時的固定延遲
+    double jitterMs = 0.0;      // 在延遲上加減的隨機抖動（均勻分布）
+    quint32 seed = 1;           // 固定種子：同樣的紀錄與設定每次結果相同
+};
+
+// 重播引擎：把紀錄整理成「指令 → 依序的回應」，依收到的指令回傳對應回應
+// 同一指令多次出現時依紀錄順序輪流回傳，用完從頭開始（流程可重複執行）
+class ScpiReplayEngine
+{
+public:
+    struct Reply {
+        bool hasResponse = false;
+        QByteArray data;
+        qint64 delayNs = 0;
+    };
+
+    bool load(const QString& logPath);
+    void setTiming(const ScpiReplayTiming& timing);
+
+    // 依指令取得回應；查詢（含 '?'）找不到紀錄時 ok = false
+    Reply respond(const QByteArray& command, bool& ok);
+
+    QString resource() const { return m_resource; }
+    QString lastError() const { return m_error; }
+
+private:
+    struct Recorded {
+        QByteArray data;
+        qint64 latencyNs = 0;
+    };
+    struct Entry {
+        QVector<Recorded> replies;   // 空表示設定指令（沒有回應）
+        int cursor = 0;
+    };
+
+    static QByteArray keyOf(const QByteArray& command);
+    qint64 delayFor(qint64 recordedNs);
+
+    QHash<QByteArray, Entry> m_entries;
+    ScpiReplayTiming m_timing;
+    std::mt19937 m_rng;
+    QString m_resource;
+    QString m_error;
+    QMutex m_mutex;
+};
@@ -0,0 +1,125 @@
+#include "scpisimulatorserver.h"
+#include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+#include <QDebug>
+
+bool ScpiSimulatorServer::ensureRunning(const QString& logPath, quint16 port,
+                                        const ScpiReplayTiming& timing, QString* error)
+{
+    static QMutex mutex;
+    static QHash<quint16, ScpiSimulatorServer*> servers;
+
+    QMutexLocker locker(&mutex);
+    if (servers.contains(port)) return true;
+
+    std::unique_ptr<ScpiReplayEngine> engine(new ScpiReplayEngine());
+    if (!engine->load(logPath)) {
+        if (error) *error = engine->lastError();
+        return false;
+    }
+    engine->setTiming(timing);
+
+    QThread* thread = new QThread();
+    thread->setObjectName(QString("ScpiSimulator:%1").arg(port));
+    ScpiSimulatorServer* server = new ScpiSimulatorServer(std::move(engine));
+    server->moveToThread(thread);
+    QObject::connect(thread, &QThread::finished, server, &QObject::deleteLater);
+    thread->start();
+
+    bool ok = false;
+    QString err;
+    QMetaObject::invokeMethod(server, [server, port, &ok, &err]() {
+        ok = server->listen(port, &err);
+    }, Qt::BlockingQueuedConnection);
+
+    if (!ok) {
+        thread->quit();
+        thread->wait();
+        delete thread;
+        if (error) *error = err;
+        return false;
+    }
+
+    if (QCoreApplication* app = QCoreApplication::instance()) {
+        QObject::connect(app, &QCoreApplication::aboutToQuit, app, [thread]() {
+            thread->quit();
+            thread->wait();
+        });
+    }
+    servers.insert(port, server);
+    return true;
+}
+
+ScpiSimulatorServer::ScpiSimulatorServer(std::unique_ptr<ScpiReplayEngine> engine)
+    : m_engine(std::move(engine))
+{
+    m_clock.start();
+}
+
+bool ScpiSimulatorServer::listen(quint16 port, QString* error)
+{
+    m_server = new QTcpServer(this);
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        if (error) *error = QString("Simulator listen on %1 failed: %2").arg(port).arg(m_server->errorString());
+        qWarning() << "[ScpiSimulator]" << (error ? *error : QString());
+        return false;
+    }
+    connect(m_server, &QTcpServer::newConnection, this, &ScpiSimulatorServer::onNewConnection);
+    qDebug() << "[ScpiSimulator] Listening on 127.0.0.1:" << port << "as" << m_engine->resource();
+    return true;
+}
+
+void ScpiSimulatorServer::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        m_clients.insert(socket, Client());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_clients.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void ScpiSimulatorServer::onReadyRead(QTcpSocket* socket)
+{
+    auto it = m_clients.find(socket);
+    if (it == m_clients.end()) return;
+    Client& client = it.value();
+    client.rx.append(socket->readAll());
+
+    // 每個 LF 結尾的 program message 視為一筆指令；
+    // 驅動程式送出的指令不一定帶 LF，沒有後續資料時剩下的內容也當成一筆
+    while (!client.rx.isEmpty()) {
+        int idx = client.rx.indexOf('\n');
+        if (idx < 0) {
+            if (socket->bytesAvailable() > 0) break;
+            idx = client.rx.size() - 1;
+        }
+        const QByteArray command = client.rx.left(idx + 1);
+        client.rx.remove(0, idx + 1);
+
+        bool ok = true;
+        ScpiReplayEngine::Reply reply = m_engine->respond(command, ok);
+        if (!reply.hasResponse) continue;   // 設定指令或未紀錄的查詢（用戶端會逾時）
+
+        const qint64 now = m_clock.nsecsElapsed();
+        const qint64 sendAt = qMax(now + reply.delayNs, client.busyUntilNs);
+        client.busyUntilNs = sendAt;
+
+        // QTimer 以毫秒為單位，次毫秒延遲直接送出（需要精確延遲請用行程內模擬）
+        const int delayMs = static_cast<int>((sendAt - now) / 1000000);
+        const QByteArray data = reply.data;
+        if (delayMs <= 0) {
+            socket->write(data);
+        } else {
+            QTimer::singleShot(delayMs, Qt::PreciseTimer, socket, [socket, data]() { socket->write(data); });
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "scpireplayengine.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <memory>
+
+class QTcpServer;
+class QTcpSocket;
+
+// 本機 TCP 模擬儀器：在 127.0.0.1:<port> 依紀錄檔回應
+// 走真正的 TcpCommunication 路徑，連 socket 分段、Nagle 等行為都包含在量測內
+// 每個 port 一個實例，跑在自己的執行緒（事件迴圈），程式結束時一起停止
+class ScpiSimulatorServer : public QObject
+{
+    Q_OBJECT
+public:
+    // 啟動（已啟動則沿用）指定 port 的模擬器
+    static bool ensureRunning(const QString& logPath, quint16 port,
+                              const ScpiReplayTiming& timing, QString* error = nullptr);
+
+private:
+    explicit ScpiSimulatorServer(std::unique_ptr<ScpiReplayEngine> engine);
+
+    bool listen(quint16 port, QString* error);   // 在 server 執行緒呼叫
+    void onNewConnection();
+    void onReadyRead(QTcpSocket* socket);
+
+    struct Client {
+        QByteArray rx;
+        qint64 busyUntilNs = 0;   // 前一個回應送出的時間點，回應不會因抖動而亂序
+    };
+
+    std::unique_ptr<ScpiReplayEngine> m_engine;
+    QTcpServer* m_server = nullptr;
+    QHash<QTcpSocket*, Client> m_clients;
+    QElapsedTimer m_clock;
+};
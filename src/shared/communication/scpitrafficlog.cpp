@@ -0,0 +1,103 @@
+#include "scpitrafficlog.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QtEndian>
+#include <QDebug>
+
+const QByteArray ScpiTrafficLog::magic("SCPITRC1");
+
+ScpiTrafficLog::~ScpiTrafficLog()
+{
+    close();
+}
+
+bool ScpiTrafficLog::open(const QString& path, const QString& resource)
+{
+    close();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        m_error = QString("Open traffic log failed: %1 (%2)").arg(path, m_file.errorString());
+        qWarning() << "[ScpiTrafficLog]" << m_error;
+        return false;
+    }
+
+    const QByteArray res = resource.toUtf8();
+    uchar len[2];
+    qToLittleEndian<quint16>(static_cast<quint16>(res.size()), len);
+    m_file.write(magic);
+    m_file.write(reinterpret_cast<const char*>(len), sizeof(len));
+    m_file.write(res);
+    m_error.clear();
+    return true;
+}
+
+void ScpiTrafficLog::close()
+{
+    if (m_file.isOpen()) {
+        m_file.flush();
+        m_file.close();
+    }
+}
+
+void ScpiTrafficLog::append(ScpiTrafficRecord::Direction dir, qint64 timestampNs, const char* data, int len)
+{
+    if (!m_file.isOpen()) return;
+
+    // 13 bytes 固定表頭 + 資料；QFile 自帶緩衝，不需每筆 flush
+    uchar head[13];
+    head[0] = static_cast<uchar>(dir);
+    qToLittleEndian<quint64>(static_cast<quint64>(timestampNs), head + 1);
+    qToLittleEndian<quint32>(static_cast<quint32>(len), head + 9);
+    m_file.write(reinterpret_cast<const char*>(head), sizeof(head));
+    if (len > 0) m_file.write(data, len);
+}
+
+bool ScpiTrafficLog::load(const QString& path, QVector<ScpiTrafficRecord>& records,
+                          QString* resource, QString* error)
+{
+    records.clear();
+    auto fail = [&](const QString& msg) {
+        if (error) *error = msg;
+        qWarning() << "[ScpiTrafficLog]" << msg;
+        return false;
+    };
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return fail(QString("Open traffic log failed: %1 (%2)").arg(path, file.errorString()));
+
+    const QByteArray all = file.readAll();
+    const uchar* p = reinterpret_cast<const uchar*>(all.constData());
+    const qint64 size = all.size();
+
+    if (size < magic.size() + 2 || !all.startsWith(magic))
+        return fail(QString("Not a SCPI traffic log: %1").arg(path));
+
+    qint64 pos = magic.size();
+    const quint16 resLen = qFromLittleEndian<quint16>(p + pos);
+    pos += 2;
+    if (pos + resLen > size) return fail(QString("Truncated traffic log header: %1").arg(path));
+    if (resource) *resource = QString::fromUtf8(all.constData() + pos, resLen);
+    pos += resLen;
+
+    while (pos + 13 <= size) {
+        ScpiTrafficRecord rec;
+        rec.direction = static_cast<ScpiTrafficRecord::Direction>(p[pos]);
+        rec.timestampNs = static_cast<qint64>(qFromLittleEndian<quint64>(p + pos + 1));
+        const quint32 len = qFromLittleEndian<quint32>(p + pos + 9);
+        pos += 13;
+        if (pos + len > size) {
+            // 程式中途結束時最後一筆可能不完整，保留前面的資料
+            qWarning() << "[ScpiTrafficLog] Truncated record ignored in" << path;
+            break;
+        }
+        rec.data = all.mid(static_cast<int>(pos), static_cast<int>(len));
+        pos += len;
+        records.append(rec);
+    }
+
+    if (error) error->clear();
+    return true;
+}
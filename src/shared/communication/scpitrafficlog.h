@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+// SCPI 通訊紀錄（二進位格式，小端序）
+//   檔頭：  "SCPITRC1"  u16 resource 長度  resource(UTF-8)
+//   每筆：  u8 方向  u64 時間(ns，相對開檔)  u32 長度  資料
+// 讀回時可用 ScpiReplayEngine 重播
+struct ScpiTrafficRecord
+{
+    enum Direction : quint8 { Write = 0, Read = 1, Error = 2 };
+
+    Direction direction = Write;
+    qint64 timestampNs = 0;
+    QByteArray data;            // Error 時為錯誤訊息
+};
+
+class ScpiTrafficLog
+{
+public:
+    ScpiTrafficLog() = default;
+    ~ScpiTrafficLog();
+
+    bool open(const QString& path, const QString& resource);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    void append(ScpiTrafficRecord::Direction dir, qint64 timestampNs, const char* data, int len);
+
+    QString lastError() const { return m_error; }
+
+    // 讀取整份紀錄
+    static bool load(const QString& path, QVector<ScpiTrafficRecord>& records,
+                     QString* resource = nullptr, QString* error = nullptr);
+
+private:
+    QFile m_file;
+    QString m_error;
+
+    static const QByteArray magic;
+};
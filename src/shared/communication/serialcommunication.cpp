@@ -1,5 +1,6 @@
 // SerialCommunication.cpp
 #include "serialcommunication.h"
+#include "instrumentmetrics.h"
 #include <QDebug>
 
 SerialCommunication::SerialCommunication(const QString& portName, int baudRate)
@@ -50,14 +51,17 @@ int SerialCommunication::write(const QByteArray& data) {
         return -1;
     }
     qint64 written = m_port->write(data);
-    if (!m_port->waitForBytesWritten(3000)) {
+    if (!m_port->waitForBytesWritten(m_timeoutMs)) {
         m_error = "Serial write timeout";
+        if (m_metrics) m_metrics->addTimeout();
         return -1;
     }
     if (written < 0) {
         m_error = "Serial write failed";
+        if (m_metrics) m_metrics->addError();
         return -1;
     }
+    if (m_metrics) m_metrics->addBytesOut(written);
     m_error.clear();
     return static_cast<int>(written);
 }
@@ -67,21 +71,82 @@ int SerialCommunication::read(QByteArray& data, int maxLen) {
         m_error = "Serial port not open";
         return -1;
     }
-    if (!m_port->waitForReadyRead(3000)) {
+    // 緩衝區已有資料就直接讀（分段讀取時不要再等新資料進來）
+    if (m_port->bytesAvailable() == 0 && !m_port->waitForReadyRead(m_timeoutMs)) {
         m_error = "Serial read timeout";
+        if (m_metrics) m_metrics->addTimeout();
         return -1;
     }
     QByteArray buf = m_port->read(maxLen);
     if (buf.isEmpty()) {
         m_error = "Serial read failed or no data";
+        if (m_metrics) m_metrics->addError();
         return -1;
     }
+    if (m_metrics) m_metrics->addBytesIn(buf.size());
     data = buf;
     m_error.clear();
     return buf.size();
 }
 
 
+int SerialCommunication::readInto(char* buffer, int maxLen) {
+    if (!isOpen()) {
+        m_error = "Serial port not open";
+        return -1;
+    }
+    if (m_port->bytesAvailable() == 0 && !m_port->waitForReadyRead(m_timeoutMs)) {
+        m_error = "Serial read timeout";
+        if (m_metrics) m_metrics->addTimeout();
+        return -1;
+    }
+    qint64 n = m_port->read(buffer, maxLen);
+    if (n <= 0) {
+        m_error = "Serial read failed or no data";
+        if (m_metrics) m_metrics->addError();
+        return -1;
+    }
+    if (m_metrics) m_metrics->addBytesIn(n);
+    m_error.clear();
+    return static_cast<int>(n);
+}
+
+// 不等待：先處理已到達的 socket 事件，緩衝區沒有資料就回傳 0
+int SerialCommunication::readAvailable(char* buffer, int maxLen) {
+    if (!isOpen()) {
+        m_error = "Serial port not open";
+        return -1;
+    }
+    if (m_port->bytesAvailable() == 0) {
+        m_port->waitForReadyRead(0);
+        if (m_port->bytesAvailable() == 0) {
+            if (!isOpen()) {
+                m_error = "Serial connection lost";
+                if (m_metrics) m_metrics->addError();
+                return -1;
+            }
+            return 0;
+        }
+    }
+    qint64 n = m_port->read(buffer, maxLen);
+    if (n < 0) {
+        m_error = "Serial read failed";
+        if (m_metrics) m_metrics->addError();
+        return -1;
+    }
+    if (m_metrics) m_metrics->addBytesIn(n);
+    m_error.clear();
+    return static_cast<int>(n);
+}
+
+void SerialCommunication::setTimeout(int ms) {
+    m_timeoutMs = ms > 0 ? ms : defaultTimeoutMs;
+}
+
+int SerialCommunication::timeout() const {
+    return m_timeoutMs;
+}
+
 bool SerialCommunication::isOpen() const {
     return m_port && m_port->isOpen();
 }
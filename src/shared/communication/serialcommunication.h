@@ -1,9 +1,12 @@
 // SerialCommunication.h
 #pragma once
 #include "icommunication.h"
+
 #include <QSerialPort>
 #include <QString>
 
+class EndpointMetrics;
+
 class SerialCommunication : public ICommunication {
 public:
     SerialCommunication(const QString& portName, int baudRate = 9600);
@@ -13,12 +16,21 @@ public:
     void close() override;
     int write(const QByteArray& data) override;
     int read(QByteArray& data, int maxLen) override;
+    int readInto(char* buffer, int maxLen) override;
+    bool supportsNonBlockingRead() const override { return true; }
+    int readAvailable(char* buffer, int maxLen) override;
+    void setTimeout(int ms) override;
+    int timeout() const override;
     bool isOpen() const override;
     QString lastError() const override { return m_error; }
+    void setMetrics(EndpointMetrics* metrics) override { m_metrics = metrics; }
+    EndpointMetrics* metrics() const override { return m_metrics; }
 
 private:
     QString m_portName;
     int m_baudRate;
     QSerialPort* m_port = nullptr;
     QString m_error;
+    int m_timeoutMs = defaultTimeoutMs;
+    EndpointMetrics* m_metrics = nullptr;   // 位元組數 / 逾時統計，由 Session Pool 註冊
 };
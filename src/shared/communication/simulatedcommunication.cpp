@@ -0,0 +1,104 @@
+#include "simulatedcommunication.h"
+#include <QThread>
+#include <QDebug>
+#include <cstring>
+
+SimulatedCommunication::SimulatedCommunication(const QString& logPath, const ScpiReplayTiming& timing)
+    : m_logPath(logPath), m_timing(timing)
+{
+    m_clock.start();
+}
+
+bool SimulatedCommunication::open()
+{
+    if (m_opened) return true;
+    m_engine.reset(new ScpiReplayEngine());
+    if (!m_engine->load(m_logPath)) {
+        m_error = m_engine->lastError();
+        m_engine.reset();
+        return false;
+    }
+    m_engine->setTiming(m_timing);
+    m_opened = true;
+    m_error.clear();
+    return true;
+}
+
+void SimulatedCommunication::close()
+{
+    m_opened = false;
+    m_engine.reset();
+    m_pending.clear();
+    m_pendingError = false;
+}
+
+int SimulatedCommunication::write(const QByteArray& data)
+{
+    if (!m_opened) {
+        m_error = "Simulator not open";
+        return -1;
+    }
+
+    bool ok = true;
+    ScpiReplayEngine::Reply reply = m_engine->respond(data, ok);
+    if (!ok) {
+        m_pendingError = true;
+        m_error = m_engine->lastError();
+        return data.size();   // 寫入本身成功，讀取時才回報
+    }
+    if (reply.hasResponse) {
+        m_pending.append(reply.data);
+        m_readyAtNs = m_clock.nsecsElapsed() + reply.delayNs;
+        m_pendingError = false;
+    }
+    m_error.clear();
+    return data.size();
+}
+
+bool SimulatedCommunication::waitReady()
+{
+    if (m_pending.isEmpty()) {
+        // 沒有回應可讀：不實際等待逾時，讓基準測試不被拖慢
+        m_error = m_pendingError ? m_error : QString("Simulated read timeout");
+        m_pendingError = false;
+        return false;
+    }
+
+    const qint64 timeoutNs = static_cast<qint64>(m_timeoutMs) * 1000000;
+    qint64 waitNs = m_readyAtNs - m_clock.nsecsElapsed();
+    if (waitNs > timeoutNs) {
+        QThread::msleep(static_cast<unsigned long>(m_timeoutMs));
+        m_error = "Simulated read timeout (latency exceeds timeout)";
+        return false;
+    }
+
+    // 大段時間交給 sleep，最後 2 ms 忙等（系統 sleep 精度不足以模擬次毫秒延遲）
+    if (waitNs > 2000000)
+        QThread::usleep(static_cast<unsigned long>((waitNs - 2000000) / 1000));
+    while (m_clock.nsecsElapsed() < m_readyAtNs) {}
+    return true;
+}
+
+int SimulatedCommunication::read(QByteArray& data, int maxLen)
+{
+    data.resize(qMax(0, maxLen));
+    int n = readInto(data.data(), maxLen);
+    data.resize(qMax(0, n));
+    return n;
+}
+
+int SimulatedCommunication::readInto(char* buffer, int maxLen)
+{
+    if (!m_opened) {
+        m_error = "Simulator not open";
+        return -1;
+    }
+    if (!waitReady()) return -1;
+
+    const int n = qMin(maxLen, m_pending.size());
+    memcpy(buffer, m_pending.constData(), n);
+    m_pending.remove(0, n);
+    m_ended = m_pending.isEmpty();   // 模擬 GPIB：整個回應讀完即訊息結束
+    m_error.clear();
+    return n;
+}
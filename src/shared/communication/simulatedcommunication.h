@@ -0,0 +1,42 @@
+#pragma once
+
+#include "icommunication.h"
+#include "scpireplayengine.h"
+#include <QElapsedTimer>
+#include <memory>
+
+// 行程內的模擬通訊：不經過網路，直接由 ScpiReplayEngine 回應
+// 回應在「寫入時間 + 延遲」之後才讀得到，延遲小於數毫秒時以忙等補足，量測結果可重現
+class SimulatedCommunication : public ICommunication
+{
+public:
+    SimulatedCommunication(const QString& logPath, const ScpiReplayTiming& timing);
+
+    bool open() override;
+    void close() override;
+    int write(const QByteArray& data) override;
+    int read(QByteArray& data, int maxLen) override;
+    int readInto(char* buffer, int maxLen) override;
+    void setTimeout(int ms) override { m_timeoutMs = ms > 0 ? ms : defaultTimeoutMs; }
+    int timeout() const override { return m_timeoutMs; }
+    bool lastReadEndedMessage() const override { return m_ended; }
+    bool reportsMessageEnd() const override { return true; }
+    bool isOpen() const override { return m_opened; }
+    QString lastError() const override { return m_error; }
+
+private:
+    bool waitReady();
+
+    QString m_logPath;
+    ScpiReplayTiming m_timing;
+    std::unique_ptr<ScpiReplayEngine> m_engine;
+
+    QElapsedTimer m_clock;
+    QByteArray m_pending;       // 尚未被讀走的回應
+    qint64 m_readyAtNs = 0;     // 回應可讀的時間點
+    bool m_pendingError = false;
+    bool m_ended = false;
+    bool m_opened = false;
+    int m_timeoutMs = defaultTimeoutMs;
+    QString m_error;
+};
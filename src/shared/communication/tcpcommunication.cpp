@@ -1,5 +1,6 @@
 // TcpCommunication.cpp
 #include "tcpcommunication.h"
+#include "instrumentmetrics.h"
 #include <QDebug>
 
 TcpCommunication::TcpCommunication(const QString& ip, quint16 port)
@@ -20,7 +21,7 @@ bool TcpCommunication::open() {
         return true;
     }
     m_socket->connectToHost(m_ip, m_port);
-    if (!m_socket->waitForConnected(3000)) {
+    if (!m_socket->waitForConnected(m_timeoutMs)) {
         m_error = QString("TCP connect failed: %1:%2 [%3]")
         .arg(m_ip).arg(m_port).arg(m_socket->errorString());
         return false;
@@ -51,14 +52,17 @@ int TcpCommunication::write(const QByteArray& data) {
         return -1;
     }
     qint64 written = m_socket->write(data);
-    if (!m_socket->waitForBytesWritten(3000)) {
+    if (!m_socket->waitForBytesWritten(m_timeoutMs)) {
         m_error = "TCP write timeout";
+        if (m_metrics) m_metrics->addTimeout();
         return -1;
     }
     if (written < 0) {
         m_error = "TCP write failed";
+        if (m_metrics) m_metrics->addError();
         return -1;
     }
+    if (m_metrics) m_metrics->addBytesOut(written);
     m_error.clear();
     return static_cast<int>(written);
 }
@@ -68,21 +72,82 @@ int TcpCommunication::read(QByteArray& data, int maxLen) {
         m_error = "TCP socket not open";
         return -1;
     }
-    if (!m_socket->waitForReadyRead(3000)) {
+    // 緩衝區已有資料就直接讀（分段讀取時不要再等新資料進來）
+    if (m_socket->bytesAvailable() == 0 && !m_socket->waitForReadyRead(m_timeoutMs)) {
         m_error = "TCP read timeout";
+        if (m_metrics) m_metrics->addTimeout();
         return -1;
     }
     QByteArray buf = m_socket->read(maxLen);
     if (buf.isEmpty()) {
         m_error = "TCP read failed or no data";
+        if (m_metrics) m_metrics->addError();
         return -1;
     }
+    if (m_metrics) m_metrics->addBytesIn(buf.size());
     data = buf;
     m_error.clear();
     return buf.size();
 }
 
 
+int TcpCommunication::readInto(char* buffer, int maxLen) {
+    if (!isOpen()) {
+        m_error = "TCP socket not open";
+        return -1;
+    }
+    if (m_socket->bytesAvailable() == 0 && !m_socket->waitForReadyRead(m_timeoutMs)) {
+        m_error = "TCP read timeout";
+        if (m_metrics) m_metrics->addTimeout();
+        return -1;
+    }
+    qint64 n = m_socket->read(buffer, maxLen);
+    if (n <= 0) {
+        m_error = "TCP read failed or no data";
+        if (m_metrics) m_metrics->addError();
+        return -1;
+    }
+    if (m_metrics) m_metrics->addBytesIn(n);
+    m_error.clear();
+    return static_cast<int>(n);
+}
+
+// 不等待：先處理已到達的 socket 事件，緩衝區沒有資料就回傳 0
+int TcpCommunication::readAvailable(char* buffer, int maxLen) {
+    if (!isOpen()) {
+        m_error = "TCP socket not open";
+        return -1;
+    }
+    if (m_socket->bytesAvailable() == 0) {
+        m_socket->waitForReadyRead(0);
+        if (m_socket->bytesAvailable() == 0) {
+            if (!isOpen()) {
+                m_error = "TCP connection lost";
+                if (m_metrics) m_metrics->addError();
+                return -1;
+            }
+            return 0;
+        }
+    }
+    qint64 n = m_socket->read(buffer, maxLen);
+    if (n < 0) {
+        m_error = "TCP read failed";
+        if (m_metrics) m_metrics->addError();
+        return -1;
+    }
+    if (m_metrics) m_metrics->addBytesIn(n);
+    m_error.clear();
+    return static_cast<int>(n);
+}
+
+void TcpCommunication::setTimeout(int ms) {
+    m_timeoutMs = ms > 0 ? ms : defaultTimeoutMs;
+}
+
+int TcpCommunication::timeout() const {
+    return m_timeoutMs;
+}
+
 bool TcpCommunication::isOpen() const {
     return m_socket && m_socket->state() == QAbstractSocket::ConnectedState;
 }
@@ -0,0 +1,28 @@
+#include "writtenstatecache.h"
+
+bool WrittenStateCache::matches(int channel, const QString& key, const QString& command) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_channels.constFind(channel);
+    if (it == m_channels.constEnd()) return false;
+    auto entry = it->constFind(key);
+    return entry != it->constEnd() && *entry == command;
+}
+
+void WrittenStateCache::record(int channel, const QString& key, const QString& command)
+{
+    QMutexLocker locker(&m_mutex);
+    m_channels[channel].insert(key, command);
+}
+
+void WrittenStateCache::invalidateChannel(int channel)
+{
+    QMutexLocker locker(&m_mutex);
+    m_channels.remove(channel);
+}
+
+void WrittenStateCache::invalidateAll()
+{
+    QMutexLocker locker(&m_mutex);
+    m_channels.clear();
+}
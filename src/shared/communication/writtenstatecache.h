@@ -0,0 +1,24 @@
+#pragma once
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+// 每條實體連線「上次成功送出」的設定：channel → (key → 完整指令文字)
+// 驅動程式送設定前比對，相同就略過；由 InstrumentSession 持有，跨動作保留（驅動物件每次動作重建）
+// 批次內的指令在 flush 成功後才記錄；不查 SYST:ERR?，儀器拒絕的指令不會被偵測
+// 重連、連線錯誤、批次送出失敗、閒置後的健康檢查時整份作廢，下次全部重送
+// Load Off / Power Off 作廢該通道，前面板手動修改過的設定在下一次開啟前會重送
+class WrittenStateCache
+{
+public:
+    // channel 以硬體通道為準；沒有通道的儀器用 0
+    bool matches(int channel, const QString& key, const QString& command) const;
+    void record(int channel, const QString& key, const QString& command);
+
+    void invalidateChannel(int channel);
+    void invalidateAll();
+
+private:
+    mutable QMutex m_mutex;
+    QHash<int, QHash<QString, QString>> m_channels;
+};
@@ -7,7 +7,6 @@
 #include "messageservice.h"
 #include "smartstepspinbox.h"
 #include <QSignalBlocker>
-#include <QTimer>
 
 DPO7000TriggerController::DPO7000TriggerController(QWidget* triggerWidget, QObject* parent)
     : AbstractTriggerController(triggerWidget, parent)
@@ -30,11 +29,6 @@ DPO7000TriggerController::DPO7000TriggerController(QWidget* triggerWidget, QObje
     m_lblTrigStatus = triggerWidget->findChild<QLabel*>("triggerStatus");
     m_btnTrigSteady = triggerWidget->findChild<QPushButton*>("btntrig_Steady");
 
-    m_statusTimer = new QTimer(this);
-    connect(m_statusTimer, &QTimer::timeout,
-            this, &DPO7000TriggerController::updateRunStopStatus);
-    m_statusTimer->start(500);
-
     connectSignals();
 }
 
@@ -51,16 +45,18 @@ void DPO7000TriggerController::cleanup()
     // 斷開所有信號
     disconnect();
 
-    // 清理其他資源
-    if (m_statusTimer) {
-        m_statusTimer->stop();
-        delete m_statusTimer;
-        m_statusTimer = nullptr;
-    }
+    // 停止背景狀態監控
+    delete m_statusMonitor;
+    m_statusMonitor = nullptr;
 }
 
 void DPO7000TriggerController::setInstrument(Oscilloscope* instrument)
 {
+    // 換儀器（或放開儀器）前先停掉仍在使用舊儀器的背景工作
+    if (instrument != m_instrument) {
+        cleanupWorkerThread();
+    }
+
     if (auto* dpo7000 = dynamic_cast<DPO7000*>(instrument)) {
         m_instrument = dpo7000;
         updateTriggerStatus();
@@ -71,12 +67,33 @@ void DPO7000TriggerController::setInstrument(Oscilloscope* instrument)
     } else {
         m_instrument = nullptr;
     }
+    restartStatusMonitor();
 }
 
 void DPO7000TriggerController::setInstrument(DPO7000* instrument)
 {
+    if (instrument != m_instrument) {
+        cleanupWorkerThread();
+    }
     m_instrument = instrument;
     updateTriggerStatus();
+    restartStatusMonitor();
+}
+
+// 每台儀器一個監控；更換儀器時先停掉舊的（阻塞到背景查詢結束）
+void DPO7000TriggerController::restartStatusMonitor()
+{
+    delete m_statusMonitor;
+    m_statusMonitor = nullptr;
+    m_lastScopeLevel = qQNaN();
+
+    DPO7000* dpo7000 = getDPO7000Instrument();
+    if (!dpo7000) return;
+
+    m_statusMonitor = new ScopeStatusMonitor(dpo7000, this);
+    connect(m_statusMonitor, &ScopeStatusMonitor::statusChanged,
+            this, &DPO7000TriggerController::onScopeStatusChanged);
+    m_statusMonitor->start();
 }
 
 DPO7000* DPO7000TriggerController::getDPO7000Instrument() const
@@ -180,7 +197,9 @@ void DPO7000TriggerController::onSingleTriggered()
             );
     }
 
-    QTimer::singleShot(200, this, &DPO7000TriggerController::updateRunStopStatus);
+    if (m_statusMonitor) {
+        m_statusMonitor->pollAfterOperation();
+    }
 }
 
 void DPO7000TriggerController::onRunStopTriggered()
@@ -190,7 +209,9 @@ void DPO7000TriggerController::onRunStopTriggered()
         return;
     }
 
-    bool isRunning = m_instrument->isRunning();
+    // 以背景監控最後一次的狀態為準；監控尚未輪詢到（或查詢失敗）時才直接向儀器查詢
+    const ScopeStatus status = m_statusMonitor ? m_statusMonitor->lastStatus() : ScopeStatus();
+    const bool isRunning = status.valid ? status.running : m_instrument->isRunning();
 
     qDebug() << "[DPO7000TriggerController] Current state:"
              << (isRunning ? "Running" : "Stopped");
@@ -203,17 +224,26 @@ void DPO7000TriggerController::onRunStopTriggered()
         m_instrument->run();
     }
 
-    QTimer::singleShot(100, this, &DPO7000TriggerController::updateRunStopStatus);
+    if (m_statusMonitor) {
+        m_statusMonitor->pollNow();
+    }
 }
 
-void DPO7000TriggerController::updateRunStopStatus()
+void DPO7000TriggerController::onScopeStatusChanged(const ScopeStatus& status)
 {
-    if (!m_instrument || !checkInstrumentConnection()) {
+    // 半自動觸發進行中由 worker 更新狀態顯示
+    if (!status.valid || m_worker) {
         return;
     }
 
-    bool isRunning = m_instrument->isRunning();
-    setRunningUI(isRunning);
+    setRunningUI(status.running);
+
+    // 儀器端的觸發電平改變（例如前面板操作）才同步到輸入框，不覆蓋正在編輯的值
+    if (m_spinTrigLevel && status.triggerLevel != m_lastScopeLevel && !m_spinTrigLevel->hasFocus()) {
+        QSignalBlocker blocker(m_spinTrigLevel);
+        m_spinTrigLevel->setValue(status.triggerLevel);
+    }
+    m_lastScopeLevel = status.triggerLevel;
 }
 
 void DPO7000TriggerController::setRunningUI(bool running)
@@ -609,6 +639,11 @@ void DPO7000TriggerController::setupWorkerThread()
                 MessageService::instance().showWarning("Semi-Auto Trigger Error", error);
             });
 
+    // worker 獨佔儀器期間暫停背景狀態監控
+    if (m_statusMonitor) {
+        m_statusMonitor->pause();
+    }
+
     // 啟動 thread
     m_workerThread->start();
 
@@ -625,6 +660,11 @@ void DPO7000TriggerController::setupWorkerThread()
 
 void DPO7000TriggerController::cleanupWorkerThread()
 {
+    // 搜尋在 worker 執行緒的事件處理中執行，quit() 要等它結束；先要求在下一次探測前停止
+    if (m_worker) {
+        m_worker->stopTracking();
+    }
+
     if (m_workerThread) {
         if (m_workerThread->isRunning()) {
             m_workerThread->quit();
@@ -639,6 +679,10 @@ void DPO7000TriggerController::cleanupWorkerThread()
 
     // m_worker 會被 thread 自動刪除（如果設定了父子關係）
     m_worker = nullptr;
+
+    if (m_statusMonitor) {
+        m_statusMonitor->resume();
+    }
 }
 
 void DPO7000TriggerController::lockTriggerControls(bool lock)
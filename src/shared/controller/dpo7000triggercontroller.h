@@ -2,8 +2,9 @@
 #include "AbstractTriggerController.h"
 #include "dpo7000.h"
 #include "autotriggerworker.h"
+#include "scopestatusmonitor.h"
 #include <QThread>
-#include <QTimer>
+#include <QtNumeric>
 
 class QComboBox;
 class QPushButton;
@@ -40,7 +41,7 @@ private slots:
     void onTriggerSteadyToggled(bool on);
     void onTargetLevelChanged();
     void onStepScaleChanged();
-    void updateRunStopStatus();
+    void onScopeStatusChanged(const ScopeStatus& status);
 
 protected:
     void connectSignals() override;
@@ -62,7 +63,10 @@ private:
     SmartStepSpinBox* m_autoTrigTarget = nullptr;
     QLabel* m_lblTrigStatus = nullptr;
     QPushButton* m_btnTrigSteady = nullptr;
-    QTimer* m_statusTimer = nullptr;
+    ScopeStatusMonitor* m_statusMonitor = nullptr;
+    double m_lastScopeLevel = qQNaN();     // 上一次從儀器讀到的觸發電平
+
+    void restartStatusMonitor();
 
     bool checkInstrumentConnection() const;
     void showConnectionError() const;
@@ -1,30 +1,82 @@
 #include "chromaload6310spec.h"
-#include <QMap>
 #include <QString>
-#include <functional>
 #include <optional>
 #include <QDebug>
 
+namespace {
 
-QMap<QString, std::function<ChromaLoadSpec()>> createSpecMap = {
-    { "63101", createChroma63101Spec },
-    { "63102", createChroma63102Spec },
-    { "63103", createChroma63103Spec },
-    { "63105", createChroma63105Spec },
-    { "63106", createChroma63106Spec },
-    { "63108", createChroma63108Spec },
-    { "63112", createChroma63112Spec },
-    };
+// 與 createChroma631xxSpec() 的 currentSpec / voltageSpec / power 一致（Debug 建置會在第一次使用時比對）
+constexpr ChromaModelLimits modelLimits[chromaSubModelCount] = {
+    { "63101", {{  20.0,   4.0, 1.0,  80.0, false }, {  200.0,  40.0, 1.0,  80.0, true }} },
+    { "63102", {{  20.0,   2.0, 1.0,  80.0, false }, {  100.0,  20.0, 1.0,  80.0, true }} },
+    { "63103", {{  30.0,   6.0, 1.0,  80.0, false }, {  300.0,  60.0, 2.5, 500.0, true }} },
+    { "63105", {{  30.0,   1.0, 2.5, 500.0, false }, {  300.0,  10.0, 2.5, 500.0, true }} },
+    { "63106", {{  60.0,  12.0, 1.0,  80.0, false }, {  600.0, 120.0, 1.0,  80.0, true }} },
+    { "63108", {{  60.0,   2.0, 2.5, 500.0, false }, {  600.0,  20.0, 2.5, 500.0, true }} },
+    { "63112", {{ 120.0,  24.0, 1.0,  80.0, false }, { 1200.0, 240.0, 1.0,  80.0, true }} },
+};
+
+// "631xx" 的 xx → ID；-1 表示沒有這個型號
+constexpr int idBySuffix[13] = { -1, 0, 1, 2, -1, 3, 4, -1, 5, -1, -1, -1, 6 };
+
+// 含描述字串的完整規格：只建一次，之後共用
+const QVector<ChromaLoadSpec>& fullSpecs()
+{
+    static const QVector<ChromaLoadSpec> specs = []() {
+        QVector<ChromaLoadSpec> v = {
+            createChroma63101Spec(), createChroma63102Spec(), createChroma63103Spec(),
+            createChroma63105Spec(), createChroma63106Spec(), createChroma63108Spec(),
+            createChroma63112Spec(),
+        };
+#ifndef QT_NO_DEBUG
+        for (int id = 0; id < chromaSubModelCount; ++id) {
+            const ChromaModelLimits& m = modelLimits[id];
+            Q_ASSERT(v[id].model == QLatin1String(m.model));
+            Q_ASSERT(v[id].ranges.size() == 2);
+            for (int r = 0; r < 2; ++r) {
+                Q_ASSERT(v[id].ranges[r].power == m.ranges[r].power);
+                Q_ASSERT(v[id].ranges[r].currentSpec.maxCurrent == m.ranges[r].maxCurrent);
+                Q_ASSERT(v[id].ranges[r].voltageSpec.minVoltage == m.ranges[r].minVoltage);
+                Q_ASSERT(v[id].ranges[r].voltageSpec.maxVoltage == m.ranges[r].maxVoltage);
+            }
+        }
+#endif
+        return v;
+    }();
+    return specs;
+}
 
+} // namespace
+
+int chromaSubModelId(const QString& subModel)
+{
+    if (subModel.size() != 5 || !subModel.startsWith(QLatin1String("631"))) return -1;
+    const int tens = subModel.at(3).digitValue();
+    const int ones = subModel.at(4).digitValue();
+    if (tens < 0 || ones < 0) return -1;
+    const int suffix = tens * 10 + ones;
+    return suffix < 13 ? idBySuffix[suffix] : -1;
+}
+
+const ChromaModelLimits* chromaModelLimits(int subModelId)
+{
+    if (subModelId < 0 || subModelId >= chromaSubModelCount) return nullptr;
+    return &modelLimits[subModelId];
+}
 
 // 回傳 PowerRangeSpec，精確描述是哪一檔（低檔or高檔）
 std::optional<PowerRangeSpec> findPowerRange(const QString& subModel, double currval)
 {
-    if (!createSpecMap.contains(subModel)) return std::nullopt;
-    ChromaLoadSpec spec = createSpecMap[subModel]();
-    for (const auto& range : spec.ranges) {                 //ex:63103 spec.ranges = { range30, range300 };
-        if (currval <= range.currentSpec.maxCurrent) {
-            return range;
+    return findPowerRange(chromaSubModelId(subModel), currval);
+}
+
+std::optional<PowerRangeSpec> findPowerRange(int subModelId, double currval)
+{
+    const ChromaModelLimits* limits = chromaModelLimits(subModelId);
+    if (!limits) return std::nullopt;
+    for (int r = 0; r < 2; ++r) {
+        if (currval <= limits->ranges[r].maxCurrent) {
+            return fullSpecs()[subModelId].ranges[r];
         }
     }
     // 沒找到則回傳空
@@ -505,52 +557,46 @@ QString selectOptimalLoadMode(const QString& subModel,
                               double current,
                               double voltage)
 {
-    double expectedPower = current * voltage;
-
-    if (!createSpecMap.contains(subModel)) {
+    const int id = chromaSubModelId(subModel);
+    if (id < 0) {
         qWarning() << "[Chroma6310Spec] Unknown subModel:" << subModel;
-        return "CCL";  // fallback
+        return QStringLiteral("CCL");  // fallback
     }
+    return selectOptimalLoadMode(id, current, voltage);
+}
 
-    ChromaLoadSpec spec = createSpecMap[subModel]();
-    QString selectedMode = "CCL";
-    bool foundSuitable = false;
-
-    // 從低檔開始檢查,選擇能滿足功率和電流的最小檔位
-    for (const auto& range : spec.ranges) {
-        bool currentOK = (current <= range.currentSpec.maxCurrent * 0.95);  // 5% 餘裕
-        bool powerOK = (expectedPower <= range.power * 0.95);              // 5% 餘裕
-        bool voltageOK = (voltage >= range.voltageSpec.minVoltage &&
-                          voltage <= range.voltageSpec.maxVoltage);
-
-        if (currentOK && powerOK && voltageOK) {
-            foundSuitable = true;
-            // 根據 remark 判斷是 CCL 還是 CCH
-            if (range.currentSpec.remark.contains("CCH")) {
-                selectedMode = "CCH";
-            } else if (range.currentSpec.remark.contains("CCL")) {
-                selectedMode = "CCL";
-            }
+QString selectOptimalLoadMode(int subModelId,
+                              double current,
+                              double voltage)
+{
+    static const QString ccl = QStringLiteral("CCL");
+    static const QString cch = QStringLiteral("CCH");
 
-            qDebug() << "[Chroma6310Spec] Selected mode:" << selectedMode
-                     << "for SubModel:" << subModel
-                     << "I=" << current << "A, V=" << voltage << "V, P=" << expectedPower << "W";
-            break;  // 選擇第一個合適的 (通常是較低檔)
-        }
+    const ChromaModelLimits* limits = chromaModelLimits(subModelId);
+    if (!limits) {
+        qWarning() << "[Chroma6310Spec] Unknown subModel id:" << subModelId;
+        return ccl;  // fallback
     }
 
-    if (!foundSuitable) {
-        qWarning() << "[Chroma6310Spec] ⚠️ WARNING: No suitable range found!";
-        qWarning() << "  SubModel:" << subModel;
-        qWarning() << "  Current:" << current << "A";
-        qWarning() << "  Voltage:" << voltage << "V";
-        qWarning() << "  Expected Power:" << expectedPower << "W";
-        qWarning() << "  ⚠️ May trigger OPP protection!";
-        qWarning() << "  Forcing CCH mode to minimize risk...";
-
-        // 強制選擇高檔以降低風險
-        selectedMode = "CCH";
+    const double expectedPower = current * voltage;
+
+    // 從低檔開始檢查,選擇能滿足功率和電流的最小檔位
+    for (const ChromaRangeLimits& range : limits->ranges) {
+        const bool currentOK = (current <= range.maxCurrent * 0.95);  // 5% 餘裕
+        const bool powerOK = (expectedPower <= range.power * 0.95);   // 5% 餘裕
+        const bool voltageOK = (voltage >= range.minVoltage && voltage <= range.maxVoltage);
+        if (currentOK && powerOK && voltageOK)
+            return range.highRange ? cch : ccl;   // 第一個合適的即為較低檔
     }
 
-    return selectedMode;
+    qWarning() << "[Chroma6310Spec] ⚠️ WARNING: No suitable range found!";
+    qWarning() << "  SubModel:" << limits->model;
+    qWarning() << "  Current:" << current << "A";
+    qWarning() << "  Voltage:" << voltage << "V";
+    qWarning() << "  Expected Power:" << expectedPower << "W";
+    qWarning() << "  ⚠️ May trigger OPP protection!";
+    qWarning() << "  Forcing CCH mode to minimize risk...";
+
+    // 強制選擇高檔以降低風險
+    return cch;
 }
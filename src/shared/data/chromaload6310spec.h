@@ -1,6 +1,7 @@
 #pragma once
 #include <QString>
 #include <QVector>
+#include <optional>
 
 struct AccuracySpec {
     double percentOfReading = 0.0;
@@ -76,8 +77,34 @@ ChromaLoadSpec createChroma63106Spec();
 ChromaLoadSpec createChroma63108Spec();
 ChromaLoadSpec createChroma63112Spec();
 
+// ===== 數值規格表 =====
+// 檔位 / 模式選擇只需要少數幾個數值：編譯期常數表，與上面含描述字串的完整規格分開
+// 每個子型號都是低檔（CCL）+ 高檔（CCH）兩檔，由低到高排列
+struct ChromaRangeLimits {
+    double power;         // W
+    double maxCurrent;    // A
+    double minVoltage;    // V
+    double maxVoltage;    // V
+    bool highRange;       // true = CCH，false = CCL
+};
+
+struct ChromaModelLimits {
+    const char* model;
+    ChromaRangeLimits ranges[2];
+};
+
+constexpr int chromaSubModelCount = 7;
+
+// 子型號字串 → 固定 ID（0 ~ chromaSubModelCount-1），未知型號回傳 -1；不配置記憶體
+int chromaSubModelId(const QString& subModel);
+const ChromaModelLimits* chromaModelLimits(int subModelId);
+
 std::optional<PowerRangeSpec> findPowerRange(const QString& subModel, double currval);
+std::optional<PowerRangeSpec> findPowerRange(int subModelId, double currval);
 
 QString selectOptimalLoadMode(const QString& subModel,
                               double current,
                               double voltage);
+QString selectOptimalLoadMode(int subModelId,
+                              double current,
+                              double voltage);
@@ -0,0 +1,103 @@
+#include "chromaloadbatch.h"
+#include "chromaload6310spec.h"
+#include <cmath>
+#include <limits>
+
+void ChromaLoadBatch::resize(int cells)
+{
+    cells = qMax(0, cells);
+    m_subModelIds.fill(-1, cells);
+    m_currents.fill(std::numeric_limits<double>::quiet_NaN(), cells);
+    m_voltages.fill(0.0, cells);
+
+    for (QVector<double>* v : { &m_lowPower, &m_lowMaxCurrent, &m_lowMinVoltage, &m_lowMaxVoltage,
+                                &m_highPower, &m_highMaxCurrent, &m_highMinVoltage, &m_highMaxVoltage,
+                                &m_powers })
+        v->resize(cells);
+    m_valid.resize(cells);
+    m_ranges.resize(cells);
+    m_oppRisks.resize(cells);
+}
+
+void ChromaLoadBatch::setCell(int cell, int subModelId, double current, double voltage)
+{
+    m_subModelIds[cell] = static_cast<qint8>(chromaModelLimits(subModelId) ? subModelId : -1);
+    m_currents[cell] = current;
+    m_voltages[cell] = voltage;
+}
+
+void ChromaLoadBatch::evaluate()
+{
+    evaluate(0, size());
+}
+
+void ChromaLoadBatch::evaluate(int first, int count)
+{
+    const int begin = qMax(0, first);
+    const int n = qMin(size(), first + count);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    // 1) 依型號展開檔位限制（查表，每個 cell 一次）
+    for (int i = begin; i < n; ++i) {
+        const ChromaModelLimits* m = chromaModelLimits(m_subModelIds[i]);
+        const bool valid = m && !std::isnan(m_currents[i]);
+        m_valid[i] = valid;
+        if (!m) {
+            m_lowPower[i] = m_lowMaxCurrent[i] = m_lowMinVoltage[i] = m_lowMaxVoltage[i] = nan;
+            m_highPower[i] = m_highMaxCurrent[i] = m_highMinVoltage[i] = m_highMaxVoltage[i] = nan;
+            continue;
+        }
+        m_lowPower[i] = m->ranges[0].power;
+        m_lowMaxCurrent[i] = m->ranges[0].maxCurrent;
+        m_lowMinVoltage[i] = m->ranges[0].minVoltage;
+        m_lowMaxVoltage[i] = m->ranges[0].maxVoltage;
+        m_highPower[i] = m->ranges[1].power;
+        m_highMaxCurrent[i] = m->ranges[1].maxCurrent;
+        m_highMinVoltage[i] = m->ranges[1].minVoltage;
+        m_highMaxVoltage[i] = m->ranges[1].maxVoltage;
+    }
+
+    // 2) 連續陣列上的無分支比較（5% 餘裕）；以 & 取代 && 避免短路分支
+    const double* cur = m_currents.constData();
+    const double* vol = m_voltages.constData();
+    const double* lp = m_lowPower.constData();
+    const double* li = m_lowMaxCurrent.constData();
+    const double* lvMin = m_lowMinVoltage.constData();
+    const double* lvMax = m_lowMaxVoltage.constData();
+    const double* hp = m_highPower.constData();
+    const double* hi = m_highMaxCurrent.constData();
+    const double* hvMin = m_highMinVoltage.constData();
+    const double* hvMax = m_highMaxVoltage.constData();
+    const quint8* valid = m_valid.constData();
+    double* power = m_powers.data();
+    qint8* range = m_ranges.data();
+    quint8* risk = m_oppRisks.data();
+
+    for (int i = begin; i < n; ++i) {
+        const double p = cur[i] * vol[i];
+        const int lowOk = (cur[i] <= li[i] * 0.95) & (p <= lp[i] * 0.95)
+                          & (vol[i] >= lvMin[i]) & (vol[i] <= lvMax[i]);
+        const int highOk = (cur[i] <= hi[i] * 0.95) & (p <= hp[i] * 0.95)
+                           & (vol[i] >= hvMin[i]) & (vol[i] <= hvMax[i]);
+        const int none = (lowOk | highOk) ^ 1;
+        const int v = valid[i];
+
+        // lowOk → 0、只有 highOk → 1、都不行 → -1；不適用 → -2
+        const int r = (lowOk ^ 1) * (1 - 2 * none);
+        range[i] = static_cast<qint8>(v ? r : RangeNotApplicable);
+        power[i] = v ? p : nan;
+        risk[i] = static_cast<quint8>(v & none);
+    }
+}
+
+QString ChromaLoadBatch::mode(int cell) const
+{
+    static const QString ccl = QStringLiteral("CCL");
+    static const QString cch = QStringLiteral("CCH");
+    switch (m_ranges[cell]) {
+    case RangeLow:  return ccl;
+    case RangeHigh:
+    case RangeNone: return cch;   // 與 selectOptimalLoadMode 相同：找不到合適檔位時強制高檔
+    default:        return QString();
+    }
+}
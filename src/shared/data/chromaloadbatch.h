@@ -0,0 +1,49 @@
+#pragma once
+#include <QString>
+#include <QVector>
+
+// 整張 Load 表的檔位 / 模式批次判斷
+// 資料以 structure-of-arrays 排列：每個欄位一個連續陣列，cell 以 row-major（row × outputs）排列，
+// 判斷迴圈只有純數值比較、沒有分支，編譯器可自動向量化
+// 判斷規則與 selectOptimalLoadMode() 相同（5% 餘裕、由低檔往高檔找）
+class ChromaLoadBatch
+{
+public:
+    enum Range : qint8 {
+        RangeLow = 0,           // CCL
+        RangeHigh = 1,          // CCH
+        RangeNone = -1,         // 沒有合適檔位（會強制 CCH，可能觸發 OPP）
+        RangeNotApplicable = -2 // 非 Chroma 6310 通道或空白
+    };
+
+    void resize(int cells);
+    int size() const { return m_currents.size(); }
+
+    // subModelId 為 chromaSubModelId()，-1 表示該 cell 不檢查；current 為 NaN 表示空白
+    void setCell(int cell, int subModelId, double current, double voltage);
+
+    void evaluate();
+    // 只重新判斷 [first, first + count)；單一 cell 編輯時不必整張表重算
+    void evaluate(int first, int count);
+
+    Range range(int cell) const { return static_cast<Range>(m_ranges[cell]); }
+    double power(int cell) const { return m_powers[cell]; }
+    bool oppRisk(int cell) const { return m_oppRisks[cell] != 0; }
+    QString mode(int cell) const;   // "CCL" / "CCH"；不適用時為空字串
+
+private:
+    // 輸入
+    QVector<qint8>  m_subModelIds;
+    QVector<double> m_currents;
+    QVector<double> m_voltages;
+
+    // evaluate() 先依型號把檔位限制展開成逐 cell 的陣列，第二段只剩連續的數值運算
+    QVector<double> m_lowPower, m_lowMaxCurrent, m_lowMinVoltage, m_lowMaxVoltage;
+    QVector<double> m_highPower, m_highMaxCurrent, m_highMinVoltage, m_highMaxVoltage;
+    QVector<quint8> m_valid;
+
+    // 輸出
+    QVector<qint8>  m_ranges;
+    QVector<double> m_powers;       // W；不適用時為 NaN
+    QVector<quint8> m_oppRisks;
+};
@@ -0,0 +1,115 @@
+#include "numericcolumn.h"
+
+namespace {
+bool parseCell(const QString& text, double& out)
+{
+    const QString t = text.trimmed();
+    if (t.isEmpty()) return false;
+    bool ok = false;
+    out = t.toDouble(&ok);
+    return ok;
+}
+}
+
+NumericColumn::NumericColumn(int size)
+{
+    resize(size);
+}
+
+NumericColumn NumericColumn::fromStrings(const QVector<QString>& texts)
+{
+    NumericColumn col(texts.size());
+    for (int i = 0; i < texts.size(); ++i)
+        col.setText(i, texts[i]);
+    return col;
+}
+
+QVector<QString> NumericColumn::toStrings() const
+{
+    QVector<QString> texts;
+    texts.reserve(size());
+    for (int i = 0; i < size(); ++i)
+        texts.append(text(i));
+    return texts;
+}
+
+void NumericColumn::resize(int size)
+{
+    size = qMax(0, size);
+    const int oldSize = m_values.size();
+    m_values.resize(size);
+    m_valid.resize((size + 63) / 64);
+
+    for (int i = oldSize; i < size; ++i) {
+        m_values[i] = 0.0;
+        setInvalid(i);
+    }
+    // 截短時清掉最後一個 word 中超出範圍的位元，operator== 才能直接比較 word
+    if (size < oldSize && (size % 64) != 0)
+        m_valid[size / 64] &= (quint64(1) << (size % 64)) - 1;
+}
+
+bool NumericColumn::isValid(int i) const
+{
+    if (i < 0 || i >= size()) return false;
+    return (m_valid[i / 64] >> (i % 64)) & 1;
+}
+
+double NumericColumn::value(int i, double fallback) const
+{
+    return isValid(i) ? m_values[i] : fallback;
+}
+
+bool NumericColumn::tryValue(int i, double& out) const
+{
+    if (!isValid(i)) return false;
+    out = m_values[i];
+    return true;
+}
+
+void NumericColumn::set(int i, double v)
+{
+    if (i < 0 || i >= size()) return;
+    m_values[i] = v;
+    m_valid[i / 64] |= quint64(1) << (i % 64);
+}
+
+void NumericColumn::setInvalid(int i)
+{
+    if (i < 0 || i >= size()) return;
+    m_values[i] = 0.0;
+    m_valid[i / 64] &= ~(quint64(1) << (i % 64));
+}
+
+bool NumericColumn::setText(int i, const QString& text)
+{
+    double v = 0.0;
+    if (parseCell(text, v)) {
+        set(i, v);
+        return true;
+    }
+    setInvalid(i);
+    return false;
+}
+
+QString NumericColumn::text(int i) const
+{
+    return isValid(i) ? format(m_values[i]) : QString();
+}
+
+void NumericColumn::appendText(const QString& text)
+{
+    resize(size() + 1);
+    setText(size() - 1, text);
+}
+
+// 最短且可完整還原的十進位表示（1.5 → "1.5"，0.001 → "0.001"）
+QString NumericColumn::format(double v)
+{
+    return QString::number(v, 'g', 15);
+}
+
+bool NumericColumn::operator==(const NumericColumn& other) const
+{
+    return m_values == other.m_values && m_valid == other.m_valid;
+}
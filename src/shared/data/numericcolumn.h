@@ -0,0 +1,39 @@
+#pragma once
+#include <QString>
+#include <QVector>
+
+// Page2 表格數值欄位的型別化儲存：連續的 double + 有效位元圖（空白 / 無法解析的 cell 為無效）
+// 字串只在 UI 與 XML 邊界轉換一次；QVector 隱式共享，跨信號 / lambda 複製只增加參考計數
+class NumericColumn
+{
+public:
+    NumericColumn() = default;
+    explicit NumericColumn(int size);
+
+    static NumericColumn fromStrings(const QVector<QString>& texts);
+    QVector<QString> toStrings() const;
+
+    int size() const { return m_values.size(); }
+    bool isEmpty() const { return m_values.isEmpty(); }
+    void resize(int size);                      // 新增的 cell 為無效
+
+    bool isValid(int i) const;
+    double value(int i, double fallback = 0.0) const;   // 超出範圍或無效時回傳 fallback
+    bool tryValue(int i, double& out) const;
+    const double* constData() const { return m_values.constData(); }
+
+    void set(int i, double v);
+    void setInvalid(int i);
+    bool setText(int i, const QString& text);   // 回傳是否為有效數值
+    QString text(int i) const;                  // 無效時為空字串
+    void appendText(const QString& text);
+
+    static QString format(double v);
+
+    bool operator==(const NumericColumn& other) const;
+    bool operator!=(const NumericColumn& other) const { return !(*this == other); }
+
+private:
+    QVector<double> m_values;       // 無效 cell 一律存 0，比較時不受舊值影響
+    QVector<quint64> m_valid;       // 每 64 個 cell 一個 word
+};
@@ -3,16 +3,50 @@
 #include <QString>
 #include <QList>
 #include <QMetaType>
+#include "numericcolumn.h"
 
 struct InputRow { QString vin, frequency, phase; };
-struct LoadMetaRow { QVector<QString> modes, names, vo, von, riseSlopeCCH, fallSlopeCCH,riseSlopeCCL,fallSlopeCCL; };
-struct LoadDataRow { QString label; QVector<QString> values; };
-struct DynamicMetaRow { QVector<QString> vo,von, riseSlopeCCDH,fallSlopeCCDH,riseSlopeCCDL,fallSlopeCCDL,t1t2; };
+
+// 數值欄位以 NumericColumn 儲存（解析一次），字串只在 UI / XML 邊界轉換
+struct LoadMetaRow {
+    QVector<QString> modes, names;
+    NumericColumn vo, von, riseSlopeCCH, fallSlopeCCH, riseSlopeCCL, fallSlopeCCL;
+};
+struct LoadDataRow { QString label; NumericColumn values; };
+
+// Dynamic 資料列與 T1~T2 是 "a~b" 區間，維持字串
+struct DynamicMetaRow {
+    NumericColumn vo, von, riseSlopeCCDH, fallSlopeCCDH, riseSlopeCCDL, fallSlopeCCDL;
+    QVector<QString> t1t2;
+};
 struct DynamicDataRow { QString label; QVector<QString> values; };
 
+// 比較用：Page2 同步時只在內容真的變動才發布新的 RecipeSnapshot
+inline bool operator==(const InputRow& a, const InputRow& b)
+{ return a.vin == b.vin && a.frequency == b.frequency && a.phase == b.phase; }
+inline bool operator==(const LoadMetaRow& a, const LoadMetaRow& b)
+{
+    return a.modes == b.modes && a.names == b.names && a.vo == b.vo && a.von == b.von
+           && a.riseSlopeCCH == b.riseSlopeCCH && a.fallSlopeCCH == b.fallSlopeCCH
+           && a.riseSlopeCCL == b.riseSlopeCCL && a.fallSlopeCCL == b.fallSlopeCCL;
+}
+inline bool operator==(const LoadDataRow& a, const LoadDataRow& b)
+{ return a.label == b.label && a.values == b.values; }
+inline bool operator==(const DynamicMetaRow& a, const DynamicMetaRow& b)
+{
+    return a.vo == b.vo && a.von == b.von
+           && a.riseSlopeCCDH == b.riseSlopeCCDH && a.fallSlopeCCDH == b.fallSlopeCCDH
+           && a.riseSlopeCCDL == b.riseSlopeCCDL && a.fallSlopeCCDL == b.fallSlopeCCDL
+           && a.t1t2 == b.t1t2;
+}
+inline bool operator==(const DynamicDataRow& a, const DynamicDataRow& b)
+{ return a.label == b.label && a.values == b.values; }
+
 struct RelayDataRow {
     QString label;
     QVector<QString> values;
 };
+inline bool operator==(const RelayDataRow& a, const RelayDataRow& b)
+{ return a.label == b.label && a.values == b.values; }
 
 enum class LoadKind { Input, Relay, Load, DyLoad };
@@ -0,0 +1,123 @@
+#include "recipesnapshot.h"
+#include <atomic>
+
+namespace {
+// 全域遞增：不同來源（Page2 編輯 / XML 載入）建立的快照版本號也不會重複
+std::atomic<quint64> g_nextVersion{1};
+}
+
+template <typename Row>
+QHash<QString, int> RecipeSnapshot::buildLabelIndex(const QVector<Row>& rows)
+{
+    QHash<QString, int> index;
+    index.reserve(rows.size());
+    for (int i = 0; i < rows.size(); ++i) {
+        if (!index.contains(rows[i].label))
+            index.insert(rows[i].label, i);
+    }
+    return index;
+}
+
+RecipeSnapshotPtr RecipeSnapshot::create(const RecipeTables& tables)
+{
+    std::shared_ptr<RecipeSnapshot> snapshot(new RecipeSnapshot());
+    snapshot->m_tables = tables;
+    snapshot->m_loadRowIndex = buildLabelIndex(tables.loadRows);
+    snapshot->m_dynamicRowIndex = buildLabelIndex(tables.dynamicRows);
+    snapshot->m_version = g_nextVersion.fetch_add(1);
+    for (quint64& v : snapshot->m_tableVersions)
+        v = snapshot->m_version;
+    return snapshot;
+}
+
+RecipeSnapshotPtr RecipeSnapshot::derive(const RecipeSnapshotPtr& self, Table table,
+                                         const std::function<void(RecipeTables&)>& apply,
+                                         bool relabel)
+{
+    if (!self) {
+        RecipeTables tables;
+        apply(tables);
+        return create(tables);
+    }
+
+    std::shared_ptr<RecipeSnapshot> snapshot(new RecipeSnapshot(*self));
+    apply(snapshot->m_tables);
+    // 只改數值時 label 索引不變，沿用（隱式共享）
+    if (relabel && table == LoadRowsTable)
+        snapshot->m_loadRowIndex = buildLabelIndex(snapshot->m_tables.loadRows);
+    else if (relabel && table == DynamicRowsTable)
+        snapshot->m_dynamicRowIndex = buildLabelIndex(snapshot->m_tables.dynamicRows);
+    snapshot->m_version = g_nextVersion.fetch_add(1);
+    snapshot->m_tableVersions[tableSlot(table)] = snapshot->m_version;
+    return snapshot;
+}
+
+RecipeSnapshotPtr RecipeSnapshot::withInputRows(const RecipeSnapshotPtr& self, const QVector<InputRow>& rows)
+{
+    if (self && self->m_tables.inputRows == rows) return self;
+    return derive(self, InputTable, [&](RecipeTables& t) { t.inputRows = rows; });
+}
+
+RecipeSnapshotPtr RecipeSnapshot::withLoadMeta(const RecipeSnapshotPtr& self, const LoadMetaRow& meta)
+{
+    if (self && self->m_tables.loadMeta == meta) return self;
+    return derive(self, LoadMetaTable, [&](RecipeTables& t) { t.loadMeta = meta; });
+}
+
+RecipeSnapshotPtr RecipeSnapshot::withLoadRows(const RecipeSnapshotPtr& self, const QVector<LoadDataRow>& rows)
+{
+    if (self && self->m_tables.loadRows == rows) return self;
+    return derive(self, LoadRowsTable, [&](RecipeTables& t) { t.loadRows = rows; });
+}
+
+RecipeSnapshotPtr RecipeSnapshot::withDynamicMeta(const RecipeSnapshotPtr& self, const DynamicMetaRow& meta)
+{
+    if (self && self->m_tables.dynamicMeta == meta) return self;
+    return derive(self, DynamicMetaTable, [&](RecipeTables& t) { t.dynamicMeta = meta; });
+}
+
+RecipeSnapshotPtr RecipeSnapshot::withDynamicRows(const RecipeSnapshotPtr& self, const QVector<DynamicDataRow>& rows)
+{
+    if (self && self->m_tables.dynamicRows == rows) return self;
+    return derive(self, DynamicRowsTable, [&](RecipeTables& t) { t.dynamicRows = rows; });
+}
+
+RecipeSnapshotPtr RecipeSnapshot::withEdit(const RecipeSnapshotPtr& self, Table table,
+                                           const std::function<void(RecipeTables&)>& apply,
+                                           bool relabel)
+{
+    return derive(self, table, apply, relabel);
+}
+
+int RecipeSnapshot::tableSlot(Table table)
+{
+    switch (table) {
+    case InputTable:       return 0;
+    case LoadMetaTable:    return 1;
+    case LoadRowsTable:    return 2;
+    case DynamicMetaTable: return 3;
+    case DynamicRowsTable: return 4;
+    default:               return 0;
+    }
+}
+
+quint64 RecipeSnapshot::tableVersion(Table table) const
+{
+    return m_tableVersions[tableSlot(table)];
+}
+
+RecipeSnapshot::Tables RecipeSnapshot::changedSince(const RecipeSnapshot* older) const
+{
+    if (!older) return AllTables;
+    if (older == this || older->m_version == m_version) return Tables();
+
+    static constexpr Table order[TableCount] = {
+        InputTable, LoadMetaTable, LoadRowsTable, DynamicMetaTable, DynamicRowsTable
+    };
+    Tables changed;
+    for (int i = 0; i < TableCount; ++i) {
+        if (m_tableVersions[i] != older->m_tableVersions[i])
+            changed |= order[i];
+    }
+    return changed;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <QFlags>
+#include <QHash>
+#include <QMetaType>
+#include <QVector>
+#include <functional>
+#include <memory>
+#include "page2config.h"
+
+class RecipeSnapshot;
+using RecipeSnapshotPtr = std::shared_ptr<const RecipeSnapshot>;
+
+// Page2 配方表格（Input / Load / Dynamic）
+struct RecipeTables {
+    QVector<InputRow> inputRows;
+    LoadMetaRow loadMeta;
+    QVector<LoadDataRow> loadRows;
+    DynamicMetaRow dynamicMeta;
+    QVector<DynamicDataRow> dynamicRows;
+};
+
+// 配方表格的不可變快照：Page2ViewModel 發布，Page3ViewModel / Page3Model / 背景工作共用同一份
+// 修改一律產生新快照，未變動的表格與舊快照共享（QVector 隱式共享），跨執行緒只傳遞指標
+// 每張表各有版本號，使用端以 changedSince() 取得差異，只處理有變動的表格
+class RecipeSnapshot
+{
+public:
+    enum Table {
+        InputTable       = 0x01,
+        LoadMetaTable    = 0x02,
+        LoadRowsTable    = 0x04,
+        DynamicMetaTable = 0x08,
+        DynamicRowsTable = 0x10,
+        AllTables        = 0x1F
+    };
+    Q_DECLARE_FLAGS(Tables, Table)
+
+    static RecipeSnapshotPtr create(const RecipeTables& tables = RecipeTables());
+
+    // 產生新版本；內容相同時直接回傳 self，不增加版本
+    static RecipeSnapshotPtr withInputRows(const RecipeSnapshotPtr& self, const QVector<InputRow>& rows);
+    static RecipeSnapshotPtr withLoadMeta(const RecipeSnapshotPtr& self, const LoadMetaRow& meta);
+    static RecipeSnapshotPtr withLoadRows(const RecipeSnapshotPtr& self, const QVector<LoadDataRow>& rows);
+    static RecipeSnapshotPtr withDynamicMeta(const RecipeSnapshotPtr& self, const DynamicMetaRow& meta);
+    static RecipeSnapshotPtr withDynamicRows(const RecipeSnapshotPtr& self, const QVector<DynamicDataRow>& rows);
+
+    // 單一 cell 編輯：呼叫端已確認內容有變，不做整張表比較，一定產生新版本
+    // relabel = false（只改數值）時沿用 label 索引
+    static RecipeSnapshotPtr withEdit(const RecipeSnapshotPtr& self, Table table,
+                                      const std::function<void(RecipeTables&)>& apply,
+                                      bool relabel = true);
+
+    quint64 version() const { return m_version; }
+    quint64 tableVersion(Table table) const;
+
+    // 與較舊的快照比較，回傳有變動的表格；older 為 nullptr 時視為全部變動
+    Tables changedSince(const RecipeSnapshot* older) const;
+
+    const RecipeTables& tables() const { return m_tables; }
+    const QVector<InputRow>& inputRows() const { return m_tables.inputRows; }
+    const LoadMetaRow& loadMeta() const { return m_tables.loadMeta; }
+    const QVector<LoadDataRow>& loadRows() const { return m_tables.loadRows; }
+    const DynamicMetaRow& dynamicMeta() const { return m_tables.dynamicMeta; }
+    const QVector<DynamicDataRow>& dynamicRows() const { return m_tables.dynamicRows; }
+
+    // label → 行索引（O(1)）；找不到回傳 -1，label 重複時取第一行（與逐行搜尋相同）
+    int loadRowIndex(const QString& label) const { return m_loadRowIndex.value(label, -1); }
+    int dynamicRowIndex(const QString& label) const { return m_dynamicRowIndex.value(label, -1); }
+
+private:
+    static constexpr int TableCount = 5;
+
+    RecipeSnapshot() = default;
+    static RecipeSnapshotPtr derive(const RecipeSnapshotPtr& self, Table table,
+                                    const std::function<void(RecipeTables&)>& apply,
+                                    bool relabel = true);
+    static int tableSlot(Table table);
+    template <typename Row>
+    static QHash<QString, int> buildLabelIndex(const QVector<Row>& rows);
+
+    RecipeTables m_tables;
+    QHash<QString, int> m_loadRowIndex;      // 只在 Load 行變動時重建，其餘情況隱式共享
+    QHash<QString, int> m_dynamicRowIndex;
+    quint64 m_version = 0;
+    quint64 m_tableVersions[TableCount] = {};
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(RecipeSnapshot::Tables)
+Q_DECLARE_METATYPE(RecipeSnapshotPtr)
@@ -10,24 +10,23 @@ QString DeltaA3000::vendor() const { return "Delta"; }
 
 void DeltaA3000::setVoltage(double v) {
     // qDebug() << QString("SOURce:VOLTage:AC %1").arg(v, 0, 'f', 3);
-    sendCommandWithLog(QString("SOURce:VOLTage:AC %1").arg(v, 0, 'f', 3), "[DeltaA3000]");
+    sendIfChanged(0, "VOLT", QString("SOURce:VOLTage:AC %1").arg(v, 0, 'f', 3), "[DeltaA3000]");
 }
 void DeltaA3000::setFrequency(double f) {
      // DeltaA3000 Frequency最低到30
      // qDebug() << QString("SOURce:FREQuency %1").arg(f, 0, 'f', 3);
-    sendCommandWithLog(QString("SOURce:FREQuency %1").arg(f, 0, 'f', 3), "[DeltaA3000]");
+    sendIfChanged(0, "FREQ", QString("SOURce:FREQuency %1").arg(f, 0, 'f', 3), "[DeltaA3000]");
 }
 
 void DeltaA3000::setPhaseOn(double p) {
     // qDebug() << QString("SOURce:PHASe:ON %1").arg(p, 0, 'f', 3);
-    sendCommandWithLog(QString("SOURce:PHASe:ON %1").arg(p, 0, 'f', 3), "[DeltaA3000]");
+    sendIfChanged(0, "PHASE:ON", QString("SOURce:PHASe:ON %1").arg(p, 0, 'f', 3), "[DeltaA3000]");
 }
 
 void DeltaA3000::setPhaseOff(double p) {
      //SOURce:PHASe:OFF value
     // qDebug() << QString("SOURce:PHASe:OFF %1").arg(p, 0, 'f', 3);
-    sendCommandWithLog(QString("SOURce:PHASe:OFF %1"
-                               "").arg(p, 0, 'f', 3), "[DeltaA3000]");
+    sendIfChanged(0, "PHASE:OFF", QString("SOURce:PHASe:OFF %1").arg(p, 0, 'f', 3), "[DeltaA3000]");
 }
 
 void DeltaA3000::setPowerOn() {
@@ -40,6 +39,7 @@ void DeltaA3000::setPowerOff() {
     //OUTPut OFF
     // qDebug() << QString("OUTPut OFF");
     sendCommandWithLog(QString("OUTPut OFF"), "[DeltaA3000]");
+    invalidateWrittenChannel(0);
 }
 
 double DeltaA3000::measureVoltage() {
@@ -10,6 +10,7 @@ Chroma6310::~Chroma6310() { disconnect(); }
 void Chroma6310::setLoadOn() {
     //Load ON
     // qDebug() << QString("Load ON");
+    syncLoadMode();
     sendCommandWithLog(QString("LOAD ON"), "[Chroma6310]");
 }
 
@@ -17,6 +18,7 @@ void Chroma6310::setLoadOff() {
     //Load OFF
     // qDebug() << QString("Load OFF");
     sendCommandWithLog(QString("LOAD OFF"), "[Chroma6310]");
+    invalidateWrittenChannel(realChannel());
 }
 
 void Chroma6310::setChannel(int channel) {
@@ -32,8 +34,22 @@ void Chroma6310::setLoadMode(const QString& mode) {
         qWarning() << "Chroma6310::setLoadMode: Invalid mode:" << mode;
         return;
     }
-    QString cmd = QString("MODE %1").arg(mode);
-    write(cmd);
+    // 只記錄，等到有依模式的設定要寫入（或 Load ON）時才送出
+    m_pendingMode = mode;
+}
+
+void Chroma6310::syncLoadMode()
+{
+    if (m_pendingMode.isEmpty()) return;
+    sendIfChanged(realChannel(), "MODE", QString("MODE %1").arg(m_pendingMode), "[Chroma6310]");
+}
+
+void Chroma6310::writeModeSetting(const QString& key, const QString& cmd, const QString& tag)
+{
+    const QString modeKey = m_pendingMode + "/" + key;
+    if (isWrittenState(realChannel(), modeKey, cmd)) return;
+    syncLoadMode();
+    sendIfChanged(realChannel(), modeKey, cmd, tag);
 }
 
 // 設定 Von，單位V
@@ -41,35 +57,35 @@ void Chroma6310::setVon(double von)
 {
     // 根據 Chroma 指令，單位需自行處理（這裡假設以 V 為主）
     QString cmd = QString("CONF:VOLT:ON %1").arg(von);
-    write(cmd);
+    sendIfChanged(realChannel(), "VON", cmd, "[Chroma6310]");
 }
 
 // 設定靜態模式電流的 Rise Slope，單位A/us（依手冊）
 void Chroma6310::setStaticRiseSlope(double slope)
 {
     QString cmd = QString("CURR:STAT:RISE %1").arg(slope);
-    write(cmd);
+    writeModeSetting("STAT:RISE", cmd, "[Chroma6310]");
 }
 
 // 設定靜態模式電流的 Fall Slope，單位A/us（依手冊）
 void Chroma6310::setStaticFallSlope(double slope)
 {
     QString cmd = QString("CURR:STAT:FALL %1").arg(slope);
-    write(cmd);
+    writeModeSetting("STAT:FALL", cmd, "[Chroma6310]");
 }
 
 // 設定動態模式電流的 Rise Slope，單位A/us（依手冊）
 void Chroma6310::setDynamicRiseSlope(double slope)
 {
     QString cmd = QString("CURR:DYN:RISE %1").arg(slope);
-    write(cmd);
+    writeModeSetting("DYN:RISE", cmd, "[Chroma6310]");
 }
 
 // 設定動態模式電流的 Fall Slope，單位A/us（依手冊）
 void Chroma6310::setDynamicFallSlope(double slope)
 {
     QString cmd = QString("CURR:DYN:FALL %1").arg(slope);
-    write(cmd);
+    writeModeSetting("DYN:FALL", cmd, "[Chroma6310]");
 }
 
 void Chroma6310::setStaticCurrent(const StaticCurrentParam& param)
@@ -80,9 +96,11 @@ void Chroma6310::setStaticCurrent(const StaticCurrentParam& param)
     double voltage = param.expectedVoltage;
 
     // 選擇模式
-    QString modeStr = selectOptimalLoadMode(m_model, current, voltage);
+    QString modeStr = selectOptimalLoadMode(m_subModelId, current, voltage);
 
+    // 最後的模式就是負載實際運作的模式，一定要同步
     setLoadMode(modeStr);
+    syncLoadMode();
 
     // 設定電流
     int segs = getNumSegments();
@@ -95,7 +113,7 @@ void Chroma6310::setStaticCurrent(const StaticCurrentParam& param)
         double value = param.levels[i];
         QString segName = (i == 0) ? "L1" : "L2";
         QString cmd = QString("CURR:STAT:%1 %2").arg(segName).arg(value);
-        sendCommandWithLog(cmd, "[Chroma6310] setStaticCurrent:" + segName);
+        writeModeSetting("STAT:" + segName, cmd, "[Chroma6310] setStaticCurrent:" + segName);
     }
 
     if (param.levels.size() > segs) {
@@ -111,12 +129,13 @@ void Chroma6310::setDynamicCurrent(const DynamicCurrentParam& param)
     double voltage = param.expectedVoltage;
 
     // 選擇動態模式
-    QString baseMode = selectOptimalLoadMode(m_model, maxCurrent, voltage);
+    QString baseMode = selectOptimalLoadMode(m_subModelId, maxCurrent, voltage);
 
     // 轉換為動態模式
     QString modeStr = (baseMode == "CCH") ? "CCDH" : "CCDL";
 
     setLoadMode(modeStr);
+    syncLoadMode();
 
     // 設定動態電流級別 (L1, L2)
     int segs = getNumSegments();
@@ -128,18 +147,18 @@ void Chroma6310::setDynamicCurrent(const DynamicCurrentParam& param)
         double value = param.levels[i];
         QString segName = (i == 0) ? "L1" : "L2";
         QString cmd = QString("CURR:DYN:%1 %2").arg(segName).arg(value);
-        sendCommandWithLog(cmd, "[Chroma6310] setDynamicCurrent:" + segName);
+        writeModeSetting("DYN:" + segName, cmd, "[Chroma6310] setDynamicCurrent:" + segName);
     }
 
     // 設定動態時間參數 (T1, T2)
     if (!param.timings.isEmpty()) {
         if (param.timings.size() >= 1) {
             QString cmd = QString("CURR:DYN:T1 %1").arg(param.timings[0]);
-            sendCommandWithLog(cmd, "[Chroma6310] setDynamicCurrent:T1");
+            writeModeSetting("DYN:T1", cmd, "[Chroma6310] setDynamicCurrent:T1");
         }
         if (param.timings.size() >= 2) {
             QString cmd = QString("CURR:DYN:T2 %1").arg(param.timings[1]);
-            sendCommandWithLog(cmd, "[Chroma6310] setDynamicCurrent:T2");
+            writeModeSetting("DYN:T2", cmd, "[Chroma6310] setDynamicCurrent:T2");
         }
     }
 
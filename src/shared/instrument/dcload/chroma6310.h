@@ -1,5 +1,6 @@
 #pragma once
 #include "dcload.h"
+#include "chromaload6310spec.h"
 #include <QVector>
 #include <QList>
 
@@ -38,7 +39,7 @@ class Chroma6310 : public DCLoad
 {
 public:
     Chroma6310(const QString& subModel,ICommunication* comm = nullptr)
-        : DCLoad(comm), m_model(subModel){};
+        : DCLoad(comm), m_model(subModel), m_subModelId(chromaSubModelId(subModel)){};
 
     ~Chroma6310() override;
 
@@ -49,6 +50,9 @@ public:
 
     int getNumSegments() const override { return 2; }  // Chroma 6310 支援 L1/L2
 
+    // 6310 mainframe 接受分號串接的複合指令；取保守長度避免超過輸入緩衝
+    int maxBatchMessageLength() const override { return 512; }
+
     void setChannel(int channel) override;
     void setLoadMode(const QString& mode) override;
     void setVon(double von) override;
@@ -66,6 +70,15 @@ public:
     QString subModel() const { return m_model; }
 
     QString m_model;
+    int m_subModelId = -1;   // chromaSubModelId(m_model)，選檔時直接查表
+
+private:
+    // MODE 延後送出：電流 / 斜率 / 時間依模式各自保存，只有真的要寫入這些值時才切換模式
+    void syncLoadMode();
+    // 依目前模式送出（與上次確認值相同則略過，也不會為此切換模式）
+    void writeModeSetting(const QString& key, const QString& cmd, const QString& tag);
+
+    QString m_pendingMode;
 
 
     // // --- Common----------------------------------------
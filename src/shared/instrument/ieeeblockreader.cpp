@@ -0,0 +1,315 @@
+#include "ieeeblockreader.h"
+#include <QDebug>
+#include <cstring>
+#include <limits>
+
+IeeeBlockReader::IeeeBlockReader(ICommunication* comm)
+    : m_comm(comm) {}
+
+bool IeeeBlockReader::fail(const QString& msg)
+{
+    m_error = msg;
+    qWarning() << "[IeeeBlockReader]" << m_error;
+    return false;
+}
+
+bool IeeeBlockReader::readHeader(qint64& payloadLen)
+{
+    payloadLen = 0;
+    if (!m_comm) return fail("No communication object");
+
+    // 1) 一次讀兩個 byte：回應直接以 #<d> 開始時 header 只需兩次讀取（#<d>、<len>）
+    //    '#' 之前的內容（HEADer ON 的指令名稱、複合查詢的前段回應）保留在 prefix()，
+    //    長度未知只能逐 byte 往後找，否則會讀進 payload
+    char head[2];
+    m_prefix.clear();
+    int got = m_comm->readInto(head, 2);
+    if (got == 1 && m_comm->readInto(head + 1, 1) == 1) got = 2;   // 分段到達
+    if (got != 2)
+        return fail("Read failed (block header): " + m_comm->lastError());
+    while (head[0] != '#') {
+        if (m_prefix.size() >= m_maxPrefix)
+            return fail("Unexpected response (not a binary block)");
+        m_prefix.append(head[0]);
+        head[0] = head[1];
+        if (m_comm->readInto(&head[1], 1) != 1)
+            return fail("Read failed (block header): " + m_comm->lastError());
+    }
+
+    // 2) <d>：長度位數
+    const char c = head[1];
+    if (c < '0' || c > '9')
+        return fail("Malformed binary header: ndig not a digit");
+
+    const int ndig = c - '0';
+    if (ndig == 0) {
+        // 不定長度：只能以 END 判斷結束；串流通訊上 payload 裡的 LF 與結尾無法區分
+        if (!m_comm->reportsMessageEnd())
+            return fail("Indefinite-length block (#0) is not supported on this transport");
+        payloadLen = -1;
+        m_error.clear();
+        return true;
+    }
+
+    // 3) <len>：一次讀齊 ndig 位數並直接累加
+    char digits[9];
+    if (!readExact(digits, ndig))
+        return fail("Read failed while completing length digits");
+
+    qint64 len = 0;
+    for (int i = 0; i < ndig; ++i) {
+        if (digits[i] < '0' || digits[i] > '9')
+            return fail("Malformed binary header: invalid length");
+        len = len * 10 + (digits[i] - '0');
+    }
+
+    payloadLen = len;
+    m_error.clear();
+    return true;
+}
+
+void IeeeBlockReader::consumeTerminator()
+{
+    // 定長區塊之後還有回應結束字元（LF + END），讀掉以免留給下一個查詢
+    if (!m_consumeTerminator) return;
+    char c = 0;
+    if (m_comm->readInto(&c, 1) == 1 && c != '\n')
+        qWarning() << "[IeeeBlockReader] Unexpected byte after block:" << int(c);
+}
+
+bool IeeeBlockReader::readTerminator()
+{
+    char c = 0;
+    if (m_comm->readInto(&c, 1) != 1)
+        return fail("Read failed while receiving block terminator: " + m_comm->lastError());
+    if (c != '\n')
+        qWarning() << "[IeeeBlockReader] Unexpected byte after block:" << int(c);
+    return true;
+}
+
+bool IeeeBlockReader::skipPayload(qint64 len)
+{
+    return discard(len) && readTerminator();
+}
+
+bool IeeeBlockReader::readExact(char* dst, qint64 len)
+{
+    qint64 done = 0;
+    while (done < len) {
+        int want = static_cast<int>(qMin<qint64>(len - done, chunkSize));
+        int n = m_comm->readInto(dst + done, want);
+        if (n <= 0) {
+            return fail(QString("Read failed while receiving payload, remain=%1 %2")
+                            .arg(len - done).arg(m_comm->lastError()));
+        }
+        done += n;
+    }
+    return true;
+}
+
+bool IeeeBlockReader::discard(qint64 len)
+{
+    QByteArray sink(static_cast<int>(qMin<qint64>(len, chunkSize)), Qt::Uninitialized);
+    while (len > 0) {
+        int want = static_cast<int>(qMin<qint64>(len, sink.size()));
+        if (!readExact(sink.data(), want)) return false;
+        len -= want;
+    }
+    return true;
+}
+
+bool IeeeBlockReader::readIndefinite(QByteArray& out)
+{
+    // #0：長度未知，倍增配置並直接讀進 out 的尾端，直到通訊層回報訊息結束（END）
+    // readHeader 已確認通訊會回報訊息結尾
+    qint64 size = 0;
+    out.resize(chunkSize);
+    for (;;) {
+        if (out.size() - size < chunkSize)
+            out.resize(static_cast<int>(qMax<qint64>(out.size() * 2, size + chunkSize)));
+
+        int n = m_comm->readInto(out.data() + size, chunkSize);
+        if (n <= 0) {
+            out.clear();
+            return fail("Read failed while receiving indefinite-length block: " + m_comm->lastError());
+        }
+        size += n;
+        if (m_comm->lastReadEndedMessage()) break;
+    }
+
+    // 去掉與 END 一起送出的 LF
+    if (size > 0 && out[static_cast<int>(size - 1)] == '\n') --size;
+    out.resize(static_cast<int>(size));
+    m_error.clear();
+    return true;
+}
+
+bool IeeeBlockReader::readIndefinite(char* dst, qint64 capacity, qint64& written)
+{
+    // #0 直接讀進呼叫端緩衝區；結尾 LF 與 END 一起送出，所以最多多收 1 byte
+    written = 0;
+    qint64 size = 0;
+    bool ended = false;
+    while (size < capacity) {
+        const int want = static_cast<int>(qMin<qint64>(capacity - size, chunkSize));
+        const int n = m_comm->readInto(dst + size, want);
+        if (n <= 0)
+            return fail("Read failed while receiving indefinite-length block: " + m_comm->lastError());
+        size += n;
+        if (m_comm->lastReadEndedMessage()) {
+            ended = true;
+            break;
+        }
+    }
+
+    if (!ended) {
+        // 緩衝區已滿：剩下的只可能是結尾 LF，否則讀到 END 為止丟棄，保持通訊同步
+        char c = 0;
+        if (m_comm->readInto(&c, 1) != 1)
+            return fail("Read failed while receiving indefinite-length block: " + m_comm->lastError());
+        if (!m_comm->lastReadEndedMessage() || c != '\n') {
+            char sink[4096];
+            while (!m_comm->lastReadEndedMessage()) {
+                if (m_comm->readInto(sink, sizeof(sink)) <= 0)
+                    return fail("Read failed while discarding indefinite-length block: " + m_comm->lastError());
+            }
+            return fail(QString("Buffer too small: indefinite-length block exceeds capacity %1").arg(capacity));
+        }
+    } else if (size > 0 && dst[size - 1] == '\n') {
+        --size;
+    }
+
+    written = size;
+    m_error.clear();
+    return true;
+}
+
+bool IeeeBlockReader::readBlock(QByteArray& out)
+{
+    out.clear();
+
+    qint64 len = 0;
+    if (!readHeader(len)) return false;
+    if (len < 0) return readIndefinite(out);
+    if (len > std::numeric_limits<int>::max())
+        return fail(QString("Binary block too large for QByteArray: %1 bytes").arg(len));
+
+    out.resize(static_cast<int>(len));
+    if (!readExact(out.data(), len)) {
+        out.clear();
+        return false;
+    }
+    consumeTerminator();
+    m_error.clear();
+    return true;
+}
+
+bool IeeeBlockReader::readBlock(char* dst, qint64 capacity, qint64& written)
+{
+    written = 0;
+
+    qint64 len = 0;
+    if (!readHeader(len)) return false;
+
+    if (len < 0) return readIndefinite(dst, capacity, written);
+
+    if (len > capacity) {
+        if (discard(len)) consumeTerminator();
+        return fail(QString("Buffer too small: need %1, capacity %2").arg(len).arg(capacity));
+    }
+
+    if (!readExact(dst, len)) return false;
+    consumeTerminator();
+    written = len;
+    m_error.clear();
+    return true;
+}
+
+bool IeeeBlockReader::readBlockStreaming(const ChunkSink& sink,
+                                         const ProgressFn& progress,
+                                         const std::atomic<bool>* cancel,
+                                         int bufferSize)
+{
+    m_canceled = false;
+
+    qint64 len = 0;
+    if (!readHeader(len)) return false;
+
+    QByteArray buf(qMax(bufferSize, 1024), Qt::Uninitialized);
+    if (len < 0)
+        return streamIndefinite(buf.data(), buf.size(), sink, progress, cancel);
+
+    qint64 received = 0;
+    bool delivering = true;
+    QString abortReason;
+    if (progress) progress(0, len);
+
+    while (received < len) {
+        if (delivering && cancel && cancel->load()) {
+            m_canceled = true;
+            delivering = false;
+            abortReason = "Canceled";
+        }
+
+        int want = static_cast<int>(qMin<qint64>(len - received, buf.size()));
+        int n = m_comm->readInto(buf.data(), want);
+        if (n <= 0) {
+            return fail(QString("Read failed while receiving payload, remain=%1 %2")
+                            .arg(len - received).arg(m_comm->lastError()));
+        }
+        received += n;
+
+        if (!delivering) continue;   // 已中止：只把剩餘資料讀掉
+        if (!sink(buf.constData(), n)) {
+            delivering = false;
+            abortReason = "Sink rejected data";
+            continue;
+        }
+        if (progress) progress(received, len);
+    }
+
+    consumeTerminator();
+    if (!abortReason.isEmpty()) return fail(abortReason);
+    m_error.clear();
+    return true;
+}
+
+bool IeeeBlockReader::streamIndefinite(char* buf, int bufferSize, const ChunkSink& sink,
+                                       const ProgressFn& progress, const std::atomic<bool>* cancel)
+{
+    // 讀到訊息結束（END）為止；只有最後一段結尾的 LF 不屬於資料
+    bool delivering = true;
+    QString abortReason;
+    qint64 received = 0;
+    if (progress) progress(0, -1);
+
+    for (;;) {
+        if (delivering && cancel && cancel->load()) {
+            m_canceled = true;
+            delivering = false;
+            abortReason = "Canceled";
+        }
+
+        int n = m_comm->readInto(buf, bufferSize);
+        if (n <= 0)
+            return fail("Read failed while receiving indefinite-length block: " + m_comm->lastError());
+
+        const bool last = m_comm->lastReadEndedMessage();
+        const int deliver = (last && buf[n - 1] == '\n') ? n - 1 : n;
+
+        if (delivering && deliver > 0) {
+            if (!sink(buf, deliver)) {
+                delivering = false;
+                abortReason = "Sink rejected data";
+            } else {
+                received += deliver;
+                if (progress) progress(received, -1);
+            }
+        }
+        if (last) break;
+    }
+
+    if (!abortReason.isEmpty()) return fail(abortReason);
+    m_error.clear();
+    return true;
+}
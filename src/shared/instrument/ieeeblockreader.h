@@ -0,0 +1,77 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include "icommunication.h"
+#include <atomic>
+#include <functional>
+
+// IEEE-488.2 任意區塊回應讀取器
+//   定長：#<d><len 共 d 位><payload>   不定長：#0<payload><LF + END>（只支援會回報 END 的通訊，如 GPIB）
+// header 只解析一次，payload 以 readInto() 直接讀進目的記憶體（預先配置精確大小），
+// 不經過中間 chunk 緩衝，也不會因 append 反覆重新配置
+class IeeeBlockReader
+{
+public:
+    // 串流模式：每收到一段就交給 sink（回傳 false 表示寫入失敗、中止）
+    using ChunkSink = std::function<bool(const char* data, int len)>;
+    // total 為 -1 表示 #0 不定長度
+    using ProgressFn = std::function<void(qint64 received, qint64 total)>;
+
+    explicit IeeeBlockReader(ICommunication* comm);
+
+    // 讀取並解析 header；定長區塊回傳 payload 長度，#0 不定長度回傳 -1
+    bool readHeader(qint64& payloadLen);
+
+    // 剛好讀滿 len bytes 到 dst
+    bool readExact(char* dst, qint64 len);
+
+    // 完整讀取一個區塊（含 header）
+    bool readBlock(QByteArray& out);
+
+    // 讀入呼叫端提供的緩衝區；容量不足時失敗，但仍把 payload 讀掉以保持通訊同步
+    bool readBlock(char* dst, qint64 capacity, qint64& written);
+
+    // 以固定大小緩衝區邊收邊交給 sink，記憶體用量與區塊長度無關；
+    // cancel 被設定時停止交付，剩餘 payload 讀掉丟棄（保持通訊同步，連線可繼續使用）
+    bool readBlockStreaming(const ChunkSink& sink,
+                            const ProgressFn& progress = ProgressFn(),
+                            const std::atomic<bool>* cancel = nullptr,
+                            int bufferSize = defaultStreamBuffer);
+
+    bool wasCanceled() const { return m_canceled; }
+
+    // '#' 之前允許的前置內容長度與其內容（複合查詢時為前面各查詢的回應）
+    void setMaxPrefix(int bytes) { m_maxPrefix = bytes; }
+    QByteArray prefix() const { return m_prefix; }
+
+    // 定長區塊讀完後是否讀掉結尾的 LF（預設是；區塊後還有其他回應時關閉）
+    void setConsumeTerminator(bool on) { m_consumeTerminator = on; }
+
+    QString lastError() const { return m_error; }
+
+    // 自行以 readHeader / readExact 讀取定長區塊時使用
+    // 讀掉結尾的 LF，讀取失敗回傳 false
+    bool readTerminator();
+    // 拒收的區塊：payload 與結尾 LF 讀掉丟棄，保持通訊同步
+    bool skipPayload(qint64 len);
+
+private:
+    bool readIndefinite(QByteArray& out);
+    bool readIndefinite(char* dst, qint64 capacity, qint64& written);
+    bool streamIndefinite(char* buf, int bufferSize, const ChunkSink& sink,
+                          const ProgressFn& progress, const std::atomic<bool>* cancel);
+    bool discard(qint64 len);
+    void consumeTerminator();
+    bool fail(const QString& msg);
+
+    ICommunication* m_comm = nullptr;
+    QString m_error;
+    bool m_canceled = false;
+    bool m_consumeTerminator = true;
+    int m_maxPrefix = defaultMaxPrefix;
+    QByteArray m_prefix;
+
+    static const int chunkSize = 1 << 20;        // 單次 readInto 上限，避免單次傳輸超過儀器逾時
+    static const int defaultMaxPrefix = 64;      // HEADer ON 時 '#' 前可能帶有指令名稱
+    static const int defaultStreamBuffer = 256 * 1024;
+};
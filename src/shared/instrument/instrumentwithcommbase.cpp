@@ -1,8 +1,11 @@
 #include "instrumentwithcommbase.h"
+#include "instrumentmetrics.h"
+#include "writtenstatecache.h"
 #include <QDebug>
 
 void InstrumentWithCommBase::connect()
 {
+    IoTransaction transaction(this);
     if (m_comm && m_comm->open()) {
         m_connected = true;
         m_lastError.clear();
@@ -17,6 +20,7 @@ void InstrumentWithCommBase::connect()
 
 void InstrumentWithCommBase::disconnect()
 {
+    IoTransaction transaction(this);
     if (m_comm) {
         m_comm->close();
         // 假如 close 會有失敗（可由 m_comm->lastError() 判斷），可記錄
@@ -44,6 +48,25 @@ void InstrumentWithCommBase::setAddress(const QString& addr)
     m_address = addr;
 }
 
+EndpointMetrics* InstrumentWithCommBase::metrics() const
+{
+    return m_comm ? m_comm->metrics() : nullptr;
+}
+
+void InstrumentWithCommBase::recordQueryLatency(const QByteArray& cmd)
+{
+    if (EndpointMetrics* endpoint = metrics())
+        endpoint->addQuery(cmd, m_queryClock.nsecsElapsed());
+}
+
+QString InstrumentWithCommBase::lastError() const
+{
+    m_ioMutex.lock();
+    const QString error = m_lastError;
+    m_ioMutex.unlock();
+    return error;
+}
+
 QString InstrumentWithCommBase::getaddress() const
 {
     return m_address;
@@ -51,6 +74,37 @@ QString InstrumentWithCommBase::getaddress() const
 
 void InstrumentWithCommBase::setCommunication(ICommunication* comm){
     m_comm = comm;
+    m_responseReader.setCommunication(comm);
+}
+
+void InstrumentWithCommBase::beginBatch()
+{
+    if (m_batch && m_batch != m_ownBatch.get()) return;  // 已 attach 外部 batch
+    m_ownBatch.reset(new ScpiCommandBatch(m_comm, maxBatchMessageLength()));
+    m_batch = m_ownBatch.get();
+}
+
+bool InstrumentWithCommBase::commitBatch(bool waitForOpc)
+{
+    IoTransaction transaction(this);
+    if (!m_batch) return true;
+    bool ok = m_batch->flush(waitForOpc);
+    if (!ok) m_lastError = m_batch->lastError();
+    if (m_batch == m_ownBatch.get()) {
+        m_batch = nullptr;
+        m_ownBatch.reset();
+    }
+    return ok;
+}
+
+bool InstrumentWithCommBase::flushPendingBatch()
+{
+    if (!m_batch || m_batch->isEmpty()) return true;
+    if (!m_batch->flush()) {
+        m_lastError = m_batch->lastError();
+        return false;
+    }
+    return true;
 }
 
 int InstrumentWithCommBase::write(const QString& s) {
@@ -58,14 +112,27 @@ int InstrumentWithCommBase::write(const QString& s) {
 }
 
 int InstrumentWithCommBase::write(const QByteArray& data) {
+    IoTransaction transaction(this);
+    if (EndpointMetrics* endpoint = metrics())
+        endpoint->addCommand(data);
+    // 設定指令進 batch；查詢指令需立即送出（之前累積的先 flush 以保持順序）
+    if (m_batch && !data.contains('?')) {
+        m_batch->append(data);
+        return data.size();
+    }
+    if (!flushPendingBatch()) return -1;
+
     int ret = m_comm ? m_comm->write(data) : -1;
     if (ret < 0 && m_comm) {
         m_lastError = QString("Comm write failed: ") + m_comm->lastError();
+        invalidateWrittenState();
     }
     return ret;
 }
 
 int InstrumentWithCommBase::read(QByteArray& data, int maxLen) {
+    IoTransaction transaction(this);
+    if (!flushPendingBatch()) return -1;
     int ret = m_comm ? m_comm->read(data, maxLen) : -1;
     if (ret < 0 && m_comm) {
         m_lastError = QString("Comm read failed: ") + m_comm->lastError();
@@ -73,23 +140,50 @@ int InstrumentWithCommBase::read(QByteArray& data, int maxLen) {
     return ret;
 }
 
-bool InstrumentWithCommBase::queryDouble(const QString& cmd, double& value) {
-    if (write(cmd) < 0) {
+bool InstrumentWithCommBase::readResponse(QByteArray& data) {
+    IoTransaction transaction(this);
+    if (!flushPendingBatch()) return false;
+    if (!m_responseReader.readResponse(data)) {
+        m_lastError = QString("Comm read failed: ") + m_responseReader.lastError();
+        invalidateWrittenState();   // 回應遺失後無法確定之前的設定是否生效
+        return false;
+    }
+    return true;
+}
+
+void InstrumentWithCommBase::setResponseFraming(ScpiResponseReader::Framing framing, int fixedLength,
+                                                char terminator) {
+    m_responseReader.setFraming(framing, fixedLength);
+    m_responseReader.setTerminator(terminator);
+}
+
+// 呼叫端須持有 IoTransaction，直到解析完 m_response
+bool InstrumentWithCommBase::queryResponse(const QString& cmd) {
+    // 前一個查詢逾時後才到的回應不能當成這次的結果
+    m_responseReader.discardPending();
+    const QByteArray bytes = cmd.toUtf8();
+    m_queryClock.start();
+    if (write(bytes) < 0) {
         m_lastError = QString("Write failed: %1").arg(cmd);
         qWarning() << "[Instrument]" << m_lastError;
         return false;
     }
-    QByteArray resp;
-    int n = read(resp, 64);
-    if (n <= 0) {
-        m_lastError = QString("Read failed for: %1").arg(cmd);
+    if (!readResponse(m_response)) {
+        m_lastError = QString("Read failed for: %1 (%2)").arg(cmd, m_responseReader.lastError());
         qWarning() << "[Instrument]" << m_lastError;
         return false;
     }
+    recordQueryLatency(bytes);
+    return true;
+}
+
+bool InstrumentWithCommBase::queryDouble(const QString& cmd, double& value) {
+    IoTransaction transaction(this);
+    if (!queryResponse(cmd)) return false;
     bool ok = false;
-    value = QString(resp).toDouble(&ok);
+    value = m_response.trimmed().toDouble(&ok);
     if (!ok) {
-        m_lastError = QString("Parse failed (not a number): '%1' from %2").arg(QString(resp)).arg(cmd);
+        m_lastError = QString("Parse failed (not a number): '%1' from %2").arg(QString(m_response)).arg(cmd);
         qWarning() << "[Instrument]" << m_lastError;
         return false;
     }
@@ -99,22 +193,12 @@ bool InstrumentWithCommBase::queryDouble(const QString& cmd, double& value) {
 
 
 bool InstrumentWithCommBase::queryInt(const QString& cmd, int& value) {
-    if (write(cmd) < 0) {
-        m_lastError = QString("Write failed: %1").arg(cmd);
-        qWarning() << "[Instrument]" << m_lastError;
-        return false;
-    }
-    QByteArray resp;
-    int n = read(resp, 64);
-    if (n <= 0) {
-        m_lastError = QString("Read failed for: %1").arg(cmd);
-        qWarning() << "[Instrument]" << m_lastError;
-        return false;
-    }
+    IoTransaction transaction(this);
+    if (!queryResponse(cmd)) return false;
     bool ok = false;
-    value = QString(resp).simplified().toInt(&ok); // simplified() 避免亂碼空白
+    value = m_response.simplified().toInt(&ok); // simplified() 避免亂碼空白
     if (!ok) {
-        m_lastError = QString("Parse failed (not an int): '%1' from %2").arg(QString(resp)).arg(cmd);
+        m_lastError = QString("Parse failed (not an int): '%1' from %2").arg(QString(m_response)).arg(cmd);
         qWarning() << "[Instrument]" << m_lastError;
         return false;
     }
@@ -123,129 +207,84 @@ bool InstrumentWithCommBase::queryInt(const QString& cmd, int& value) {
 }
 
 bool InstrumentWithCommBase::queryString(const QString& cmd, QString& result) {
-    if (write(cmd) < 0) {
+    IoTransaction transaction(this);
+    if (!queryResponse(cmd)) return false;
+    result = QString(m_response).trimmed();
+    m_lastError.clear();
+    return true;
+}
+
+// 呼叫端須持有 IoTransaction，直到區塊讀完
+bool InstrumentWithCommBase::sendBinaryQuery(const QString& cmd)
+{
+    m_responseReader.discardPending();
+    m_queryClock.start();
+    // 二進位查詢（如 FILESystem:READFile）不一定帶 '?'，要確保已實際送出
+    if (write(cmd) < 0 || !flushPendingBatch()) {
         m_lastError = QString("Write failed: %1").arg(cmd);
         qWarning() << "[Instrument]" << m_lastError;
         return false;
     }
-    QByteArray resp;
-    int n = read(resp, 256); // 視儀器回應字串長度調整
-    if (n <= 0) {
-        m_lastError = QString("Read failed for: %1").arg(cmd);
-        qWarning() << "[Instrument]" << m_lastError;
+    if (!m_comm) {
+        m_lastError = "No communication object";
         return false;
     }
-    result = QString(resp).trimmed();
-    m_lastError.clear();
     return true;
 }
 
 bool InstrumentWithCommBase::queryBinary(const QString& cmd, QByteArray& out, int maxHeaderBytes)
 {
+    Q_UNUSED(maxHeaderBytes);   // header 改為精確讀取，保留參數維持相容
     out.clear();
+    IoTransaction transaction(this);
+    if (!sendBinaryQuery(cmd)) return false;
 
-    // 1) 送出指令
-    if (write(cmd) < 0) {
-        m_lastError = QString("Write failed: %1").arg(cmd);
-        qWarning() << "[Instrument]" << m_lastError;
-        return false;
-    }
-
-    // 2) 先讀一小段把 header 讀齊
-    QByteArray header;
-    QByteArray chunk;
-    // 先讀 maxHeaderBytes（足夠容納 '#', <d>, 以及 <len> 的字元）
-    int n = read(chunk, maxHeaderBytes);
-    if (n <= 0) {
-        m_lastError = QString("Read failed (header) for: %1").arg(cmd);
-        qWarning() << "[Instrument]" << m_lastError;
-        return false;
-    }
-    header.append(chunk);
-
-    // 3) 基本檢查：必須是 binary block
-    if (header.isEmpty() || header[0] != '#') {
-        // 有些儀器可能直接回純文字；若你想嚴格限制，就當作錯誤
-        m_lastError = QString("Unexpected response (not a binary block) for: %1").arg(cmd);
-        qWarning() << "[Instrument]" << m_lastError << " resp head =" << header.left(16);
+    IeeeBlockReader reader(m_comm);
+    if (!reader.readBlock(out)) {
+        m_lastError = QString("%1 for: %2").arg(reader.lastError(), cmd);
         return false;
     }
+    recordQueryLatency(cmd.toUtf8());
+    m_lastError.clear();
+    return true;
+}
 
-    if (header.size() < 2) {
-        // header 還不完整，再讀到至少 2 bytes
-        int need = 2 - header.size();
-        if (need > 0) {
-            int m = read(chunk, need);
-            if (m <= 0) {
-                m_lastError = "Read failed while completing binary header (ndig)";
-                qWarning() << "[Instrument]" << m_lastError;
-                return false;
-            }
-            header.append(chunk.left(m));
-        }
-    }
+bool InstrumentWithCommBase::queryBinary(const QString& cmd, char* dst, qint64 capacity, qint64& written)
+{
+    written = 0;
+    IoTransaction transaction(this);
+    if (!sendBinaryQuery(cmd)) return false;
 
-    // 4) 解析 <d>（長度位數）
-    char c = header[1];
-    if (c < '0' || c > '9') {
-        m_lastError = "Malformed binary header: ndig not a digit";
-        qWarning() << "[Instrument]" << m_lastError;
-        return false;
-    }
-    int ndig = c - '0';
-    if (ndig == 0) {
-        // #0 是不定長度（直到 EOI）；這裡先不支援
-        m_lastError = "Indefinite-length block (#0) not supported";
-        qWarning() << "[Instrument]" << m_lastError;
+    IeeeBlockReader reader(m_comm);
+    if (!reader.readBlock(dst, capacity, written)) {
+        m_lastError = QString("%1 for: %2").arg(reader.lastError(), cmd);
         return false;
     }
+    recordQueryLatency(cmd.toUtf8());
+    m_lastError.clear();
+    return true;
+}
 
-    // 5) 確保把 <len> 的字元讀齊
-    int headerNeeded = 2 + ndig; // '#' + ndig + len(ndig digits)
-    while (header.size() < headerNeeded) {
-        int m = read(chunk, headerNeeded - header.size());
-        if (m <= 0) {
-            m_lastError = "Read failed while completing length digits";
-            qWarning() << "[Instrument]" << m_lastError;
-            return false;
-        }
-        header.append(chunk.left(m));
-    }
+bool InstrumentWithCommBase::queryBinaryStreaming(const QString& cmd,
+                                                  const IeeeBlockReader::ChunkSink& sink,
+                                                  const IeeeBlockReader::ProgressFn& progress,
+                                                  const std::atomic<bool>* cancel)
+{
+    IoTransaction transaction(this);
+    if (!sendBinaryQuery(cmd)) return false;
 
-    // 6) 取出 payload 長度
-    bool okLen = false;
-    int payloadLen = QString::fromLatin1(header.constData() + 2, ndig).toInt(&okLen);
-    if (!okLen || payloadLen < 0) {
-        m_lastError = "Malformed binary header: invalid length";
-        qWarning() << "[Instrument]" << m_lastError;
+    IeeeBlockReader reader(m_comm);
+    if (!reader.readBlockStreaming(sink, progress, cancel)) {
+        m_lastError = QString("%1 for: %2").arg(reader.lastError(), cmd);
         return false;
     }
-
-    // 7) 把 header 後面在第一包中的「已經攜帶的 payload」先取出
-    int alreadyPayload = header.size() - headerNeeded;
-    if (alreadyPayload > 0) {
-        out.append(header.constData() + headerNeeded, alreadyPayload);
-    }
-
-    // 8) 繼續把剩下的 payload 讀完
-    int remain = payloadLen - alreadyPayload;
-    while (remain > 0) {
-        int chunkSize = qMin(remain, 64 * 1024); // 分塊讀，避免一次申請過大 buffer
-        int m = read(chunk, chunkSize);
-        if (m <= 0) {
-            m_lastError = QString("Read failed while receiving payload, remain=%1").arg(remain);
-            qWarning() << "[Instrument]" << m_lastError;
-            return false;
-        }
-        out.append(chunk.constData(), m);
-        remain -= m;
-    }
-
+    recordQueryLatency(cmd.toUtf8());
     m_lastError.clear();
     return true;
 }
 
 void InstrumentWithCommBase::sendCommandWithLog(const QString& cmd, const QString& tag) {
+    IoTransaction transaction(this);
     if (write(cmd) < 0) {
         m_lastError = QString("Write failed: %1").arg(cmd);
         qWarning() << (tag.isEmpty() ? "[Instrument]" : tag) << m_lastError;
@@ -253,3 +292,42 @@ void InstrumentWithCommBase::sendCommandWithLog(const QString& cmd, const QStrin
         m_lastError.clear();
     }
 }
+
+bool InstrumentWithCommBase::isWrittenState(int channel, const QString& key, const QString& cmd) const
+{
+    WrittenStateCache* state = m_comm ? m_comm->writtenState() : nullptr;
+    return state && state->matches(channel, key, cmd);
+}
+
+bool InstrumentWithCommBase::sendIfChanged(int channel, const QString& key, const QString& cmd,
+                                           const QString& tag)
+{
+    IoTransaction transaction(this);
+    if (isWrittenState(channel, key, cmd)) return false;
+
+    sendCommandWithLog(cmd, tag);
+    if (!m_lastError.isEmpty()) return true;
+
+    // 進 batch 的指令還沒送出，等 flush 成功才記錄
+    if (m_batch) {
+        m_batch->recordOnFlush(channel, key, cmd);
+    } else if (WrittenStateCache* state = m_comm ? m_comm->writtenState() : nullptr) {
+        state->record(channel, key, cmd);
+    }
+    return true;
+}
+
+void InstrumentWithCommBase::invalidateWrittenChannel(int channel)
+{
+    IoTransaction transaction(this);
+    if (WrittenStateCache* state = m_comm ? m_comm->writtenState() : nullptr)
+        state->invalidateChannel(channel);
+    // 同一批次內較早的設定在 flush 後才記錄，也要一併作廢
+    if (m_batch) m_batch->invalidateOnFlush(channel);
+}
+
+void InstrumentWithCommBase::invalidateWrittenState()
+{
+    if (WrittenStateCache* state = m_comm ? m_comm->writtenState() : nullptr)
+        state->invalidateAll();
+}
@@ -2,12 +2,21 @@
 #include "instrumentbase.h"
 #include "iinstrumentcomm.h"
 #include "icommunication.h"
+#include "scpicommandbatch.h"
+#include "ieeeblockreader.h"
+#include "scpiresponsereader.h"
+#include <QElapsedTimer>
+#include <QRecursiveMutex>
+#include <memory>
+#include <optional>
+
+class EndpointMetrics;
 
 class InstrumentWithCommBase : public InstrumentBase, public IInstrumentComm
 {
 public:
     InstrumentWithCommBase(ICommunication* comm = nullptr)
-        : m_comm(comm), m_connected(false), m_address("") {}
+        : m_comm(comm), m_connected(false), m_address(""), m_responseReader(comm) {}
 
     virtual ~InstrumentWithCommBase() {
         if (m_connected && m_comm) {
@@ -22,10 +31,51 @@ public:
     QString getaddress() const override;
 
     void setCommunication(ICommunication* comm);
-    QString lastError() const { return m_lastError; }
+    ICommunication* communication() const { return m_comm; }
+    QString lastError() const;
+
+    // === SCPI 批次 ===
+    // attach 後的設定指令先累積在 batch，查詢或 read 前會自動 flush
+    // 多個通道物件 attach 同一個 batch（同一 comm）即可整台 mainframe 合併送出
+    void attachBatch(ScpiCommandBatch* batch) { m_batch = batch; }
+    void detachBatch() { m_batch = nullptr; }
+    ScpiCommandBatch* batch() const { return m_batch; }
+
+    // 單一儀器的便利用法：beginBatch() ... commitBatch()
+    void beginBatch();
+    bool commitBatch(bool waitForOpc = false);
+
+    // 單一 program message 最大長度；0 表示不支援分號複合指令
+    virtual int maxBatchMessageLength() const { return 0; }
 
 protected:
 
+    // 一次完整的 I/O 交易：寫入 + 讀回應 + 解析 m_response / m_lastError 不被其他執行緒插入
+    // 先鎖本物件再鎖連線的交易鎖（Pool 連線為 session mutex），順序固定避免死結
+    // 背景狀態監控與 GUI 執行緒共用同一個儀器物件時靠它序列化；可重入
+    class IoTransaction
+    {
+    public:
+        explicit IoTransaction(const InstrumentWithCommBase* owner)
+            : m_mutex(&owner->m_ioMutex)
+        {
+            m_mutex->lock();
+            m_commLock.emplace(owner->m_comm);
+        }
+        ~IoTransaction()
+        {
+            m_commLock.reset();
+            m_mutex->unlock();
+        }
+
+        IoTransaction(const IoTransaction&) = delete;
+        IoTransaction& operator=(const IoTransaction&) = delete;
+
+    private:
+        QRecursiveMutex* m_mutex;
+        std::optional<CommTransaction> m_commLock;
+    };
+
     QString m_address;
     bool    m_connected;
     ICommunication* m_comm;
@@ -34,15 +84,57 @@ protected:
     int write(const QByteArray& data);
 
     int read(QByteArray& data, int maxLen);
+    // 讀一個完整的文字回應（累積到終止字元 / EOI / 固定長度），不含結尾 LF
+    bool readResponse(QByteArray& data);
+    // 回應框的判斷方式；預設 LF 終止（GPIB 收到 EOI 也算結束）
+    void setResponseFraming(ScpiResponseReader::Framing framing, int fixedLength = 0,
+                            char terminator = '\n');
 
     QString m_lastError;
     bool queryInt(const QString& cmd, int& value);
     bool queryDouble(const QString& cmd, double& value);
     bool queryString(const QString& cmd, QString& result);
+    // IEEE-488.2 區塊回應（#<d><len><data> 與 #0 不定長度）
     bool queryBinary(const QString& cmd, QByteArray& out,
                      int maxHeaderBytes = 32);
+    // 直接讀入呼叫端緩衝區（容量不足時失敗）
+    bool queryBinary(const QString& cmd, char* dst, qint64 capacity, qint64& written);
+    // 串流：以固定緩衝區邊收邊交給 sink，可回報進度與取消
+    bool queryBinaryStreaming(const QString& cmd,
+                              const IeeeBlockReader::ChunkSink& sink,
+                              const IeeeBlockReader::ProgressFn& progress = IeeeBlockReader::ProgressFn(),
+                              const std::atomic<bool>* cancel = nullptr);
 
     void sendCommandWithLog(const QString& cmd, const QString& tag);
+    // 送出區塊查詢：先丟棄上一個查詢殘留的回應，並確保 batch 中的指令已送出
+    // 呼叫端須持有 IoTransaction，直到區塊讀完
+    bool sendBinaryQuery(const QString& cmd);
+
+    // 設定指令的重送抑制：與此連線上次成功送出的 (channel, key) 相同就不送出，回傳 true 表示已送出
+    // 連線不提供已寫入狀態（非 Pool 連線）時一律送出；attach batch 時等 flush 成功才記錄
+    bool sendIfChanged(int channel, const QString& key, const QString& cmd, const QString& tag);
+    bool isWrittenState(int channel, const QString& key, const QString& cmd) const;
+    void invalidateWrittenState();
+    // 輸出關閉後該通道的設定要重送（前面板可能在這之後被修改）
+    void invalidateWrittenChannel(int channel);
+
+private:
+    bool flushPendingBatch();
+    bool queryResponse(const QString& cmd);
+    void recordQueryLatency(const QByteArray& cmd);
+
+    // 連線註冊的統計物件（Session Pool 以資源 key 註冊）；非 Pool 連線或尚未開啟時為 nullptr
+    EndpointMetrics* metrics() const;
+
+    ScpiCommandBatch* m_batch = nullptr;
+    std::unique_ptr<ScpiCommandBatch> m_ownBatch;
+
+    mutable QRecursiveMutex m_ioMutex;     // 見 IoTransaction
+
+    ScpiResponseReader m_responseReader;   // 每個儀器物件各自一個環形緩衝區（不隨 session 共用）
+    QByteArray m_response;                 // 重複使用，查詢不重新配置
+
+    QElapsedTimer m_queryClock;            // 查詢往返時間（寫入 → 完整回應）
 
 };
 
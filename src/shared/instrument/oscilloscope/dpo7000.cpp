@@ -1,7 +1,33 @@
 #include "dpo7000.h"
+#include <QSaveFile>
+#include <QtEndian>
+#include <QElapsedTimer>
 #include <QDebug>
-#include <QThread>
+#include <QStringList>
+#include <limits>
 
+namespace {
+// ACQuire:STATE? 回應可能是 "1" / "0" / "RUN" / "STOP" / "ON" / "OFF"（HEADer ON 時帶有指令標頭）
+bool parseRunState(const QString& response)
+{
+    const QString value = response.trimmed().section(' ', -1);
+    return value == "1" ||
+           value.contains("RUN", Qt::CaseInsensitive) ||
+           value.contains("ON", Qt::CaseInsensitive);
+}
+
+// HEADer ON 時回應帶有指令標頭（":HORIZONTAL:SCALE 1.0E-3"），只取值的部分
+QString stripHeader(const QString& response)
+{
+    const QString trimmed = response.trimmed();
+    return trimmed.startsWith(':') ? trimmed.section(' ', 1).trimmed() : trimmed;
+}
+
+QString cacheNumber(double value)
+{
+    return QString::number(value, 'g', 12);
+}
+}
 
 DPO7000::~DPO7000() {
     disconnect();   
@@ -10,12 +36,13 @@ DPO7000::~DPO7000() {
 // === 基本設置方法 ===
 void DPO7000::setChannelPosition(int channel, double position)
 {
-    sendCommandWithLog(QString("CH%1:POSITION %2").arg(channel).arg(position), "[DPO7000]");
+    // 位置會被夾限在 ±5 div，不記錄寫入值
+    writeSetting(QString("CH%1:POSITION %2").arg(channel).arg(position), QString("CH%1:POS").arg(channel));
 }
 
 void DPO7000::setHorizontalPosition(double position)
 {
-    sendCommandWithLog(QString("HORizontal:POSition %1").arg(position), "[DPO7000]");
+    writeSetting(QString("HORizontal:POSition %1").arg(position), "HOR:POS");
 }
 
 void DPO7000::setChannelCoupling(int channel, const QString& coupling)
@@ -25,33 +52,37 @@ void DPO7000::setChannelCoupling(int channel, const QString& coupling)
 
 void DPO7000::setTimebase(double timePerDiv)
 {
-    sendCommandWithLog(QString("HORizontal:SCALe %1").arg(timePerDiv), "[DPO7000]");
+    // 儀器會捨入到可用的時基檔位，下次讀取再查詢實際值
+    writeSetting(QString("HORizontal:SCALe %1").arg(timePerDiv), "HOR:SCALE");
 }
 
 void DPO7000::setChannelScale(int channel, double voltsPerDiv)
 {
-    sendCommandWithLog(QString("CH%1:SCALe %2").arg(channel).arg(voltsPerDiv), "[DPO7000]");
+    writeSetting(QString("CH%1:SCALe %2").arg(channel).arg(voltsPerDiv), QString("CH%1:SCALE").arg(channel));
 }
 
 void DPO7000::enableChannel(int channel, bool enabled)
 {
     QString cmd = QString("CH%1:STATe %2").arg(channel).arg(enabled ? "ON" : "OFF");
-    sendCommandWithLog(cmd, "[DPO7000]");
+    writeSetting(cmd, QString("CH%1:STATE").arg(channel), enabled ? "1" : "0");
 }
 
 // === 觸發設置方法 ===
 void DPO7000::setTriggerType(const QString& type)
 {
     m_triggerType = type.toUpper();
-    sendCommandWithLog(QString("TRIGger:A:TYPe %1").arg(m_triggerType), "[DPO7000]");
+    writeSetting(QString("TRIGger:A:TYPe %1").arg(m_triggerType), "TRIG:TYPE", m_triggerType);
+    // 來源 / 斜率的查詢路徑依觸發類型而定
+    m_stateCache.invalidate("TRIG:SOURCE");
+    m_stateCache.invalidate("TRIG:SLOPE");
 }
 
 void DPO7000::setTriggerSource(const QString& source)
 {
     if (m_triggerType == "EDGE") {
-        sendCommandWithLog(QString("TRIGger:A:EDGE:SOUrce %1").arg(source.toUpper()), "[DPO7000]");
+        writeSetting(QString("TRIGger:A:EDGE:SOUrce %1").arg(source.toUpper()), "TRIG:SOURCE", source.toUpper());
     } else {
-        sendCommandWithLog(QString("TRIGger:A:%1:SOUrce %2").arg(m_triggerType, source.toUpper()), "[DPO7000]");
+        writeSetting(QString("TRIGger:A:%1:SOUrce %2").arg(m_triggerType, source.toUpper()), "TRIG:SOURCE", source.toUpper());
     }
 }
 
@@ -61,11 +92,11 @@ void DPO7000::setTriggerSlope(const QString& slope)
 
     if (m_triggerType == "EDGE") {
         if (normalizedSlope == "RISING" || normalizedSlope == "RISing" || normalizedSlope == "POS") {
-            sendCommandWithLog("TRIGger:A:EDGE:SLOpe RISe", "[DPO7000]");
+            writeSetting("TRIGger:A:EDGE:SLOpe RISe", "TRIG:SLOPE", "RISE");
         } else if (normalizedSlope == "FALLING" || normalizedSlope == "FALling" || normalizedSlope == "NEG") {
-            sendCommandWithLog("TRIGger:A:EDGE:SLOpe FALL", "[DPO7000]");
+            writeSetting("TRIGger:A:EDGE:SLOpe FALL", "TRIG:SLOPE", "FALL");
         } else if (normalizedSlope == "BOTH" || normalizedSlope == "EITher") {
-            sendCommandWithLog("TRIGger:A:EDGE:SLOpe EITher", "[DPO7000]");
+            writeSetting("TRIGger:A:EDGE:SLOpe EITher", "TRIG:SLOPE", "EITHER");
         } else {
             qWarning() << "[DPO7000] Invalid slope parameter:" << slope
                        << "Valid options: RISING, FALLING, BOTH";
@@ -76,18 +107,33 @@ void DPO7000::setTriggerSlope(const QString& slope)
 
 void DPO7000::setTriggerLevel(double level)
 {
-    sendCommandWithLog(QString("TRIGger:A:LEVel %1").arg(level), "[DPO7000]");
+    applyTriggerLevel(level);
+}
+
+bool DPO7000::applyTriggerLevel(double level)
+{
+    // 準位解析度依垂直檔位而定，寫入值不一定是儀器實際值
+    return writeSetting(QString("TRIGger:A:LEVel %1").arg(level), "TRIG:LEVEL");
 }
 
 // === 控制方法 ===
+void DPO7000::reset()
+{
+    sendCommandWithLog("*RST", "[DPO7000]");
+    m_triggerType = "EDGE";
+    m_stateCache.invalidateAll();
+}
+
 void DPO7000::autoSetup()
 {
     sendCommandWithLog("AUTOSet EXECute", "[DPO7000]");
+    // Autoset 會改變時基、通道與觸發，整份快取作廢
+    m_stateCache.invalidateAll();
 }
 
 void DPO7000::automode()
 {
-    sendCommandWithLog("TRIGger:A:MODe AUTO", "[DPO7000]");
+    writeSetting("TRIGger:A:MODe AUTO", "TRIG:MODE", "AUTO");
 }
 
 void DPO7000::run()
@@ -122,7 +168,7 @@ void DPO7000::single()
 
 void DPO7000::normal()
 {
-    sendCommandWithLog("TRIGger:A:MODe NORMal", "[DPO7000]");
+    writeSetting("TRIGger:A:MODe NORMal", "TRIG:MODE", "NORMAL");
 }
 
 void DPO7000::force()
@@ -149,20 +195,7 @@ bool DPO7000::isRunning()
         return false;
     }
 
-    // 移除空白和換行
-    response = response.trimmed();
-
-    // qDebug() << "[DPO7000] isRunning() query response:" << response;
-
-    // 判斷是否正在執行
-    // 可能的回應: "1", "0", "RUN", "STOP", "ON", "OFF"
-    bool running = (response == "1" ||
-                    response.contains("RUN", Qt::CaseInsensitive) ||
-                    response.contains("ON", Qt::CaseInsensitive));
-
-    // qDebug() << "[DPO7000] isRunning() result:" << running;
-
-    return running;
+    return parseRunState(response);
 }
 
 QString DPO7000::getStopAfterMode()
@@ -181,50 +214,45 @@ QString DPO7000::getStopAfterMode()
 // === 查詢方法（半自動觸發核心） ===
 QString DPO7000::getTriggerSource()
 {
+    const QString query = (m_triggerType == "EDGE")
+                              ? QString("TRIGger:A:EDGE:SOUrce?")
+                              : QString("TRIGger:A:%1:SOUrce?").arg(m_triggerType);
     QString source;
-    if (m_triggerType == "EDGE") {
-        if (!queryString("TRIGger:A:EDGE:SOUrce?", source)) {
-            qWarning() << "[DPO7000] getTriggerSource failed:" << lastError();
-            return "";
-        }
-    } else {
-        if (!queryString(QString("TRIGger:A:%1:SOUrce?").arg(m_triggerType), source)) {
-            qWarning() << "[DPO7000] getTriggerSource failed for type" << m_triggerType << ":" << lastError();
-            return "";
-        }
+    if (!cachedString("TRIG:SOURCE", query, source)) {
+        qWarning() << "[DPO7000] getTriggerSource failed for type" << m_triggerType << ":" << lastError();
+        return "";
     }
-    return source.trimmed();
+    return source;
 }
 
 QString DPO7000::getTriggerType()
 {
     QString type;
-    if (!queryString("TRIGger:A:TYPe?", type)) {
+    if (!cachedString("TRIG:TYPE", "TRIGger:A:TYPe?", type)) {
         qWarning() << "[DPO7000] getTriggerType failed:" << lastError();
         return "";
     }
-    return type.trimmed();
+    return type;
 }
 
 QString DPO7000::getTriggerSlope()
 {
-    QString slope;
-    if (m_triggerType == "EDGE") {
-        if (!queryString("TRIGger:A:EDGE:SLOpe?", slope)) {
-            qWarning() << "[DPO7000] getTriggerSlope failed:" << lastError();
-            return "";
-        }
-    } else {
+    if (m_triggerType != "EDGE") {
         qWarning() << "[DPO7000] Getting slope not supported for trigger type:" << m_triggerType;
         return "";
     }
-    return slope.trimmed();
+    QString slope;
+    if (!cachedString("TRIG:SLOPE", "TRIGger:A:EDGE:SLOpe?", slope)) {
+        qWarning() << "[DPO7000] getTriggerSlope failed:" << lastError();
+        return "";
+    }
+    return slope;
 }
 
 double DPO7000::getTriggerLevel()
 {
     double level = 0.0;
-    if (!queryDouble("TRIGger:A:LEVel?", level)) {
+    if (!cachedDouble("TRIG:LEVEL", "TRIGger:A:LEVel?", level)) {
         qWarning() << "[DPO7000] getTriggerLevel failed:" << lastError();
     }
     return level;
@@ -233,18 +261,18 @@ double DPO7000::getTriggerLevel()
 QString DPO7000::getTriggerMode()
 {
     QString mode;
-    if (!queryString("TRIGger:A:MODe?", mode)) {
+    if (!cachedString("TRIG:MODE", "TRIGger:A:MODe?", mode)) {
         qWarning() << "[DPO7000] getTriggerMode failed:" << lastError();
         return "";
     }
-    return mode.trimmed();
+    return mode;
 }
 
 // === 通道和時基查詢 ===
 double DPO7000::getChannelPosition(int channel)
 {
     double pos = 0.0;
-    if (!queryDouble(QString("CH%1:POSITION?").arg(channel), pos)) {
+    if (!cachedDouble(QString("CH%1:POS").arg(channel), QString("CH%1:POSITION?").arg(channel), pos)) {
         qWarning() << "[DPO7000] getChannelPosition failed:" << lastError();
     }
     return pos;
@@ -253,7 +281,7 @@ double DPO7000::getChannelPosition(int channel)
 double DPO7000::getHorizontalPosition()
 {
     double pos = 0.0;
-    if (!queryDouble("HORizontal:POSition?", pos)) {
+    if (!cachedDouble("HOR:POS", "HORizontal:POSition?", pos)) {
         qWarning() << "[DPO7000] getHorizontalPosition failed:" << lastError();
     }
     return pos;
@@ -262,7 +290,7 @@ double DPO7000::getHorizontalPosition()
 double DPO7000::getChannelScale(int channel)
 {
     double scale = 0.0;
-    if (!queryDouble(QString("CH%1:SCALe?").arg(channel), scale)) {
+    if (!cachedDouble(QString("CH%1:SCALE").arg(channel), QString("CH%1:SCALe?").arg(channel), scale)) {
         qWarning() << "[DPO7000] getChannelScale failed for CH" << channel << ":" << lastError();
     }
     return scale;
@@ -271,22 +299,118 @@ double DPO7000::getChannelScale(int channel)
 bool DPO7000::isChannelEnabled(int channel)
 {
     QString state;
-    if (!queryString(QString("CH%1:STATe?").arg(channel), state)) {
+    if (!cachedString(QString("CH%1:STATE").arg(channel), QString("CH%1:STATe?").arg(channel), state)) {
         qWarning() << "[DPO7000] isChannelEnabled failed for CH" << channel << ":" << lastError();
         return false;
     }
-    return (state.trimmed() == "1" || state.trimmed().toUpper() == "ON");
+    return (state == "1" || state.toUpper() == "ON");
 }
 
 double DPO7000::getTimebase()
 {
     double timebase = 0.0;
-    if (!queryDouble("HORizontal:SCALe?", timebase)) {
+    if (!cachedDouble("HOR:SCALE", "HORizontal:SCALe?", timebase)) {
         qWarning() << "[DPO7000] getTimebase failed:" << lastError();
     }
     return timebase;
 }
 
+// === 設定狀態快取 ===
+bool DPO7000::writeSetting(const QString& cmd, const QString& key, const QString& value)
+{
+    IoTransaction transaction(this);
+    sendCommandWithLog(cmd, "[DPO7000]");
+    const bool ok = m_lastError.isEmpty();
+    if (ok && !value.isEmpty()) {
+        m_stateCache.store(key, value);
+    } else {
+        m_stateCache.invalidate(key);
+    }
+    return ok;
+}
+
+bool DPO7000::refreshStateCache()
+{
+    QVector<QPair<QString, QString>> fields = {
+        { "HOR:SCALE",  "HORizontal:SCALe?" },
+        { "HOR:POS",    "HORizontal:POSition?" },
+        { "TRIG:TYPE",  "TRIGger:A:TYPe?" },
+        { "TRIG:MODE",  "TRIGger:A:MODe?" },
+        { "TRIG:LEVEL", "TRIGger:A:LEVel?" },
+    };
+    if (m_triggerType == "EDGE") {
+        fields.append({ "TRIG:SOURCE", "TRIGger:A:EDGE:SOUrce?" });
+        fields.append({ "TRIG:SLOPE",  "TRIGger:A:EDGE:SLOpe?" });
+    } else {
+        fields.append({ "TRIG:SOURCE", QString("TRIGger:A:%1:SOUrce?").arg(m_triggerType) });
+    }
+    for (int ch = 1; ch <= channelCount; ++ch) {
+        fields.append({ QString("CH%1:SCALE").arg(ch), QString("CH%1:SCALe?").arg(ch) });
+        fields.append({ QString("CH%1:POS").arg(ch),   QString("CH%1:POSition?").arg(ch) });
+        fields.append({ QString("CH%1:STATE").arg(ch), QString("CH%1:STATe?").arg(ch) });
+    }
+
+    QStringList queries;
+    queries.reserve(fields.size());
+    for (const auto& field : fields)
+        queries << field.second;
+
+    // 複合查詢：儀器以分號串接所有回應，一次往返
+    IoTransaction transaction(this);
+    QString response;
+    if (!queryString(queries.join(";:"), response)) {
+        return false;
+    }
+
+    const QStringList values = response.trimmed().split(';');
+    if (values.size() != fields.size()) {
+        m_lastError = QString("State refresh returned %1 fields, expected %2")
+                          .arg(values.size()).arg(fields.size());
+        qWarning() << "[DPO7000]" << m_lastError;
+        return false;
+    }
+
+    QHash<QString, QString> snapshot;
+    snapshot.reserve(fields.size());
+    for (int i = 0; i < fields.size(); ++i)
+        snapshot.insert(fields[i].first, stripHeader(values[i]));
+    m_stateCache.storeAll(snapshot);
+    return true;
+}
+
+bool DPO7000::cachedString(const QString& key, const QString& query, QString& value)
+{
+    if (m_stateCache.lookup(key, value)) return true;
+
+    // 任何一個欄位過期就整批更新，同一輪 UI 刷新的其他 getter 都會命中快取
+    if (m_stateCache.stalenessMs() > 0 && refreshStateCache()
+        && m_stateCache.lookup(key, value)) return true;
+
+    // 不在批次內的欄位（例如 CH5 以上）或快取停用：單獨查詢
+    QString response;
+    if (!queryString(query, response)) return false;
+    value = stripHeader(response);
+    m_stateCache.store(key, value);
+    return true;
+}
+
+bool DPO7000::cachedDouble(const QString& key, const QString& query, double& value)
+{
+    IoTransaction transaction(this);
+    QString text;
+    if (!cachedString(key, query, text)) return false;
+
+    bool ok = false;
+    const double parsed = text.toDouble(&ok);
+    if (!ok) {
+        m_stateCache.invalidate(key);
+        m_lastError = QString("Invalid numeric response for %1: %2").arg(query, text);
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
 // === 狀態查詢方法（半自動觸發必需） ===
 QString DPO7000::getAcquisitionState()
 {
@@ -308,29 +432,116 @@ QString DPO7000::getTriggerState()
     return state.trimmed();
 }
 
+int DPO7000::acquireSingle(int timeoutMs, bool useSrq)
+{
+    if (!m_comm) return -1;
+
+    if (useSrq) {
+        // 擷取完成時 *OPC 設定 OPC 位元並發出 SRQ；等待期間不持有交易鎖
+        sendCommandWithLog("ACQuire:STOPAfter SEQuence;:ACQuire:STATE RUN;*OPC", "[DPO7000]");
+        if (!m_lastError.isEmpty()) return -1;
+        if (waitForServiceRequest(timeoutMs)) return 1;
+
+        // 沒有觸發：停止擷取讓 *OPC 完成，收掉它發出的 SRQ，下一次等待才不會誤判
+        sendCommandWithLog("ACQuire:STATE STOP", "[DPO7000]");
+        if (!m_lastError.isEmpty()) return -1;
+        waitForServiceRequest(ICommunication::defaultTimeoutMs);
+        return 0;
+    }
+
+    IoTransaction transaction(this);
+    sendCommandWithLog("ACQuire:STOPAfter SEQuence;:ACQuire:STATE RUN", "[DPO7000]");
+    if (!m_lastError.isEmpty()) return -1;
+
+    // *OPC? 在擷取完成後才回應，逾時即視為沒有觸發
+    const int savedTimeout = m_comm->timeout();
+    m_comm->setTimeout(timeoutMs);
+    QString opc;
+    const bool triggered = queryString("*OPC?", opc);
+    m_comm->setTimeout(savedTimeout);
+    if (triggered) return 1;
+
+    // 停止擷取後 *OPC? 會回應，讀掉這個遲到的 "1"，下一個查詢才不會讀到
+    sendCommandWithLog("ACQuire:STATE STOP", "[DPO7000]");
+    QByteArray late;
+    if (!m_lastError.isEmpty() || !readResponse(late)) {
+        qWarning() << "[DPO7000] acquireSingle: no *OPC? response after stop:" << lastError();
+        return -1;
+    }
+    m_lastError.clear();
+    return 0;
+}
+
 // === 系統操作方法 ===
 bool DPO7000::waitForOperationComplete(int timeoutMs)
 {
-    const int POLL_INTERVAL = 50;
-    int elapsedTime = 0;
+    // *OPC? 等所有待處理操作完成才回應 "1"：一次阻塞查詢，逾時即 timeoutMs，不固定間隔輪詢
+    // 不先送 *OPC：SRQ 已啟用時它會設定 OPC 位元，讓等待 SRQ 的一方誤判
+    if (!m_comm) return false;
 
-    // 發送操作完成查詢命令
-    sendCommandWithLog("*OPC", "[DPO7000]");
+    IoTransaction transaction(this);
+    const int savedTimeout = m_comm->timeout();
+    m_comm->setTimeout(timeoutMs);
+    QString opcResult;
+    const bool ok = queryString("*OPC?", opcResult) && opcResult.section(' ', -1) == "1";
+    m_comm->setTimeout(savedTimeout);
 
-    while (elapsedTime < timeoutMs) {
-        QString opcResult;
-        if (queryString("*OPC?", opcResult)) {
-            if (opcResult.trimmed() == "1") {
-                return true;
-            }
-        }
+    if (!ok) {
+        qWarning() << "[DPO7000] waitForOperationComplete failed after" << timeoutMs << "ms:" << lastError();
+    }
+    return ok;
+}
 
-        QThread::msleep(POLL_INTERVAL);
-        elapsedTime += POLL_INTERVAL;
+// === 背景狀態監控 ===
+bool DPO7000::queryStatusSnapshot(bool& running, QString& triggerState, double& triggerLevel)
+{
+    IoTransaction transaction(this);
+    QString response;
+    if (!queryString("ACQuire:STATE?;:TRIGger:STATE?;:TRIGger:A:LEVel?", response)) {
+        return false;
     }
 
-    qWarning() << "[DPO7000] waitForOperationComplete timeout after" << timeoutMs << "ms";
-    return false;
+    const QStringList fields = response.trimmed().split(';');
+    if (fields.size() != 3) {
+        m_lastError = QString("Unexpected status response: %1").arg(response.trimmed());
+        return false;
+    }
+
+    bool ok = false;
+    const double level = fields[2].trimmed().section(' ', -1).toDouble(&ok);
+    if (!ok) {
+        m_lastError = QString("Invalid trigger level: %1").arg(fields[2].trimmed());
+        return false;
+    }
+
+    running = parseRunState(fields[0]);
+    triggerState = fields[1].trimmed().section(' ', -1).toUpper();
+    triggerLevel = level;
+    m_stateCache.store("TRIG:LEVEL", cacheNumber(level));
+    return true;
+}
+
+bool DPO7000::enableServiceRequest()
+{
+    if (!m_comm || !m_comm->supportsServiceRequest()) return false;
+    sendCommandWithLog("*CLS;*ESE 1;*SRE 32", "[DPO7000]");
+    return true;
+}
+
+bool DPO7000::waitForServiceRequest(int timeoutMs)
+{
+    if (!m_comm || m_comm->waitForServiceRequest(timeoutMs) != 1) return false;
+
+    // 等待 SRQ 期間不持有交易鎖，GUI 執行緒的指令可照常送出
+    // 讀取即清除事件狀態暫存器，ESB 歸零後下一次事件才會再發出 SRQ
+    QString esr;
+    queryString("*ESR?", esr);
+    return true;
+}
+
+void DPO7000::armOperationComplete()
+{
+    sendCommandWithLog("*OPC", "[DPO7000]");
 }
 
 QString DPO7000::getSystemError()
@@ -379,11 +590,11 @@ QByteArray DPO7000::captureScreenshot(const QString& format)
     return img;
 }
 
-QByteArray DPO7000::captureWaveformFile(int channel,
-                                        const QString& format,
-                                        const QString& scopePath,
-                                        int startPoint,
-                                        int stopPoint)
+QString DPO7000::saveWaveformOnScope(int channel,
+                                    const QString& format,
+                                    const QString& scopePath,
+                                    int startPoint,
+                                    int stopPoint)
 {
     // 1) 選擇來源通道
     sendCommandWithLog(QString("DATa:SOUrce CH%1").arg(channel), "[DPO7000]");
@@ -412,6 +623,18 @@ QByteArray DPO7000::captureWaveformFile(int channel,
     // 5) 執行保存
     sendCommandWithLog("SAVe:WAVEform:DATa", "[DPO7000]");
 
+    return quotedPath;
+}
+
+QByteArray DPO7000::captureWaveformFile(int channel,
+                                        const QString& format,
+                                        const QString& scopePath,
+                                        int startPoint,
+                                        int stopPoint)
+{
+    // 1)~5) 在儀器端存檔
+    const QString quotedPath = saveWaveformOnScope(channel, format, scopePath, startPoint, stopPoint);
+
     // 6) 讀回完整檔案位元流
     QByteArray payload;
     if (!queryBinary(QString("FILESystem:READFile %1").arg(quotedPath), payload)) {
@@ -425,21 +648,298 @@ QByteArray DPO7000::captureWaveformFile(int channel,
     return payload;
 }
 
+// === 波形擷取（CURVe? 二進位） ===
+
+bool DPO7000::setupCurveTransfer(int startPoint, int stopPoint)
+{
+    // 未指定結束點時取整筆記錄長度
+    if (stopPoint <= 0) {
+        int recordLength = 0;
+        if (!queryInt("HORizontal:RECOrdlength?", recordLength) || recordLength <= 0) {
+            qWarning() << "[DPO7000] query record length failed:" << lastError();
+            return false;
+        }
+        stopPoint = recordLength;
+    }
+    if (startPoint <= 0) startPoint = 1;
+
+    bool ok = true;
+    auto send = [this, &ok](const QString& cmd) {
+        sendCommandWithLog(cmd, "[DPO7000]");
+        ok = ok && lastError().isEmpty();
+    };
+
+    // 回應不帶 header，preamble 以純數值回傳
+    send("HEADer OFF");
+    send(m_curveBytesPerPoint == 1 ? "DATa:ENCdg RIBinary" : "DATa:ENCdg SRIbinary");
+    send(QString("WFMOutpre:BYT_Nr %1").arg(m_curveBytesPerPoint));
+    send(QString("DATa:STARt %1").arg(startPoint));
+    send(QString("DATa:STOP %1").arg(stopPoint));
+    return ok;
+}
+
+bool DPO7000::parsePreamble(const QByteArray& text, WaveformPreamble& pre)
+{
+    // 欄位依序：BYT_Nr;NR_Pt;XINcr;XZEro;PT_Off;YMUlt;YOFf;YZEro;HOR:SCAL;CH<x>:SCAL
+    const QList<QByteArray> fields = text.split(';');
+    if (fields.size() < 10) {
+        qWarning() << "[DPO7000] Malformed WFMOutpre? response:" << text.left(128);
+        return false;
+    }
+
+    // HEADer ON 時欄位前帶有名稱，取最後一個 token
+    bool allOk = true;
+    auto value = [&fields, &allOk](int i) {
+        const QByteArray f = fields[i].trimmed();
+        bool ok = false;
+        double v = f.mid(f.lastIndexOf(' ') + 1).toDouble(&ok);
+        allOk = allOk && ok;
+        return v;
+    };
+
+    pre.bytesPerPoint = static_cast<int>(value(0));
+    pre.numPoints     = static_cast<int>(value(1));
+    pre.xIncr         = value(2);
+    pre.xZero         = value(3);
+    pre.ptOff         = value(4);
+    pre.yMult         = value(5);
+    pre.yOff          = value(6);
+    pre.yZero         = value(7);
+    pre.timeScale     = value(8);
+    pre.channelScale  = value(9);
+
+    if (!allOk || (pre.bytesPerPoint != 1 && pre.bytesPerPoint != 2) || pre.numPoints < 0) {
+        qWarning() << "[DPO7000] Invalid WFMOutpre? values:" << text.left(128);
+        return false;
+    }
+    return true;
+}
+
+void DPO7000::convertCurve(const char* raw, int numPoints,
+                           const WaveformPreamble& pre, WaveformData& out)
+{
+    out.voltagePoints.resize(numPoints);
+    out.timePoints.resize(numPoints);
+    double* volts = out.voltagePoints.data();
+    double* times = out.timePoints.data();
+
+    // v = (raw - YOFF) * YMULT + YZERO 展開成單一乘加，讓編譯器向量化
+    const double gain = pre.yMult;
+    const double offset = pre.yZero - pre.yOff * pre.yMult;
+
+    if (pre.bytesPerPoint == 1) {
+        const qint8* src = reinterpret_cast<const qint8*>(raw);
+        for (int i = 0; i < numPoints; ++i)
+            volts[i] = src[i] * gain + offset;
+    } else {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        // SRIbinary 為 LSB first，與主機相同，直接當 int16 陣列使用
+        const qint16* src = reinterpret_cast<const qint16*>(raw);
+        for (int i = 0; i < numPoints; ++i)
+            volts[i] = src[i] * gain + offset;
+#else
+        for (int i = 0; i < numPoints; ++i)
+            volts[i] = qFromLittleEndian<qint16>(raw + 2 * i) * gain + offset;
+#endif
+    }
+
+    // t = XZERO + (i - PT_OFF) * XINCR
+    const double t0 = pre.xZero - pre.ptOff * pre.xIncr;
+    const double dt = pre.xIncr;
+    for (int i = 0; i < numPoints; ++i)
+        times[i] = t0 + i * dt;
+}
+
+bool DPO7000::fetchChannelCurve(int channel, WaveformData& out, WaveformPreamble& pre,
+                                qint64* transferredBytes)
+{
+    // 通道切換、preamble、CURVe? 合併成一個 program message：一次寫入、一個回應
+    //   回應格式：<preamble 10 欄>;#<d><len><data>\n
+    const QString cmd = QString("DATa:SOUrce CH%1;"
+                                ":WFMOutpre:BYT_Nr?;NR_Pt?;XINcr?;XZEro?;PT_Off?;YMUlt?;YOFf?;YZEro?;"
+                                ":HORizontal:SCALe?;:CH%1:SCALe?;:CURVe?").arg(channel);
+    // 寫入到讀完整個區塊都不能讓其他執行緒（狀態監控）插入查詢
+    IoTransaction transaction(this);
+    if (!sendBinaryQuery(cmd)) {
+        qWarning() << "[DPO7000] CURVe? request failed for CH" << channel << ":" << lastError();
+        return false;
+    }
+
+    IeeeBlockReader reader(m_comm);
+    reader.setMaxPrefix(1024);
+
+    qint64 len = 0;
+    if (!reader.readHeader(len) || len < 0) {
+        qWarning() << "[DPO7000] CURVe? header failed for CH" << channel << ":" << reader.lastError();
+        return false;
+    }
+    // 拒收時仍把區塊讀掉，下一個查詢才不會讀到殘留的波形資料
+    if (!parsePreamble(reader.prefix(), pre)) {
+        reader.skipPayload(len);
+        return false;
+    }
+    if (len > std::numeric_limits<int>::max()) {
+        qWarning() << "[DPO7000] CURVe? block too large on CH" << channel << ":" << len << "bytes";
+        reader.skipPayload(len);
+        return false;
+    }
+    // 區塊長度必須與 preamble 的點數一致，否則時間軸與資料對不起來
+    const qint64 expected = qint64(pre.numPoints) * pre.bytesPerPoint;
+    if (len != expected) {
+        qWarning() << "[DPO7000] CURVe? point count mismatch on CH" << channel
+                   << ": got" << len << "bytes, expected" << expected;
+        reader.skipPayload(len);
+        return false;
+    }
+
+    QByteArray raw(static_cast<int>(len), Qt::Uninitialized);
+    if (!reader.readExact(raw.data(), len) || !reader.readTerminator()) {
+        qWarning() << "[DPO7000] CURVe? payload failed for CH" << channel << ":" << reader.lastError();
+        return false;
+    }
+
+    const int numPoints = pre.numPoints;
+
+    convertCurve(raw.constData(), numPoints, pre, out);
+    out.channel = channel;
+    out.recordLength = numPoints;
+    out.sampleRate = pre.xIncr > 0.0 ? 1.0 / pre.xIncr : 0.0;
+    out.timeBase = pre.timeScale;
+    out.voltageScale = pre.channelScale;
+    out.timestamp = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+
+    if (transferredBytes) *transferredBytes = len;
+    return true;
+}
+
+bool DPO7000::acquireWaveform(int channel, WaveformData& out, int startPoint, int stopPoint)
+{
+    if (!setupCurveTransfer(startPoint, stopPoint)) return false;
+
+    WaveformPreamble pre;
+    return fetchChannelCurve(channel, out, pre, nullptr);
+}
+
+bool DPO7000::acquireWaveforms(const QVector<int>& channels,
+                               QVector<WaveformData>& out,
+                               int startPoint, int stopPoint,
+                               QVector<WaveformTransferStats>* stats)
+{
+    out.clear();
+    if (stats) stats->clear();
+    if (channels.isEmpty()) return true;
+
+    // 停止 → 逐通道讀取 → 恢復 RUN 為一個交易，期間狀態監控的查詢排在後面
+    IoTransaction transaction(this);
+
+    // 1) 停在同一次擷取：所有通道讀到的是同一個觸發事件
+    const bool wasRunning = isRunning();
+    if (wasRunning) {
+        sendCommandWithLog("ACQuire:STATE STOP", "[DPO7000]");
+        QString opc;
+        queryString("*OPC?", opc);
+    }
+
+    // 2) 傳輸格式與點範圍只設定一次
+    bool ok = setupCurveTransfer(startPoint, stopPoint);
+
+    // 3) 逐通道各一次寫入 / 一個回應
+    QVector<WaveformPreamble> preambles;
+    for (int i = 0; ok && i < channels.size(); ++i) {
+        WaveformData wf;
+        WaveformPreamble pre;
+        qint64 bytes = 0;
+
+        QElapsedTimer timer;
+        timer.start();
+        ok = fetchChannelCurve(channels[i], wf, pre, &bytes);
+        const qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+        if (!ok) break;
+
+        if (stats) {
+            WaveformTransferStats st;
+            st.channel = channels[i];
+            st.bytes = bytes;
+            st.elapsedUs = elapsedUs;
+            st.mbPerSec = elapsedUs > 0 ? (bytes / 1.0e6) / (elapsedUs / 1.0e6) : 0.0;
+            stats->append(st);
+            qDebug() << "[DPO7000] CH" << st.channel << st.bytes << "bytes in"
+                     << st.elapsedUs / 1000.0 << "ms," << st.mbPerSec << "MB/s";
+        }
+
+        // 4) 時間軸相同時共用同一份 timePoints（隱式共享，不另佔記憶體）
+        if (!out.isEmpty()) {
+            const WaveformPreamble& ref = preambles.first();
+            if (wf.recordLength == out.first().recordLength
+                && pre.xIncr == ref.xIncr && pre.xZero == ref.xZero && pre.ptOff == ref.ptOff) {
+                wf.timePoints = out.first().timePoints;
+            } else {
+                qWarning() << "[DPO7000] CH" << channels[i] << "time axis differs from CH" << out.first().channel;
+            }
+        }
+
+        preambles.append(pre);
+        out.append(wf);
+    }
+
+    if (wasRunning) {
+        sendCommandWithLog("ACQuire:STATE RUN", "[DPO7000]");
+    }
+
+    if (!ok) out.clear();
+    return ok;
+}
+
+bool DPO7000::captureWaveformFileStreaming(int channel,
+                                           const WaveformChunkSink& sink,
+                                           const CaptureProgress& progress,
+                                           const std::atomic<bool>* cancel,
+                                           const QString& format,
+                                           const QString& scopePath,
+                                           int startPoint,
+                                           int stopPoint)
+{
+    const QString quotedPath = saveWaveformOnScope(channel, format, scopePath, startPoint, stopPoint);
+
+    bool ok = queryBinaryStreaming(QString("FILESystem:READFile %1").arg(quotedPath),
+                                   sink, progress, cancel);
+    if (!ok) {
+        qWarning() << "[DPO7000] READFILE streaming failed:" << lastError();
+    }
+
+    // 取消時 payload 已讀完丟棄，連線仍同步，照常刪除儀器端暫存檔
+    sendCommandWithLog(QString("FILESystem:DELEte %1").arg(quotedPath), "[DPO7000]");
+    return ok;
+}
+
 bool DPO7000::captureWaveformFileToHost(int channel,
                                         const QString& hostFilePath,
                                         const QString& format,
                                         const QString& scopePath,
                                         int startPoint,
-                                        int stopPoint)
+                                        int stopPoint,
+                                        const CaptureProgress& progress,
+                                        const std::atomic<bool>* cancel)
 {
-    QByteArray fileBytes = captureWaveformFile(channel, format, scopePath, startPoint, stopPoint);
-    if (fileBytes.isEmpty()) return false;
-
-    QFile f(hostFilePath);
-    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    QSaveFile f(hostFilePath);
+    if (!f.open(QIODevice::WriteOnly)) {
         qWarning() << "[DPO7000] open host file failed:" << hostFilePath;
         return false;
     }
-    f.write(fileBytes);
+
+    auto sink = [&f](const char* data, int len) {
+        return f.write(data, len) == len;
+    };
+
+    if (!captureWaveformFileStreaming(channel, sink, progress, cancel,
+                                      format, scopePath, startPoint, stopPoint)) {
+        f.cancelWriting();
+        return false;
+    }
+
+    if (!f.commit()) {
+        qWarning() << "[DPO7000] commit host file failed:" << hostFilePath << f.errorString();
+        return false;
+    }
     return true;
 }
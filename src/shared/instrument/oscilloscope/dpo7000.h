@@ -16,6 +16,8 @@ public:
     void setTimebase(double timePerDiv) override;
     void setChannelScale(int channel, double voltsPerDiv) override;
     void setTriggerLevel(double level) override;
+    // 同 setTriggerLevel，寫入失敗回傳 false（錯誤見 lastError()）
+    bool applyTriggerLevel(double level);
 
     // === 選擇性實作的函數 ===
     void setChannelPosition(int channel, double position) override;
@@ -26,6 +28,7 @@ public:
     void setTriggerSource(const QString& source) override;
     void setTriggerType(const QString& type) override;
     void setTriggerSlope(const QString& slope) override;
+    void reset() override;
     void autoSetup() override;
     void run() override;
     void stop() override;
@@ -47,10 +50,26 @@ public:
     double getTimebase() override;
     bool isRunning() override;  // 查詢是否運行
 
+    // 一次查詢時基、觸發與 CH1~CH4 的設定（約 20 個欄位）
+    bool refreshStateCache() override;
+
     // === 狀態查詢方法（半自動觸發必需） ===
     QString getAcquisitionState() override;
     QString getTriggerState() override;
     QString getStopAfterMode()override;
+    // Single 擷取並等它完成：SRQ 可用時等 *OPC 發出的 Service Request，否則以一次 *OPC? 阻塞查詢
+    // 回傳 1 = 已觸發擷取、0 = timeoutMs 內沒有觸發（擷取已停止，遲到的完成通知已收掉）、-1 = 通訊失敗
+    int acquireSingle(int timeoutMs, bool useSrq);
+
+    // === 背景狀態監控 ===
+    // 一次往返取得擷取 / 觸發狀態與觸發電平（ACQuire:STATE?;:TRIGger:STATE?;:TRIGger:A:LEVel?）
+    bool queryStatusSnapshot(bool& running, QString& triggerState, double& triggerLevel);
+    // SRQ：*ESE 1（OPC）+ *SRE 32（ESB）；傳輸層不支援 SRQ 時回傳 false，由呼叫端改用輪詢
+    bool enableServiceRequest();
+    // 收到 SRQ 回傳 true（並以 *ESR? 清除事件暫存器），逾時或不支援回傳 false
+    bool waitForServiceRequest(int timeoutMs);
+    // 待處理的操作（例如 Single 擷取）完成時設定 OPC 位元，搭配 SRQ 通知
+    void armOperationComplete();
 
     // === 系統操作方法 ===
     bool waitForOperationComplete(int timeoutMs = 5000) override;
@@ -58,6 +77,17 @@ public:
     void clearErrors() override;
     double measureSignalPeak(int channel, const QString& measureType = "MAXimum") override;
 
+    // === 波形擷取（CURVe? 二進位） ===
+    bool acquireWaveform(int channel, WaveformData& out,
+                         int startPoint = -1, int stopPoint = -1) override;
+    bool acquireWaveforms(const QVector<int>& channels, QVector<WaveformData>& out,
+                          int startPoint = -1, int stopPoint = -1,
+                          QVector<WaveformTransferStats>* stats = nullptr) override;
+
+    // 每點位元組數：1 = RIBinary int8，2 = SRIbinary int16（預設，保留高解析度模式的精度）
+    void setCurveBytesPerPoint(int bytes) { m_curveBytesPerPoint = (bytes == 1) ? 1 : 2; }
+    int curveBytesPerPoint() const { return m_curveBytesPerPoint; }
+
     // === DPO7000 專用方法 ===
     // 抓取完整波形檔（CSV/WFM/ISF）為位元流
     QByteArray captureWaveformFile(int channel,
@@ -65,14 +95,63 @@ public:
                                    const QString& scopePath = "E:\\temp\\wave.csv",
                                    int startPoint = -1, int stopPoint = -1);
 
-    // 直接存檔到主機檔案系統
+    using WaveformChunkSink = IeeeBlockReader::ChunkSink;
+    using CaptureProgress = IeeeBlockReader::ProgressFn;
+
+    // 串流抓取：每收到一段就交給 sink，記憶體只用固定大小緩衝區（與記錄長度無關）
+    bool captureWaveformFileStreaming(int channel,
+                                      const WaveformChunkSink& sink,
+                                      const CaptureProgress& progress = CaptureProgress(),
+                                      const std::atomic<bool>* cancel = nullptr,
+                                      const QString& format = "CSV",
+                                      const QString& scopePath = "E:\\temp\\wave.csv",
+                                      int startPoint = -1, int stopPoint = -1);
+
+    // 直接串流存檔到主機檔案系統（完成才取代目標檔，失敗或取消不留下殘檔）
     bool captureWaveformFileToHost(int channel,
                                    const QString& hostFilePath,
                                    const QString& format = "CSV",
                                    const QString& scopePath = "E:\\temp\\wave.csv",
-                                   int startPoint = -1, int stopPoint = -1);
+                                   int startPoint = -1, int stopPoint = -1,
+                                   const CaptureProgress& progress = CaptureProgress(),
+                                   const std::atomic<bool>* cancel = nullptr);
 
 
 private:
+    static constexpr int channelCount = 4;
+
+    // 送出設定並更新快取：成功才寫入 value；失敗或 value 為空（儀器會捨入 / 夾限的數值）時作廢該欄位
+    bool writeSetting(const QString& cmd, const QString& key, const QString& value = QString());
+
+    // 快取 → 批次更新 → 單獨查詢，依序嘗試；成功時 value 為去除標頭後的回應
+    bool cachedString(const QString& key, const QString& query, QString& value);
+    bool cachedDouble(const QString& key, const QString& query, double& value);
+
+    // WFMOutpre? 換算參數
+    struct WaveformPreamble {
+        int bytesPerPoint = 1;
+        int numPoints = 0;
+        double xIncr = 0.0;
+        double xZero = 0.0;
+        double ptOff = 0.0;
+        double yMult = 0.0;
+        double yOff = 0.0;
+        double yZero = 0.0;
+        double timeScale = 0.0;     // HORizontal:SCALe?
+        double channelScale = 0.0;  // CH<x>:SCALe?
+    };
+
+    bool setupCurveTransfer(int startPoint, int stopPoint);
+    static bool parsePreamble(const QByteArray& text, WaveformPreamble& pre);
+    bool fetchChannelCurve(int channel, WaveformData& out, WaveformPreamble& pre,
+                           qint64* transferredBytes);
+    static void convertCurve(const char* raw, int numPoints,
+                             const WaveformPreamble& pre, WaveformData& out);
+
+    // 在儀器端存成檔案，回傳加上引號的儀器端路徑
+    QString saveWaveformOnScope(int channel, const QString& format, const QString& scopePath,
+                                int startPoint, int stopPoint);
+
     QString m_triggerType = "EDGE";
+    int m_curveBytesPerPoint = 2;
 };
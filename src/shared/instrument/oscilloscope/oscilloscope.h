@@ -3,6 +3,7 @@
 
 #pragma once
 #include "../InstrumentWithCommBase.h"
+#include "scopestatecache.h"
 #include <QString>
 #include <QList>
 #include <QVector>
@@ -24,6 +25,14 @@ struct WaveformData {
     WaveformData() : channel(1), sampleRate(0), timeBase(0), voltageScale(0), recordLength(0) {}
 };
 
+// 單一通道的傳輸統計
+struct WaveformTransferStats {
+    int channel = 0;
+    qint64 bytes = 0;
+    qint64 elapsedUs = 0;
+    double mbPerSec = 0.0;
+};
+
 // 可擴充的示波器抽象父類
 class Oscilloscope : public InstrumentWithCommBase {
 
@@ -41,6 +50,25 @@ public:
 
     // 基本擷取功能
     virtual QByteArray captureScreenshot(const QString& format) { return QByteArray(); }
+    // 直接以二進位傳輸擷取波形並換算成電壓/時間（不經儀器端檔案）
+    // startPoint / stopPoint <= 0 表示整筆記錄（點數由 1 起算）
+    virtual bool acquireWaveform(int channel, WaveformData& out,
+                                 int startPoint = -1, int stopPoint = -1) { return false; }
+
+    // 多通道：同一次擷取（停止狀態）的多個通道，回傳點數與時間軸對齊的一組波形
+    // 預設逐通道呼叫 acquireWaveform（不保證同一次觸發），各機型可 override
+    virtual bool acquireWaveforms(const QVector<int>& channels, QVector<WaveformData>& out,
+                                  int startPoint = -1, int stopPoint = -1,
+                                  QVector<WaveformTransferStats>* stats = nullptr) {
+        out.clear();
+        if (stats) stats->clear();
+        for (int ch : channels) {
+            WaveformData wf;
+            if (!acquireWaveform(ch, wf, startPoint, stopPoint)) return false;
+            out.append(wf);
+        }
+        return true;
+    }
     virtual void setTimebase(double timePerDiv) {}
     virtual void setChannelScale(int channel, double Div) {}
     virtual void setTriggerLevel(double level) {}
@@ -65,6 +93,7 @@ public:
     virtual void setTriggerCoupling(const QString& coupling) {}
 
     // 控制功能
+    virtual void reset() {}         // *RST
     virtual void autoSetup() {}
     virtual void automode() {}
     virtual void run() {}
@@ -96,12 +125,17 @@ public:
     virtual QString getStopAfterMode() { return ""; }
     virtual bool isRunning(){ return false; }
 
-
+    // === 設定狀態快取 ===
+    // 查詢類 getter 在期限內直接回傳快取；前面板可能被操作過時（重新交給 controller）先整份作廢
+    void invalidateStateCache() { m_stateCache.invalidateAll(); }
+    // 以一次複合查詢更新整份快取；不支援的機型回傳 false
+    virtual bool refreshStateCache() { return false; }
 
 
 protected:
     // 成員變數
     int m_currentChannel = 1;
+    ScopeStateCache m_stateCache;
 
 };
 
@@ -0,0 +1,57 @@
+#include "scopestatecache.h"
+
+ScopeStateCache::ScopeStateCache()
+{
+    m_clock.start();
+}
+
+void ScopeStateCache::setStalenessMs(int ms)
+{
+    QMutexLocker locker(&m_mutex);
+    m_stalenessMs = qMax(0, ms);
+}
+
+int ScopeStateCache::stalenessMs() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stalenessMs;
+}
+
+bool ScopeStateCache::lookup(const QString& key, QString& value) const
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_stalenessMs <= 0) return false;
+
+    auto it = m_entries.constFind(key);
+    if (it == m_entries.constEnd()) return false;
+    if (m_clock.elapsed() - it->stampMs > m_stalenessMs) return false;
+
+    value = it->value;
+    return true;
+}
+
+void ScopeStateCache::store(const QString& key, const QString& value)
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.insert(key, Entry{value, m_clock.elapsed()});
+}
+
+void ScopeStateCache::storeAll(const QHash<QString, QString>& values)
+{
+    QMutexLocker locker(&m_mutex);
+    const qint64 now = m_clock.elapsed();
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it)
+        m_entries.insert(it.key(), Entry{it.value(), now});
+}
+
+void ScopeStateCache::invalidate(const QString& key)
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.remove(key);
+}
+
+void ScopeStateCache::invalidateAll()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+}
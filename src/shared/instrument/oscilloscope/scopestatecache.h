@@ -0,0 +1,39 @@
+#pragma once
+#include <QHash>
+#include <QString>
+#include <QMutex>
+#include <QElapsedTimer>
+
+// 示波器設定的影子狀態：key 為設定名稱（例如 "HOR:SCALE"、"CH1:STATE"），value 為儀器回應的文字
+// setter 寫入時同步更新（write-through），批次查詢一次填滿；讀取在 staleness 期限內直接回傳快取
+// autoSetup / *RST 等會整體改變設定的操作必須 invalidateAll()
+// 可跨執行緒使用（GUI、狀態監控、半自動觸發 worker）
+class ScopeStateCache
+{
+public:
+    ScopeStateCache();
+
+    // 0 = 停用快取，每次讀取都重新查詢
+    void setStalenessMs(int ms);
+    int stalenessMs() const;
+
+    // 在期限內有值回傳 true
+    bool lookup(const QString& key, QString& value) const;
+
+    void store(const QString& key, const QString& value);
+    void storeAll(const QHash<QString, QString>& values);
+
+    void invalidate(const QString& key);
+    void invalidateAll();
+
+private:
+    struct Entry {
+        QString value;
+        qint64 stampMs = 0;
+    };
+
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+    QElapsedTimer m_clock;
+    int m_stalenessMs = 2000;
+};
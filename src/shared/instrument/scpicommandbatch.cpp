@@ -0,0 +1,134 @@
+#include "scpicommandbatch.h"
+#include "writtenstatecache.h"
+#include <QDebug>
+
+ScpiCommandBatch::ScpiCommandBatch(ICommunication* comm, int maxMessageLength)
+    : m_comm(comm), m_maxMessageLength(maxMessageLength), m_opcReader(comm, 256) {}
+
+void ScpiCommandBatch::append(const QByteArray& command)
+{
+    QByteArray cmd = command.trimmed();
+    if (cmd.isEmpty()) return;
+
+    // 不支援複合指令：維持原本逐筆送出的行為
+    if (m_maxMessageLength <= 0) {
+        send(cmd);
+        return;
+    }
+
+    // 共通指令 (*xxx) 與已指定 root 的指令不需補 ':'
+    auto piece = [&cmd](bool first) -> QByteArray {
+        if (first || cmd.startsWith('*') || cmd.startsWith(':')) return cmd;
+        QByteArray rooted(":");
+        rooted.append(cmd);
+        return rooted;
+    };
+
+    QByteArray next = piece(m_message.isEmpty());
+    if (!m_message.isEmpty() && m_message.size() + 1 + next.size() > m_maxMessageLength) {
+        // 超過儀器輸入緩衝長度，先送出目前累積的部分
+        send(m_message);
+        m_message.clear();
+        m_pending = 0;
+        next = piece(true);
+    }
+
+    if (!m_message.isEmpty()) m_message.append(';');
+    m_message.append(next);
+    m_pending++;
+}
+
+void ScpiCommandBatch::recordOnFlush(int channel, const QString& key, const QString& command)
+{
+    m_stateUpdates.append({ channel, key, command });
+}
+
+void ScpiCommandBatch::invalidateOnFlush(int channel)
+{
+    m_stateUpdates.append({ channel, QString(), QString() });
+}
+
+bool ScpiCommandBatch::flush(bool waitForOpc)
+{
+    // append 途中（逐筆模式或自動分段）已送出失敗的也要回報
+    bool ok = !m_failed;
+    m_failed = false;
+
+    if (waitForOpc) {
+        m_opcReader.discardPending();
+        // *OPC? 併入同一訊息，一次傳輸同時完成設定與確認
+        if (m_maxMessageLength > 0 && !m_message.isEmpty()
+            && m_message.size() + 6 <= m_maxMessageLength) {
+            m_message.append(";*OPC?");
+        } else {
+            if (!m_message.isEmpty()) ok = send(m_message);
+            m_message = "*OPC?";
+        }
+    }
+
+    if (!m_message.isEmpty()) {
+        ok = send(m_message) && ok;
+        m_message.clear();
+        m_pending = 0;
+    }
+
+    if (waitForOpc && ok) {
+        QByteArray resp;
+        if (!m_opcReader.readResponse(resp) || resp.trimmed() != "1") {
+            m_error = QString("*OPC? barrier failed: '%1' %2")
+                          .arg(QString::fromLatin1(resp.trimmed()), m_opcReader.lastError());
+            qWarning() << "[ScpiCommandBatch]" << m_error;
+            invalidateWrittenState();
+            return false;
+        }
+    }
+
+    if (ok) {
+        m_error.clear();
+        applyStateUpdates();
+    } else {
+        invalidateWrittenState();
+    }
+    return ok;
+}
+
+void ScpiCommandBatch::applyStateUpdates()
+{
+    WrittenStateCache* state = m_comm ? m_comm->writtenState() : nullptr;
+    if (state) {
+        for (const auto& update : m_stateUpdates) {
+            if (update.key.isEmpty()) state->invalidateChannel(update.channel);
+            else state->record(update.channel, update.key, update.command);
+        }
+    }
+    m_stateUpdates.clear();
+}
+
+// 批次內的設定不確定是否已生效，驅動程式記錄的已寫入狀態全部作廢
+void ScpiCommandBatch::invalidateWrittenState()
+{
+    m_stateUpdates.clear();
+    if (m_comm) {
+        if (WrittenStateCache* state = m_comm->writtenState())
+            state->invalidateAll();
+    }
+}
+
+bool ScpiCommandBatch::send(const QByteArray& message)
+{
+    if (!m_comm) {
+        m_failed = true;
+        m_error = "Batch flush failed: no communication object";
+        qWarning() << "[ScpiCommandBatch]" << m_error;
+        return false;
+    }
+    m_transactions++;
+    if (m_comm->write(message) < 0) {
+        m_failed = true;
+        m_error = QString("Batch write failed: %1 [%2]")
+                      .arg(m_comm->lastError(), QString::fromLatin1(message.left(64)));
+        qWarning() << "[ScpiCommandBatch]" << m_error;
+        return false;
+    }
+    return true;
+}
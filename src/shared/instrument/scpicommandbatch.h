@@ -0,0 +1,52 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include "icommunication.h"
+#include "scpiresponsereader.h"
+
+// SCPI 指令批次：收集多筆設定指令，flush 時以分號串接成一個 program message 送出
+// 後續指令自動補上 ':'（回到 root），避免被解析為前一指令的子節點
+// 同一台 mainframe 的多個通道物件可 attach 同一個 batch，整台設定合併成一兩次傳輸
+class ScpiCommandBatch
+{
+public:
+    // maxMessageLength <= 0 表示儀器不支援複合指令，append 時直接逐筆送出
+    explicit ScpiCommandBatch(ICommunication* comm, int maxMessageLength = 0);
+
+    void append(const QByteArray& command);
+
+    // 已寫入狀態的更新等 flush 成功才套用（依加入順序），失敗時捨棄
+    void recordOnFlush(int channel, const QString& key, const QString& command);
+    void invalidateOnFlush(int channel);
+
+    // 送出尚未送出的指令；waitForOpc = true 時在訊息尾端加上 *OPC? 並等待儀器回 1
+    bool flush(bool waitForOpc = false);
+
+    bool isEmpty() const           { return m_message.isEmpty(); }
+    int pendingCount() const       { return m_pending; }
+    int transactionCount() const   { return m_transactions; }  // 實際匯流排寫入次數
+    QString lastError() const      { return m_error; }
+    ICommunication* communication() const { return m_comm; }
+
+private:
+    bool send(const QByteArray& message);
+    void invalidateWrittenState();
+    void applyStateUpdates();
+
+    struct StateUpdate {
+        int channel = 0;
+        QString key;            // 空字串 = 作廢整個通道
+        QString command;
+    };
+
+    ICommunication* m_comm = nullptr;
+    int m_maxMessageLength = 0;
+    QByteArray m_message;
+    int m_pending = 0;
+    int m_transactions = 0;
+    bool m_failed = false;      // 上次 flush 之後是否有傳送失敗
+    ScpiResponseReader m_opcReader;   // *OPC? 回應可能分段到達
+    QVector<StateUpdate> m_stateUpdates;
+    QString m_error;
+};
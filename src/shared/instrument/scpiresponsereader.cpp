@@ -0,0 +1,154 @@
+#include "scpiresponsereader.h"
+#include <QElapsedTimer>
+#include <QDebug>
+#include <cstring>
+
+ScpiResponseReader::ScpiResponseReader(ICommunication* comm, int capacity)
+    : m_comm(comm)
+{
+    int cap = 256;
+    while (cap < capacity && cap < maxCapacity) cap <<= 1;
+    m_ring.resize(cap);
+    m_mask = cap - 1;
+}
+
+void ScpiResponseReader::setCommunication(ICommunication* comm)
+{
+    m_comm = comm;
+    discardPending();
+}
+
+void ScpiResponseReader::setFraming(Framing framing, int fixedLength)
+{
+    m_framing = framing;
+    m_fixedLength = qMax(0, fixedLength);
+    m_scanned = 0;
+}
+
+void ScpiResponseReader::discardPending()
+{
+    if (m_count > 0)
+        qDebug() << "[ScpiResponseReader] Discard" << m_count << "stale bytes";
+    m_head = 0;
+    m_count = 0;
+    m_scanned = 0;
+    m_ended = false;
+}
+
+bool ScpiResponseReader::fail(const QString& msg)
+{
+    m_error = msg;
+    qWarning() << "[ScpiResponseReader]" << m_error;
+    return false;
+}
+
+bool ScpiResponseReader::readResponse(QByteArray& out)
+{
+    out.resize(0);
+    if (!m_comm) return fail("No communication object");
+    if (m_framing == Framing::Length && m_fixedLength <= 0)
+        return fail("Length framing without a length");
+
+    QElapsedTimer clock;
+    clock.start();
+    const int budgetMs = m_comm->timeout();
+
+    for (;;) {
+        const int consume = findFrameEnd();
+        if (consume >= 0) {
+            take(consume, out);
+            m_error.clear();
+            return true;
+        }
+
+        if (clock.elapsed() >= budgetMs) {
+            return fail(QString("Response timeout after %1 ms, %2 bytes received without terminator")
+                            .arg(budgetMs).arg(m_count));
+        }
+        if (!fill()) return false;
+    }
+}
+
+int ScpiResponseReader::findFrameEnd()
+{
+    switch (m_framing) {
+    case Framing::Length:
+        return m_count >= m_fixedLength ? m_fixedLength : -1;
+
+    case Framing::Eoi:
+        return (m_ended && m_count > 0) ? m_count : -1;
+
+    case Framing::Terminator:
+    default:
+        // 只掃描上次之後新進來的資料
+        for (int i = m_scanned; i < m_count; ++i) {
+            if (m_ring.at((m_head + i) & m_mask) == m_terminator)
+                return i + 1;
+        }
+        m_scanned = m_count;
+        // GPIB：儀器以 EOI 結束但未送終止字元
+        return (m_ended && m_count > 0) ? m_count : -1;
+    }
+}
+
+void ScpiResponseReader::take(int len, QByteArray& out)
+{
+    // 最多分兩段複製（資料跨越環形緩衝區尾端時）
+    out.resize(len);
+    const int first = qMin(len, m_ring.size() - m_head);
+    memcpy(out.data(), m_ring.constData() + m_head, first);
+    if (len > first)
+        memcpy(out.data() + first, m_ring.constData(), len - first);
+
+    m_head = (m_head + len) & m_mask;
+    m_count -= len;
+    m_scanned = 0;
+    if (m_count == 0) {
+        m_head = 0;
+        m_ended = false;
+    }
+
+    // 去掉結尾的終止字元 / CR（固定長度回應原樣交出）
+    if (m_framing != Framing::Length) {
+        while (!out.isEmpty() && (out.endsWith(m_terminator) || out.endsWith('\r') || out.endsWith('\n')))
+            out.chop(1);
+    }
+}
+
+void ScpiResponseReader::grow()
+{
+    // 依序搬到新緩衝區，head 歸零；m_scanned 是相對 head 的位置，不受影響
+    const int cap = m_ring.size() * 2;
+    QByteArray bigger(cap, Qt::Uninitialized);
+    const int first = qMin(m_count, m_ring.size() - m_head);
+    memcpy(bigger.data(), m_ring.constData() + m_head, first);
+    if (m_count > first)
+        memcpy(bigger.data() + first, m_ring.constData(), m_count - first);
+
+    m_ring.swap(bigger);
+    m_mask = cap - 1;
+    m_head = 0;
+    qDebug() << "[ScpiResponseReader] Ring buffer grown to" << cap << "bytes";
+}
+
+bool ScpiResponseReader::fill()
+{
+    // 單次讀取受通訊層逾時限制，整體時間由 readResponse 把關
+    if (m_count == m_ring.size()) {
+        if (m_ring.size() >= maxCapacity)
+            return fail(QString("Response exceeds %1 bytes without terminator").arg(maxCapacity));
+        grow();
+    }
+
+    // 讀進 tail 之後連續的空間
+    const int tail = (m_head + m_count) & m_mask;
+    const int span = (tail >= m_head) ? m_ring.size() - tail : m_head - tail;
+
+    int n = m_comm->readInto(m_ring.data() + tail, span);
+    if (n <= 0)
+        return fail("Read failed: " + m_comm->lastError());
+
+    m_count += n;
+    m_ended = m_comm->lastReadEndedMessage();
+    return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include "icommunication.h"
+
+// SCPI 文字回應的分框讀取：
+// TCP / Serial 的回應可能分成好幾段到達，單次 read() 會拿到半個數字或被截斷的字串；
+// 這裡持續累積到框結束條件成立才交出完整回應。
+// 資料收在固定容量的環形緩衝區，回應較長時才倍增一次，平常查詢不會重新配置記憶體。
+class ScpiResponseReader
+{
+public:
+    enum class Framing {
+        Terminator,   // 讀到終止字元（預設 LF）；GPIB 收到 EOI 也視為結束
+        Eoi,          // 只依通訊層的訊息結束（GPIB EOI），不看內容
+        Length        // 固定長度的回應
+    };
+
+    explicit ScpiResponseReader(ICommunication* comm = nullptr, int capacity = defaultCapacity);
+
+    void setCommunication(ICommunication* comm);
+    void setFraming(Framing framing, int fixedLength = 0);
+    void setTerminator(char terminator) { m_terminator = terminator; }
+
+    // 讀一個完整回應（不含終止字元與結尾 CR）；out 重複使用時不會重新配置
+    // 整個回應共用一個逾時（通訊層 timeout()），不因資料斷續到達而延長
+    bool readResponse(QByteArray& out);
+
+    // 丟棄緩衝區中尚未取走的資料（例如前一個逾時查詢晚到的回應）
+    void discardPending();
+    int pending() const { return m_count; }
+
+    QString lastError() const { return m_error; }
+
+private:
+    bool fill();
+    int findFrameEnd();
+    void take(int len, QByteArray& out);
+    void grow();
+    bool fail(const QString& msg);
+
+    ICommunication* m_comm = nullptr;
+    Framing m_framing = Framing::Terminator;
+    char m_terminator = '\n';
+    int m_fixedLength = 0;
+
+    QByteArray m_ring;       // 容量固定為 2 的次方
+    int m_mask = 0;
+    int m_head = 0;          // 第一個未取走的 byte
+    int m_count = 0;         // 緩衝區內資料量
+    int m_scanned = 0;       // 已找過終止字元的長度，新資料到達時只掃描新的部分
+    bool m_ended = false;    // 通訊層回報訊息結束
+
+    QString m_error;
+
+    static const int defaultCapacity = 4096;
+    static const int maxCapacity = 1 << 20;   // 超過表示不是文字回應（應改用 queryBinary）
+};
@@ -5,11 +5,67 @@
 #include "page1viewmodel.h"
 #include "page2viewmodel.h"
 #include "page3viewmodel.h"
+#include "scopestatusmonitor.h"
 #include <QFile>
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QPointer>
+#include <QTimer>
 #include <QDebug>
 
+namespace {
+// 背景執行緒解析的結果；只套用檔案裡有的頁面
+struct LoadedConfig
+{
+    bool opened = false;
+    QString error;
+    bool hasPage1 = false;
+    Page1Config page1;
+    bool hasPage2 = false;
+    Page2Model::Tables page2;
+    bool hasPage3 = false;
+    Page3Model::XmlState page3;
+};
+
+LoadedConfig parseConfigFile(const QString& fileName, const Page3Model::XmlState& page3Base)
+{
+    LoadedConfig loaded;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        loaded.error = file.errorString();
+        return loaded;
+    }
+    loaded.opened = true;
+
+    QXmlStreamReader reader(&file);
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (!reader.isStartElement()) continue;
+
+        if (reader.name() == "Page1") {
+            loaded.page1 = Page1Model::readConfigXml(reader);
+            loaded.hasPage1 = true;
+        }
+        else if (reader.name() == "Page2") {
+            loaded.page2 = Page2Model::readTablesXml(reader);
+            loaded.hasPage2 = true;
+        }
+        else if (reader.name() == "Page3") {
+            loaded.page3 = Page3Model::readStateXml(reader, page3Base);
+            loaded.hasPage3 = true;
+        }
+    }
+
+    // 與原本相同：格式錯誤之前已讀到的頁面照樣套用
+    if (reader.hasError()) {
+        loaded.error = reader.errorString();
+    }
+    return loaded;
+}
+}
+
 AppService& AppService::instance()
 {
     static AppService instance;
@@ -43,6 +99,10 @@ void AppService::connectPage1ToPage2(Page1ViewModel* vm1, Page2ViewModel* vm2)
 
     connect(vm1, &Page1ViewModel::relayOutputsChanged,
             vm2, &Page2ViewModel::setMaxRelayOutput);
+
+    // Page1 Load 通道的子型號供 Page2 檢查檔位 / OPP
+    connect(vm1, &Page1ViewModel::configUpdated,
+            vm2, &Page2ViewModel::setLoadSubModels);
 }
 
 void AppService::connectPage1ToPage3(Page1ViewModel* vm1, Page3ViewModel* vm3)
@@ -58,79 +118,145 @@ void AppService::connectPage2ToPage3(Page2ViewModel* vm2, Page3ViewModel* vm3)
     connect(vm2, &Page2ViewModel::TitleListChanged,
             vm3, &Page3ViewModel::updateTitles);
 
-    // Page2 tbl_input、tbl_load、tbl_Dynamic 連動 Page3
-    connect(vm2, &Page2ViewModel::inputRowsStructChanged,
-            vm3, &Page3ViewModel::onInputDataChanged);
-    connect(vm2, &Page2ViewModel::loadMetaStructChanged,
-            vm3, &Page3ViewModel::onLoadMetaChanged);
-    connect(vm2, &Page2ViewModel::loadRowsStructChanged,
-            vm3, &Page3ViewModel::onLoadRowsChanged);
-    connect(vm2, &Page2ViewModel::dynamicMetaStructChanged,
-            vm3, &Page3ViewModel::onDynamicMetaChanged);
-    connect(vm2, &Page2ViewModel::dynamicRowsStructChanged,
-            vm3, &Page3ViewModel::onDynamicRowsChanged);
+    // Page2 tbl_input、tbl_load、tbl_Dynamic 連動 Page3（共用同一份不可變快照）
+    connect(vm2, &Page2ViewModel::recipeSnapshotChanged,
+            vm3, &Page3ViewModel::onRecipeSnapshotChanged);
 }
 
 void AppService::saveAllToXml(const QString& fileName,
                               Page1* page1, Page2* page2, Page3* page3,
                               Page1ViewModel* vm1, Page2ViewModel* vm2, Page3ViewModel* vm3)
 {
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qWarning() << "Failed to open file for writing:" << fileName;
+    const SaveTarget target = { fileName, page1, page2, page3, vm1, vm2, vm3 };
+    if (m_pendingLoads > 0) {
+        // 載入的結果還在排隊，現在擷取會存到舊設定
+        qDebug() << "[AppService] Save of" << fileName << "deferred until load is applied";
+        m_deferredSaves.append(target);
         return;
     }
+    saveTarget(target);
+}
 
-    QXmlStreamWriter writer(&file);
-    writer.setAutoFormatting(true);
+void AppService::saveTarget(const SaveTarget& target)
+{
+    startSave(target.fileName,
+              collectSections(target.page1, target.page2, target.page3,
+                              target.vm1, target.vm2, target.vm3));
+}
 
-    writer.writeStartDocument();
-    writer.writeStartElement("loodGUI");
+void AppService::loadAllFromXml(const QString& fileName,
+                                Page1ViewModel* vm1, Page2ViewModel* vm2, Page3ViewModel* vm3)
+{
+    // 前一次載入的結果要先套用完，順序才不會顛倒
+    m_loadFuture.waitForFinished();
 
-    // 同步 UI 到 ViewModel
-    if (page1) page1->syncUIToViewModel();
-    if (page2) page2->syncUIToViewModel();
-    if (page3) page3->syncUIToViewModel();
+    const Page3Model::XmlState page3Base = vm3 ? vm3->xmlState() : Page3Model::XmlState();
+    QPointer<Page1ViewModel> p1(vm1);
+    QPointer<Page2ViewModel> p2(vm2);
+    QPointer<Page3ViewModel> p3(vm3);
+
+    ++m_pendingLoads;
+    m_loadFuture = QtConcurrent::run([this, fileName, page3Base, p1, p2, p3]() {
+        const LoadedConfig loaded = parseConfigFile(fileName, page3Base);
+        if (!loaded.opened) {
+            qWarning() << "Failed to open file for reading:" << fileName << loaded.error;
+        } else if (!loaded.error.isEmpty()) {
+            qWarning() << "[AppService] XML error in" << fileName << ":" << loaded.error;
+        }
 
-    // 寫入 XML
-    if (vm1) vm1->writeXml(writer);
-    if (vm2) vm2->writeXml(writer);
-    if (vm3) vm3->writeXml(writer);
+        // 套用會觸發頁面間的連動與 UI 更新，回到 GUI 執行緒依檔案順序進行
+        // 開檔失敗也要回到 GUI 執行緒結束這次載入，延後的存檔才會執行
+        QMetaObject::invokeMethod(this, [this, loaded, p1, p2, p3]() {
+            if (loaded.hasPage1 && p1) p1->applyLoadedConfig(loaded.page1);
+            if (loaded.hasPage2 && p2) p2->applyLoadedTables(loaded.page2);
+            if (loaded.hasPage3 && p3) p3->applyLoadedState(loaded.page3);
+            finishLoad();
+        }, Qt::QueuedConnection);
+    });
+}
 
-    writer.writeEndElement(); // loodGUI
-    writer.writeEndDocument();
-    file.close();
+void AppService::finishLoad()
+{
+    if (--m_pendingLoads > 0) return;   // 還有更新的載入排在後面
+
+    const QVector<SaveTarget> saves = m_deferredSaves;
+    m_deferredSaves.clear();
+    for (const auto& target : saves) {
+        saveTarget(target);
+    }
 }
 
-void AppService::loadAllFromXml(const QString& fileName,
-                                Page1ViewModel* vm1, Page2ViewModel* vm2, Page3ViewModel* vm3)
+void AppService::startAutosave(const QString& fileName, int intervalMs,
+                               Page1* page1, Page2* page2, Page3* page3,
+                               Page1ViewModel* vm1, Page2ViewModel* vm2, Page3ViewModel* vm3)
 {
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "Failed to open file for reading:" << fileName;
+    if (fileName.isEmpty() || intervalMs <= 0) {
+        stopAutosave();
         return;
     }
 
-    QXmlStreamReader reader(&file);
+    m_autosave = { fileName, page1, page2, page3, vm1, vm2, vm3 };
+    if (!m_autosaveTimer) {
+        m_autosaveTimer = new QTimer(this);
+        connect(m_autosaveTimer, &QTimer::timeout, this, &AppService::autosave);
+    }
+    m_autosaveTimer->start(intervalMs);
+}
 
-    while (!reader.atEnd()) {
-        reader.readNext();
-        if (reader.isStartElement()) {
-            if (reader.name() == "Page1" && vm1) {
-                vm1->loadXml(reader);
-            }
-            else if (reader.name() == "Page2" && vm2) {
-                vm2->loadXml(reader);
-            }
-            else if (reader.name() == "Page3" && vm3) {
-                vm3->loadXml(reader);
-            }
+void AppService::stopAutosave()
+{
+    if (m_autosaveTimer) m_autosaveTimer->stop();
+    m_autosave = SaveTarget();
+}
+
+void AppService::waitForPendingIo()
+{
+    m_saveFuture.waitForFinished();
+    m_loadFuture.waitForFinished();
+}
+
+void AppService::autosave()
+{
+    // 上一次還沒寫完、或載入還沒套用就跳過這一輪，不讓 GUI 執行緒等待
+    if (m_autosave.fileName.isEmpty() || m_saveFuture.isRunning() || m_pendingLoads > 0) return;
+
+    saveTarget(m_autosave);
+}
+
+// GUI 執行緒：同步 UI 到 ViewModel，並擷取各頁面的資料副本
+QVector<ConfigSection> AppService::collectSections(Page1* page1, Page2* page2, Page3* page3,
+                                                   Page1ViewModel* vm1, Page2ViewModel* vm2,
+                                                   Page3ViewModel* vm3)
+{
+    // 同步 UI 到 ViewModel
+    if (page1) page1->syncUIToViewModel();
+    if (page2) page2->syncUIToViewModel();
+    if (page3) page3->syncUIToViewModel();
+
+    QVector<ConfigSection> sections;
+    if (vm1) sections.append(vm1->xmlSection());
+    if (vm2) sections.append(vm2->xmlSection());
+    if (vm3) sections.append(vm3->xmlSection());
+    return sections;
+}
+
+void AppService::startSave(const QString& fileName, const QVector<ConfigSection>& sections)
+{
+    // 存檔依序進行，後一次的內容一定比較新
+    m_saveFuture.waitForFinished();
+
+    m_saveFuture = QtConcurrent::run([this, fileName, sections]() {
+        QString error;
+        if (m_configWriter.write(fileName, sections, error) == ConfigFileWriter::Result::Failed) {
+            qWarning() << "[AppService] Failed to save" << fileName << ":" << error;
         }
-    }
-    file.close();
+    });
 }
 
 void AppService::registerMetaTypes()
 {
     qRegisterMetaType<LoadKind>("LoadKind");
+    qRegisterMetaType<RecipeSnapshotPtr>("RecipeSnapshotPtr");
+    qRegisterMetaType<SequenceStepResult>("SequenceStepResult");
+    qRegisterMetaType<ScopeStatus>("ScopeStatus");
 }
@@ -2,6 +2,8 @@
 
 #include <QObject>
 #include <QString>
+#include <QFuture>
+#include "configfilewriter.h"
 
 class Page1;
 class Page2;
@@ -9,6 +11,7 @@ class Page3;
 class Page1ViewModel;
 class Page2ViewModel;
 class Page3ViewModel;
+class QTimer;
 
 class AppService : public QObject {
     Q_OBJECT
@@ -21,7 +24,9 @@ public:
                               Page2ViewModel* vm2,
                               Page3ViewModel* vm3);
 
-    // XML 序列化
+    // XML 序列化：UI 同步與擷取資料在 GUI 執行緒，序列化 / 寫檔 / 解析在背景執行緒
+    // 存檔只重新序列化內容有變動的頁面；載入解析完成後回到 GUI 執行緒依 Page1 → Page3 套用
+    // 載入尚未套用前的存檔延到套用之後才擷取內容，不會以舊設定覆蓋正在載入的檔案
     void saveAllToXml(const QString& fileName,
                       Page1* page1, Page2* page2, Page3* page3,
                       Page1ViewModel* vm1, Page2ViewModel* vm2, Page3ViewModel* vm3);
@@ -29,6 +34,14 @@ public:
     void loadAllFromXml(const QString& fileName,
                         Page1ViewModel* vm1, Page2ViewModel* vm2, Page3ViewModel* vm3);
 
+    // 自動存檔：每 intervalMs 存一次，內容沒變時不寫檔
+    void startAutosave(const QString& fileName, int intervalMs,
+                       Page1* page1, Page2* page2, Page3* page3,
+                       Page1ViewModel* vm1, Page2ViewModel* vm2, Page3ViewModel* vm3);
+    void stopAutosave();
+
+    void waitForPendingIo();    // 阻塞直到背景存檔 / 載入結束（關閉程式前呼叫）
+
     // Meta Types 註冊
     void registerMetaTypes();
 
@@ -44,4 +57,32 @@ private:
     void connectPage1ToPage2(Page1ViewModel* vm1, Page2ViewModel* vm2);
     void connectPage1ToPage3(Page1ViewModel* vm1, Page3ViewModel* vm3);
     void connectPage2ToPage3(Page2ViewModel* vm2, Page3ViewModel* vm3);
+
+    // 存檔 / 載入
+    QVector<ConfigSection> collectSections(Page1* page1, Page2* page2, Page3* page3,
+                                           Page1ViewModel* vm1, Page2ViewModel* vm2,
+                                           Page3ViewModel* vm3);
+    void startSave(const QString& fileName, const QVector<ConfigSection>& sections);
+    void autosave();
+    void finishLoad();          // GUI 執行緒：一次載入套用完（或失敗）後呼叫
+
+    struct SaveTarget {
+        QString fileName;
+        Page1* page1 = nullptr;
+        Page2* page2 = nullptr;
+        Page3* page3 = nullptr;
+        Page1ViewModel* vm1 = nullptr;
+        Page2ViewModel* vm2 = nullptr;
+        Page3ViewModel* vm3 = nullptr;
+    };
+    void saveTarget(const SaveTarget& target);
+
+    ConfigFileWriter m_configWriter;
+    QFuture<void> m_saveFuture;
+    QFuture<void> m_loadFuture;
+    int m_pendingLoads = 0;                 // 已開始但尚未在 GUI 執行緒套用完的載入
+    QVector<SaveTarget> m_deferredSaves;    // 載入期間要求的存檔，依序在套用後執行
+
+    SaveTarget m_autosave;
+    QTimer* m_autosaveTimer = nullptr;
 };
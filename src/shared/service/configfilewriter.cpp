@@ -0,0 +1,86 @@
+#include "configfilewriter.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QXmlStreamWriter>
+#include <QDebug>
+
+ConfigFileWriter::Result ConfigFileWriter::write(const QString& fileName,
+                                                 const QVector<ConfigSection>& sections,
+                                                 QString& error)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QVector<QByteArray> parts;
+    parts.reserve(sections.size());
+    Signature signature;
+    int reused = 0;
+
+    for (const auto& section : sections) {
+        auto it = m_fragments.find(section.name);
+        if (it != m_fragments.end() && section.revision != 0 && it->revision == section.revision) {
+            ++reused;
+        } else {
+            QByteArray xml = serialize(section);
+            if (it == m_fragments.end()) {
+                it = m_fragments.insert(section.name, Fragment());
+            }
+            if (it->generation == 0 || it->xml != xml) {
+                it->generation = m_nextGeneration++;
+                it->xml = xml;
+            }
+            it->revision = section.revision;
+        }
+        parts.append(it->xml);
+        signature.append(qMakePair(section.name, it->generation));
+    }
+
+    auto written = m_written.constFind(fileName);
+    if (written != m_written.constEnd() && *written == signature && QFile::exists(fileName)) {
+        return Result::Unchanged;
+    }
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        error = file.errorString();
+        m_written.remove(fileName);
+        return Result::Failed;
+    }
+
+    // 與整份 QXmlStreamWriter（autoFormatting）輸出的內容相同
+    file.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<loodGUI>\n");
+    for (const auto& part : parts) {
+        file.write(part);
+    }
+    file.write("</loodGUI>\n");
+
+    if (!file.commit()) {
+        error = file.errorString();
+        m_written.remove(fileName);
+        return Result::Failed;
+    }
+
+    m_written.insert(fileName, signature);
+    qDebug() << "[ConfigFileWriter] Saved" << fileName << "-" << reused << "of"
+             << sections.size() << "sections reused";
+    return Result::Written;
+}
+
+// 放在 <loodGUI> 底下序列化再去掉外層，縮排與寫在整份文件裡時一致
+QByteArray ConfigFileWriter::serialize(const ConfigSection& section)
+{
+    QByteArray bytes;
+    {
+        QXmlStreamWriter writer(&bytes);
+        writer.setAutoFormatting(true);
+        writer.writeStartElement("loodGUI");
+        if (section.write) section.write(writer);
+        writer.writeEndElement();
+    }
+
+    const int begin = bytes.indexOf('\n');
+    const int end = bytes.lastIndexOf("</loodGUI>");
+    if (begin < 0 || end <= begin) {
+        return QByteArray();    // 區段沒有寫出任何內容
+    }
+    return bytes.mid(begin + 1, end - begin - 1);
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QMutex>
+#include <QVector>
+#include <functional>
+
+class QXmlStreamWriter;
+
+// 設定檔的一個頂層區段（Page1 / Page2 / Page3）
+// write 只讀取建立時擷取的資料副本，可在背景執行緒執行
+struct ConfigSection
+{
+    QString name;
+    quint64 revision = 0;   // 內容有變才遞增；0 = 不追蹤，每次都重新序列化
+    std::function<void(QXmlStreamWriter& writer)> write;
+};
+
+// 以區段為單位寫出 <loodGUI> 設定檔，可在任何執行緒呼叫（內部以 mutex 序列化）
+// revision 沒變的區段直接沿用上次序列化的 XML 片段；與上次寫入同一個檔案的內容完全相同時不寫檔
+// 以 QSaveFile 寫入，中途失敗不會留下寫一半的設定檔
+class ConfigFileWriter
+{
+public:
+    enum class Result { Written, Unchanged, Failed };
+
+    Result write(const QString& fileName, const QVector<ConfigSection>& sections, QString& error);
+
+private:
+    struct Fragment {
+        quint64 revision = 0;
+        quint64 generation = 0;     // 片段內容每變一次就換一個新值
+        QByteArray xml;
+    };
+    using Signature = QList<QPair<QString, quint64>>;   // 區段名稱 → generation
+
+    static QByteArray serialize(const ConfigSection& section);
+
+    QMutex m_mutex;
+    QHash<QString, Fragment> m_fragments;
+    QHash<QString, Signature> m_written;    // 檔名 → 上次成功寫入時的內容
+    quint64 m_nextGeneration = 1;
+};
@@ -0,0 +1,291 @@
+#include "instrumentmetrics.h"
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QTimer>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+
+// ===== LatencyHistogram =====
+
+int LatencyHistogram::bucketOf(quint64 us)
+{
+    if (us < 4) return static_cast<int>(us);
+    const int msb = 63 - qCountLeadingZeroBits(us);
+    const int index = (msb - 1) * 4 + static_cast<int>((us >> (msb - 2)) & 3);
+    return qMin(index, bucketCount - 1);
+}
+
+double LatencyHistogram::bucketMidUs(int index)
+{
+    if (index < 4) return index + 0.5;
+    const int msb = index / 4 + 1;
+    const int frac = index % 4;
+    const double lower = static_cast<double>(quint64(4 + frac) << (msb - 2));
+    const double upper = static_cast<double>(quint64(5 + frac) << (msb - 2));
+    return (lower + upper) / 2.0;
+}
+
+void LatencyHistogram::record(qint64 ns)
+{
+    if (ns < 0) ns = 0;
+    m_buckets[bucketOf(static_cast<quint64>(ns) / 1000)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+
+    quint64 prev = m_maxNs.load(std::memory_order_relaxed);
+    while (static_cast<quint64>(ns) > prev
+           && !m_maxNs.compare_exchange_weak(prev, static_cast<quint64>(ns), std::memory_order_relaxed)) {}
+}
+
+double LatencyHistogram::percentileUs(double p) const
+{
+    const quint64 total = count();
+    if (total == 0) return 0.0;
+    const quint64 target = qMax<quint64>(1, static_cast<quint64>(std::ceil(p * total)));
+
+    quint64 seen = 0;
+    for (int i = 0; i < bucketCount; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) return qMin(bucketMidUs(i), maxUs());
+    }
+    return maxUs();
+}
+
+// ===== EndpointMetrics =====
+
+namespace {
+// SCPI verb：去掉開頭的 ':'，到空白 / ';' / 結尾為止（保留 '?' 以區分查詢）
+void verbRange(const QByteArray& command, int& begin, int& end)
+{
+    const int n = command.size();
+    const char* d = command.constData();
+    begin = 0;
+    while (begin < n && (d[begin] == ':' || d[begin] == ' ' || d[begin] == '\t')) ++begin;
+    end = begin;
+    while (end < n && d[end] != ' ' && d[end] != ';' && d[end] != '\n' && d[end] != '\r' && d[end] != '\t')
+        ++end;
+}
+
+quint64 verbHash(const char* d, int len)
+{
+    quint64 h = 1469598103934665603ULL;   // FNV-1a，不分大小寫
+    for (int i = 0; i < len; ++i) {
+        char c = d[i];
+        if (c >= 'a' && c <= 'z') c -= 32;
+        h ^= static_cast<uchar>(c);
+        h *= 1099511628211ULL;
+    }
+    return h | 1;   // 0 保留給空槽
+}
+}
+
+VerbMetrics* EndpointMetrics::verbSlot(const QByteArray& command)
+{
+    int begin = 0, end = 0;
+    verbRange(command, begin, end);
+    const quint64 h = verbHash(command.constData() + begin, end - begin);
+
+    // 開放定址：以 CAS 佔用空槽，不需上鎖
+    const int usable = verbSlots - 1;
+    for (int probe = 0; probe < usable; ++probe) {
+        VerbMetrics& slot = m_verbs[(h + probe) % usable];
+        quint64 cur = slot.hash.load(std::memory_order_acquire);
+        if (cur == h) return &slot;
+        if (cur == 0) {
+            if (slot.hash.compare_exchange_strong(cur, h, std::memory_order_acq_rel)) {
+                const int len = qMin(end - begin, int(sizeof(slot.name)) - 1);
+                for (int i = 0; i < len; ++i) {
+                    char c = command.at(begin + i);
+                    slot.name[i] = (c >= 'a' && c <= 'z') ? char(c - 32) : c;
+                }
+                slot.ready.store(true, std::memory_order_release);
+                return &slot;
+            }
+            if (cur == h) return &slot;   // 其他執行緒剛好佔用同一個 verb
+        }
+    }
+
+    VerbMetrics& other = m_verbs[usable];
+    if (!other.ready.load(std::memory_order_acquire)) {
+        quint64 expected = 0;
+        if (other.hash.compare_exchange_strong(expected, ~quint64(0))) {
+            strcpy(other.name, "(other)");
+            other.ready.store(true, std::memory_order_release);
+        }
+    }
+    return &other;
+}
+
+void EndpointMetrics::addCommand(const QByteArray& command)
+{
+    m_commands.fetch_add(1, std::memory_order_relaxed);
+    verbSlot(command)->commands.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EndpointMetrics::addQuery(const QByteArray& command, qint64 ns)
+{
+    m_latency.record(ns);
+    verbSlot(command)->latency.record(ns);
+}
+
+// ===== InstrumentMetrics =====
+
+InstrumentMetrics& InstrumentMetrics::instance()
+{
+    static InstrumentMetrics inst;
+    return inst;
+}
+
+InstrumentMetrics::InstrumentMetrics(QObject* parent)
+    : QObject(parent) {}
+
+EndpointMetrics* InstrumentMetrics::endpoint(const QString& address)
+{
+    // 與 InstrumentSessionPool 相同的正規化：純數字視為 GPIB 位址
+    static const QRegularExpression numberOnly("^[0-9]+$");
+    QString key = address.trimmed().toUpper();
+    if (key.isEmpty()) key = "(unknown)";
+    else if (numberOnly.match(key).hasMatch()) key = "GPIB0::" + key + "::INSTR";
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_byAddress.find(key);
+    if (it != m_byAddress.end()) return it.value();
+
+    m_endpoints.emplace_back(new EndpointMetrics(key));
+    EndpointMetrics* ep = m_endpoints.back().get();
+    m_byAddress.insert(key, ep);
+    return ep;
+}
+
+QVector<EndpointSnapshot> InstrumentMetrics::snapshot() const
+{
+    QVector<EndpointSnapshot> result;
+    QMutexLocker locker(&m_mutex);
+    result.reserve(static_cast<int>(m_endpoints.size()));
+
+    for (const auto& ep : m_endpoints) {
+        EndpointSnapshot s;
+        s.address = ep->m_address;
+        s.bytesOut = ep->m_bytesOut.load(std::memory_order_relaxed);
+        s.bytesIn = ep->m_bytesIn.load(std::memory_order_relaxed);
+        s.commands = ep->m_commands.load(std::memory_order_relaxed);
+        s.queries = ep->m_latency.count();
+        s.timeouts = ep->m_timeouts.load(std::memory_order_relaxed);
+        s.errors = ep->m_errors.load(std::memory_order_relaxed);
+        s.reconnects = ep->m_reconnects.load(std::memory_order_relaxed);
+        s.p50Us = ep->m_latency.percentileUs(0.50);
+        s.p99Us = ep->m_latency.percentileUs(0.99);
+        s.maxUs = ep->m_latency.maxUs();
+
+        for (const VerbMetrics& v : ep->m_verbs) {
+            if (!v.ready.load(std::memory_order_acquire)) continue;
+            VerbSnapshot vs;
+            vs.verb = QString::fromLatin1(v.name);
+            vs.commands = v.commands.load(std::memory_order_relaxed);
+            vs.queries = v.latency.count();
+            vs.p50Us = v.latency.percentileUs(0.50);
+            vs.p99Us = v.latency.percentileUs(0.99);
+            vs.maxUs = v.latency.maxUs();
+            s.verbs.append(vs);
+        }
+        std::sort(s.verbs.begin(), s.verbs.end(), [](const VerbSnapshot& a, const VerbSnapshot& b) {
+            return a.commands + a.queries > b.commands + b.queries;
+        });
+        result.append(s);
+    }
+    return result;
+}
+
+bool InstrumentMetrics::dumpJson(const QString& path) const
+{
+    QJsonArray endpoints;
+    for (const EndpointSnapshot& s : snapshot()) {
+        QJsonArray verbs;
+        for (const VerbSnapshot& v : s.verbs) {
+            verbs.append(QJsonObject{
+                {"verb", v.verb},
+                {"commands", double(v.commands)},
+                {"queries", double(v.queries)},
+                {"p50_us", v.p50Us},
+                {"p99_us", v.p99Us},
+                {"max_us", v.maxUs}});
+        }
+        endpoints.append(QJsonObject{
+            {"address", s.address},
+            {"bytes_out", double(s.bytesOut)},
+            {"bytes_in", double(s.bytesIn)},
+            {"commands", double(s.commands)},
+            {"queries", double(s.queries)},
+            {"timeouts", double(s.timeouts)},
+            {"errors", double(s.errors)},
+            {"reconnects", double(s.reconnects)},
+            {"p50_us", s.p50Us},
+            {"p99_us", s.p99Us},
+            {"max_us", s.maxUs},
+            {"verbs", verbs}});
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[InstrumentMetrics] Open failed:" << path << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(QJsonObject{{"endpoints", endpoints}}).toJson());
+    return file.commit();
+}
+
+bool InstrumentMetrics::dumpCsv(const QString& path) const
+{
+    QByteArray out("address,verb,commands,queries,p50_us,p99_us,max_us,"
+                   "bytes_out,bytes_in,timeouts,errors,reconnects\n");
+    for (const EndpointSnapshot& s : snapshot()) {
+        // 第一列為整台儀器的合計（verb 欄為 *）
+        out += QString("%1,*,%2,%3,%4,%5,%6,%7,%8,%9,%10,%11\n")
+                   .arg(s.address).arg(s.commands).arg(s.queries)
+                   .arg(s.p50Us, 0, 'f', 1).arg(s.p99Us, 0, 'f', 1).arg(s.maxUs, 0, 'f', 1)
+                   .arg(s.bytesOut).arg(s.bytesIn).arg(s.timeouts).arg(s.errors).arg(s.reconnects)
+                   .toUtf8();
+        for (const VerbSnapshot& v : s.verbs) {
+            out += QString("%1,%2,%3,%4,%5,%6,%7,,,,,\n")
+                       .arg(s.address, v.verb).arg(v.commands).arg(v.queries)
+                       .arg(v.p50Us, 0, 'f', 1).arg(v.p99Us, 0, 'f', 1).arg(v.maxUs, 0, 'f', 1)
+                       .toUtf8();
+        }
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[InstrumentMetrics] Open failed:" << path << file.errorString();
+        return false;
+    }
+    file.write(out);
+    return file.commit();
+}
+
+void InstrumentMetrics::startPeriodicDump(const QString& dir, int intervalMs)
+{
+    m_dumpDir = dir;
+    QDir().mkpath(dir);
+    if (!m_dumpTimer) {
+        m_dumpTimer = new QTimer(this);
+        connect(m_dumpTimer, &QTimer::timeout, this, [this]() {
+            const QDir d(m_dumpDir);
+            dumpJson(d.filePath("instrument_metrics.json"));
+            dumpCsv(d.filePath("instrument_metrics.csv"));
+        });
+    }
+    m_dumpTimer->start(qMax(1000, intervalMs));
+    qDebug() << "[InstrumentMetrics] Periodic dump to" << dir << "every" << intervalMs << "ms";
+}
+
+void InstrumentMetrics::stopPeriodicDump()
+{
+    if (m_dumpTimer) m_dumpTimer->stop();
+}
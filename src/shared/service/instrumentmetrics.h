@@ -0,0 +1,132 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <deque>
+#include <memory>
+
+class QTimer;
+
+// 延遲直方圖：對數刻度（每個 2 倍區間分 4 格），1 us ~ 約 268 s
+// record() 只做 atomic 累加，可在任何執行緒同時呼叫
+class LatencyHistogram
+{
+public:
+    void record(qint64 ns);
+
+    quint64 count() const { return m_count.load(std::memory_order_relaxed); }
+    double percentileUs(double p) const;    // p: 0 ~ 1，以 bucket 中點估計
+    double maxUs() const { return m_maxNs.load(std::memory_order_relaxed) / 1000.0; }
+
+private:
+    static const int bucketCount = 112;
+    static int bucketOf(quint64 us);
+    static double bucketMidUs(int index);
+
+    std::atomic<quint64> m_buckets[bucketCount] = {};
+    std::atomic<quint64> m_count{0};
+    std::atomic<quint64> m_maxNs{0};
+};
+
+// 單一 SCPI verb 的統計（例如 "MEAS:VOLT?"、"CURR:STAT:L1"）
+struct VerbMetrics
+{
+    std::atomic<quint64> hash{0};        // 0 = 空槽
+    std::atomic<bool> ready{false};      // name 寫好後才設定
+    char name[32] = {};
+    std::atomic<quint64> commands{0};
+    LatencyHistogram latency;            // 只有查詢會記錄
+};
+
+// 單一儀器位址的統計；物件建立後不會釋放，取得的指標可長期保存
+class EndpointMetrics
+{
+public:
+    explicit EndpointMetrics(const QString& address) : m_address(address) {}
+
+    QString address() const { return m_address; }
+
+    void addBytesOut(qint64 n)  { if (n > 0) m_bytesOut.fetch_add(static_cast<quint64>(n), std::memory_order_relaxed); }
+    void addBytesIn(qint64 n)   { if (n > 0) m_bytesIn.fetch_add(static_cast<quint64>(n), std::memory_order_relaxed); }
+    void addTimeout()           { m_timeouts.fetch_add(1, std::memory_order_relaxed); }
+    void addError()             { m_errors.fetch_add(1, std::memory_order_relaxed); }
+    void addReconnect()         { m_reconnects.fetch_add(1, std::memory_order_relaxed); }
+
+    // 指令數（依 verb 分類）
+    void addCommand(const QByteArray& command);
+    // 查詢往返延遲（寫入到完整回應）
+    void addQuery(const QByteArray& command, qint64 ns);
+
+private:
+    friend class InstrumentMetrics;
+    VerbMetrics* verbSlot(const QByteArray& command);
+
+    static const int verbSlots = 64;     // 超過時併入最後一格 "(other)"
+
+    QString m_address;
+    std::atomic<quint64> m_bytesOut{0};
+    std::atomic<quint64> m_bytesIn{0};
+    std::atomic<quint64> m_commands{0};
+    std::atomic<quint64> m_timeouts{0};
+    std::atomic<quint64> m_errors{0};
+    std::atomic<quint64> m_reconnects{0};
+    LatencyHistogram m_latency;
+    VerbMetrics m_verbs[verbSlots];
+};
+
+struct VerbSnapshot
+{
+    QString verb;
+    quint64 commands = 0;
+    quint64 queries = 0;
+    double p50Us = 0, p99Us = 0, maxUs = 0;
+};
+
+struct EndpointSnapshot
+{
+    QString address;
+    quint64 bytesOut = 0, bytesIn = 0;
+    quint64 commands = 0, queries = 0;
+    quint64 timeouts = 0, errors = 0, reconnects = 0;
+    double p50Us = 0, p99Us = 0, maxUs = 0;
+    QVector<VerbSnapshot> verbs;
+};
+
+// 儀器通訊量測：各通訊後端與 InstrumentWithCommBase 在熱路徑只做 atomic 累加，
+// 只有第一次遇到新位址時上鎖；snapshot / dump 隨時可呼叫，不影響量測中的執行緒
+class InstrumentMetrics : public QObject
+{
+    Q_OBJECT
+public:
+    static InstrumentMetrics& instance();
+
+    // 同一位址（正規化後）回傳同一物件
+    EndpointMetrics* endpoint(const QString& address);
+
+    QVector<EndpointSnapshot> snapshot() const;
+
+    bool dumpJson(const QString& path) const;
+    bool dumpCsv(const QString& path) const;    // 每列一個 位址 × verb
+
+    // 定期寫出 <dir>/instrument_metrics.json 與 .csv（需在有事件迴圈的執行緒呼叫）
+    void startPeriodicDump(const QString& dir, int intervalMs = 60000);
+    void stopPeriodicDump();
+
+private:
+    InstrumentMetrics(QObject* parent = nullptr);
+    ~InstrumentMetrics() = default;
+    InstrumentMetrics(const InstrumentMetrics&) = delete;
+    InstrumentMetrics& operator=(const InstrumentMetrics&) = delete;
+
+    mutable QMutex m_mutex;
+    std::deque<std::unique_ptr<EndpointMetrics>> m_endpoints;
+    QHash<QString, EndpointMetrics*> m_byAddress;
+
+    QTimer* m_dumpTimer = nullptr;
+    QString m_dumpDir;
+};
@@ -23,6 +23,15 @@ void applyLineEditStyle(QLineEdit* le) {
     )");
 }
 
+// 數值有風險時（例如可能觸發 OPP）改用淡紅底色
+void applyLineEditWarning(QLineEdit* le, bool warning) {
+    if (!le) return;
+    const QString bg = warning ? "#ffd6d6" : "white";
+    le->setStyleSheet(QString(R"(
+        QLineEdit { background-color: %1; border:none; padding:0; margin:0; text-align:center; }
+    )").arg(bg));
+}
+
 void applyComboBoxStyle(QComboBox *cb, bool headerLook)
 {
     if (!cb) return;
@@ -7,6 +7,7 @@ class QLineEdit;
 namespace StyleUtils {
 void applyTableStyle(QTableWidget* tbl);
 void applyLineEditStyle(QLineEdit* le);
+void applyLineEditWarning(QLineEdit* le, bool warning);
 void applyComboBoxStyle(QComboBox *cb, bool headerLook = false);
 void applyHeaderLook(QWidget *w);
 }
@@ -1,15 +1,12 @@
 #include "autotriggerworker.h"
 #include "dpo7000.h"
 #include <QDebug>
-#include <QThread>
 #include <QElapsedTimer>
 #include <cmath>
 
 AutoTriggerWorker::AutoTriggerWorker(DPO7000* instrument, QObject* parent)
     : QObject(parent), m_instrument(instrument)
 {
-    m_timer = new QTimer(this);
-    connect(m_timer, &QTimer::timeout, this, &AutoTriggerWorker::performAdjustment);
 }
 
 AutoTriggerWorker::~AutoTriggerWorker()
@@ -65,27 +62,19 @@ void AutoTriggerWorker::startTracking()
     resetTracking();
 
     try {
-        // 設為 Normal 模式
+        // 設為 Normal 模式：沒有觸發就不擷取，擷取次數才能反映實際觸發
         m_instrument->normal();
         qDebug() << "[AutoTriggerWorker] Set to NORMAL mode for continuous display";
 
-        // 設定起始觸發電平
-        if (!setTriggerLevel(m_currentLevel)) {
-            emit trackingError("Failed to set initial trigger level");
-            stopTracking();
-            return;
-        }
+        m_triggerWindowMs = computeTriggerWindowMs();
+        m_useSrq = m_instrument->enableServiceRequest();
+        qDebug() << QString("[AutoTriggerWorker] Trigger window: %1 ms (%2)")
+                        .arg(m_triggerWindowMs).arg(m_useSrq ? "SRQ" : "*OPC?");
 
-        // 檢查是否已經達到目標
-        if (isTargetReached()) {
-            emit targetReached(m_currentLevel);
-            emit trackingCompleted(true, "Already at target level");
-            stopTracking();
-            return;
-        }
+        performAdjustment();
 
-        // 開始定期調整
-        m_timer->start(800);
+        // 探測以 Single 擷取進行，結束後回到連續擷取
+        m_instrument->continuous();
 
     } catch (const std::exception& e) {
         // 捕獲異常並發送錯誤信號
@@ -106,97 +95,168 @@ void AutoTriggerWorker::startTracking()
 void AutoTriggerWorker::stopTracking()
 {
     QMutexLocker locker(&m_paramsMutex);
+    if (!m_isTracking) return;
     m_isTracking = false;
     locker.unlock();
 
-    if (m_timer && m_timer->isActive()) {
-        m_timer->stop();
-    }
-
     qDebug() << "[AutoTriggerWorker] Semi-auto trigger tracking stopped";
 }
 
 // ===== 調整邏輯 =====
 void AutoTriggerWorker::performAdjustment()
 {
-    // 檢查追蹤狀態
     QMutexLocker locker(&m_paramsMutex);
     if (!m_isTracking) {
         qDebug() << "[AutoTriggerWorker] Tracking stopped, skipping adjustment";
         return;
     }
-
-    double targetLevel = m_targetLevel;
-    double currentLevel = m_currentLevel;
-    int stepCount = m_stepCount;
+    const double startLevel = m_startLevel;
+    const double targetLevel = m_targetLevel;
+    const double resolution = qMax(m_stepScale, 1e-3);
     locker.unlock();
 
-    // 檢查儀器連線（最優先）
-    if (!m_instrument || !m_instrument->isConnected()) {
-        m_timer->stop();
-        emit trackingError("Instrument disconnected during adjustment");
+    QElapsedTimer clock;
+    clock.start();
+    QString error;
+
+    auto fail = [&](const QString& message) {
+        stopTracking();
+        emit trackingError(message);
+    };
+
+    // 1. 直接嘗試目標：能觸發就一次完成
+    ProbeResult result = probeLevel(targetLevel, error);
+    if (result == ProbeResult::Stopped) return;
+    if (result == ProbeResult::Failed) { fail(error); return; }
+    if (result == ProbeResult::Triggered) {
+        finishAt(targetLevel, true, QString("Successfully reached target level %1V in %2 steps (%3 ms)")
+                                        .arg(targetLevel, 0, 'f', 3).arg(m_stepCount)
+                                        .arg(clock.elapsed()));
         return;
     }
 
-    try {
-        qDebug() << "";
-        qDebug() << QString("[AutoTriggerWorker] ========== Step %1 ==========").arg(stepCount + 1);
-        qDebug() << QString("  Current Level:  %1 V").arg(currentLevel, 8, 'f', 3);
-        qDebug() << QString("  Target Level:   %1 V").arg(targetLevel, 8, 'f', 3);
-
-        // 計算下一步電平
-        double nextLevel = calculateNextStep();
-        qDebug() << QString("  Next Level:     %1 V").arg(nextLevel, 8, 'f', 3);
-
-        // 設定新觸發電平
-        if (!setTriggerLevel(nextLevel)) {
-            m_timer->stop();
-            emit trackingError(QString("Failed to set trigger level to %1V")
-                                   .arg(nextLevel, 0, 'f', 3));
+    // 2. 起始電平必須能觸發，才有「觸發 / 不觸發」的搜尋區間
+    result = probeLevel(startLevel, error);
+    if (result == ProbeResult::Stopped) return;
+    if (result == ProbeResult::Failed) { fail(error); return; }
+    if (result == ProbeResult::NotTriggered) {
+        finishAt(startLevel, false, QString("No trigger at start level %1V or target level %2V")
+                                        .arg(startLevel, 0, 'f', 3).arg(targetLevel, 0, 'f', 3));
+        return;
+    }
+
+    // 3. 倍增步長往目標前進，直到失去觸發（good 一定能觸發，bad 一定不能）
+    const double direction = (targetLevel >= startLevel) ? 1.0 : -1.0;
+    double good = startLevel;
+    double bad = targetLevel;
+    double delta = resolution;
+    for (;;) {
+        const double next = good + direction * delta;
+        if ((next - bad) * direction >= 0.0) break;
+
+        result = probeLevel(next, error);
+        if (result == ProbeResult::Stopped) return;
+        if (result == ProbeResult::Failed) { fail(error); return; }
+        if (result == ProbeResult::NotTriggered) {
+            bad = next;
+            break;
+        }
+        good = next;
+        delta *= 2.0;
+    }
+
+    // 4. 在 [good, bad] 之間二分，直到區間小於 stepScale
+    double lastProbed = bad;
+    while (qAbs(bad - good) > resolution) {
+        const double mid = (good + bad) / 2.0;
+        result = probeLevel(mid, error);
+        if (result == ProbeResult::Stopped) return;
+        if (result == ProbeResult::Failed) { fail(error); return; }
+        if (result == ProbeResult::Triggered) good = mid;
+        else bad = mid;
+        lastProbed = mid;
+    }
+
+    // 最後探測的若不是 good，回到最後一個確定能觸發的電平
+    if (lastProbed != good) {
+        if (!setTriggerLevel(good) || !m_instrument->waitForOperationComplete(2000)) {
+            fail(QString("Failed to set trigger level to %1V").arg(good, 0, 'f', 3));
             return;
         }
+    }
 
-        // 等待儀器穩定
-        qDebug() << "  Waiting for instrument to stabilize (300ms)...";
-        QThread::msleep(300);
+    finishAt(good, true, QString("Trigger threshold found at %1V (target %2V) in %3 steps (%4 ms)")
+                             .arg(good, 0, 'f', 3).arg(targetLevel, 0, 'f', 3)
+                             .arg(m_stepCount).arg(clock.elapsed()));
+}
 
-        // 更新狀態
-        QMutexLocker locker2(&m_paramsMutex);
-        m_currentLevel = nextLevel;
-        m_stepCount++;
-        int newStepCount = m_stepCount;
-        locker2.unlock();
+// 設定電平並以 *OPC? 確認，再做一次 Single 擷取；觸發窗內擷取完成才視為新電平可觸發
+AutoTriggerWorker::ProbeResult AutoTriggerWorker::probeLevel(double level, QString& error)
+{
+    if (!isTracking()) return ProbeResult::Stopped;
 
-        qDebug() << QString("  Set to %1V (Step %2)").arg(nextLevel, 0, 'f', 3).arg(newStepCount);
-        emit adjustmentProgress(nextLevel, newStepCount);
+    if (!m_instrument || !m_instrument->isConnected()) {
+        error = "Instrument disconnected during adjustment";
+        return ProbeResult::Failed;
+    }
 
-        // 檢查是否達到目標
-        if (isTargetReached()) {
-            qDebug() << QString("TARGET REACHED at %1V in %2 steps")
-            .arg(nextLevel, 0, 'f', 3)
-                .arg(newStepCount);
+    if (!setTriggerLevel(level)) {
+        error = QString("Failed to set trigger level to %1V: %2").arg(level, 0, 'f', 3)
+                    .arg(m_instrument->lastError());
+        return ProbeResult::Failed;
+    }
+    if (!m_instrument->waitForOperationComplete(2000)) {
+        error = QString("Trigger level %1V not confirmed (*OPC? timeout)").arg(level, 0, 'f', 3);
+        return ProbeResult::Failed;
+    }
 
-            m_timer->stop();
-            emit targetReached(nextLevel);
+    QMutexLocker locker(&m_paramsMutex);
+    m_currentLevel = level;
+    const int stepCount = ++m_stepCount;
+    locker.unlock();
+    emit adjustmentProgress(level, stepCount);
+
+    // 等待由儀器結束（擷取完成或觸發窗逾時），stopTracking 在這次探測之後生效
+    QElapsedTimer window;
+    window.start();
+    const int acquired = m_instrument->acquireSingle(m_triggerWindowMs, m_useSrq);
+    if (acquired < 0) {
+        error = QString("Acquisition at %1V failed: %2").arg(level, 0, 'f', 3).arg(m_instrument->lastError());
+        return ProbeResult::Failed;
+    }
+    if (!isTracking()) return ProbeResult::Stopped;
 
-            QString shortMessage = QString("Successfully reached target level %1V in %2 steps")
-                                       .arg(nextLevel, 0, 'f', 3)
-                                       .arg(newStepCount);
+    if (acquired > 0) {
+        qDebug() << QString("[AutoTriggerWorker] Step %1: %2V -> TRIGGER (%3 ms)")
+                        .arg(stepCount).arg(level, 0, 'f', 3).arg(window.elapsed());
+        return ProbeResult::Triggered;
+    }
+    qDebug() << QString("[AutoTriggerWorker] Step %1: %2V -> no acquisition in %3 ms")
+                    .arg(stepCount).arg(level, 0, 'f', 3).arg(window.elapsed());
+    return ProbeResult::NotTriggered;
+}
 
-            emit trackingCompleted(true, shortMessage);
-        }
+// 觸發窗：三個完整擷取視窗（10 格 × 時基），至少 100 ms，最多 10 秒
+int AutoTriggerWorker::computeTriggerWindowMs()
+{
+    const double timebase = m_instrument->getTimebase();
+    if (timebase <= 0.0) return 200;
+    const double recordMs = timebase * 10.0 * 1000.0;
+    return qBound(100, static_cast<int>(std::ceil(recordMs * 3.0)), 10000);
+}
 
-    } catch (const std::exception& e) {
-        m_timer->stop();
-        QString errorMsg = QString("Adjustment failed: %1").arg(e.what());
-        emit trackingError(errorMsg);
-        qCritical() << "[AutoTriggerWorker] Exception during adjustment:" << e.what();
+void AutoTriggerWorker::finishAt(double level, bool success, const QString& message)
+{
+    QMutexLocker locker(&m_paramsMutex);
+    m_currentLevel = level;
+    locker.unlock();
 
-    } catch (...) {
-        m_timer->stop();
-        emit trackingError("Unknown error occurred during adjustment");
-        qCritical() << "[AutoTriggerWorker] Unknown exception during adjustment";
+    qDebug() << "[AutoTriggerWorker]" << message;
+    if (success && isTargetReached()) {
+        emit targetReached(level);
     }
+    stopTracking();
+    emit trackingCompleted(success, message);
 }
 
 // ===== 其他輔助方法 =====
@@ -205,9 +265,9 @@ bool AutoTriggerWorker::setTriggerLevel(double level)
     if (!m_instrument) return false;
 
     try {
-        m_instrument->setTriggerLevel(level);
-        qDebug() << QString("    Trigger level set to: %1V").arg(level, 0, 'f', 3);
-        return true;
+        if (m_instrument->applyTriggerLevel(level)) return true;
+        qCritical() << "[AutoTriggerWorker] Failed to set trigger level:" << m_instrument->lastError();
+        return false;
     } catch (const std::exception& e) {
         qCritical() << "[AutoTriggerWorker] Failed to set trigger level:" << e.what();
         return false;
@@ -217,27 +277,16 @@ bool AutoTriggerWorker::setTriggerLevel(double level)
     }
 }
 
-double AutoTriggerWorker::calculateNextStep()
+bool AutoTriggerWorker::isTracking() const
 {
     QMutexLocker locker(&m_paramsMutex);
-
-    double difference = m_targetLevel - m_currentLevel;
-    double step = m_stepScale;
-
-    if (qAbs(difference) <= m_stepScale) {
-        return m_targetLevel;
-    }
-
-    if (difference > 0) {
-        return m_currentLevel + step;
-    } else {
-        return m_currentLevel - step;
-    }
+    return m_isTracking;
 }
 
 bool AutoTriggerWorker::isTargetReached() const
 {
     const double tolerance = 1.0;
+    QMutexLocker locker(&m_paramsMutex);
     return qAbs(m_currentLevel - m_targetLevel) <= tolerance;
 }
 
@@ -1,12 +1,16 @@
 #pragma once
 #include <QObject>
-#include <QTimer>
 #include <QMutex>
 #include <QThread>
 #include <QElapsedTimer>
 
 class DPO7000;
 
+// 半自動觸發追蹤：從起始電平往目標電平移動，並以儀器實際的觸發狀態為準
+// 每次設定都以 *OPC? 確認，再以一次 Single 擷取判斷新電平是否仍能觸發：觸發窗內擷取完成即可觸發
+// 擷取完成由儀器通知（GPIB 為 *OPC + SRQ，其餘為阻塞的 *OPC?），不固定間隔輪詢
+// （TRIGger:STATE? 可能還是上一個電平留下的狀態，不能作為依據）
+// 先直接嘗試目標；不行則以倍增步長逼近，找到失去觸發的區間後二分搜尋到 stepScale 解析度
 class AutoTriggerWorker : public QObject
 {
     Q_OBJECT
@@ -23,8 +27,8 @@ public:
 
 public slots:
     void startTracking();
-    void stopTracking();
-    void performAdjustment();
+    void stopTracking();        // 可從其他執行緒呼叫，搜尋在下一次探測前結束
+    void performAdjustment();   // 執行整個搜尋（由 startTracking 呼叫）
 
 signals:
     void targetReached(double finalLevel);
@@ -33,8 +37,9 @@ signals:
     void trackingCompleted(bool success, const QString& message);
 
 private:
+    enum class ProbeResult { Triggered, NotTriggered, Failed, Stopped };
+
     DPO7000* m_instrument = nullptr;
-    QTimer* m_timer = nullptr;
 
     // 執行緒安全的參數
     mutable QMutex m_paramsMutex;
@@ -44,10 +49,15 @@ private:
     double m_currentLevel = 0.0;
     bool m_isTracking = false;
     int m_stepCount = 0;
+    int m_triggerWindowMs = 200;    // 判定「沒有觸發」前等待擷取完成的時間，依時基計算
+    bool m_useSrq = false;          // 傳輸層支援 SRQ 時以 Service Request 等待擷取完成
 
     // 輔助方法
     bool setTriggerLevel(double level);
-    double calculateNextStep();
+    ProbeResult probeLevel(double level, QString& error);
+    bool isTracking() const;
+    int computeTriggerWindowMs();
+    void finishAt(double level, bool success, const QString& message);
     bool isTargetReached() const;
     void resetTracking();
 
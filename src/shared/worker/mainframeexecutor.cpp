@@ -0,0 +1,93 @@
+#include "mainframeexecutor.h"
+#include "dcload.h"
+#include <QtConcurrent>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QDebug>
+#include <exception>
+
+MainframeExecutor& MainframeExecutor::instance()
+{
+    static MainframeExecutor instance;
+    return instance;
+}
+
+MainframeExecutor::MainframeExecutor(QObject* parent)
+    : QObject(parent)
+{
+    // 獨立的 pool：呼叫端通常已在 globalInstance 的執行緒上，共用會搶到自己的名額
+    m_pool.setMaxThreadCount(defaultMaxThreads);
+}
+
+MainframeExecutor::~MainframeExecutor()
+{
+    m_pool.waitForDone();
+}
+
+QVector<QVector<DCLoad*>> MainframeExecutor::groupByCommunication(const QVector<DCLoad*>& dcLoads)
+{
+    QVector<ICommunication*> order;
+    QVector<QVector<DCLoad*>> groups;
+    for (DCLoad* dcLoad : dcLoads) {
+        if (!dcLoad) continue;
+        ICommunication* comm = dcLoad->communication();
+        int idx = order.indexOf(comm);
+        if (idx < 0) {
+            order.append(comm);
+            groups.append(QVector<DCLoad*>());
+            idx = order.size() - 1;
+        }
+        groups[idx].append(dcLoad);
+    }
+    return groups;
+}
+
+QVector<MainframeGroupResult> MainframeExecutor::run(const QVector<DCLoad*>& dcLoads,
+                                                     const GroupTask& task)
+{
+    // 1. 依通訊物件分組
+    const QVector<QVector<DCLoad*>> groups = groupByCommunication(dcLoads);
+
+    QVector<MainframeGroupResult> results(groups.size());
+    if (groups.isEmpty()) return results;
+
+    auto runGroup = [this, &task, &groups, &results](int i) {
+        MainframeGroupResult& r = results[i];
+        const QVector<DCLoad*>& group = groups[i];
+        r.comm = group.first()->communication();
+        r.channelCount = group.size();
+        r.label = group.first()->getaddress().isEmpty() ? group.first()->model()
+                                                          : group.first()->getaddress();
+
+        QElapsedTimer timer;
+        timer.start();
+        try {
+            r.success = task(group, r.error);
+        } catch (const std::exception& ex) {
+            r.success = false;
+            r.error = QString("Exception: %1").arg(ex.what());
+        }
+        r.elapsedMs = timer.elapsed();
+
+        if (!r.success)
+            qWarning() << "[MainframeExecutor]" << r.label << "failed:" << r.error;
+        emit groupFinished(r.label, r.success, r.error, r.elapsedMs);
+    };
+
+    // 2. 只有一台時直接在呼叫端執行，省去執行緒切換
+    if (groups.size() == 1) {
+        runGroup(0);
+        return results;
+    }
+
+    // 3. 各組丟到 pool 平行執行，呼叫端等待全部完成（最慢的一台決定總時間）
+    QVector<QFuture<void>> futures;
+    futures.reserve(groups.size());
+    for (int i = 0; i < groups.size(); ++i)
+        futures.append(QtConcurrent::run(&m_pool, runGroup, i));
+
+    for (QFuture<void>& f : futures)
+        f.waitForFinished();
+
+    return results;
+}
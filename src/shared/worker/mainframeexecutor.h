@@ -0,0 +1,56 @@
+#pragma once
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+#include <QString>
+#include <functional>
+
+class DCLoad;
+class ICommunication;
+
+// 單一 mainframe（同一個通訊 Session）的執行結果
+struct MainframeGroupResult
+{
+    ICommunication* comm = nullptr;
+    QString label;          // 位址（未設定時為型號）
+    int channelCount = 0;
+    bool success = false;
+    QString error;
+    qint64 elapsedMs = 0;
+};
+
+// DC Load 平行執行器：
+// 依通訊物件把通道分組，不同 mainframe 在有上限的 thread pool 上同時執行；
+// 同一組的通道仍在同一條執行緒上依原順序處理（同一台的指令序列不可交錯）
+class MainframeExecutor : public QObject
+{
+    Q_OBJECT
+public:
+    // 回傳 false 並填入 error 表示該組失敗，不影響其他組
+    using GroupTask = std::function<bool(const QVector<DCLoad*>& group, QString& error)>;
+
+    static MainframeExecutor& instance();
+
+    // 阻塞直到所有組完成；結果依各組第一個通道在 dcLoads 中的順序排列
+    QVector<MainframeGroupResult> run(const QVector<DCLoad*>& dcLoads, const GroupTask& task);
+
+    // 依通訊物件分組（保留第一次出現的順序）
+    static QVector<QVector<DCLoad*>> groupByCommunication(const QVector<DCLoad*>& dcLoads);
+
+    void setMaxThreadCount(int count) { m_pool.setMaxThreadCount(count); }
+    int maxThreadCount() const        { return m_pool.maxThreadCount(); }
+
+signals:
+    // 每組完成時在 worker 執行緒發出（跨執行緒連線會自動 queued）
+    void groupFinished(const QString& label, bool success, const QString& error, qint64 elapsedMs);
+
+private:
+    MainframeExecutor(QObject* parent = nullptr);
+    ~MainframeExecutor() override;
+
+    MainframeExecutor(const MainframeExecutor&) = delete;
+    MainframeExecutor& operator=(const MainframeExecutor&) = delete;
+
+    QThreadPool m_pool;
+    static const int defaultMaxThreads = 8;
+};
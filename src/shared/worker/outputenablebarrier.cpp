@@ -0,0 +1,118 @@
+#include "outputenablebarrier.h"
+#include <QtConcurrent>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QThread>
+#include <QDebug>
+#include <atomic>
+#include <exception>
+
+QString OutputEnableReport::summary() const
+{
+    QStringList lines;
+    lines << QString("Output enable %1, issue skew %2 us, completion skew %3 us")
+                 .arg(success ? "OK" : "FAILED")
+                 .arg(issueSkewNs / 1000.0, 0, 'f', 1)
+                 .arg(completionSkewNs / 1000.0, 0, 'f', 1);
+    for (const auto& t : timings) {
+        lines << QString("  %1: %2 issued +%3 us, done +%4 us%5")
+                     .arg(t.label)
+                     .arg(t.success ? "OK" : "FAILED")
+                     .arg(t.issuedNs / 1000.0, 0, 'f', 1)
+                     .arg(t.completedNs / 1000.0, 0, 'f', 1)
+                     .arg(t.error.isEmpty() ? QString() : " (" + t.error + ")");
+    }
+    return lines.join("\n");
+}
+
+void OutputEnableBarrier::add(const QString& label, EnableFn fn)
+{
+    m_participants.append({label, std::move(fn)});
+}
+
+OutputEnableReport OutputEnableBarrier::fire(int readyTimeoutMs)
+{
+    OutputEnableReport report;
+    const int n = m_participants.size();
+    if (n == 0) return report;
+
+    report.timings.resize(n);
+
+    // 每個參與者一條執行緒，確保放行時全部同時在跑
+    m_pool.setMaxThreadCount(n);
+
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<bool> abort{false};
+    QElapsedTimer clock;
+
+    auto worker = [&](int i) {
+        OutputEnableTiming& t = report.timings[i];
+        t.label = m_participants[i].label;
+
+        ready.fetch_add(1);
+        // 放行前忙等：比 QWaitCondition 喚醒延遲小且一致
+        while (!go.load(std::memory_order_acquire)) {
+            if (abort.load(std::memory_order_acquire)) {
+                t.error = "Barrier aborted before release";
+                return;
+            }
+            QThread::yieldCurrentThread();
+        }
+
+        t.issuedNs = clock.nsecsElapsed();
+        try {
+            t.success = m_participants[i].fn(t.error);
+        } catch (const std::exception& ex) {
+            t.success = false;
+            t.error = QString("Exception: %1").arg(ex.what());
+        }
+        t.completedNs = clock.nsecsElapsed();
+    };
+
+    QVector<QFuture<void>> futures;
+    futures.reserve(n);
+    for (int i = 0; i < n; ++i)
+        futures.append(QtConcurrent::run(&m_pool, worker, i));
+
+    // 等待全部就緒
+    QElapsedTimer readyTimer;
+    readyTimer.start();
+    while (ready.load() < n) {
+        if (readyTimer.elapsed() > readyTimeoutMs) {
+            abort.store(true, std::memory_order_release);
+            break;
+        }
+        QThread::yieldCurrentThread();
+    }
+
+    if (!abort.load()) {
+        clock.start();
+        go.store(true, std::memory_order_release);
+    }
+
+    for (QFuture<void>& f : futures)
+        f.waitForFinished();
+
+    if (abort.load()) {
+        qWarning() << "[OutputEnableBarrier] Participants not ready within" << readyTimeoutMs << "ms, nothing sent";
+        return report;
+    }
+
+    // 計算時間差
+    qint64 minIssued = report.timings.first().issuedNs, maxIssued = minIssued;
+    qint64 minDone = report.timings.first().completedNs, maxDone = minDone;
+    report.success = true;
+    for (const auto& t : report.timings) {
+        minIssued = qMin(minIssued, t.issuedNs);
+        maxIssued = qMax(maxIssued, t.issuedNs);
+        minDone = qMin(minDone, t.completedNs);
+        maxDone = qMax(maxDone, t.completedNs);
+        if (!t.success) report.success = false;
+    }
+    report.issueSkewNs = maxIssued - minIssued;
+    report.completionSkewNs = maxDone - minDone;
+
+    qDebug().noquote() << "[OutputEnableBarrier]" << report.summary();
+    return report;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <QString>
+#include <QVector>
+#include <QThreadPool>
+#include <functional>
+
+// 單一參與者的輸出開啟時間（相對於 barrier 放行瞬間，單位 ns）
+struct OutputEnableTiming
+{
+    QString label;
+    bool success = false;
+    QString error;
+    qint64 issuedNs = 0;      // 開始送出指令
+    qint64 completedNs = 0;   // 指令寫入完成
+};
+
+struct OutputEnableReport
+{
+    QVector<OutputEnableTiming> timings;
+    bool success = false;
+    qint64 issueSkewNs = 0;       // 各參與者開始送出的最大時間差
+    qint64 completionSkewNs = 0;  // 各參與者寫入完成的最大時間差
+
+    QString summary() const;
+};
+
+// 輸出開啟同步 barrier：
+// 每個參與者先在自己的執行緒上就緒等待，全部就緒後同時放行，
+// 讓 setPowerOn / setLoadOn 盡可能在同一瞬間送出，並量測實際的時間差（主機端）
+class OutputEnableBarrier
+{
+public:
+    // 回傳 false 並填入 error 表示該參與者開啟失敗
+    using EnableFn = std::function<bool(QString& error)>;
+
+    OutputEnableBarrier() = default;
+
+    void add(const QString& label, EnableFn fn);
+    int count() const { return m_participants.size(); }
+
+    // 阻塞直到全部完成；readyTimeoutMs 內未全部就緒則放棄（不送出任何指令）
+    OutputEnableReport fire(int readyTimeoutMs = 3000);
+
+private:
+    struct Participant {
+        QString label;
+        EnableFn fn;
+    };
+    QVector<Participant> m_participants;
+    QThreadPool m_pool;
+};
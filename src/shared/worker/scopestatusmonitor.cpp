@@ -0,0 +1,179 @@
+#include "scopestatusmonitor.h"
+#include "dpo7000.h"
+#include <QThread>
+#include <QElapsedTimer>
+#include <QDebug>
+
+ScopeStatusMonitor::ScopeStatusMonitor(DPO7000* scope, QObject* parent)
+    : QObject(parent), m_scope(scope)
+{
+}
+
+ScopeStatusMonitor::~ScopeStatusMonitor()
+{
+    stop();
+}
+
+void ScopeStatusMonitor::setIntervals(int fastMs, int idleMs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_fastMs = qMax(10, fastMs);
+    m_idleMs = qMax(m_fastMs, idleMs);
+}
+
+void ScopeStatusMonitor::start()
+{
+    if (m_thread || !m_scope) return;
+
+    QMutexLocker locker(&m_mutex);
+    m_stop = false;
+    m_paused = false;
+    m_parked = false;
+    m_pollRequested = false;
+    m_armOpc = false;
+    locker.unlock();
+
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->start();
+}
+
+void ScopeStatusMonitor::stop()
+{
+    if (!m_thread) return;
+
+    QMutexLocker locker(&m_mutex);
+    m_stop = true;
+    m_wake.wakeAll();
+    locker.unlock();
+
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+bool ScopeStatusMonitor::isActive() const
+{
+    return m_thread != nullptr;
+}
+
+ScopeStatus ScopeStatusMonitor::lastStatus() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_last;
+}
+
+void ScopeStatusMonitor::pollNow()
+{
+    QMutexLocker locker(&m_mutex);
+    m_pollRequested = true;
+    m_wake.wakeAll();
+}
+
+void ScopeStatusMonitor::pollAfterOperation()
+{
+    QMutexLocker locker(&m_mutex);
+    m_armOpc = true;
+    m_pollRequested = true;
+    m_wake.wakeAll();
+}
+
+void ScopeStatusMonitor::pause()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_paused) return;
+    m_paused = true;
+    m_wake.wakeAll();
+    while (m_thread && !m_parked && !m_stop)
+        m_wake.wait(&m_mutex);
+}
+
+void ScopeStatusMonitor::resume()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_paused) return;
+    m_paused = false;
+    m_pollRequested = true;     // 暫停期間狀態可能已改變
+    m_wake.wakeAll();
+}
+
+void ScopeStatusMonitor::run()
+{
+    const bool useSrq = m_scope->enableServiceRequest();
+    qDebug() << "[ScopeStatusMonitor] Started," << (useSrq ? "SRQ enabled" : "polling only");
+
+    QMutexLocker locker(&m_mutex);
+    int interval = m_fastMs;
+    while (!m_stop) {
+        if (m_paused) {
+            m_parked = true;
+            m_wake.wakeAll();
+            while (m_paused && !m_stop)
+                m_wake.wait(&m_mutex);
+            m_parked = false;
+            continue;
+        }
+
+        const bool armOpc = m_armOpc;
+        if (m_pollRequested) interval = m_fastMs;
+        m_armOpc = false;
+        m_pollRequested = false;
+        const int fastMs = m_fastMs;
+        const int idleMs = m_idleMs;
+        locker.unlock();
+
+        if (armOpc && useSrq) m_scope->armOperationComplete();
+
+        ScopeStatus status;
+        if (m_scope->isConnected()) {
+            status.valid = m_scope->queryStatusSnapshot(status.running, status.triggerState,
+                                                        status.triggerLevel);
+        }
+
+        locker.relock();
+        const bool changed = (status != m_last);
+        if (changed) m_last = status;
+        locker.unlock();
+
+        if (changed) {
+            emit statusChanged(status);
+            interval = fastMs;
+        } else {
+            interval = qMin(interval * 2, idleMs);
+        }
+
+        if (waitForNextPoll(interval, useSrq)) interval = fastMs;
+        locker.relock();
+    }
+
+    m_parked = false;
+    m_wake.wakeAll();
+    qDebug() << "[ScopeStatusMonitor] Stopped";
+}
+
+// 等到下一次輪詢；stop / pause / pollNow 會立即結束等待
+bool ScopeStatusMonitor::waitForNextPoll(int intervalMs, bool useSrq)
+{
+    if (!useSrq) {
+        QMutexLocker locker(&m_mutex);
+        if (!m_stop && !m_paused && !m_pollRequested)
+            m_wake.wait(&m_mutex, static_cast<unsigned long>(intervalMs));
+        return false;
+    }
+
+    // SRQ 等待不能同時等 wait condition，切成短片段，片段之間檢查控制旗標
+    constexpr int sliceMs = 50;
+    QElapsedTimer clock;
+    clock.start();
+    for (;;) {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_stop || m_paused || m_pollRequested) return false;
+        }
+        const int remaining = intervalMs - static_cast<int>(clock.elapsed());
+        if (remaining <= 0) return false;
+        if (m_scope->waitForServiceRequest(qMin(remaining, sliceMs))) {
+            qDebug() << "[ScopeStatusMonitor] Service request received";
+            return true;
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QMetaType>
+
+class DPO7000;
+class QThread;
+
+// 示波器狀態（一次往返查詢的結果）
+struct ScopeStatus
+{
+    bool valid = false;         // false = 查詢失敗（離線或沒有回應）
+    bool running = false;       // ACQuire:STATE?
+    QString triggerState;       // TRIGger:STATE?：ARMED / AUTO / READY / SAVE / TRIGGER
+    double triggerLevel = 0.0;  // TRIGger:A:LEVel?
+
+    bool operator==(const ScopeStatus& other) const {
+        return valid == other.valid && running == other.running
+               && triggerState == other.triggerState && triggerLevel == other.triggerLevel;
+    }
+    bool operator!=(const ScopeStatus& other) const { return !(*this == other); }
+};
+
+// 每台示波器一個背景狀態監控：在自己的執行緒上以單一複合查詢輪詢，只在狀態真的改變時發出 statusChanged
+// 沒有變化時輪詢間隔倍增到 idleMs；有變化或 pollNow() 時回到 fastMs
+// 傳輸層支援 SRQ（GPIB）時，等待期間改等 Service Request，Single 擷取完成會立即喚醒
+class ScopeStatusMonitor : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ScopeStatusMonitor(DPO7000* scope, QObject* parent = nullptr);
+    ~ScopeStatusMonitor() override;
+
+    void setIntervals(int fastMs, int idleMs);
+    void start();
+    void stop();        // 阻塞直到背景執行緒結束
+    bool isActive() const;
+
+    ScopeStatus lastStatus() const;
+
+public slots:
+    void pollNow();             // 送出指令後呼叫：立即查詢並回到快速輪詢
+    void pollAfterOperation();  // Single 等待完成：有 SRQ 時先送 *OPC，完成即通知
+    void pause();               // 阻塞直到目前的查詢結束；之後其他執行緒可獨佔儀器
+    void resume();
+
+signals:
+    void statusChanged(const ScopeStatus& status);
+
+private:
+    void run();
+    bool waitForNextPoll(int intervalMs, bool useSrq);  // 回傳 true = 有事件，回到快速輪詢
+
+    DPO7000* m_scope = nullptr;
+    QThread* m_thread = nullptr;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    bool m_stop = false;
+    bool m_paused = false;
+    bool m_parked = false;          // 背景執行緒已停在暫停點
+    bool m_pollRequested = false;
+    bool m_armOpc = false;
+    int m_fastMs = 100;
+    int m_idleMs = 2000;
+    ScopeStatus m_last;
+};
+
+Q_DECLARE_METATYPE(ScopeStatus)
@@ -0,0 +1,217 @@
+#include "sequencerunner.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+
+SequenceRunner::SequenceRunner(QObject* parent)
+    : QObject(parent)
+{
+}
+
+SequenceRunner::~SequenceRunner()
+{
+    abort();
+    wait();
+}
+
+bool SequenceRunner::start(std::unique_ptr<Executor> executor, const QVector<SequenceStep>& steps)
+{
+    if (!executor || steps.isEmpty()) return false;
+
+    QMutexLocker locker(&m_mutex);
+    if (m_running) return false;
+    m_running = true;
+    m_paused = false;
+    m_abort = false;
+    locker.unlock();
+
+    // QtConcurrent 的 lambda 必須可複製，executor 改由 shared_ptr 持有
+    std::shared_ptr<Executor> shared(std::move(executor));
+    m_future = QtConcurrent::run([this, shared, steps]() {
+        run(shared, steps);
+    });
+    return true;
+}
+
+bool SequenceRunner::isRunning() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_running;
+}
+
+bool SequenceRunner::isPaused() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_paused;
+}
+
+void SequenceRunner::pause()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_running || m_paused) return;
+    m_paused = true;
+    locker.unlock();
+    emit pausedChanged(true);
+}
+
+void SequenceRunner::resume()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_paused) return;
+    m_paused = false;
+    m_wake.wakeAll();
+    locker.unlock();
+    emit pausedChanged(false);
+}
+
+void SequenceRunner::abort()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_running) return;
+    m_abort = true;
+    m_wake.wakeAll();
+}
+
+void SequenceRunner::wait()
+{
+    m_future.waitForFinished();
+}
+
+void SequenceRunner::run(const std::shared_ptr<Executor>& executor, const QVector<SequenceStep>& steps)
+{
+    const int total = steps.size();
+    QVector<SequenceStepResult> results;
+    results.reserve(total);
+
+    QElapsedTimer clock;
+    clock.start();
+
+    QString error;
+    bool completed = false;
+
+    if (!executor->begin(error)) {
+        qWarning() << "[Sequence] Begin failed:" << error;
+    } else if (!executor->prepare(0, steps.first(), error)) {
+        qWarning() << "[Sequence] Step 1 invalid:" << error;
+    } else {
+        completed = true;
+        for (int i = 0; i < total; ++i) {
+            if (!waitWhilePaused()) {
+                completed = false;
+                break;
+            }
+            emit stepStarted(i, total);
+
+            SequenceStepResult result;
+            result.index = i;
+            const qint64 applyStart = clock.nsecsElapsed();
+            result.success = executor->apply(i, result.error);
+            result.applyNs = clock.nsecsElapsed() - applyStart;
+
+            if (!result.success) {
+                results.append(result);
+                emit stepFinished(result);
+                error = QString("Step %1: %2").arg(i + 1).arg(result.error);
+                completed = false;
+                break;
+            }
+
+            // 停留期間預備下一步，預備時間算在停留時間內
+            const qint64 dwellStart = clock.nsecsElapsed();
+            QString nextError;
+            const bool nextOk = (i + 1 >= total)
+                                || executor->prepare(i + 1, steps[i + 1], nextError);
+            const qint64 prepareNs = clock.nsecsElapsed() - dwellStart;
+
+            const bool dwellOk = dwell(qint64(qMax(0, steps[i].dwellMs)) * 1000000, prepareNs,
+                                       result.dwellNs);
+            results.append(result);
+            emit stepFinished(result);
+
+            if (!dwellOk) {
+                completed = false;
+                break;
+            }
+            if (!nextOk) {
+                error = QString("Step %1: %2").arg(i + 2).arg(nextError);
+                completed = false;
+                break;
+            }
+        }
+    }
+
+    executor->end();
+
+    bool aborted = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        aborted = m_abort;
+        m_running = false;
+        m_paused = false;
+        m_abort = false;
+    }
+
+    QString report = summarize(results, total, clock.nsecsElapsed());
+    if (aborted) report = "Aborted. " + report;
+    else if (!error.isEmpty()) report = error + "\n" + report;
+    qDebug() << "[Sequence]" << report;
+    emit finished(completed, report);
+}
+
+bool SequenceRunner::waitWhilePaused()
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_paused && !m_abort)
+        m_wake.wait(&m_mutex);
+    return !m_abort;
+}
+
+// 停留 dwellNs（已經過 alreadyNs）；暫停期間時間凍結，abort 立即返回 false
+bool SequenceRunner::dwell(qint64 dwellNs, qint64 alreadyNs, qint64& elapsedNs)
+{
+    QElapsedTimer clock;
+    clock.start();
+    qint64 consumed = alreadyNs;     // 不含目前這段的已停留時間
+    qint64 segmentStart = 0;
+
+    QMutexLocker locker(&m_mutex);
+    for (;;) {
+        if (m_abort) {
+            elapsedNs = consumed + (clock.nsecsElapsed() - segmentStart);
+            return false;
+        }
+        if (m_paused) {
+            consumed += clock.nsecsElapsed() - segmentStart;
+            while (m_paused && !m_abort)
+                m_wake.wait(&m_mutex);
+            segmentStart = clock.nsecsElapsed();
+            continue;
+        }
+
+        const qint64 remaining = dwellNs - consumed - (clock.nsecsElapsed() - segmentStart);
+        if (remaining <= 0) {
+            elapsedNs = consumed + (clock.nsecsElapsed() - segmentStart);
+            return true;
+        }
+        m_wake.wait(&m_mutex, static_cast<unsigned long>((remaining + 999999) / 1000000));
+    }
+}
+
+QString SequenceRunner::summarize(const QVector<SequenceStepResult>& results, int total, qint64 totalNs)
+{
+    int passed = 0;
+    qint64 applySum = 0;
+    qint64 applyMax = 0;
+    for (const auto& r : results) {
+        if (r.success) ++passed;
+        applySum += r.applyNs;
+        applyMax = std::max(applyMax, r.applyNs);
+    }
+    const double applyAvgMs = results.isEmpty() ? 0.0 : applySum / 1e6 / results.size();
+    return QString("%1/%2 steps, apply avg %3 ms / max %4 ms, total %5 s")
+        .arg(passed).arg(total)
+        .arg(applyAvgMs, 0, 'f', 2)
+        .arg(applyMax / 1e6, 0, 'f', 2)
+        .arg(totalNs / 1e9, 0, 'f', 2);
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFuture>
+#include <memory>
+
+// 序列中的一個步驟：依序套用 Input / Load / Dynamic 條件後停留 dwellMs
+// 欄位為空表示這一步不變更該項設定（沿用上一步）
+struct SequenceStep
+{
+    QString inputText;      // Page2 Input 列，格式 "電壓/頻率/相位"
+    QString loadLabel;      // Page2 Load 列 label
+    QString dyLoadLabel;    // Page2 Dynamic 列 label（與 loadLabel 擇一）
+    int dwellMs = 1000;
+};
+
+struct SequenceStepResult
+{
+    int index = -1;
+    bool success = false;
+    QString error;
+    qint64 applyNs = 0;     // 套用指令（含 *OPC? 確認）所花時間
+    qint64 dwellNs = 0;     // 實際停留時間（暫停期間不計）
+};
+
+// 測試序列引擎：在背景執行緒依序套用步驟，全部時間以單調時鐘（QElapsedTimer）量測
+// 目前步驟停留期間，先預備下一步（查表、解析數值），停留結束後只剩匯流排寫入
+// pause / resume / abort 可從任何執行緒呼叫；暫停時停留時間凍結，abort 會立即喚醒停留中的等待
+class SequenceRunner : public QObject
+{
+    Q_OBJECT
+public:
+    // 步驟的實際執行由呼叫端提供（Page3ViewModel 重用既有的 AC Source / DC Load 設定路徑）
+    // 所有方法都在序列的背景執行緒上呼叫
+    class Executor
+    {
+    public:
+        virtual ~Executor() = default;
+        virtual bool begin(QString& error) = 0;                                 // 取得儀器
+        virtual bool prepare(int index, const SequenceStep& step, QString& error) = 0;  // 不送指令
+        virtual bool apply(int index, QString& error) = 0;                      // 套用已預備的步驟
+        virtual void end() = 0;                                                 // 關閉輸出並歸還儀器
+    };
+
+    explicit SequenceRunner(QObject* parent = nullptr);
+    ~SequenceRunner() override;
+
+    // 已在執行中時回傳 false
+    bool start(std::unique_ptr<Executor> executor, const QVector<SequenceStep>& steps);
+
+    bool isRunning() const;
+    bool isPaused() const;
+
+public slots:
+    void pause();
+    void resume();
+    void abort();
+    void wait();    // 阻塞直到序列結束
+
+signals:
+    void stepStarted(int index, int total);
+    void stepFinished(const SequenceStepResult& result);
+    void pausedChanged(bool paused);
+    void finished(bool completed, const QString& report);
+
+private:
+    void run(const std::shared_ptr<Executor>& executor, const QVector<SequenceStep>& steps);
+    bool waitWhilePaused();                      // 回傳 false = 已中止
+    bool dwell(qint64 dwellNs, qint64 alreadyNs, qint64& elapsedNs);
+    static QString summarize(const QVector<SequenceStepResult>& results, int total, qint64 totalNs);
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    bool m_running = false;
+    bool m_paused = false;
+    bool m_abort = false;
+    QFuture<void> m_future;
+};
+
+Q_DECLARE_METATYPE(SequenceStepResult)
@@ -10,6 +10,9 @@
 #include "page3viewmodel.h"
 #include "page4viewmodel.h"
 #include "appservice.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
 #include <QDebug>
 
 MainWindowViewModel::MainWindowViewModel(MainWindowModel* model, QObject* parent)
@@ -32,10 +35,16 @@ MainWindowViewModel::MainWindowViewModel(MainWindowModel* model, QObject* parent
 
     // 註冊 Meta Types
     AppService::instance().registerMetaTypes();
+
+    restartAutosave();
 }
 
 MainWindowViewModel::~MainWindowViewModel()
 {
+    // 頁面即將被銷毀：停止自動存檔，並等背景存檔寫完
+    AppService::instance().stopAutosave();
+    AppService::instance().waitForPendingIo();
+
     // Qt 父子關係會自動清理
 }
 
@@ -118,6 +127,7 @@ void MainWindowViewModel::onSaveDialogAccepted(const QString& fileName)
         );
 
     m_model->setLastSavePath(finalFileName);
+    restartAutosave();
 }
 
 void MainWindowViewModel::onLoadDialogAccepted(const QString& fileName)
@@ -130,4 +140,30 @@ void MainWindowViewModel::onLoadDialogAccepted(const QString& fileName)
         );
 
     m_model->setLastSavePath(fileName);
+    restartAutosave();
+}
+
+QString MainWindowViewModel::autosavePath() const
+{
+    const QString current = m_model ? m_model->lastSavePath() : QString();
+    if (!current.isEmpty()) {
+        // 載入的就是自動存檔時直接沿用，不再疊加副檔名
+        if (current.endsWith(".autosave.xml", Qt::CaseInsensitive)) return current;
+        const QFileInfo info(current);
+        return info.dir().filePath(info.completeBaseName() + ".autosave.xml");
+    }
+
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    if (dir.isEmpty() || !QDir().mkpath(dir)) return QString();
+    return QDir(dir).filePath("autosave.xml");
+}
+
+void MainWindowViewModel::restartAutosave()
+{
+    // 路徑為空時 startAutosave 會停止自動存檔
+    AppService::instance().startAutosave(
+        autosavePath(), autosaveIntervalMs,
+        m_page1, m_page2, m_page3,
+        m_page1ViewModel, m_page2ViewModel, m_page3ViewModel
+        );
 }
@@ -58,4 +58,10 @@ private:
     void initializeViewModels();
     void initializeMainWidget();
     void setupPageConnections();
+
+    // 自動存檔：寫到目前設定檔旁的 <name>.autosave.xml（尚未存檔 / 載入時寫到使用者資料夾），
+    // 不覆蓋操作員的設定檔；設定檔路徑變更後重新指定
+    QString autosavePath() const;
+    void restartAutosave();
+    static const int autosaveIntervalMs = 60000;
 };
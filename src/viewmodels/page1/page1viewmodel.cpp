@@ -163,14 +163,20 @@ void Page1ViewModel::assignChannelNumbers(InstrumentConfig& inst) const
 
 // ==================== XML 序列化 ====================
 
-void Page1ViewModel::writeXml(QXmlStreamWriter& writer) const
+// Page1 設定很小，不追蹤版本，每次存檔都重新序列化
+ConfigSection Page1ViewModel::xmlSection() const
 {
-    if (m_model) m_model->writeXml(writer);
+    if (!m_model) return {};
+
+    const Page1Config config = m_model->getConfig();
+    return { "Page1", 0, [config](QXmlStreamWriter& writer) {
+                 Page1Model::writeConfigXml(writer, config);
+             } };
 }
 
-void Page1ViewModel::loadXml(QXmlStreamReader& reader)
+void Page1ViewModel::applyLoadedConfig(const Page1Config& config)
 {
-    if (m_model) m_model->loadXml(reader);
+    if (m_model) m_model->applyLoadedConfig(config);
 }
 
 // ==================== 工具函式 ====================
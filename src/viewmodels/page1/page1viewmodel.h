@@ -5,6 +5,7 @@
 #include <QList>
 #include "page1model.h"
 #include "page1config.h"
+#include "configfilewriter.h"
 
 class Page1Model;
 struct Page1Config;
@@ -24,8 +25,9 @@ public:
     QSet<int>           channelsOfModel(const QString &modelName) const;
     bool                hasChannelInterface(const QString &instName) const;
 
-    void writeXml(QXmlStreamWriter& writer) const;
-    void loadXml(QXmlStreamReader& reader);
+    // XML 序列化：xmlSection() 擷取目前設定的副本，可在背景執行緒寫出；解析結果回到 GUI 執行緒再套用
+    ConfigSection xmlSection() const;
+    void applyLoadedConfig(const Page1Config& config);
 
 public slots:
     void setLoadOutputs(int value);
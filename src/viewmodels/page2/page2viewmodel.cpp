@@ -8,6 +8,9 @@
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
 #include "page2model.h"
+#include "page1config.h"
+#include "chromaload6310spec.h"
+#include <cmath>
 
 Page2ViewModel::Page2ViewModel(Page2Model* model, QObject *parent)
     : QObject(parent), m_model(model)
@@ -27,22 +30,22 @@ void Page2ViewModel::setMaxOutput(int maxOutput)
         if (v.size() > maxOutput) v.resize(maxOutput);
     };
     resizeVec(meta.names);
-    resizeVec(meta.vo);
     resizeVec(meta.modes);
-    resizeVec(meta.von);
-    resizeVec(meta.riseSlopeCCH);
-    resizeVec(meta.fallSlopeCCH);
-    resizeVec(meta.riseSlopeCCL);
-    resizeVec(meta.fallSlopeCCL);
+    meta.vo.resize(maxOutput);
+    meta.von.resize(maxOutput);
+    meta.riseSlopeCCH.resize(maxOutput);
+    meta.fallSlopeCCH.resize(maxOutput);
+    meta.riseSlopeCCL.resize(maxOutput);
+    meta.fallSlopeCCL.resize(maxOutput);
 
     // 同步調整 Dynamic Meta 資料長度（包含 vo 欄位）
     auto& dmeta = m_model->dynamicMeta;
-    resizeVec(dmeta.vo);
-    resizeVec(dmeta.von);
-    resizeVec(dmeta.riseSlopeCCDH);
-    resizeVec(dmeta.fallSlopeCCDH);
-    resizeVec(dmeta.riseSlopeCCDL);
-    resizeVec(dmeta.fallSlopeCCDL);
+    dmeta.vo.resize(maxOutput);
+    dmeta.von.resize(maxOutput);
+    dmeta.riseSlopeCCDH.resize(maxOutput);
+    dmeta.fallSlopeCCDH.resize(maxOutput);
+    dmeta.riseSlopeCCDL.resize(maxOutput);
+    dmeta.fallSlopeCCDL.resize(maxOutput);
 
     // 發出表頭變更信號
     QStringList headers{ "Output" };
@@ -57,7 +60,7 @@ void Page2ViewModel::setMaxOutput(int maxOutput)
     emit headersChanged(LoadKind::Load, loadHeaders);
     emit headersChanged(LoadKind::DyLoad, dynHeaders);
 
-    broadcastAllPowers();
+    updateDirtyPowers();
 }
 
 // 設置 Relay 表格的輸出數量
@@ -132,63 +135,204 @@ void Page2ViewModel::removeRow(LoadKind kind)
         emit TitleListChanged(LoadKind::DyLoad, TitleList(LoadKind::DyLoad));
 }
 
-// 單元格值變更處理
+// 單元格值變更處理：UI 每次按鍵只送出被編輯的 cell，這裡只更新該 cell
+// Model / 快照不做整張表比較；Power 與檔位只重算受影響的行或 cell
 void Page2ViewModel::cellValueChanged(LoadKind kind,
                                       int row, int col,
                                       const QString &text)
 {
+    if (row < 0 || col < 0) return;
+
     switch (kind) {
     case LoadKind::Input:
-        // 更新 Input 標題顯示
-        emit inputTitleChanged(row, QString());
+        editInputCell(row, col, text);
         break;
-
-    case LoadKind::Relay: {
-        // 只在數據行的 label 變動時更新標題列表
-        if (row >= META_ROWS_Relay && col == 0) {
-            emit TitleListChanged(LoadKind::Relay, TitleList(LoadKind::Relay));
-        }
+    case LoadKind::Relay:
+        editRelayCell(row, col, text);
+        break;
+    case LoadKind::Load:
+        editLoadCell(row, col, text);
+        break;
+    case LoadKind::DyLoad:
+        editDynamicCell(row, col, text);
         break;
     }
+}
 
-    case LoadKind::Load: {
-        // row 1: Name 行
-        if (row == 1) {
-            // emit loadNameListChanged(loadNameList());
-        }
-        // 數據行的 label 變動
-        else if (row >= META_ROWS && col == 0) {
-            emit TitleListChanged(LoadKind::Load, TitleList(LoadKind::Load));
-        }
-        // row 2: Vo 行（影響所有 Power 計算）
-        else if (row == 2) {
-            for (int r = 0; r < m_model->loadRows.size(); ++r) {
-                double p = calcRowPower(r);
-                emit powerUpdated(r + META_ROWS, p);
-            }
-        }
-        // 數據行值變動（只影響該行的 Power）
-        else if (row >= META_ROWS) {
-            int dataRow = row - META_ROWS;
-            if (dataRow < m_model->loadRows.size()) {
-                double p = calcRowPower(dataRow);
-                emit powerUpdated(row, p);
-            }
-        }
-        break;
+namespace {
+// 更新一個數值 cell，回傳內容是否有變（空白 / 無法解析視為無效）
+bool setCellText(NumericColumn& column, int i, const QString& text)
+{
+    if (column.size() <= i) column.resize(i + 1);
+    const bool wasValid = column.isValid(i);
+    const double old = column.value(i);
+    const bool valid = column.setText(i, text);
+    return valid != wasValid || (valid && column.value(i) != old);
+}
+
+// Load Meta 行 2~7（Vo、Von、Slope）
+NumericColumn* loadMetaColumn(LoadMetaRow& meta, int row)
+{
+    switch (row) {
+    case 2: return &meta.vo;
+    case 3: return &meta.von;
+    case 4: return &meta.riseSlopeCCH;
+    case 5: return &meta.fallSlopeCCH;
+    case 6: return &meta.riseSlopeCCL;
+    case 7: return &meta.fallSlopeCCL;
+    default: return nullptr;
     }
+}
 
-    case LoadKind::DyLoad: {
-        // 只在數據行的 label 變動時更新標題列表
-        if (row >= META_ROWS_Dy && col == 0) {
-            emit TitleListChanged(LoadKind::DyLoad, TitleList(LoadKind::DyLoad));
+// Dynamic Meta 行 0~5（Vo、Von、Slope）
+NumericColumn* dynamicMetaColumn(DynamicMetaRow& meta, int row)
+{
+    switch (row) {
+    case 0: return &meta.vo;
+    case 1: return &meta.von;
+    case 2: return &meta.riseSlopeCCDH;
+    case 3: return &meta.fallSlopeCCDH;
+    case 4: return &meta.riseSlopeCCDL;
+    case 5: return &meta.fallSlopeCCDL;
+    default: return nullptr;
+    }
+}
+}
+
+// Input：欄 1~3 為 Vin / Frequency / Phase，欄 0 是由三者組成的標題
+void Page2ViewModel::editInputCell(int row, int col, const QString& text)
+{
+    if (col < 1 || col > 3) return;
+
+    auto& rows = m_model->inputRows;
+    if (rows.size() <= row) rows.resize(row + 1);
+    QString& field = (col == 1) ? rows[row].vin : (col == 2) ? rows[row].frequency : rows[row].phase;
+    if (field == text) return;
+    field = text;
+
+    publishRecipe(RecipeSnapshot::withEdit(m_recipe, RecipeSnapshot::InputTable,
+                                           [&rows](RecipeTables& t) { t.inputRows = rows; }));
+    emit inputTitleChanged(row, QString());
+    emit TitleListChanged(LoadKind::Input, TitleList(LoadKind::Input));
+}
+
+// Relay：欄 0 為 label，欄 1 起為各輸出的 on / off
+void Page2ViewModel::editRelayCell(int row, int col, const QString& text)
+{
+    const int dataRow = row - META_ROWS_Relay;
+    if (dataRow < 0) return;
+
+    auto& rows = m_model->relayRows;
+    if (rows.size() <= dataRow) rows.resize(dataRow + 1);
+    RelayDataRow& data = rows[dataRow];
+
+    if (col == 0) {
+        if (data.label == text) return;
+        data.label = text;
+        emit TitleListChanged(LoadKind::Relay, TitleList(LoadKind::Relay));
+        return;
+    }
+
+    const int out = col - 1;
+    if (out >= m_maxRelayOutput) return;
+    while (data.values.size() < m_maxRelayOutput)
+        data.values.append(QString("off"));
+    data.values[out] = text;
+}
+
+// Load：Meta 行 0 Mode、1 Name、2~7 數值；數據行欄 0 為 label，最後一欄 Power 不可編輯
+void Page2ViewModel::editLoadCell(int row, int col, const QString& text)
+{
+    const int outputs = maxOutput();
+    const int out = col - 1;
+
+    if (row < META_ROWS) {
+        if (out < 0 || out >= outputs) return;
+        auto& meta = m_model->loadMeta;
+        if (row == 0 || row == 1) {
+            QVector<QString>& texts = (row == 0) ? meta.modes : meta.names;
+            if (texts.size() <= out) texts.resize(outputs);
+            if (texts[out] == text) return;
+            texts[out] = text;
+        } else if (!setCellText(*loadMetaColumn(meta, row), out, text)) {
+            return;
         }
-        break;
+        publishRecipe(RecipeSnapshot::withEdit(m_recipe, RecipeSnapshot::LoadMetaTable,
+                                               [&meta](RecipeTables& t) { t.loadMeta = meta; }));
+        if (row == 2) updateVoShadow(out);     // Vo 影響該欄所有有值行的 Power 與檔位
+        return;
     }
 
-    default:
-        break;
+    const int dataRow = row - META_ROWS;
+    auto& rows = m_model->loadRows;
+    if (rows.size() <= dataRow) rows.resize(dataRow + 1);
+    LoadDataRow& data = rows[dataRow];
+
+    if (col == 0) {
+        if (data.label == text) return;
+        data.label = text;
+        publishRecipe(RecipeSnapshot::withEdit(m_recipe, RecipeSnapshot::LoadRowsTable,
+                                               [&rows](RecipeTables& t) { t.loadRows = rows; }));
+        emit TitleListChanged(LoadKind::Load, TitleList(LoadKind::Load));
+        return;
     }
+
+    if (out >= outputs) return;
+    if (data.values.size() < outputs) data.values.resize(outputs);
+    if (!setCellText(data.values, out, text)) return;
+    publishRecipe(RecipeSnapshot::withEdit(m_recipe, RecipeSnapshot::LoadRowsTable,
+                                           [&rows](RecipeTables& t) { t.loadRows = rows; },
+                                           false));
+    updateLoadCellShadow(dataRow, out);
+}
+
+// Dynamic：Meta 行 0~5 數值；數據行欄 0 為 label，欄 1 起為 "a~b" 區間，最後一欄 T1~T2 存在 Meta
+void Page2ViewModel::editDynamicCell(int row, int col, const QString& text)
+{
+    const int outputs = maxOutput();
+    const int out = col - 1;
+    auto& meta = m_model->dynamicMeta;
+    auto publishMeta = [this, &meta]() {
+        publishRecipe(RecipeSnapshot::withEdit(m_recipe, RecipeSnapshot::DynamicMetaTable,
+                                               [&meta](RecipeTables& t) { t.dynamicMeta = meta; }));
+    };
+
+    if (row < META_ROWS_Dy) {
+        if (out < 0 || out >= outputs) return;
+        if (!setCellText(*dynamicMetaColumn(meta, row), out, text)) return;
+        publishMeta();
+        return;
+    }
+
+    const int dataRow = row - META_ROWS_Dy;
+    if (col == outputs + 1) {
+        if (meta.t1t2.size() <= dataRow) meta.t1t2.resize(dataRow + 1);
+        if (meta.t1t2[dataRow] == text) return;
+        meta.t1t2[dataRow] = text;
+        publishMeta();
+        return;
+    }
+
+    auto& rows = m_model->dynamicRows;
+    if (rows.size() <= dataRow) rows.resize(dataRow + 1);
+    DynamicDataRow& data = rows[dataRow];
+
+    if (col == 0) {
+        if (data.label == text) return;
+        data.label = text;
+        publishRecipe(RecipeSnapshot::withEdit(m_recipe, RecipeSnapshot::DynamicRowsTable,
+                                               [&rows](RecipeTables& t) { t.dynamicRows = rows; }));
+        emit TitleListChanged(LoadKind::DyLoad, TitleList(LoadKind::DyLoad));
+        return;
+    }
+
+    if (out >= outputs) return;
+    if (data.values.size() < outputs) data.values.resize(outputs);
+    if (data.values[out] == text) return;
+    data.values[out] = text;
+    publishRecipe(RecipeSnapshot::withEdit(m_recipe, RecipeSnapshot::DynamicRowsTable,
+                                           [&rows](RecipeTables& t) { t.dynamicRows = rows; },
+                                           false));
 }
 
 // 計算指定數據行的功率（Power = Σ(Vo[i] * Value[i])）
@@ -204,7 +348,7 @@ double Page2ViewModel::calcRowPower(int dataRow) const
     // 檢查：如果每一組都是空的，返回 NaN
     bool allEmpty = true;
     for (int i = 0; i < N; ++i) {
-        if (!vo[i].trimmed().isEmpty() && !rowVals[i].trimmed().isEmpty()) {
+        if (vo.isValid(i) && rowVals.isValid(i)) {
             allEmpty = false;
             break;
         }
@@ -214,16 +358,232 @@ double Page2ViewModel::calcRowPower(int dataRow) const
     // 計算總功率
     double total = 0.0;
     for (int i = 0; i < N; ++i)
-        total += vo[i].toDouble() * rowVals[i].toDouble();
+        total += vo.value(i) * rowVals.value(i);
     return total;
 }
 
 // 廣播所有數據行的功率更新
 void Page2ViewModel::broadcastAllPowers()
 {
-    for (int r = 0; r < m_model->loadRows.size(); ++r) {
-        emit powerUpdated(r + META_ROWS, calcRowPower(r));
+    m_shadowOutputs = -1;   // 整張表重新解析
+    updateDirtyPowers();
+}
+
+// 把 Model 的數值欄同步到影子：只標記有變動的行，回傳是否有行需要重算
+bool Page2ViewModel::syncPowerShadow()
+{
+    const double nan = std::nan("");
+    auto at = [nan](const NumericColumn& col, int i) {
+        return col.isValid(i) ? col.value(i) : nan;
+    };
+    auto same = [](double a, double b) {
+        return a == b || (std::isnan(a) && std::isnan(b));
+    };
+
+    const int outputs = maxOutput();
+    const auto& vo = m_model->loadMeta.vo;
+    const auto& rows = m_model->loadRows;
+    const int cells = rows.size() * outputs;
+
+    // 結構變動（輸出數 / 行數）：全部重建
+    if (outputs != m_shadowOutputs || rows.size() != m_rowPowers.size()) {
+        m_shadowOutputs = outputs;
+        m_voValues.resize(outputs);
+        for (int c = 0; c < outputs; ++c)
+            m_voValues[c] = at(vo, c);
+        m_cellValues.resize(cells);
+        for (int r = 0; r < rows.size(); ++r) {
+            for (int c = 0; c < outputs; ++c)
+                m_cellValues[r * outputs + c] = at(rows[r].values, c);
+        }
+        m_rowPowers.fill(nan, rows.size());
+        m_rowDirty.fill(1, rows.size());
+        return true;
+    }
+
+    bool anyDirty = false;
+    for (int r = 0; r < rows.size(); ++r) {
+        const auto& values = rows[r].values;
+        for (int c = 0; c < outputs; ++c) {
+            const int i = r * outputs + c;
+            const double v = at(values, c);
+            if (same(v, m_cellValues[i])) continue;
+            m_cellValues[i] = v;
+            m_rowDirty[r] = 1;
+            anyDirty = true;
+        }
+    }
+
+    // Vo 變動只影響該欄有值的行
+    for (int c = 0; c < outputs; ++c) {
+        const double v = at(vo, c);
+        if (same(v, m_voValues[c])) continue;
+        m_voValues[c] = v;
+        for (int r = 0; r < rows.size(); ++r) {
+            if (!std::isnan(m_cellValues[r * outputs + c])) {
+                m_rowDirty[r] = 1;
+                anyDirty = true;
+            }
+        }
+    }
+    return anyDirty;
+}
+
+// 重算有變動的行（Power = Σ(Vo[i] * Value[i])），合併成一個 powersUpdated
+void Page2ViewModel::updateDirtyPowers()
+{
+    if (!syncPowerShadow()) return;
+
+    QVector<int> rows;
+    QVector<double> values;
+
+    for (int r = 0; r < m_rowPowers.size(); ++r) {
+        if (!m_rowDirty[r]) continue;
+        m_rowDirty[r] = 0;
+
+        m_rowPowers[r] = shadowRowPower(r);
+        rows.append(r + META_ROWS);
+        values.append(m_rowPowers[r]);
+    }
+
+    if (!rows.isEmpty())
+        emit powersUpdated(rows, values);
+    checkLoadTable();
+}
+
+// 由影子計算一行的 Power；每一組 Vo / Value 都是空的則為 NaN，空白視為 0
+double Page2ViewModel::shadowRowPower(int row) const
+{
+    const int outputs = m_shadowOutputs;
+    const double* cell = m_cellValues.constData() + row * outputs;
+    bool anyPair = false;
+    double total = 0.0;
+    for (int c = 0; c < outputs; ++c) {
+        const double v = m_voValues[c];
+        const double x = cell[c];
+        anyPair |= !std::isnan(v) && !std::isnan(x);
+        total += (std::isnan(v) ? 0.0 : v) * (std::isnan(x) ? 0.0 : x);
+    }
+    return anyPair ? total : std::nan("");
+}
+
+// 影子、檔位結果與 Model 的結構（行數 / 輸出數）一致時，才能只更新單一 cell
+bool Page2ViewModel::shadowInSync() const
+{
+    const int rows = m_model->loadRows.size();
+    const int cells = rows * m_shadowOutputs;
+    return m_shadowOutputs == maxOutput() && m_rowPowers.size() == rows
+           && m_checkedOutputs == m_shadowOutputs && m_checkedRanges.size() == cells
+           && m_loadBatch.size() == cells;
+}
+
+// 單一數據 cell 變動：只更新該 cell 的影子、重算該行 Power、重新判斷該 cell 的檔位
+void Page2ViewModel::updateLoadCellShadow(int dataRow, int output)
+{
+    if (!shadowInSync()) {
+        updateDirtyPowers();
+        return;
+    }
+
+    const NumericColumn& values = m_model->loadRows[dataRow].values;
+    const int cell = dataRow * m_shadowOutputs + output;
+    m_cellValues[cell] = values.isValid(output) ? values.value(output) : std::nan("");
+    m_rowPowers[dataRow] = shadowRowPower(dataRow);
+
+    emit powersUpdated({ dataRow + META_ROWS }, { m_rowPowers[dataRow] });
+    checkLoadCell(cell);
+}
+
+// 單一 Vo 變動：只重算該欄有值的行
+void Page2ViewModel::updateVoShadow(int output)
+{
+    if (!shadowInSync()) {
+        updateDirtyPowers();
+        return;
+    }
+
+    const auto& vo = m_model->loadMeta.vo;
+    m_voValues[output] = vo.isValid(output) ? vo.value(output) : std::nan("");
+
+    QVector<int> rows;
+    QVector<double> values;
+    for (int r = 0; r < m_rowPowers.size(); ++r) {
+        const int cell = r * m_shadowOutputs + output;
+        if (std::isnan(m_cellValues[cell])) continue;
+        m_rowPowers[r] = shadowRowPower(r);
+        rows.append(r + META_ROWS);
+        values.append(m_rowPowers[r]);
+        checkLoadCell(cell);
+    }
+    if (!rows.isEmpty())
+        emit powersUpdated(rows, values);
+}
+
+// 依 Page1 的 Load 通道設定建立「輸出 index → 子型號」對照
+void Page2ViewModel::setLoadSubModels(const Page1Config& cfg)
+{
+    m_outputSubModelIds.clear();
+    for (const auto& ic : cfg.instruments) {
+        if (!ic.enabled || ic.type != "Load") continue;
+        for (const auto& ch : ic.channels) {
+            if (ch.index <= 0 || ch.subModel.isEmpty()) continue;
+            while (m_outputSubModelIds.size() < ch.index)
+                m_outputSubModelIds.append(-1);
+            m_outputSubModelIds[ch.index - 1] = chromaSubModelId(ch.subModel);
+        }
+    }
+    checkLoadTable();
+}
+
+// 整張 Load 表一次判斷檔位與 OPP 風險（500 行 × 8 輸出只是數千個 cell 的純數值運算）
+// 數值直接取自 Power 的數值影子
+void Page2ViewModel::checkLoadTable()
+{
+    syncPowerShadow();
+
+    const int outputs = m_shadowOutputs;
+    const int cells = m_cellValues.size();
+
+    m_loadBatch.resize(cells);
+    for (int i = 0; i < cells; ++i) {
+        const int c = i % outputs;
+        const double current = m_cellValues[i];
+        const double voltage = std::isnan(m_voValues[c]) ? 0.0 : m_voValues[c];
+        m_loadBatch.setCell(i, std::isnan(current) ? -1 : m_outputSubModelIds.value(c, -1),
+                            current, voltage);
+    }
+    m_loadBatch.evaluate();
+
+    // 表格結構變了就全部重新通知
+    if (outputs != m_checkedOutputs || m_checkedRanges.size() != cells) {
+        m_checkedRanges.fill(ChromaLoadBatch::RangeNotApplicable - 1, cells);
+        m_checkedOutputs = outputs;
     }
+
+    for (int i = 0; i < cells; ++i)
+        notifyLoadCell(i);
+}
+
+// 重新判斷單一 cell（shadowInSync() 成立時）
+void Page2ViewModel::checkLoadCell(int cell)
+{
+    const int c = cell % m_shadowOutputs;
+    const double current = m_cellValues[cell];
+    const double voltage = std::isnan(m_voValues[c]) ? 0.0 : m_voValues[c];
+    m_loadBatch.setCell(cell, std::isnan(current) ? -1 : m_outputSubModelIds.value(c, -1),
+                        current, voltage);
+    m_loadBatch.evaluate(cell, 1);
+    notifyLoadCell(cell);
+}
+
+// 檢查結果有變化才通知 UI
+void Page2ViewModel::notifyLoadCell(int cell)
+{
+    const qint8 range = m_loadBatch.range(cell);
+    if (range == m_checkedRanges[cell]) return;
+    m_checkedRanges[cell] = range;
+    emit loadCellChecked(cell / m_checkedOutputs + META_ROWS, cell % m_checkedOutputs + 1,
+                         m_loadBatch.mode(cell), m_loadBatch.oppRisk(cell));
 }
 
 // 獲取 Load 的名稱列表
@@ -238,14 +598,21 @@ QStringList Page2ViewModel::loadNameList() const
 }
 
 // XML 序列化
-void Page2ViewModel::writeXml(QXmlStreamWriter& writer) const
+ConfigSection Page2ViewModel::xmlSection()
 {
-    m_model->writeXml(writer);
+    const Page2Model::Tables tables = m_model->tables();
+    if (tables != m_savedTables) {
+        m_savedTables = tables;
+        ++m_xmlRevision;
+    }
+    return { "Page2", m_xmlRevision, [tables](QXmlStreamWriter& writer) {
+                 Page2Model::writeTablesXml(writer, tables);
+             } };
 }
 
-void Page2ViewModel::loadXml(QXmlStreamReader& reader)
+void Page2ViewModel::applyLoadedTables(const Page2Model::Tables& tables)
 {
-    m_model->loadXml(reader);
+    m_model->applyLoadedTables(tables);
     refreshUIOutputs();
 }
 
@@ -293,6 +660,8 @@ int Page2ViewModel::maxOutput() const {
 // 配置載入完成回調
 void Page2ViewModel::onConfigLoaded()
 {
+    m_checkedRanges.clear();   // UI 會重建，檢查結果需全部重新通知
+    m_shadowOutputs = -1;      // Power 也需全部重算
     emit dataChanged();
 }
 
@@ -300,7 +669,7 @@ void Page2ViewModel::onConfigLoaded()
 
 void Page2ViewModel::setInputRows(const QVector<InputRow>& rows) {
     m_model->inputRows = rows;
-    emit inputRowsStructChanged(rows);
+    publishRecipe(RecipeSnapshot::withInputRows(m_recipe, rows));
     emit TitleListChanged(LoadKind::Input, TitleList(LoadKind::Input));
 }
 
@@ -312,22 +681,30 @@ void Page2ViewModel::setRelayRows(const QVector<RelayDataRow>& rows) {
 
 void Page2ViewModel::setLoadMeta(const LoadMetaRow& meta) {
     m_model->loadMeta = meta;
-    emit loadMetaStructChanged(meta);
+    publishRecipe(RecipeSnapshot::withLoadMeta(m_recipe, meta));
     emit TitleListChanged(LoadKind::Load, TitleList(LoadKind::Load));
 }
 
 void Page2ViewModel::setLoadRows(const QVector<LoadDataRow>& rows) {
     m_model->loadRows = rows;
-    emit loadRowsStructChanged(rows);
+    publishRecipe(RecipeSnapshot::withLoadRows(m_recipe, rows));
 }
 
 void Page2ViewModel::setDynamicMeta(const DynamicMetaRow& meta) {
     m_model->dynamicMeta = meta;
-    emit dynamicMetaStructChanged(meta);
+    publishRecipe(RecipeSnapshot::withDynamicMeta(m_recipe, meta));
     emit TitleListChanged(LoadKind::DyLoad, TitleList(LoadKind::DyLoad));
 }
 
 void Page2ViewModel::setDynamicRows(const QVector<DynamicDataRow>& rows) {
     m_model->dynamicRows = rows;
-    emit dynamicRowsStructChanged(rows);
+    publishRecipe(RecipeSnapshot::withDynamicRows(m_recipe, rows));
+}
+
+// 內容沒變時 with*() 會回傳原本的快照，不通知
+void Page2ViewModel::publishRecipe(const RecipeSnapshotPtr& snapshot)
+{
+    if (snapshot == m_recipe) return;
+    m_recipe = snapshot;
+    emit recipeSnapshotChanged(m_recipe);
 }
@@ -5,6 +5,11 @@
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
 #include "page2model.h"
+#include "chromaloadbatch.h"
+#include "recipesnapshot.h"
+#include "configfilewriter.h"
+
+struct Page1Config;
 
 // Page2 的 ViewModel - 負責業務邏輯和 UI-Model 數據轉換
 class Page2ViewModel : public QObject
@@ -19,9 +24,9 @@ public:
     // 獲取指定表格的標題列表（供 Page3 ComboBox 使用）
     QStringList TitleList(LoadKind type) const;
 
-    // XML 序列化
-    void writeXml(QXmlStreamWriter& writer) const;
-    void loadXml(QXmlStreamReader& reader);
+    // XML 序列化：xmlSection() 擷取表格副本（O(1)），表格內容沒變時 revision 不變，存檔沿用上次的片段
+    ConfigSection xmlSection();
+    void applyLoadedTables(const Page2Model::Tables& tables);
 
     // Model 數據代理訪問
     const QVector<InputRow>& inputRows() const      { return m_model->inputRows; }
@@ -31,6 +36,9 @@ public:
     const DynamicMetaRow& dynamicMeta() const      { return m_model->dynamicMeta; }
     const QVector<DynamicDataRow>& dynamicRows() const { return m_model->dynamicRows; }
 
+    // 目前的配方快照（Input / Load / Dynamic），可直接跨執行緒保存
+    RecipeSnapshotPtr recipeSnapshot() const { return m_recipe; }
+
     int maxOutput() const;           // Load/Dynamic 的最大輸出數
     int maxRelayOutput() const { return m_maxRelayOutput; }
 
@@ -45,17 +53,24 @@ public:
     // Power 計算（Load 表格專用）
     double calcRowPower(int dataRow) const;     // dataRow 是數據行索引（不含 Meta 行）
     void broadcastAllPowers();                  // 廣播所有行的 Power 更新
+    void updateDirtyPowers();                   // 只重算數值有變動的行
+
+    // 檔位 / OPP 檢查（Load 表格專用）：整張表一次批次判斷，只對狀態有變化的 cell 發出 loadCellChecked
+    void checkLoadTable();
 
 public slots:
     // 設置輸出數量（會調整 Meta 長度並更新表頭）
     void setMaxOutput(int maxOutput);
     void setMaxRelayOutput(int maxRelayOutput);
 
+    // Page1 設定變更：更新每個輸出對應的 Chroma 子型號
+    void setLoadSubModels(const Page1Config& cfg);
+
     // 行操作
     void addRow(LoadKind kind);
     void removeRow(LoadKind kind);
 
-    // 單元格值變更處理
+    // 單元格值變更處理：只更新被編輯的 cell（row / col 為 UI 表格座標，含 Meta 行）
     void cellValueChanged(LoadKind kind, int row, int col, const QString &text);
 
     // UI 刷新
@@ -77,18 +92,16 @@ signals:
     void rowAddRequested(LoadKind kind, const QStringList &validatorTags);
     void rowRemoveRequested(LoadKind kind);
     void inputTitleChanged(int row, const QString &display);
-    void powerUpdated(int row, double value);
+    void powersUpdated(const QVector<int>& rows, const QVector<double>& values);
+    void loadCellChecked(int row, int col, const QString& mode, bool oppRisk);
 
     // 標題列表變更（通知 Page3）
     void TitleListChanged(LoadKind type, const QStringList& titles);
 
     // 數據變更
     void dataChanged();
-    void inputRowsStructChanged(const QVector<InputRow>&);
-    void loadMetaStructChanged(const LoadMetaRow&);
-    void loadRowsStructChanged(const QVector<LoadDataRow>&);
-    void dynamicMetaStructChanged(const DynamicMetaRow&);
-    void dynamicRowsStructChanged(const QVector<DynamicDataRow>&);
+    // 配方內容有變動才發出；使用端以 changedSince() 取差異
+    void recipeSnapshotChanged(const RecipeSnapshotPtr& snapshot);
 
 private:
     // Meta 行數常量
@@ -98,4 +111,35 @@ private:
 
     int m_maxRelayOutput = 1;
     Page2Model* m_model = nullptr;
+
+    void publishRecipe(const RecipeSnapshotPtr& snapshot);
+    RecipeSnapshotPtr m_recipe = RecipeSnapshot::create();
+
+    // 單一 cell 編輯
+    void editInputCell(int row, int col, const QString& text);
+    void editRelayCell(int row, int col, const QString& text);
+    void editLoadCell(int row, int col, const QString& text);
+    void editDynamicCell(int row, int col, const QString& text);
+
+    // Load 表的數值影子：與 Model 比對找出變動的 cell，Power 只重算有變動的行
+    bool syncPowerShadow();
+    bool shadowInSync() const;
+    double shadowRowPower(int row) const;
+    void updateLoadCellShadow(int dataRow, int output);
+    void updateVoShadow(int output);
+    void checkLoadCell(int cell);
+    void notifyLoadCell(int cell);
+    int m_shadowOutputs = -1;           // -1 = 需全部重建
+    QVector<double> m_voValues;         // NaN = 空白
+    QVector<double> m_cellValues;       // rows × outputs，row-major，NaN = 空白
+    QVector<double> m_rowPowers;
+    QVector<quint8> m_rowDirty;
+
+    QVector<int> m_outputSubModelIds;   // 輸出 index（0 起算）→ chromaSubModelId，-1 = 非 Chroma 6310
+    Page2Model::Tables m_savedTables;  // 上次 xmlSection() 的內容，用來判斷 revision
+    quint64 m_xmlRevision = 1;
+
+    ChromaLoadBatch m_loadBatch;
+    QVector<qint8> m_checkedRanges;     // 上次檢查結果，用來只通知有變化的 cell
+    int m_checkedOutputs = 0;
 };
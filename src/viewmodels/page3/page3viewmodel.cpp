@@ -3,7 +3,10 @@
 #include <QDebug>
 #include "messageservice.h"
 #include <QtConcurrent/QtConcurrentRun>
-#include "communicationfactory.h"
+#include "instrumentsessionpool.h"
+#include "mainframeexecutor.h"
+#include "outputenablebarrier.h"
+#include <QSet>
 #include <QMessageBox>
 #include <QPointer>
 #include "acsourcefactory.h"
@@ -22,6 +25,8 @@ Page3ViewModel::Page3ViewModel(Page3Model* p3, QObject *parent)
     // 當計時器超時時，執行實際的配置更新
     connect(m_configTimer, &QTimer::timeout,
             this, &Page3ViewModel::applyPendingConfig);
+
+    m_sequenceRunner = new SequenceRunner(this);
 }
 
 Page3ViewModel::~Page3ViewModel()
@@ -30,6 +35,9 @@ Page3ViewModel::~Page3ViewModel()
     if (m_configTimer) {
         m_configTimer->stop();
     }
+    // 序列的背景執行緒會呼叫本物件的方法，必須先停下
+    m_sequenceRunner->abort();
+    m_sequenceRunner->wait();
     cleanupAllInstruments();
     cleanupTriggerResources();
 }
@@ -122,8 +130,8 @@ void Page3ViewModel::createOscilloscopes()
         // qDebug() << "  Model:   " << ic.modelName;
         // qDebug() << "  Address: " << ic.address;
 
-        // ===== 步驟1: 創建 Communication =====
-        ICommunication* comm = CommunicationFactory::create(ic.address);
+        // ===== 步驟1: 取得 Pool 中的長駐 Communication =====
+        ICommunication* comm = InstrumentSessionPool::instance().sharedCommunication(ic.address);
         if (!comm) {
             // qWarning() << "[Page3VM] Failed to create communication for:" << ic.address;
             skippedCount++;
@@ -137,7 +145,6 @@ void Page3ViewModel::createOscilloscopes()
 
         if (!oscilloscope) {
             // qWarning() << "[Page3VM] Failed to create oscilloscope for model:" << ic.modelName;
-            delete comm;  // 記得清理 comm
             skippedCount++;
             continue;
         }
@@ -150,7 +157,6 @@ void Page3ViewModel::createOscilloscopes()
             if (!oscilloscope->isConnected()) {
                 // qWarning() << "[Page3VM] Failed to connect oscilloscope:" << ic.modelName;
                 delete oscilloscope;
-                delete comm;
                 skippedCount++;
                 continue;
             }
@@ -160,14 +166,12 @@ void Page3ViewModel::createOscilloscopes()
         } catch (const std::exception& e) {
             qWarning() << "[Page3VM] Exception during connection:" << e.what();
             delete oscilloscope;
-            delete comm;
             skippedCount++;
             continue;
         }
 
         // ===== 步驟4: 儲存成功創建的儀器 =====
         m_oscilloscopes[ic.modelName] = oscilloscope;
-        m_oscilloscopeComms[ic.modelName] = comm;
         createdCount++;
 
         // 設置第一台為當前活躍儀器
@@ -186,7 +190,7 @@ void Page3ViewModel::createOscilloscopes()
 
 void Page3ViewModel::cleanupOscilloscopes()
 {
-    if (m_oscilloscopes.isEmpty() && m_oscilloscopeComms.isEmpty()) {
+    if (m_oscilloscopes.isEmpty()) {
         // qDebug() << "[Page3VM] No oscilloscopes to clean up";
         return;
     }
@@ -194,6 +198,14 @@ void Page3ViewModel::cleanupOscilloscopes()
     // qDebug() << "[Page3VM] ===== Cleaning Up Oscilloscopes =====";
     // qDebug() << "[Page3VM] Oscilloscopes count:" << m_oscilloscopes.size();
 
+    // ===== 先停掉使用示波器的背景執行緒 =====
+    // 狀態監控與半自動觸發在背景執行緒上呼叫示波器；舊的 trigger widget 要等 Page3 處理
+    // page1ConfigChanged 才會刪除，斷線 / 刪除前必須先讓 controller 放開儀器（阻塞到執行緒結束）
+    if (m_currentTriggerController) {
+        m_currentTriggerController->setInstrument(nullptr);
+    }
+    m_currentOscilloscope = nullptr;
+
     // ===== 斷開所有連接 =====
     // qDebug() << "[Page3VM] Phase 1: Disconnecting...";
     for (auto it = m_oscilloscopes.begin(); it != m_oscilloscopes.end(); ++it) {
@@ -211,9 +223,7 @@ void Page3ViewModel::cleanupOscilloscopes()
         }
     }
 
-    // ===== 等待斷開完成 =====
-    // qDebug() << "[Page3VM] Phase 2: Waiting for disconnection to complete...";
-    QThread::msleep(100);  // 給儀器時間完成斷開操作
+    // 實體連線由 InstrumentSessionPool 保留（閒置逾時才關閉），這裡不需等待斷線完成
 
     // ===== 刪除 Oscilloscope 對象 =====
     // qDebug() << "[Page3VM] Phase 3: Deleting oscilloscope objects...";
@@ -232,24 +242,6 @@ void Page3ViewModel::cleanupOscilloscopes()
     }
     m_oscilloscopes.clear();
 
-    // ===== 刪除 Communication 對象 =====
-    // qDebug() << "[Page3VM] Phase 4: Deleting communication objects...";
-    for (auto it = m_oscilloscopeComms.begin(); it != m_oscilloscopeComms.end(); ++it) {
-        if (it.value()) {
-            // qDebug() << "Deleting communication:" << it.key();
-
-            try {
-                delete it.value();
-                // qDebug() << "Deleted";
-            } catch (const std::exception& e) {
-                qWarning() << "Delete failed:" << e.what();
-            } catch (...) {
-                qWarning() << "Delete failed: Unknown error";
-            }
-        }
-    }
-    m_oscilloscopeComms.clear();
-
     // ===== 清空當前指標 =====
     // qDebug() << "[Page3VM] Phase 5: Clearing pointers...";
     m_currentOscilloscope = nullptr;
@@ -369,68 +361,24 @@ void Page3ViewModel::applyPendingConfig()
     }
 }
 
-void Page3ViewModel::onInputDataChanged(const QVector<InputRow>& rows) {
-    if (m_page3) m_page3->setPage2InputDataChanged(rows);
-    m_page2InputData = rows;
-
-    qDebug() << "[Page3ViewModel] InputRows changed, size:" << rows.size();
-    for (int i = 0; i < rows.size(); ++i) {
-        const auto& r = rows[i];
-        qDebug() << QString("  [%1] vin:%2 frequency:%3 phase:%4").arg(i).arg(r.vin).arg(r.frequency).arg(r.phase);
+// Page2 配方變更：只保存快照指標，依 changedSince() 處理有變動的表格
+void Page3ViewModel::onRecipeSnapshotChanged(const RecipeSnapshotPtr& snapshot)
+{
+    if (!snapshot) return;
+    const RecipeSnapshot::Tables changed = snapshot->changedSince(m_recipe.get());
+    m_recipe = snapshot;
+    if (m_page3) m_page3->setRecipeSnapshot(snapshot);
+
+    if (changed & RecipeSnapshot::InputTable) {
+        const auto& rows = snapshot->inputRows();
+        qDebug() << "[Page3ViewModel] InputRows changed, size:" << rows.size();
+        for (int i = 0; i < rows.size(); ++i) {
+            const auto& r = rows[i];
+            qDebug() << QString("  [%1] vin:%2 frequency:%3 phase:%4").arg(i).arg(r.vin).arg(r.frequency).arg(r.phase);
+        }
     }
 }
 
-void Page3ViewModel::onLoadMetaChanged(const LoadMetaRow& meta) {
-    if (m_page3) m_page3->setPage2LoadMetaDataChanged(meta);
-    m_LoadMetaData = meta;
-
-    // qDebug() << "[Page3ViewModel] LoadMeta changed:";
-    // auto printVec = [](const char* name, const QVector<QString>& vec) {
-    //     qDebug() << QString("    %1: [%2]").arg(name).arg(vec.join(", "));
-    // };
-    // printVec("modes", meta.modes);
-    // printVec("names", meta.names);
-    // printVec("vo", meta.vo);
-    // printVec("von", meta.von);
-    // printVec("riseSlope", meta.riseSlope);
-    // printVec("fallSlope", meta.fallSlope);
-}
-
-void Page3ViewModel::onLoadRowsChanged(const QVector<LoadDataRow>& rows) {
-    if (m_page3) m_page3->setPage2LoadRowsChanged(rows);
-    m_LoadRowsData = rows;
-    // qDebug() << "[Page3ViewModel] LoadRows changed, size:" << rows.size();
-    // for (int i = 0; i < rows.size(); ++i) {
-    //     const auto& r = rows[i];
-    //     qDebug() << QString("  [%1] label:%2 values:[%3]").arg(i).arg(r.label).arg(r.values.join(", "));
-    // }
-}
-
-void Page3ViewModel::onDynamicMetaChanged(const DynamicMetaRow& meta) {
-    if (m_page3) m_page3->setPage2DynamicMetaChanged(meta);
-    m_DynamicMetaData = meta;
-
-    // qDebug() << "[Page3ViewModel] DynamicMeta changed:";
-    // auto printVec = [](const char* name, const QVector<QString>& vec) {
-    //     qDebug() << QString("    %1: [%2]").arg(name).arg(vec.join(", "));
-    // };
-    // printVec("von", meta.von);
-    // printVec("riseSlope", meta.riseSlope);
-    // printVec("fallSlope", meta.fallSlope);
-    // printVec("t1t2", meta.t1t2);
-}
-
-void Page3ViewModel::onDynamicRowsChanged(const QVector<DynamicDataRow>& rows) {
-    if (m_page3) m_page3->setPage2DynamicRowsChanged(rows);
-    m_DynamicRowsData = rows;
-
-    // qDebug() << "[Page3ViewModel] DynamicRows changed, size:" << rows.size();
-    // for (int i = 0; i < rows.size(); ++i) {
-    //     const auto& r = rows[i];
-    //     qDebug() << QString("  [%1] label:%2 values:[%3]").arg(i).arg(r.label).arg(r.values.join(", "));
-    // }
-}
-
 
 void Page3ViewModel::onInputToggled(bool on)
 {
@@ -467,32 +415,27 @@ void Page3ViewModel::onLoadChanged()
     handleLoad(LoadAction::Change);
 }
 
-void Page3ViewModel::applyLoadVonSetting(DCLoad* dcLoad,const int &index,const QVector<QString>& vons)
+void Page3ViewModel::applyLoadVonSetting(DCLoad* dcLoad,const int &index,const NumericColumn& vons)
 {
     // 設定 Von
-    if (index - 1 < vons.size()) {
-        bool ok = false;
-        double val = vons[index - 1].toDouble(&ok);
-        if (ok) dcLoad->setVon(val);
-    }
+    double val = 0.0;
+    if (vons.tryValue(index - 1, val))
+        dcLoad->setVon(val);
 }
 
 void Page3ViewModel::applyLoadSlopeSetting(DCLoad* dcLoad,
                                            int index,
-                                           const QVector<QString>& riseSlopeCCH,
-                                           const QVector<QString>& fallSlopeCCH,
-                                           const QVector<QString>& riseSlopeCCL,
-                                           const QVector<QString>& fallSlopeCCL)
+                                           const NumericColumn& riseSlopeCCH,
+                                           const NumericColumn& fallSlopeCCH,
+                                           const NumericColumn& riseSlopeCCL,
+                                           const NumericColumn& fallSlopeCCL)
 {
-    auto applySlope = [&](const QString& mode, const QVector<QString>& vec,
+    auto applySlope = [&](const QString& mode, const NumericColumn& vec,
                           auto setFunc) {
-        if (index - 1 < vec.size()) {
-            bool ok;
-            double val = vec[index - 1].toDouble(&ok);
-            if (ok) {
-                dcLoad->setLoadMode(mode);
-                (dcLoad->*setFunc)(val);
-            }
+        double val = 0.0;
+        if (vec.tryValue(index - 1, val)) {
+            dcLoad->setLoadMode(mode);
+            (dcLoad->*setFunc)(val);
         }
     };
 
@@ -506,7 +449,7 @@ void Page3ViewModel::applyLoadValueSettings(DCLoad* dcLoad,
                             int index,
                             double value,
                             const QString& mode,
-                            const QVector<QString>& outputVoltages)
+                            const NumericColumn& outputVoltages)
 {
     int nSegments = dcLoad->getNumSegments();
 
@@ -517,9 +460,9 @@ void Page3ViewModel::applyLoadValueSettings(DCLoad* dcLoad,
 
         // 從 outputVoltages 取得對應通道的電壓
         if (index - 1 < outputVoltages.size()) {
-            bool ok;
-            double voltage = outputVoltages[index - 1].toDouble(&ok);
-            param.expectedVoltage = ok ? voltage : 0.0;
+            double voltage = 0.0;
+            const bool ok = outputVoltages.tryValue(index - 1, voltage);
+            param.expectedVoltage = voltage;
 
             if (ok) {
                 qDebug() << "[Page3ViewModel] Channel" << index
@@ -543,13 +486,7 @@ void Page3ViewModel::applyLoadValueSettings(DCLoad* dcLoad,
         param.levels = QVector<double>(nSegments, value);
         param.enabledMask = QVector<bool>(nSegments, true);
 
-        if (index - 1 < outputVoltages.size()) {
-            bool ok;
-            double voltage = outputVoltages[index - 1].toDouble(&ok);
-            param.expectedVoltage = ok ? voltage : 0.0;
-        } else {
-            param.expectedVoltage = 0.0;
-        }
+        param.expectedVoltage = outputVoltages.value(index - 1);
 
         dcLoad->setStaticCurrent(param);
     }
@@ -561,12 +498,12 @@ void Page3ViewModel::applyLoadSettings(DCLoad* dcLoad,
                                        int index,
                                        double value,
                                        const QString& mode,
-                                       const QVector<QString>& vons,
-                                       const QVector<QString>& riseSlopeCCH,
-                                       const QVector<QString>& fallSlopeCCH,
-                                       const QVector<QString>& riseSlopeCCL,
-                                       const QVector<QString>& fallSlopeCCL,
-                                       const QVector<QString>& outputVoltages)
+                                       const NumericColumn& vons,
+                                       const NumericColumn& riseSlopeCCH,
+                                       const NumericColumn& fallSlopeCCH,
+                                       const NumericColumn& riseSlopeCCL,
+                                       const NumericColumn& fallSlopeCCL,
+                                       const NumericColumn& outputVoltages)
 {
     // int nSegments = dcLoad->getNumSegments();
     dcLoad->setChannel(dcLoad->realChannel());
@@ -587,12 +524,12 @@ void Page3ViewModel::applyDyLoadSettings(DCLoad* dcLoad,
                                          int index,
                                          const QString& value,
                                          const QString& dyTime,
-                                         const QVector<QString>& vons,
-                                         const QVector<QString>& riseSlopeCCDH,
-                                         const QVector<QString>& fallSlopeCCDH,
-                                         const QVector<QString>& riseSlopeCCDL,
-                                         const QVector<QString>& fallSlopeCCDL,
-                                         const QVector<QString>& outputVoltages)
+                                         const NumericColumn& vons,
+                                         const NumericColumn& riseSlopeCCDH,
+                                         const NumericColumn& fallSlopeCCDH,
+                                         const NumericColumn& riseSlopeCCDL,
+                                         const NumericColumn& fallSlopeCCDL,
+                                         const NumericColumn& outputVoltages)
 {
     // int nSegments = dcLoad->getNumSegments();
     dcLoad->setChannel(dcLoad->realChannel());
@@ -611,20 +548,17 @@ void Page3ViewModel::applyDyLoadSettings(DCLoad* dcLoad,
 
 void Page3ViewModel::applyDyLoadSlopeSetting(DCLoad* dcLoad,
                                              int index,
-                                             const QVector<QString>& riseSlopeCCDH,
-                                             const QVector<QString>& fallSlopeCCDH,
-                                             const QVector<QString>& riseSlopeCCDL,
-                                             const QVector<QString>& fallSlopeCCDL)
+                                             const NumericColumn& riseSlopeCCDH,
+                                             const NumericColumn& fallSlopeCCDH,
+                                             const NumericColumn& riseSlopeCCDL,
+                                             const NumericColumn& fallSlopeCCDL)
 {
-    auto applySlope = [&](const QString& mode, const QVector<QString>& vec,
+    auto applySlope = [&](const QString& mode, const NumericColumn& vec,
                           auto setFunc) {
-        if (index - 1 < vec.size()) {
-            bool ok;
-            double val = vec[index - 1].toDouble(&ok);
-            if (ok) {
-                dcLoad->setLoadMode(mode);
-                (dcLoad->*setFunc)(val);
-            }
+        double val = 0.0;
+        if (vec.tryValue(index - 1, val)) {
+            dcLoad->setLoadMode(mode);
+            (dcLoad->*setFunc)(val);
         }
     };
 
@@ -638,7 +572,7 @@ void Page3ViewModel::applyDyLoadValueSettings(DCLoad* dcLoad,
                               int index,
                               const QString& value,
                               const QString& dyTime,
-                              const QVector<QString>& outputVoltages)
+                              const NumericColumn& outputVoltages)
 {
     int nSegments = dcLoad->getNumSegments();
 
@@ -681,9 +615,9 @@ void Page3ViewModel::applyDyLoadValueSettings(DCLoad* dcLoad,
     }
     //  從 outputVoltages 取得對應通道的電壓
     if (index - 1 < outputVoltages.size()) {
-        bool ok;
-        double voltage = outputVoltages[index - 1].toDouble(&ok);
-        param.expectedVoltage = ok ? voltage : 0.0;
+        double voltage = 0.0;
+        const bool ok = outputVoltages.tryValue(index - 1, voltage);
+        param.expectedVoltage = voltage;
 
         if (ok && !param.levels.isEmpty()) {
             double maxCurrent = *std::max_element(param.levels.begin(), param.levels.end());
@@ -800,6 +734,8 @@ void Page3ViewModel::connectTriggerController() {
 
     // 如果執行到這裡，說明找到了示波器物件
     // qDebug() << "[Page3ViewModel] Found oscilloscope, setting to controller";
+    // 上次交給 controller 之後，操作員可能動過前面板，快取的設定不再可信
+    oscilloscope->invalidateStateCache();
     m_currentTriggerController->setInstrument(oscilloscope);
     m_currentOscilloscope = oscilloscope;
 
@@ -813,26 +749,44 @@ void Page3ViewModel::cleanupTriggerResources()
     m_currentInstrumentModel.clear();
 }
 
-void Page3ViewModel::writeXml(QXmlStreamWriter& writer) const
+ConfigSection Page3ViewModel::xmlSection()
+{
+    const Page3Model::XmlState state = xmlState();
+    if (state != m_savedXmlState) {
+        m_savedXmlState = state;
+        ++m_xmlRevision;
+    }
+    return { "Page3", m_xmlRevision, [state](QXmlStreamWriter& writer) {
+                 Page3Model::writeStateXml(writer, state);
+             } };
+}
+
+Page3Model::XmlState Page3ViewModel::xmlState() const
 {
-    m_page3->setSelectedInputState(m_selectedInputIndex, m_selectedInputText);
-    m_page3->setSelectedLoadState(m_selectedLoadIndex, m_selectedLoadText);
-    m_page3->setSelectedDyLoadState(m_selectedDyLoadIndex, m_selectedDyLoadText);
-    m_page3->setSelectedRelayState(m_selectedRelayIndex, m_selectedRelayText);
+    // 選擇狀態以 ViewModel 為準，只放進回傳的副本，不回寫 Model
+    Page3Model::XmlState state = m_page3->xmlState();
+    state.selectedInputIndex = m_selectedInputIndex;
+    state.selectedInputText = m_selectedInputText;
+    state.selectedLoadIndex = m_selectedLoadIndex;
+    state.selectedLoadText = m_selectedLoadText;
+    state.selectedDyLoadIndex = m_selectedDyLoadIndex;
+    state.selectedDyLoadText = m_selectedDyLoadText;
+    state.selectedRelayIndex = m_selectedRelayIndex;
+    state.selectedRelayText = m_selectedRelayText;
 
     // 添加調試輸出
-    // qDebug() << "[Page3ViewModel::writeXml] Saving selections:";
+    // qDebug() << "[Page3ViewModel::xmlState] Saving selections:";
     // qDebug() << "  Input:" << m_selectedInputIndex << m_selectedInputText;
     // qDebug() << "  Load:" << m_selectedLoadIndex << m_selectedLoadText;
     // qDebug() << "  DyLoad:" << m_selectedDyLoadIndex << m_selectedDyLoadText;
 
-    m_page3->writeXml(writer);
+    return state;
 }
 
-void Page3ViewModel::loadXml(QXmlStreamReader& reader)
+void Page3ViewModel::applyLoadedState(const Page3Model::XmlState& state)
 {
-    // 先讓 Model 載入 XML 資料
-    m_page3->loadXml(reader);
+    // 先讓 Model 套用解析好的 XML 資料
+    m_page3->applyXmlState(state);
 
     // 從 Model 取得載入的資料並同步到 ViewModel
     restoreFromModel();
@@ -851,11 +805,8 @@ void Page3ViewModel::restoreFromModel()
     m_dyloadTitles = m_page3->getDyLoadTitles();
     m_relayTitles = m_page3->getRelayTitles();
 
-    // 還原 Load 相關資料
-    m_LoadMetaData = m_page3->getLoadMetaData();
-    m_LoadRowsData = m_page3->getLoadRowsData();
-    m_DynamicMetaData = m_page3->getDynamicMetaData();
-    m_DynamicRowsData = m_page3->getDynamicRowsData();
+    // 還原 Load 相關資料（與 Model 共用同一份快照）
+    m_recipe = m_page3->recipeSnapshot();
 
     // 還原當前選擇狀態
     m_selectedInputIndex = m_page3->getSelectedInputIndex();
@@ -935,15 +886,15 @@ void Page3ViewModel::handleInput(InputAction action)
             // 解析輸入參數
             auto params = self->parseInputText(inputTxt);
             if (!params.valid) {
-                self->cleanupACSourceResources(createResult.source, createResult.comm);
+                self->cleanupACSourceResources(createResult);
                 return;
             }
 
             // 執行操作
             self->executeACSourceAction(createResult.source, action, params);
 
-            // 清理資源
-            self->cleanupACSourceResources(createResult.source, createResult.comm);
+            // 清理資源（連線歸還 Pool，不關閉）
+            self->cleanupACSourceResources(createResult);
 
         } catch (const std::exception& ex) {
             if (self) {
@@ -1005,21 +956,24 @@ Page3ViewModel::ACSourceCreationResult Page3ViewModel::createACSource(
             return result;
         }
 
-        // 創建通信對象
-        result.comm = CommunicationFactory::create(ic.address);
-        if (!result.comm) {
+        // 從 Pool 取得長駐連線（閒置過久會先 *IDN? 檢查，斷線自動重連）
+        result.lease = InstrumentSessionPool::instance().acquire(ic.address);
+        if (!result.lease.isValid()) {
             QMetaObject::invokeMethod(&MessageService::instance(), "showWarning", Qt::QueuedConnection,
                                       Q_ARG(QString, "Error Message"),
-                                      Q_ARG(QString, "Communication format error.\nPlease check the Instruments configuration!"));
+                                      Q_ARG(QString, "Communication open failed.\n" + result.lease.errorString() +
+                                                         "\nPlease check the Instruments configuration!"));
             QMetaObject::invokeMethod(self, "forceOff", Qt::QueuedConnection, Q_ARG(LoadKind, LoadKind::Input));
+            result.lease.release();
             return result;
         }
+        result.comm = result.lease.comm();
 
         // 創建 AC Source
         result.source = ACSourceFactory::createACSource(ic.modelName, result.comm);
         if (!result.source) {
-            delete result.comm;
             result.comm = nullptr;
+            result.lease.release();
             QMetaObject::invokeMethod(&MessageService::instance(), "showWarning", Qt::QueuedConnection,
                                       Q_ARG(QString, "Error Message"),
                                       Q_ARG(QString, "AC Source creation failed!"));
@@ -1035,9 +989,10 @@ Page3ViewModel::ACSourceCreationResult Page3ViewModel::createACSource(
                                       Q_ARG(QString, result.source->model() + " communication open failed!"));
             QMetaObject::invokeMethod(self, "forceOff", Qt::QueuedConnection, Q_ARG(LoadKind, LoadKind::Input));
             delete result.source;
-            delete result.comm;
             result.source = nullptr;
             result.comm = nullptr;
+            result.lease.markFailed();
+            result.lease.release();
             return result;
         }
 
@@ -1102,11 +1057,13 @@ void Page3ViewModel::executeACSourceAction(
     }
 }
 
-// Input資源清理
-void Page3ViewModel::cleanupACSourceResources(ACSource* source, ICommunication* comm)
+// Input資源清理（儀器物件刪除，連線歸還 Pool）
+void Page3ViewModel::cleanupACSourceResources(ACSourceCreationResult& result)
 {
-    if (source) delete source;
-    if (comm) delete comm;
+    if (result.source) delete result.source;
+    result.source = nullptr;
+    result.comm = nullptr;
+    result.lease.release();
 }
 
 
@@ -1120,23 +1077,12 @@ void Page3ViewModel::handleLoad(LoadAction action)
         return;
     }
 
-    // 2. 準備數據
-    const auto& meta = m_LoadMetaData;
-    const auto& modes = meta.modes;
-    const auto& vons = meta.von;
-    const auto& riseSlopeCCH = meta.riseSlopeCCH;
-    const auto& fallSlopeCCH = meta.fallSlopeCCH;
-    const auto& riseSlopeCCL = meta.riseSlopeCCL;
-    const auto& fallSlopeCCL = meta.fallSlopeCCL;
-    const auto& outputVoltages = meta.vo;
-
+    // 2. 準備數據：只帶走快照指標，背景執行期間 Page2 再修改也不影響這次設定
     // 3. 非同步處理
     QFuture<void> future = QtConcurrent::run([cfg = m_page1Config, self,
                                               action,
-                                              modes, vons,
-                                              riseSlopeCCH, fallSlopeCCH,
-                                              riseSlopeCCL, fallSlopeCCL,
-                                              outputVoltages]() {
+                                              recipe = m_recipe,
+                                              loadTxt = m_selectedLoadText]() {
         try {
             // 檢查對象有效性
             if (!self) return;
@@ -1148,23 +1094,26 @@ void Page3ViewModel::handleLoad(LoadAction action)
             }
 
             // 尋找選定的 Load 數據
-            auto dataInfo = self->findSelectedLoadData(self);
+            const auto& meta = recipe->loadMeta();
+            auto dataInfo = findSelectedLoadData(*recipe, loadTxt);
 
-            // 執行每個 DC Load 的操作
-            for (DCLoad* dcLoad : createResult.dcLoads) {
+            // 執行每個 DC Load 的操作（同一台 mainframe 合併為一個批次，Load ON 以 *OPC? 確認）
+            self->runBatchedPerMainframe(createResult.dcLoads,
+                                         action == LoadAction::LoadOn,
+                                         [&](DCLoad* dcLoad) {
                 int index = dcLoad->channelIndex();
 
                 self->executeDCLoadAction(
                     dcLoad, action, index, dataInfo,
-                    modes, vons,
-                    riseSlopeCCH, fallSlopeCCH,
-                    riseSlopeCCL, fallSlopeCCL,
-                    outputVoltages
+                    meta.modes, meta.von,
+                    meta.riseSlopeCCH, meta.fallSlopeCCH,
+                    meta.riseSlopeCCL, meta.fallSlopeCCL,
+                    meta.vo
                     );
-            }
+            });
 
-            // 清理資源
-            self->cleanupDCLoadResources(createResult.dcLoads, createResult.commMap);
+            // 清理資源（連線歸還 Pool，不關閉）
+            self->cleanupDCLoadResources(createResult);
 
         } catch (const std::exception& ex) {
             if (self) {
@@ -1208,12 +1157,25 @@ Page3ViewModel::DCLoadCreationResult Page3ViewModel::createDCLoads(
             if (!ic.enabled || ic.type != "Load") continue;
             if (ic.modelName.isEmpty() || ic.address.isEmpty()) continue;
 
-            // 取得或創建通信物件
-            ICommunication* comm = result.commMap.value(ic.address, nullptr);
+            // 取得 Pool 中的長駐連線（同一位址的多個通道共用同一個 lease）
+            // 以正規化位址為 key，"5" 與 "GPIB0::5::INSTR" 視為同一台，避免重複 acquire
+            const QString sessionKey = InstrumentSessionPool::normalizeResource(ic.address);
+            ICommunication* comm = result.commMap.value(sessionKey, nullptr);
             if (!comm) {
-                comm = CommunicationFactory::create(ic.address);
-                if (!comm) continue;
-                result.commMap[ic.address] = comm;
+                InstrumentSessionLease lease = InstrumentSessionPool::instance().acquire(ic.address);
+                if (!lease.isValid()) {
+                    QMetaObject::invokeMethod(&MessageService::instance(), "showWarning",
+                                              Qt::QueuedConnection,
+                                              Q_ARG(QString, "Error Message"),
+                                              Q_ARG(QString, ic.modelName + " communication open failed!\n" +
+                                                                 lease.errorString()));
+                    QMetaObject::invokeMethod(self, "forceOff", Qt::QueuedConnection, Q_ARG(LoadKind, kind));
+                    cleanupDCLoadResources(result);
+                    return result;
+                }
+                comm = lease.comm();
+                result.commMap[sessionKey] = comm;
+                result.leases.emplace(sessionKey, std::move(lease));
             }
 
             // 為每個通道創建 DC Load
@@ -1229,6 +1191,7 @@ Page3ViewModel::DCLoadCreationResult Page3ViewModel::createDCLoads(
                 int hwChannel = ic.channelNumbers.value(i, -1);
                 dcLoad->setRealChannel(hwChannel);
                 dcLoad->setChannelIndex(uiIndex);
+                dcLoad->setAddress(ic.address);
 
                 // 連接檢查
                 dcLoad->connect();
@@ -1241,15 +1204,14 @@ Page3ViewModel::DCLoadCreationResult Page3ViewModel::createDCLoads(
                     //                           Q_ARG(LoadKind, LoadKind::Load));
                     // QMetaObject::invokeMethod(self, "emitForceOff", Qt::QueuedConnection,
                     //                           Q_ARG(LoadKind, LoadKind::DyLoad));
-                    emit self->forceOff(kind);
+                    QMetaObject::invokeMethod(self, "forceOff", Qt::QueuedConnection, Q_ARG(LoadKind, kind));
 
                     delete dcLoad;
 
-                    // 清理已創建的資源
-                    for (auto load : result.dcLoads) delete load;
-                    for (auto c : result.commMap) delete c;
-                    result.dcLoads.clear();
-                    result.commMap.clear();
+                    // 清理已創建的資源，並讓該位址下次取用時重新檢查連線
+                    auto failed = result.leases.find(sessionKey);
+                    if (failed != result.leases.end()) failed->second.markFailed();
+                    cleanupDCLoadResources(result);
                     return result;
                 }
 
@@ -1277,10 +1239,9 @@ Page3ViewModel::DCLoadCreationResult Page3ViewModel::createDCLoads(
             //                           Q_ARG(LoadKind, LoadKind::Load));
             // QMetaObject::invokeMethod(self, "emitForceOff", Qt::QueuedConnection,
             //                           Q_ARG(LoadKind, LoadKind::DyLoad));
-                emit self->forceOff(kind);
+            QMetaObject::invokeMethod(self, "forceOff", Qt::QueuedConnection, Q_ARG(LoadKind, kind));
 
-            for (auto comm : result.commMap) delete comm;
-            result.commMap.clear();
+            cleanupDCLoadResources(result);
             return result;
         }
 
@@ -1288,10 +1249,7 @@ Page3ViewModel::DCLoadCreationResult Page3ViewModel::createDCLoads(
 
     } catch (const std::exception& ex) {
         // 異常處理：清理所有資源
-        for (auto load : result.dcLoads) delete load;
-        for (auto comm : result.commMap) delete comm;
-        result.dcLoads.clear();
-        result.commMap.clear();
+        cleanupDCLoadResources(result);
         result.success = false;
         qWarning() << "[createDCLoads] Exception:" << ex.what();
     }
@@ -1300,20 +1258,13 @@ Page3ViewModel::DCLoadCreationResult Page3ViewModel::createDCLoads(
 }
 
 Page3ViewModel::LoadDataInfo Page3ViewModel::findSelectedLoadData(
-    QPointer<Page3ViewModel> self)
+    const RecipeSnapshot& recipe, const QString& label)
 {
     LoadDataInfo info;
 
-    if (!self) return info;
-
-    auto it = std::find_if(self->m_LoadRowsData.begin(),
-                           self->m_LoadRowsData.end(),
-                           [&](const LoadDataRow& row) {
-                               return row.label == self->m_selectedLoadText;
-                           });
-
-    if (it != self->m_LoadRowsData.end()) {
-        info.values = it->values;
+    const int rowIndex = recipe.loadRowIndex(label);
+    if (rowIndex >= 0) {
+        info.values = recipe.loadRows()[rowIndex].values;
         info.found = true;
     }
 
@@ -1327,12 +1278,12 @@ void Page3ViewModel::executeDCLoadAction(
     int index,
     const LoadDataInfo& dataInfo,
     const QVector<QString>& modes,
-    const QVector<QString>& vons,
-    const QVector<QString>& riseSlopeCCH,
-    const QVector<QString>& fallSlopeCCH,
-    const QVector<QString>& riseSlopeCCL,
-    const QVector<QString>& fallSlopeCCL,
-    const QVector<QString>& outputVoltages)
+    const NumericColumn& vons,
+    const NumericColumn& riseSlopeCCH,
+    const NumericColumn& fallSlopeCCH,
+    const NumericColumn& riseSlopeCCL,
+    const NumericColumn& fallSlopeCCL,
+    const NumericColumn& outputVoltages)
 {
     int realindex = dcLoad->realChannel();
 
@@ -1345,14 +1296,8 @@ void Page3ViewModel::executeDCLoadAction(
 
     // Load On 或 Change：需要設定參數
     if (!dataInfo.found) return;
-    if (index <= 0 || index > dataInfo.values.size()) return;
-
-    QString strValue = dataInfo.values[index - 1].trimmed();
-    if (strValue.isEmpty()) return;
-
-    bool ok = false;
-    double currval = strValue.toDouble(&ok);
-    if (!ok) return;
+    double currval = 0.0;
+    if (index <= 0 || !dataInfo.values.tryValue(index - 1, currval)) return;
 
     // 取得模式（預設為 CC）
     QString mode = (index - 1 < modes.size()) ?
@@ -1373,20 +1318,61 @@ void Page3ViewModel::executeDCLoadAction(
     }
 }
 
-// 清理 DC Load 資源
-void Page3ViewModel::cleanupDCLoadResources(
-    QVector<DCLoad*>& dcLoads,
-    QMap<QString, ICommunication*>& commMap)
+// 依 mainframe 分組平行執行：每台在自己的 worker 執行緒上共用一個 batch，
+// 整台設定合併為一到兩次匯流排傳輸，總時間取決於最慢的一台
+bool Page3ViewModel::runBatchedPerMainframe(const QVector<DCLoad*>& dcLoads,
+                                            bool waitForOpc,
+                                            const std::function<void(DCLoad*)>& perChannel)
 {
-    for (auto dcLoad : dcLoads) {
-        if (dcLoad) delete dcLoad;
+    const auto results = MainframeExecutor::instance().run(
+        dcLoads,
+        [waitForOpc, &perChannel](const QVector<DCLoad*>& group, QString& error) {
+            DCLoad* first = group.first();
+            ScpiCommandBatch batch(first->communication(), first->maxBatchMessageLength());
+
+            for (DCLoad* dcLoad : group) {
+                dcLoad->attachBatch(&batch);
+                perChannel(dcLoad);
+                dcLoad->detachBatch();
+            }
+
+            if (!batch.flush(waitForOpc)) {
+                error = batch.lastError();
+                return false;
+            }
+            return true;
+        });
+
+    bool allOk = true;
+    QStringList failed;
+    for (const auto& r : results) {
+        qDebug() << "[Page3ViewModel] Mainframe" << r.label << "channels =" << r.channelCount
+                 << (r.success ? "OK" : "FAILED") << r.elapsedMs << "ms";
+        if (!r.success) {
+            allOk = false;
+            failed << QString("%1: %2").arg(r.label, r.error);
+        }
+    }
+
+    if (!failed.isEmpty()) {
+        QMetaObject::invokeMethod(&MessageService::instance(), "showWarning",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(QString, "Error Message"),
+                                  Q_ARG(QString, "DC Load setting failed!\n" + failed.join("\n")));
     }
-    dcLoads.clear();
+    return allOk;
+}
 
-    for (auto comm : commMap) {
-        if (comm) delete comm;
+// 清理 DC Load 資源（儀器物件刪除，連線歸還 Pool）
+void Page3ViewModel::cleanupDCLoadResources(DCLoadCreationResult& result)
+{
+    for (auto dcLoad : result.dcLoads) {
+        if (dcLoad) delete dcLoad;
     }
-    commMap.clear();
+    result.dcLoads.clear();
+
+    result.commMap.clear();
+    result.leases.clear();
 }
 
 // handleDyLoad
@@ -1399,23 +1385,12 @@ void Page3ViewModel::cleanupDCLoadResources(
         return;
     }
 
-    // 2. 準備數據
-    const auto& meta = m_DynamicMetaData;
-    const auto& vons = meta.von;
-    const auto& riseSlopeCCDH = meta.riseSlopeCCDH;
-    const auto& fallSlopeCCDH = meta.fallSlopeCCDH;
-    const auto& riseSlopeCCDL = meta.riseSlopeCCDL;
-    const auto& fallSlopeCCDL = meta.fallSlopeCCDL;
-    const auto& outputVoltages = meta.vo;
-    const auto& t1t2 = meta.t1t2;
-
+    // 2. 準備數據：只帶走快照指標
     // 3. 非同步處理
     QFuture<void> future = QtConcurrent::run([cfg = m_page1Config, self,
                                               action,
-                                              vons,
-                                              riseSlopeCCDH, fallSlopeCCDH,
-                                              riseSlopeCCDL, fallSlopeCCDL,
-                                              outputVoltages, t1t2]() {
+                                              recipe = m_recipe,
+                                              dyLoadTxt = m_selectedDyLoadText]() {
         try {
             // 檢查對象有效性
             if (!self) return;
@@ -1427,23 +1402,26 @@ void Page3ViewModel::cleanupDCLoadResources(
             }
 
             // 5. 尋找選定的 DyLoad 數據
-            auto dataInfo = self->findSelectedDyLoadData(self, t1t2);
+            const auto& meta = recipe->dynamicMeta();
+            auto dataInfo = findSelectedDyLoadData(*recipe, dyLoadTxt);
 
-            // 6. 執行每個 DC Load 的動態操作
-            for (DCLoad* dcLoad : createResult.dcLoads) {
+            // 6. 執行每個 DC Load 的動態操作（同一台 mainframe 合併為一個批次）
+            self->runBatchedPerMainframe(createResult.dcLoads,
+                                         action == DyLoadAction::DyLoadOn,
+                                         [&](DCLoad* dcLoad) {
                 int index = dcLoad->channelIndex();
 
                 self->executeDCDyLoadAction(
                     dcLoad, action, index, dataInfo,
-                    vons,
-                    riseSlopeCCDH, fallSlopeCCDH,
-                    riseSlopeCCDL, fallSlopeCCDL,
-                    outputVoltages
+                    meta.von,
+                    meta.riseSlopeCCDH, meta.fallSlopeCCDH,
+                    meta.riseSlopeCCDL, meta.fallSlopeCCDL,
+                    meta.vo
                     );
-            }
+            });
 
             // 7. 清理資源（重用 handleLoad 的函數）
-            self->cleanupDCLoadResources(createResult.dcLoads, createResult.commMap);
+            self->cleanupDCLoadResources(createResult);
 
         } catch (const std::exception& ex) {
             if (self) {
@@ -1481,25 +1459,17 @@ struct DyLoadDataInfo {
 };
 
 Page3ViewModel::DyLoadDataInfo Page3ViewModel::findSelectedDyLoadData(
-    QPointer<Page3ViewModel> self,
-    const QVector<QString>& t1t2Vector)
+    const RecipeSnapshot& recipe, const QString& label)
 {
     DyLoadDataInfo info;
 
-    if (!self) return info;
-
-    auto it = std::find_if(self->m_DynamicRowsData.begin(),
-                           self->m_DynamicRowsData.end(),
-                           [&](const DynamicDataRow& row) {
-                               return row.label == self->m_selectedDyLoadText;
-                           });
-
-    if (it != self->m_DynamicRowsData.end()) {
-        info.values = it->values;
+    const int rowIndex = recipe.dynamicRowIndex(label);
+    if (rowIndex >= 0) {
+        info.values = recipe.dynamicRows()[rowIndex].values;
 
         // 從 t1t2 獲取時間數據
-        int rowIndex = std::distance(self->m_DynamicRowsData.begin(), it);
-        if (rowIndex >= 0 && rowIndex < t1t2Vector.size()) {
+        const auto& t1t2Vector = recipe.dynamicMeta().t1t2;
+        if (rowIndex < t1t2Vector.size()) {
             info.t1t2 = t1t2Vector[rowIndex].trimmed();
         }
 
@@ -1515,12 +1485,12 @@ void Page3ViewModel::executeDCDyLoadAction(
     DyLoadAction action,
     int index,
     const DyLoadDataInfo& dataInfo,
-    const QVector<QString>& vons,
-    const QVector<QString>& riseSlopeCCDH,
-    const QVector<QString>& fallSlopeCCDH,
-    const QVector<QString>& riseSlopeCCDL,
-    const QVector<QString>& fallSlopeCCDL,
-    const QVector<QString>& outputVoltages)
+    const NumericColumn& vons,
+    const NumericColumn& riseSlopeCCDH,
+    const NumericColumn& fallSlopeCCDH,
+    const NumericColumn& riseSlopeCCDL,
+    const NumericColumn& fallSlopeCCDL,
+    const NumericColumn& outputVoltages)
 {
     int realindex = dcLoad->realChannel();
 
@@ -1553,6 +1523,467 @@ void Page3ViewModel::executeDCDyLoadAction(
     }
 }
 
+// handleSyncApply：Input 與 Load / DyLoad 同步套用交易
+// 0. 示波器在 GUI 執行緒先進入 single（物件屬於 GUI 執行緒，cleanupOscilloscopes 隨時可能刪除）
+// 1. AC Source、各台 DC Load 平行設定（不開輸出），各自以 *OPC? 確認設定完成
+// 2. 任一台失敗即中止，不開任何輸出
+// 3. 全部確認後經 OutputEnableBarrier 同時放行 Power ON / Load ON，並量測開啟時間差
+void Page3ViewModel::handleSyncApply(bool includeInput, LoadKind loadKind, bool armScope)
+{
+    QPointer<Page3ViewModel> self(this);
+
+    const bool includeLoad = (loadKind == LoadKind::Load || loadKind == LoadKind::DyLoad);
+    if (!includeInput && !includeLoad) return;
+
+    // 1. 驗證配置（失敗時 validate* 已顯示訊息）
+    if ((includeInput && !validateInputConfiguration())
+        || (loadKind == LoadKind::Load && !validateLoadConfiguration())
+        || (loadKind == LoadKind::DyLoad && !validateDyLoadConfiguration())) {
+        emit syncApplyFinished(false, "Synchronized apply aborted: invalid configuration", 0);
+        return;
+    }
+
+    // 示波器先進入 single 等待觸發，才能抓到開機瞬間
+    // 與狀態監控的查詢由儀器的 I/O 交易鎖序列化；背景執行緒不持有示波器指標
+    if (armScope && m_currentOscilloscope) {
+        m_currentOscilloscope->single();
+        if (!m_currentOscilloscope->isRunning()) {
+            const QString msg = "Synchronized apply aborted, outputs not enabled.\nNot ready: Oscilloscope";
+            qWarning() << "[SyncApply]" << msg;
+            MessageService::instance().showWarning("Error Message", msg);
+            emit syncApplyFinished(false, msg, 0);
+            return;
+        }
+    }
+
+    // 2. 非同步處理
+    QFuture<void> future = QtConcurrent::run([cfg = m_page1Config,
+                                              inputTxt = m_selectedInputText,
+                                              loadTxt = m_selectedLoadText,
+                                              dyLoadTxt = m_selectedDyLoadText,
+                                              recipe = m_recipe,
+                                              self, includeInput, includeLoad,
+                                              loadKind]() {
+        try {
+            if (!self) return;
+
+            auto forceOffAll = [&]() {
+                if (includeInput) emit self->forceOff(LoadKind::Input);
+                if (includeLoad) emit self->forceOff(loadKind);
+            };
+            // 建立儀器失敗時 create* 已顯示訊息，這裡只回報結果
+            auto abort = [&](const QString& reason) {
+                emit self->syncApplyFinished(false, "Synchronized apply aborted: " + reason, 0);
+            };
+
+            // 3. 建立儀器（固定先 AC Source 後 DC Load 的順序取得 lease）
+            ACSourceCreationResult source;
+            InputParameters params;
+            if (includeInput) {
+                source = self->createACSource(cfg, self);
+                if (!source.success || !source.source || !source.comm) {
+                    if (includeLoad) emit self->forceOff(loadKind);
+                    abort("AC Source not available");
+                    return;
+                }
+                params = self->parseInputText(inputTxt);
+                if (!params.valid) {
+                    self->cleanupACSourceResources(source);
+                    forceOffAll();
+                    abort("invalid input setting");
+                    return;
+                }
+            }
+
+            DCLoadCreationResult loads;
+            if (includeLoad) {
+                loads = self->createDCLoads(cfg, self, loadKind);
+                if (!loads.success || loads.dcLoads.isEmpty()) {
+                    self->cleanupACSourceResources(source);
+                    if (includeInput) emit self->forceOff(LoadKind::Input);
+                    abort("DC Load not available");
+                    return;
+                }
+            }
+
+            // 4. 平行設定
+            QFuture<bool> sourceStage;
+            if (includeInput) {
+                ACSource* ac = source.source;
+                sourceStage = QtConcurrent::run([ac, params]() {
+                    ScpiCommandBatch batch(ac->communication(), ac->maxBatchMessageLength());
+                    ac->attachBatch(&batch);
+                    ac->setVoltage(params.voltage);
+                    ac->setFrequency(params.frequency);
+                    ac->setPhaseOn(params.phase);
+                    ac->detachBatch();
+                    return batch.flush(true);
+                });
+            }
+
+            // 只開啟實際有設定值的通道
+            QMutex enabledMutex;
+            QSet<DCLoad*> enabledLoads;
+            auto markEnabled = [&](DCLoad* dcLoad, bool hasValue) {
+                if (!hasValue) return;
+                QMutexLocker locker(&enabledMutex);
+                enabledLoads.insert(dcLoad);
+            };
+
+            bool loadsOk = true;
+            if (loadKind == LoadKind::Load) {
+                const auto& loadMeta = recipe->loadMeta();
+                auto dataInfo = findSelectedLoadData(*recipe, loadTxt);
+                loadsOk = dataInfo.found && self->runBatchedPerMainframe(
+                    loads.dcLoads, true, [&](DCLoad* dcLoad) {
+                        self->executeDCLoadAction(
+                            dcLoad, LoadAction::Change, dcLoad->channelIndex(), dataInfo,
+                            loadMeta.modes, loadMeta.von,
+                            loadMeta.riseSlopeCCH, loadMeta.fallSlopeCCH,
+                            loadMeta.riseSlopeCCL, loadMeta.fallSlopeCCL,
+                            loadMeta.vo);
+                        markEnabled(dcLoad, dataInfo.values.isValid(dcLoad->channelIndex() - 1));
+                    });
+            } else if (loadKind == LoadKind::DyLoad) {
+                const auto& dyMeta = recipe->dynamicMeta();
+                auto dataInfo = findSelectedDyLoadData(*recipe, dyLoadTxt);
+                loadsOk = dataInfo.found && self->runBatchedPerMainframe(
+                    loads.dcLoads, true, [&](DCLoad* dcLoad) {
+                        self->executeDCDyLoadAction(
+                            dcLoad, DyLoadAction::Change, dcLoad->channelIndex(), dataInfo,
+                            dyMeta.von,
+                            dyMeta.riseSlopeCCDH, dyMeta.fallSlopeCCDH,
+                            dyMeta.riseSlopeCCDL, dyMeta.fallSlopeCCDL,
+                            dyMeta.vo);
+                        const int index = dcLoad->channelIndex();
+                        markEnabled(dcLoad, index > 0
+                                    && !dataInfo.values.value(index - 1).trimmed().isEmpty());
+                    });
+            }
+
+            const bool sourceOk = !includeInput || sourceStage.result();
+
+            // 5. 任一台未確認完成：中止，不開任何輸出
+            if (!sourceOk || !loadsOk) {
+                QStringList failed;
+                if (!sourceOk) failed << "AC Source";
+                if (!loadsOk) failed << "DC Load";
+                const QString msg = "Synchronized apply aborted, outputs not enabled.\nNot ready: " + failed.join(", ");
+                qWarning() << "[SyncApply]" << msg;
+                QMetaObject::invokeMethod(&MessageService::instance(), "showWarning",
+                                          Qt::QueuedConnection,
+                                          Q_ARG(QString, "Error Message"),
+                                          Q_ARG(QString, msg));
+                self->cleanupDCLoadResources(loads);
+                self->cleanupACSourceResources(source);
+                forceOffAll();
+                emit self->syncApplyFinished(false, msg, 0);
+                return;
+            }
+
+            // 6. 同步開啟輸出：AC Source 與每台 mainframe 各一個參與者
+            OutputEnableBarrier barrier;
+            if (includeInput) {
+                ACSource* ac = source.source;
+                barrier.add(ac->model(), [ac](QString& error) {
+                    ScpiCommandBatch batch(ac->communication(), ac->maxBatchMessageLength());
+                    ac->attachBatch(&batch);
+                    ac->setPowerOn();
+                    ac->detachBatch();
+                    if (!batch.flush()) {
+                        error = batch.lastError();
+                        return false;
+                    }
+                    return true;
+                });
+            }
+
+            QVector<DCLoad*> toEnable;
+            for (DCLoad* dcLoad : loads.dcLoads) {
+                if (enabledLoads.contains(dcLoad)) toEnable.append(dcLoad);
+            }
+            for (const QVector<DCLoad*>& group : MainframeExecutor::groupByCommunication(toEnable)) {
+                barrier.add(group.first()->getaddress(), [group](QString& error) {
+                    DCLoad* first = group.first();
+                    ScpiCommandBatch batch(first->communication(), first->maxBatchMessageLength());
+                    for (DCLoad* dcLoad : group) {
+                        dcLoad->attachBatch(&batch);
+                        dcLoad->setChannel(dcLoad->realChannel());
+                        dcLoad->setLoadOn();
+                        dcLoad->detachBatch();
+                    }
+                    if (!batch.flush()) {
+                        error = batch.lastError();
+                        return false;
+                    }
+                    return true;
+                });
+            }
+
+            const OutputEnableReport report = barrier.fire();
+            const QString summary = report.summary();
+            if (!report.success) {
+                QMetaObject::invokeMethod(&MessageService::instance(), "showWarning",
+                                          Qt::QueuedConnection,
+                                          Q_ARG(QString, "Error Message"),
+                                          Q_ARG(QString, summary));
+            }
+
+            // 清理資源（連線歸還 Pool，不關閉）
+            self->cleanupDCLoadResources(loads);
+            self->cleanupACSourceResources(source);
+
+            emit self->syncApplyFinished(report.success, summary, report.completionSkewNs);
+
+        } catch (const std::exception& ex) {
+            if (self) {
+                qWarning() << "[SyncApply] Exception:" << ex.what();
+                emit self->syncApplyFinished(false, QString("Synchronized apply failed: %1").arg(ex.what()), 0);
+            }
+        }
+    });
+}
+
+// ========== 測試序列 ==========
+
+// 在序列背景執行緒上執行，只使用 static 輔助函數與建立時複製的設定 / 快照，不存取 ViewModel
+// 儀器 lease 只在送指令期間持有：停留、暫停期間歸還 Pool，手動操作不會被序列擋住
+// 手動操作正持有儀器時，序列的 acquire 會等到逾時並讓該步驟失敗
+class Page3ViewModel::SequenceExecutor : public SequenceRunner::Executor
+{
+public:
+    SequenceExecutor(const Page1Config& cfg, const RecipeSnapshotPtr& recipe,
+                     bool needSource, bool needLoads)
+        : m_cfg(cfg), m_recipe(recipe),
+          m_needSource(needSource), m_needLoads(needLoads) {}
+
+    // 開始前確認儀器都取得得到，確認後立即歸還
+    bool begin(QString& error) override
+    {
+        if (m_needSource) {
+            ACSourceCreationResult source = createACSource(m_cfg, nullptr);
+            const bool ok = source.success;
+            cleanupACSourceResources(source);
+            if (!ok) {
+                error = "AC Source not available";
+                return false;
+            }
+        }
+        if (m_needLoads) {
+            DCLoadCreationResult loads = createDCLoads(m_cfg, nullptr, LoadKind::Load);
+            const bool ok = loads.success && !loads.dcLoads.isEmpty();
+            cleanupDCLoadResources(loads);
+            if (!ok) {
+                error = "DC Load not available";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 查表、解析數值都在這裡完成，apply 只剩匯流排寫入
+    bool prepare(int index, const SequenceStep& step, QString& error) override
+    {
+        Prepared& p = m_slots[index % 2];
+        p = Prepared();
+        p.index = index;
+
+        if (!step.inputText.trimmed().isEmpty()) {
+            p.inputText = step.inputText.trimmed();
+            p.input = parseInputText(p.inputText);
+            if (!p.input.valid) {
+                error = "Invalid input condition " + p.inputText;
+                return false;
+            }
+        }
+        if (!step.loadLabel.isEmpty()) {
+            p.loadKind = LoadKind::Load;
+            p.load = findSelectedLoadData(*m_recipe, step.loadLabel);
+            if (!p.load.found) {
+                error = "Load row not found: " + step.loadLabel;
+                return false;
+            }
+        } else if (!step.dyLoadLabel.isEmpty()) {
+            p.loadKind = LoadKind::DyLoad;
+            p.dyLoad = findSelectedDyLoadData(*m_recipe, step.dyLoadLabel);
+            if (!p.dyLoad.found) {
+                error = "Dynamic load row not found: " + step.dyLoadLabel;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool apply(int index, QString& error) override
+    {
+        const Prepared& p = m_slots[index % 2];
+        if (p.index != index) {
+            error = "Step not prepared";
+            return false;
+        }
+
+        // 條件與上一步相同時不重送
+        if (!p.inputText.isEmpty() && p.inputText != m_appliedInput) {
+            ACSourceCreationResult source = createACSource(m_cfg, nullptr);
+            if (!source.success) {
+                error = "AC Source not available";
+                return false;
+            }
+            ACSource* ac = source.source;
+            ScpiCommandBatch batch(ac->communication(), ac->maxBatchMessageLength());
+            ac->attachBatch(&batch);
+            executeACSourceAction(ac, m_sourceOn ? InputAction::Change : InputAction::PowerOn, p.input);
+            ac->detachBatch();
+            const bool ok = batch.flush(true);
+            if (!ok) error = "AC Source: " + batch.lastError();
+            cleanupACSourceResources(source);
+            if (!ok) return false;
+            m_sourceOn = true;
+            m_appliedInput = p.inputText;
+        }
+
+        if (p.loadKind == LoadKind::Input) return true;
+
+        DCLoadCreationResult loads = createDCLoads(m_cfg, nullptr, p.loadKind);
+        if (!loads.success || loads.dcLoads.isEmpty()) {
+            cleanupDCLoadResources(loads);
+            error = "DC Load not available";
+            return false;
+        }
+        m_loadsTouched = true;
+
+        // 這一步沒有值的通道關閉，避免沿用上一步的電流
+        bool ok = false;
+        if (p.loadKind == LoadKind::Load) {
+            const auto& meta = m_recipe->loadMeta();
+            ok = runBatchedPerMainframe(loads.dcLoads, true, [&](DCLoad* dcLoad) {
+                const int ch = dcLoad->channelIndex();
+                executeDCLoadAction(
+                    dcLoad, p.load.values.isValid(ch - 1) ? LoadAction::LoadOn : LoadAction::LoadOff,
+                    ch, p.load, meta.modes, meta.von,
+                    meta.riseSlopeCCH, meta.fallSlopeCCH,
+                    meta.riseSlopeCCL, meta.fallSlopeCCL, meta.vo);
+            });
+        } else {
+            const auto& meta = m_recipe->dynamicMeta();
+            ok = runBatchedPerMainframe(loads.dcLoads, true, [&](DCLoad* dcLoad) {
+                const int ch = dcLoad->channelIndex();
+                const bool hasValue = ch > 0 && !p.dyLoad.values.value(ch - 1).trimmed().isEmpty();
+                executeDCDyLoadAction(
+                    dcLoad, hasValue ? DyLoadAction::DyLoadOn : DyLoadAction::DyloadOff,
+                    ch, p.dyLoad, meta.von,
+                    meta.riseSlopeCCDH, meta.fallSlopeCCDH,
+                    meta.riseSlopeCCDL, meta.fallSlopeCCDL, meta.vo);
+            });
+        }
+        cleanupDCLoadResources(loads);
+        if (!ok) error = "DC Load not confirmed";
+        return ok;
+    }
+
+    // 序列結束（完成 / 中止 / 失敗）一律關閉輸出：先負載後電源
+    void end() override
+    {
+        if (m_loadsTouched) {
+            DCLoadCreationResult loads = createDCLoads(m_cfg, nullptr, LoadKind::Load);
+            if (loads.success) {
+                runBatchedPerMainframe(loads.dcLoads, false, [](DCLoad* dcLoad) {
+                    dcLoad->setChannel(dcLoad->realChannel());
+                    dcLoad->setLoadOff();
+                });
+            }
+            cleanupDCLoadResources(loads);
+        }
+        if (m_sourceOn) {
+            ACSourceCreationResult source = createACSource(m_cfg, nullptr);
+            if (source.success)
+                executeACSourceAction(source.source, InputAction::PowerOff, InputParameters());
+            cleanupACSourceResources(source);
+        }
+    }
+
+private:
+    struct Prepared {
+        int index = -1;
+        QString inputText;
+        InputParameters input;
+        LoadKind loadKind = LoadKind::Input;    // Input = 這一步不變更負載
+        LoadDataInfo load;
+        DyLoadDataInfo dyLoad;
+    };
+
+    Page1Config m_cfg;
+    RecipeSnapshotPtr m_recipe;
+    bool m_needSource = false;
+    bool m_needLoads = false;
+
+    Prepared m_slots[2];        // 目前步驟 / 下一步（停留期間預備）
+    QString m_appliedInput;
+    bool m_sourceOn = false;
+    bool m_loadsTouched = false;
+};
+
+QVector<SequenceStep> Page3ViewModel::sequenceFromRecipe(int dwellMs) const
+{
+    QVector<QString> inputs;
+    for (const auto& row : m_recipe->inputRows()) {
+        if (!row.vin.isEmpty() && !row.frequency.isEmpty() && !row.phase.isEmpty())
+            inputs << QString("%1/%2/%3").arg(row.vin, row.frequency, row.phase);
+    }
+    if (inputs.isEmpty()) inputs << QString();
+
+    QVector<SequenceStep> steps;
+    for (const QString& input : inputs) {
+        bool anyLoad = false;
+        for (const auto& row : m_recipe->loadRows()) {
+            if (row.label.isEmpty()) continue;
+            steps.append({input, row.label, QString(), dwellMs});
+            anyLoad = true;
+        }
+        for (const auto& row : m_recipe->dynamicRows()) {
+            if (row.label.isEmpty()) continue;
+            steps.append({input, QString(), row.label, dwellMs});
+            anyLoad = true;
+        }
+        if (!anyLoad && !input.isEmpty())
+            steps.append({input, QString(), QString(), dwellMs});
+    }
+    return steps;
+}
+
+void Page3ViewModel::startSequence(const QVector<SequenceStep>& steps)
+{
+    if (m_page1Config.instruments.isEmpty()) {
+        MessageService::instance().showWarning("Error Message",
+                                               "No instrument settings have been loaded.\nPlease load the configuration first!");
+        return;
+    }
+    if (steps.isEmpty()) {
+        MessageService::instance().showWarning("Error Message", "The test sequence is empty.");
+        return;
+    }
+    if (m_sequenceRunner->isRunning()) {
+        MessageService::instance().showWarning("Error Message", "A test sequence is already running.");
+        return;
+    }
+
+    bool needSource = false;
+    bool needLoads = false;
+    for (const auto& step : steps) {
+        needSource |= !step.inputText.trimmed().isEmpty();
+        needLoads |= !step.loadLabel.isEmpty() || !step.dyLoadLabel.isEmpty();
+    }
+
+    std::unique_ptr<SequenceRunner::Executor> executor(
+        new SequenceExecutor(m_page1Config, m_recipe, needSource, needLoads));
+    m_sequenceRunner->start(std::move(executor), steps);
+}
+
+void Page3ViewModel::startRecipeSequence(int dwellMs)
+{
+    startSequence(sequenceFromRecipe(dwellMs));
+}
+
 void Page3ViewModel::emitForceOff(LoadKind kind) {
     emit forceOff(kind);
 }
@@ -12,7 +12,12 @@
 #include <QXmlStreamReader>
 #include "oscilloscope.h"
 #include "abstracttriggercontroller.h"
+#include "instrumentsessionpool.h"
+#include "sequencerunner.h"
+#include "configfilewriter.h"
 #include <QMutex>
+#include <functional>
+#include <map>
 
 enum class InputAction { PowerOn, PowerOff, Change };
 enum class LoadAction { LoadOn, LoadOff, Change };
@@ -26,8 +31,10 @@ public:
     Page3ViewModel(Page3Model* p3, QObject *parent = nullptr);
     virtual ~Page3ViewModel();
 
-    void writeXml(QXmlStreamWriter& writer) const;
-    void loadXml(QXmlStreamReader& reader);
+    // XML 序列化：標題 / 選擇與配方快照的副本，可在背景執行緒寫出或解析
+    ConfigSection xmlSection();                 // 內容有變時遞增 revision
+    Page3Model::XmlState xmlState() const;      // 目前狀態，也是背景解析時檔案缺少欄位的預設值
+    void applyLoadedState(const Page3Model::XmlState& state);
 
     void restoreFromModel();
     void updateUIAfterLoad();
@@ -44,59 +51,63 @@ public:
     QString getSelectedRelayText() const { return m_selectedRelayText; }
 
     // 負載設定方法
-    void applyLoadSettings(DCLoad* dcLoad,
-                           int index,
-                           double value,
-                           const QString& mode,
-                           const QVector<QString>& vons,
-                           const QVector<QString>& riseSlopeCCH,
-                           const QVector<QString>& fallSlopeCCH,
-                           const QVector<QString>& riseSlopeCCL,
-                           const QVector<QString>& fallSlopeCCL,
-                           const QVector<QString>& outputVoltages);
-
-
-    void applyLoadVonSetting(DCLoad* dcLoad,
-                             const int &index,
-                             const QVector<QString>& vons);
-
-    void applyLoadSlopeSetting(DCLoad* dcLoad,
-                               int index,
-                               const QVector<QString>& riseSlopeCCH,
-                               const QVector<QString>& fallSlopeCCH,
-                               const QVector<QString>& riseSlopeCCL,
-                               const QVector<QString>& fallSlopeCCL);
-
-    void applyLoadValueSettings(DCLoad* dcLoad,
-                           int index,
-                           double value,
-                           const QString& mode,
-                           const QVector<QString>& outputVoltages);
-
-
-    void applyDyLoadSettings(DCLoad* dcLoad,
-                             int index,
-                             const QString& value,
-                             const QString& dyTime,
-                             const QVector<QString>& vons,
-                             const QVector<QString>& riseSlopeCCDH,
-                             const QVector<QString>& fallSlopeCCDH,
-                             const QVector<QString>& riseSlopeCCDL,
-                             const QVector<QString>& fallSlopeCCDL,
-                             const QVector<QString>& outputVoltages);
-
-    void applyDyLoadSlopeSetting(DCLoad* dcLoad,
-                               int index,
-                               const QVector<QString>& riseSlopeCCDH,
-                               const QVector<QString>& fallSlopeCCDH,
-                               const QVector<QString>& riseSlopeCCDL,
-                               const QVector<QString>& fallSlopeCCDL);
-
-    void applyDyLoadValueSettings(DCLoad* dcLoad,
-                             int index,
-                             const QString& value,
-                             const QString& dyTime,
-                             const QVector<QString>& outputVoltages);
+    static void applyLoadSettings(DCLoad* dcLoad,
+                                  int index,
+                                  double value,
+                                  const QString& mode,
+                                  const NumericColumn& vons,
+                                  const NumericColumn& riseSlopeCCH,
+                                  const NumericColumn& fallSlopeCCH,
+                                  const NumericColumn& riseSlopeCCL,
+                                  const NumericColumn& fallSlopeCCL,
+                                  const NumericColumn& outputVoltages);
+
+
+    static void applyLoadVonSetting(DCLoad* dcLoad,
+                                    const int &index,
+                                    const NumericColumn& vons);
+
+    static void applyLoadSlopeSetting(DCLoad* dcLoad,
+                                      int index,
+                                      const NumericColumn& riseSlopeCCH,
+                                      const NumericColumn& fallSlopeCCH,
+                                      const NumericColumn& riseSlopeCCL,
+                                      const NumericColumn& fallSlopeCCL);
+
+    static void applyLoadValueSettings(DCLoad* dcLoad,
+                                  int index,
+                                  double value,
+                                  const QString& mode,
+                                  const NumericColumn& outputVoltages);
+
+
+    static void applyDyLoadSettings(DCLoad* dcLoad,
+                                    int index,
+                                    const QString& value,
+                                    const QString& dyTime,
+                                    const NumericColumn& vons,
+                                    const NumericColumn& riseSlopeCCDH,
+                                    const NumericColumn& fallSlopeCCDH,
+                                    const NumericColumn& riseSlopeCCDL,
+                                    const NumericColumn& fallSlopeCCDL,
+                                    const NumericColumn& outputVoltages);
+
+    static void applyDyLoadSlopeSetting(DCLoad* dcLoad,
+                                      int index,
+                                      const NumericColumn& riseSlopeCCDH,
+                                      const NumericColumn& fallSlopeCCDH,
+                                      const NumericColumn& riseSlopeCCDL,
+                                      const NumericColumn& fallSlopeCCDL);
+
+    // 測試序列：依 Page2 配方產生步驟（每個 Input 列 × 每個 Load / Dynamic 列）
+    QVector<SequenceStep> sequenceFromRecipe(int dwellMs) const;
+    SequenceRunner* sequenceRunner() const { return m_sequenceRunner; }
+
+    static void applyDyLoadValueSettings(DCLoad* dcLoad,
+                                    int index,
+                                    const QString& value,
+                                    const QString& dyTime,
+                                    const NumericColumn& outputVoltages);
 
 public slots:
     void setMaxOutput(int maxOutput);
@@ -105,11 +116,7 @@ public slots:
 
     // Page1/Page2 數據處理
     void onPage1ConfigChanged(const Page1Config &cfg);
-    void onInputDataChanged(const QVector<InputRow>& rows);
-    void onLoadMetaChanged(const LoadMetaRow& meta);
-    void onLoadRowsChanged(const QVector<LoadDataRow>& rows);
-    void onDynamicMetaChanged(const DynamicMetaRow& meta);
-    void onDynamicRowsChanged(const QVector<DynamicDataRow>& rows);
+    void onRecipeSnapshotChanged(const RecipeSnapshotPtr& snapshot);
 
     // Input 相關操作
     void onInputToggled(bool on);
@@ -126,6 +133,16 @@ public slots:
     void onDyLoadChanged();
     void handleDyLoad(DyLoadAction action);
 
+    // 同步套用：示波器先進入 single，AC Source / DC Load（Load 或 DyLoad）平行設定，
+    // 全部以 *OPC? 確認後才同時開啟輸出，結果與開啟時間差由 syncApplyFinished 回報
+    // Page3 Dynamic Load 勾選 Synchronous 時由 ON 按鈕呼叫；須在 GUI 執行緒呼叫
+    void handleSyncApply(bool includeInput, LoadKind loadKind, bool armScope = true);
+
+    // 測試序列：背景依序套用步驟，暫停 / 繼續 / 中止透過 sequenceRunner()
+    void startSequence(const QVector<SequenceStep>& steps);
+    // Page3 Sequence 群組的 Start：Page2 配方全部條件，每步停留 dwellMs
+    void startRecipeSequence(int dwellMs);
+
     // 選擇處理
     void onSelected(LoadKind type, int idx, const QString& txt);
 
@@ -150,14 +167,12 @@ private:
 
     // 數據模型
     Page3Model* m_page3 = nullptr;
+    Page3Model::XmlState m_savedXmlState;  // 上次 xmlSection() 的內容，用來判斷 revision
+    quint64 m_xmlRevision = 1;
 
     // 配置數據
     Page1Config m_page1Config;
-    QVector<InputRow> m_page2InputData;
-    LoadMetaRow m_LoadMetaData;
-    QVector<LoadDataRow> m_LoadRowsData;
-    DynamicMetaRow m_DynamicMetaData;
-    QVector<DynamicDataRow> m_DynamicRowsData;
+    RecipeSnapshotPtr m_recipe = RecipeSnapshot::create();   // Page2 配方，與 Page2ViewModel / Page3Model 共用
 
     // 當前選擇狀態
     int m_selectedInputIndex = -1;
@@ -170,10 +185,9 @@ private:
     QString m_selectedDyLoadText;
 
     // === 抽象化的儀器管理 ===
-    QMap<QString, Oscilloscope*> m_oscilloscopes;
-    QMap<QString, ICommunication*> m_oscilloscopeComms;
+    QMap<QString, Oscilloscope*> m_oscilloscopes;   // 通訊由 InstrumentSessionPool 持有
     Oscilloscope* m_currentOscilloscope = nullptr;
-    AbstractTriggerController* m_currentTriggerController = nullptr;
+    QPointer<AbstractTriggerController> m_currentTriggerController;    // 由 Page3 的 trigger widget 持有
     QString m_currentInstrumentModel;
 
     // 私有方法
@@ -188,13 +202,17 @@ private:
     // handleInput相關輔助函數
     bool validateInputConfiguration();
 
+    // 以下 static 輔助函數不存取 ViewModel 狀態，背景執行緒（含測試序列）可直接呼叫
+    // self 只用來以 queued 呼叫 forceOff，可為空
+
     struct ACSourceCreationResult {
         ACSource* source = nullptr;
-        ICommunication* comm = nullptr;
+        ICommunication* comm = nullptr;     // 由 lease 提供，不要 delete
+        InstrumentSessionLease lease;
         bool success = false;
     };
 
-    ACSourceCreationResult createACSource(const Page1Config& cfg, QPointer<Page3ViewModel> self);
+    static ACSourceCreationResult createACSource(const Page1Config& cfg, QPointer<Page3ViewModel> self);
 
     struct InputParameters {
         double voltage = 0.0;
@@ -202,33 +220,33 @@ private:
         double phase = 0.0;
         bool valid = false;
     };
-    InputParameters parseInputText(const QString& inputText);
+    static InputParameters parseInputText(const QString& inputText);
 
-    void executeACSourceAction(ACSource* source, InputAction action, const InputParameters& params);
-    void cleanupACSourceResources(ACSource* source, ICommunication* comm);
+    static void executeACSourceAction(ACSource* source, InputAction action, const InputParameters& params);
+    static void cleanupACSourceResources(ACSourceCreationResult& result);
 
     // handleLoad 相關輔助函數
     bool validateLoadConfiguration();
 
     struct LoadDataInfo {
-        QVector<QString> values;
+        NumericColumn values;
         bool found = false;
     };
 
-    LoadDataInfo findSelectedLoadData(QPointer<Page3ViewModel> self);
+    static LoadDataInfo findSelectedLoadData(const RecipeSnapshot& recipe, const QString& label);
 
-    void executeDCLoadAction(
+    static void executeDCLoadAction(
         DCLoad* dcLoad,
         LoadAction action,
         int index,
         const LoadDataInfo& dataInfo,
         const QVector<QString>& modes,
-        const QVector<QString>& vons,
-        const QVector<QString>& riseSlopeCCH,
-        const QVector<QString>& fallSlopeCCH,
-        const QVector<QString>& riseSlopeCCL,
-        const QVector<QString>& fallSlopeCCL,
-        const QVector<QString>& outputVoltages);
+        const NumericColumn& vons,
+        const NumericColumn& riseSlopeCCH,
+        const NumericColumn& fallSlopeCCH,
+        const NumericColumn& riseSlopeCCL,
+        const NumericColumn& fallSlopeCCL,
+        const NumericColumn& outputVoltages);
 
 
 
@@ -241,36 +259,44 @@ private:
         QString t1t2;
         bool found = false;
     };
-    DyLoadDataInfo findSelectedDyLoadData(QPointer<Page3ViewModel> self,
-                                          const QVector<QString>& t1t2Vector);
+    static DyLoadDataInfo findSelectedDyLoadData(const RecipeSnapshot& recipe, const QString& label);
 
-    void executeDCDyLoadAction(
+    static void executeDCDyLoadAction(
         DCLoad* dcLoad,
         DyLoadAction action,
         int index,
         const DyLoadDataInfo& dataInfo,
-        const QVector<QString>& vons,
-        const QVector<QString>& riseSlopeCCDH,
-        const QVector<QString>& fallSlopeCCDH,
-        const QVector<QString>& riseSlopeCCDL,
-        const QVector<QString>& fallSlopeCCDL,
-        const QVector<QString>& outputVoltages);
+        const NumericColumn& vons,
+        const NumericColumn& riseSlopeCCDH,
+        const NumericColumn& fallSlopeCCDH,
+        const NumericColumn& riseSlopeCCDL,
+        const NumericColumn& fallSlopeCCDL,
+        const NumericColumn& outputVoltages);
 
     // handleLoad、handleDyLoad共用
 
     struct DCLoadCreationResult {
         QVector<DCLoad*> dcLoads;
-        QMap<QString, ICommunication*> commMap;
+        QMap<QString, ICommunication*> commMap;          // 由 leases 提供，不要 delete
+        std::map<QString, InstrumentSessionLease> leases;
         bool success = false;
     };
 
-    void cleanupDCLoadResources(
-        QVector<DCLoad*>& dcLoads,
-        QMap<QString, ICommunication*>& commMap);
+    static void cleanupDCLoadResources(DCLoadCreationResult& result);
+
+    static DCLoadCreationResult createDCLoads(const Page1Config& cfg,
+                                              QPointer<Page3ViewModel> self,
+                                              LoadKind kind);
+
+    // 依通訊物件（mainframe）分組，各台在 MainframeExecutor 上平行執行，
+    // 同一台所有通道的指令合併成 SCPI 批次送出；waitForOpc = true 時每台以 *OPC? 確認
+    static bool runBatchedPerMainframe(const QVector<DCLoad*>& dcLoads,
+                                       bool waitForOpc,
+                                       const std::function<void(DCLoad*)>& perChannel);
 
-    DCLoadCreationResult createDCLoads(const Page1Config& cfg,
-                                       QPointer<Page3ViewModel> self,
-                                       LoadKind kind);
+    // 測試序列的步驟執行（重用上面的 AC Source / DC Load 設定路徑）
+    class SequenceExecutor;
+    SequenceRunner* m_sequenceRunner = nullptr;
 
      // 防抖計時器
      // 當配置變更時，不立即執行，而是啟動計時器。
@@ -304,6 +330,7 @@ signals:
     void TitlesUpdated(LoadKind type, const QStringList& titles);
     void forceOff(LoadKind type);
     void restoreSelections(LoadKind type, int index, const QString& text);
+    void syncApplyFinished(bool success, const QString& report, qint64 completionSkewNs);
 };
 
 // OscilloscopeFactory → 創建 DPO7000 示波器物件
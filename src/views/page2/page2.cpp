@@ -307,11 +307,9 @@ QLineEdit* Page2::makeLineEdit(QTableWidget* tbl, int r, int c, QChar tag,
     StyleUtils::applyLineEditStyle(lineEdit);
     tbl->setCellWidget(r, c, lineEdit);
 
+    // 每次按鍵只送出這個 cell，整表同步留給結構變動與存檔
     QObject::connect(lineEdit, &QLineEdit::textChanged, self, [=] {
-        self->syncUIToViewModel();
         vm->cellValueChanged(kind, r, c, lineEdit->text());
-        if (kind == LoadKind::Load)
-            vm->broadcastAllPowers();
     });
 
     return lineEdit;
@@ -329,7 +327,6 @@ QComboBox* Page2::makeComboBox(QTableWidget* tbl, int r, int c,
 
     QObject::connect(comboBox, QOverload<const QString&>::of(&QComboBox::currentTextChanged),
                      self, [=] {
-                         self->syncUIToViewModel();
                          vm->cellValueChanged(kind, r, c, comboBox->currentText());
                      });
 
@@ -395,12 +392,12 @@ void Page2::syncLoadTable()
     }
 
     meta.names = extractMetaRowValues(tblLoad, 1, maxOutput);
-    meta.vo = extractMetaRowValues(tblLoad, 2, maxOutput);
-    meta.von = extractMetaRowValues(tblLoad, 3, maxOutput);
-    meta.riseSlopeCCH = extractMetaRowValues(tblLoad, 4, maxOutput);
-    meta.fallSlopeCCH = extractMetaRowValues(tblLoad, 5, maxOutput);
-    meta.riseSlopeCCL = extractMetaRowValues(tblLoad, 6, maxOutput);
-    meta.fallSlopeCCL = extractMetaRowValues(tblLoad, 7, maxOutput);
+    meta.vo = NumericColumn::fromStrings(extractMetaRowValues(tblLoad, 2, maxOutput));
+    meta.von = NumericColumn::fromStrings(extractMetaRowValues(tblLoad, 3, maxOutput));
+    meta.riseSlopeCCH = NumericColumn::fromStrings(extractMetaRowValues(tblLoad, 4, maxOutput));
+    meta.fallSlopeCCH = NumericColumn::fromStrings(extractMetaRowValues(tblLoad, 5, maxOutput));
+    meta.riseSlopeCCL = NumericColumn::fromStrings(extractMetaRowValues(tblLoad, 6, maxOutput));
+    meta.fallSlopeCCL = NumericColumn::fromStrings(extractMetaRowValues(tblLoad, 7, maxOutput));
 
     emit loadMetaChanged(meta);
 
@@ -413,18 +410,13 @@ void Page2::syncLoadTable()
         else if (auto *item = tblLoad->item(row, 0))
             dataRow.label = item->text();
 
+        // 數值在這裡解析一次，之後 Power / 檔位檢查 / 硬體設定都直接使用
+        dataRow.values = NumericColumn(maxOutput);
         for (int col = 1; col <= maxOutput; ++col) {
             if (auto *le = qobject_cast<QLineEdit*>(tblLoad->cellWidget(row, col)))
-                dataRow.values << le->text();
-            else
-                dataRow.values << QString();
+                dataRow.values.setText(col - 1, le->text());
         }
 
-        while (dataRow.values.size() < maxOutput)
-            dataRow.values << QString();
-        if (dataRow.values.size() > maxOutput)
-            dataRow.values.resize(maxOutput);
-
         loadRows.append(dataRow);
     }
     emit loadRowsChanged(loadRows);
@@ -435,12 +427,12 @@ void Page2::syncDynamicTable()
     int dMaxOutput = tblDynamic->columnCount() - 2;  // 減去 Output 和 T1~T2
 
     DynamicMetaRow dmeta;
-    dmeta.vo = extractMetaRowValues(tblDynamic, 0, dMaxOutput);
-    dmeta.von = extractMetaRowValues(tblDynamic, 1, dMaxOutput);
-    dmeta.riseSlopeCCDH = extractMetaRowValues(tblDynamic, 2, dMaxOutput);
-    dmeta.fallSlopeCCDH = extractMetaRowValues(tblDynamic, 3, dMaxOutput);
-    dmeta.riseSlopeCCDL = extractMetaRowValues(tblDynamic, 4, dMaxOutput);
-    dmeta.fallSlopeCCDL = extractMetaRowValues(tblDynamic, 5, dMaxOutput);
+    dmeta.vo = NumericColumn::fromStrings(extractMetaRowValues(tblDynamic, 0, dMaxOutput));
+    dmeta.von = NumericColumn::fromStrings(extractMetaRowValues(tblDynamic, 1, dMaxOutput));
+    dmeta.riseSlopeCCDH = NumericColumn::fromStrings(extractMetaRowValues(tblDynamic, 2, dMaxOutput));
+    dmeta.fallSlopeCCDH = NumericColumn::fromStrings(extractMetaRowValues(tblDynamic, 3, dMaxOutput));
+    dmeta.riseSlopeCCDL = NumericColumn::fromStrings(extractMetaRowValues(tblDynamic, 4, dMaxOutput));
+    dmeta.fallSlopeCCDL = NumericColumn::fromStrings(extractMetaRowValues(tblDynamic, 5, dMaxOutput));
 
     // T1~T2 固定在最後一欄
     int t1t2Col = dMaxOutput + 1;
@@ -708,7 +700,6 @@ void Page2::onInputTitleChanged(int row, const QString & /*dummy*/)
                         ? QString("%1/%2/%3").arg(vin, freq, phase) : "";
 
     tblInput->item(row, 0)->setText(title);
-    syncUIToViewModel();
 }
 
 void Page2::onMaxOutputChanged(int maxOut)
@@ -716,22 +707,37 @@ void Page2::onMaxOutputChanged(int maxOut)
     vm->setMaxOutput(maxOut);
 }
 
-void Page2::onPowerUpdated(int row, double value)
+void Page2::onPowersUpdated(const QVector<int>& rows, const QVector<double>& values)
 {
     const int powerCol = tblLoad->columnCount() - 1;
-    QTableWidgetItem *item = tblLoad->item(row, powerCol);
 
-    if (!item) {
-        item = new QTableWidgetItem;
-        item->setFlags(Qt::ItemIsEnabled);
-        item->setTextAlignment(Qt::AlignCenter);
-        tblLoad->setItem(row, powerCol, item);
+    for (int i = 0; i < rows.size(); ++i) {
+        QTableWidgetItem *item = tblLoad->item(rows[i], powerCol);
+        if (!item) {
+            item = new QTableWidgetItem;
+            item->setFlags(Qt::ItemIsEnabled);
+            item->setTextAlignment(Qt::AlignCenter);
+            tblLoad->setItem(rows[i], powerCol, item);
+        }
+
+        if (std::isnan(values[i]))
+            item->setText("");
+        else
+            item->setText(QString::number(values[i], 'f', 3));
     }
+}
 
-    if (std::isnan(value))
-        item->setText("");
+// 檔位檢查結果：提示選用的檔位，可能觸發 OPP 的 cell 以底色標示
+void Page2::onLoadCellChecked(int row, int col, const QString& mode, bool oppRisk)
+{
+    auto* le = qobject_cast<QLineEdit*>(tblLoad->cellWidget(row, col));
+    if (!le) return;
+
+    StyleUtils::applyLineEditWarning(le, oppRisk);
+    if (oppRisk)
+        le->setToolTip(QString("No suitable range, %1 will be forced (may trigger OPP)").arg(mode));
     else
-        item->setText(QString::number(value, 'f', 3));
+        le->setToolTip(mode.isEmpty() ? QString() : QString("Range: %1").arg(mode));
 }
 
 void Page2::resetUIFromViewModel()
@@ -822,10 +828,6 @@ void Page2::fillRelayDataLabel(int row, const QString& label)
     QLineEdit* leLabel = qobject_cast<QLineEdit*>(tblRelay->cellWidget(row, 0));
     if (!leLabel) {
         leLabel = makeLineEdit(tblRelay, row, 0, QChar(), this, vm, LoadKind::Relay);
-        connect(leLabel, &QLineEdit::textChanged, this, [=] {
-            this->syncUIToViewModel();
-            vm->cellValueChanged(LoadKind::Relay, row, 0, leLabel->text());
-        });
     }
     QSignalBlocker block(leLabel);
     leLabel->setText(label);
@@ -874,7 +876,9 @@ void Page2::fillLoadMetaRows(int maxOutput, int metaRows)
 {
     const auto& meta = vm->loadMeta();
     auto metaRowVals = std::vector<QVector<QString>>{
-        meta.modes, meta.names, meta.vo, meta.von, meta.riseSlopeCCH, meta.fallSlopeCCH, meta.riseSlopeCCL, meta.fallSlopeCCL
+        meta.modes, meta.names, meta.vo.toStrings(), meta.von.toStrings(),
+        meta.riseSlopeCCH.toStrings(), meta.fallSlopeCCH.toStrings(),
+        meta.riseSlopeCCL.toStrings(), meta.fallSlopeCCL.toStrings()
     };
 
     for (int row = 0; row < metaRows; ++row) {
@@ -927,16 +931,12 @@ void Page2::fillLoadDataLabel(int row, const QString& label)
     QLineEdit* leLabel = qobject_cast<QLineEdit*>(tblLoad->cellWidget(row, 0));
     if (!leLabel) {
         leLabel = makeLineEdit(tblLoad, row, 0, QChar(), this, vm, LoadKind::Load);
-        connect(leLabel, &QLineEdit::textChanged, this, [=] {
-            this->syncUIToViewModel();
-            vm->cellValueChanged(LoadKind::Load, row, 0, leLabel->text());
-        });
     }
     QSignalBlocker block(leLabel);
     leLabel->setText(label);
 }
 
-void Page2::fillLoadDataValues(int row, int maxOutput, const QVector<QString>& values)
+void Page2::fillLoadDataValues(int row, int maxOutput, const NumericColumn& values)
 {
     for (int col = 0; col < maxOutput; ++col) {
         QLineEdit* le = qobject_cast<QLineEdit*>(tblLoad->cellWidget(row, col + 1));
@@ -944,7 +944,7 @@ void Page2::fillLoadDataValues(int row, int maxOutput, const QVector<QString>& v
             le = makeLineEdit(tblLoad, row, col + 1, 'd', this, vm, LoadKind::Load);
 
         QSignalBlocker block(le);
-        le->setText(col < values.size() ? values[col] : "");
+        le->setText(values.text(col));
     }
 }
 
@@ -1004,7 +1004,9 @@ void Page2::fillDynamicMetaRows(int dMaxOutput)
     int dMetaRows = kMetaRowsDynamic;
     const auto& dmeta = vm->dynamicMeta();
     auto dmetaRowVals = std::vector<QVector<QString>>{
-        dmeta.vo, dmeta.von, dmeta.riseSlopeCCDH, dmeta.fallSlopeCCDH, dmeta.riseSlopeCCDL, dmeta.fallSlopeCCDL
+        dmeta.vo.toStrings(), dmeta.von.toStrings(),
+        dmeta.riseSlopeCCDH.toStrings(), dmeta.fallSlopeCCDH.toStrings(),
+        dmeta.riseSlopeCCDL.toStrings(), dmeta.fallSlopeCCDL.toStrings()
     };
 
     for (int row = 0; row < dMetaRows; ++row) {
@@ -1054,10 +1056,6 @@ void Page2::fillDynamicDataLabel(int row, const QString& label)
     QLineEdit* leLabel = qobject_cast<QLineEdit*>(tblDynamic->cellWidget(row, 0));
     if (!leLabel) {
         leLabel = makeLineEdit(tblDynamic, row, 0, QChar(), this, vm, LoadKind::DyLoad);
-        connect(leLabel, &QLineEdit::textChanged, this, [=] {
-            this->syncUIToViewModel();
-            vm->cellValueChanged(LoadKind::DyLoad, row, 0, leLabel->text());
-        });
     }
     QSignalBlocker block(leLabel);
     leLabel->setText(label);
@@ -1147,7 +1145,8 @@ void Page2::setupConnections()
     connect(vm, &Page2ViewModel::rowAddRequested, this, &Page2::onRowAddRequested);
     connect(vm, &Page2ViewModel::rowRemoveRequested, this, &Page2::onRowRemoveRequested);
     connect(vm, &Page2ViewModel::inputTitleChanged, this, &Page2::onInputTitleChanged);
-    connect(vm, &Page2ViewModel::powerUpdated, this, &Page2::onPowerUpdated);
+    connect(vm, &Page2ViewModel::powersUpdated, this, &Page2::onPowersUpdated);
+    connect(vm, &Page2ViewModel::loadCellChecked, this, &Page2::onLoadCellChecked);
     connect(vm, &Page2ViewModel::dataChanged, this, &Page2::resetUIFromViewModel);
 
     connect(this, &Page2::inputRowsChanged, vm, &Page2ViewModel::onInputRowsChanged);
@@ -1177,7 +1176,6 @@ void Page2::connectTableItemChanged(QTableWidget* tbl, LoadKind kind, int metaRo
         int row = item->row();
         int col = item->column();
         if (col == 0 && row >= metaRows) {
-            syncUIToViewModel();
             vm->cellValueChanged(kind, row, col, item->text());
         }
     });
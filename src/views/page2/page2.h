@@ -33,7 +33,8 @@ private slots:
     void onRowRemoveRequested(LoadKind kind);
     void onInputTitleChanged(int row, const QString &dummy);
     void onMaxOutputChanged(int maxOut);
-    void onPowerUpdated(int row, double value);
+    void onPowersUpdated(const QVector<int>& rows, const QVector<double>& values);
+    void onLoadCellChecked(int row, int col, const QString& mode, bool oppRisk);
     void resetUIFromViewModel();
 
 protected:
@@ -104,7 +105,7 @@ private:
     void fillLoadMetaCell(int row, int col, const QVector<QString>& values);
     void fillLoadDataRows(int maxOutput, int metaRows, int dataRows);
     void fillLoadDataLabel(int row, const QString& label);
-    void fillLoadDataValues(int row, int maxOutput, const QVector<QString>& values);
+    void fillLoadDataValues(int row, int maxOutput, const NumericColumn& values);
     void fillLoadPowerCell(int row, int maxOutput, int dataRowIndex);
 
     // Dynamic 表格重置細分函數
@@ -62,6 +62,11 @@ void Page3::initializeUI()
 
     chkDyload = new QCheckBox(tr("Synchronous"), this);
     chkDyload->setObjectName("chkDyload");
+    chkDyload->setToolTip(tr("Turn on Input and Dynamic Load together and measure the turn-on skew"));
+
+    lblSync = new QLabel(this);
+    lblSync->setObjectName("lblSync");
+    lblSync->setFont(QFont(font().family(), 8));
 
     cmbDyload = new QComboBox(this);
     cmbDyload->setEditable(false);
@@ -86,6 +91,35 @@ void Page3::initializeUI()
     grpRelay->setFont(QFont(font().family(), 9, QFont::Bold));
     grpRelay->setFixedWidth(168);
 
+    // Sequence Group
+    spnSeqDwell = new QSpinBox(this);
+    spnSeqDwell->setRange(0, 600000);
+    spnSeqDwell->setSingleStep(100);
+    spnSeqDwell->setValue(1000);
+    spnSeqDwell->setSuffix(" ms");
+    spnSeqDwell->setToolTip(tr("Dwell time of each step"));
+    spnSeqDwell->setFixedSize(kBtnWidth, kBtnHeight);
+
+    btnSeqStart = createPushButton(tr("Start"), "btnSeqStart");
+    btnSeqPause = createPushButton(tr("Pause"), "btnSeqPause");
+    btnSeqAbort = createPushButton(tr("Abort"), "btnSeqAbort");
+    btnSeqPause->setCheckable(true);
+    for (QPushButton* btn : {btnSeqStart, btnSeqPause, btnSeqAbort})
+        btn->setFixedSize(kBtnWidth, kBtnHeight);
+
+    lblSeqStatus = new QLabel(tr("Idle"), this);
+    lblSeqStatus->setFont(QFont(font().family(), 8));
+
+    txtSeqLog = new QTextEdit(this);
+    txtSeqLog->setReadOnly(true);
+    txtSeqLog->setFont(QFont(font().family(), 8));
+    txtSeqLog->setFixedHeight(90);
+
+    grpSeq = new QGroupBox(tr("Sequence"));
+    grpSeq->setFont(QFont(font().family(), 9, QFont::Bold));
+    grpSeq->setFixedWidth(168);
+    setSequenceRunning(false);
+
     // Capture Group
     btnPic = createPushButton(tr("Waveform"), "btnPic");
     btnCsv = createPushButton(tr("CSV"), "btnCsv");
@@ -113,7 +147,8 @@ void Page3::buildLayout()
 {
     // 創建各組的佈局（使用 lambda 減少重複）
     auto createGroupLayout = [](QGroupBox* grp, QComboBox* cmb, QPushButton* btn1,
-                                QPushButton* btn2, QCheckBox* chk = nullptr) {
+                                QPushButton* btn2, QCheckBox* chk = nullptr,
+                                QLabel* info = nullptr) {
         auto *lay = new QVBoxLayout(grp);
         lay->setSpacing(6);
         lay->setContentsMargins(4, 16, 4, 8);
@@ -126,13 +161,32 @@ void Page3::buildLayout()
         row->addWidget(btn1);
         row->addWidget(btn2);
         lay->addLayout(row);
+
+        if (info) lay->addWidget(info);
     };
 
     createGroupLayout(grpInput, cmbInput, btnInput, btnChange);
     createGroupLayout(grpLoad, cmbLoad, btnLoadOn, btnLoadChg);
-    createGroupLayout(grpDyload, cmbDyload, btnDyloadOn, btnDyloadChg, chkDyload);
+    createGroupLayout(grpDyload, cmbDyload, btnDyloadOn, btnDyloadChg, chkDyload, lblSync);
     createGroupLayout(grpRelay, cmbRelay, btnRelayOn, btnRelayChg);
 
+    // Sequence Group
+    auto *laySeq = new QVBoxLayout(grpSeq);
+    laySeq->setSpacing(6);
+    laySeq->setContentsMargins(4, 16, 4, 8);
+    auto *rowSeqStart = new QHBoxLayout;
+    rowSeqStart->setSpacing(6);
+    rowSeqStart->addWidget(spnSeqDwell);
+    rowSeqStart->addWidget(btnSeqStart);
+    auto *rowSeqCtrl = new QHBoxLayout;
+    rowSeqCtrl->setSpacing(6);
+    rowSeqCtrl->addWidget(btnSeqPause);
+    rowSeqCtrl->addWidget(btnSeqAbort);
+    laySeq->addLayout(rowSeqStart);
+    laySeq->addLayout(rowSeqCtrl);
+    laySeq->addWidget(lblSeqStatus);
+    laySeq->addWidget(txtSeqLog);
+
     // Capture Group
     auto *layCap = new QVBoxLayout(grpCap);
     layCap->setSpacing(6);
@@ -150,6 +204,7 @@ void Page3::buildLayout()
     leftCol->addWidget(grpLoad);
     leftCol->addWidget(grpDyload);
     leftCol->addWidget(grpRelay);
+    leftCol->addWidget(grpSeq);
     leftCol->addStretch();
     leftCol->addWidget(grpCap);
 
@@ -181,7 +236,24 @@ void Page3::setupConnections()
     // Toggle 按鈕連接（使用輔助函數減少重複）
     connectToggleButton(btnInput, &Page3::inputToggled);
     connectToggleButton(btnLoadOn, &Page3::loadToggled);
-    connectToggleButton(btnDyloadOn, &Page3::dyloadToggled);
+
+    // DyLoad ON：勾選 Synchronous 時改走同步開啟（Input 尚未開啟則一起開）
+    connect(btnDyloadOn, &QPushButton::toggled, this, [this](bool on) {
+        btnDyloadOn->setText(on ? tr("ON") : tr("OFF"));
+        if (!on || !chkDyload->isChecked()) {
+            emit dyloadToggled(on);
+            return;
+        }
+        m_syncIncludesInput = !btnInput->isChecked();
+        if (m_syncIncludesInput) {
+            QSignalBlocker blocker(btnInput);
+            btnInput->setChecked(true);
+            btnInput->setText(tr("ON"));
+        }
+        lblSync->setText(tr("Sync: applying..."));
+        lblSync->setToolTip(QString());
+        emit syncApplyRequested(m_syncIncludesInput, LoadKind::DyLoad);
+    });
 
     // ComboBox 選擇變更（使用輔助函數）
     connectComboBox(cmbInput, LoadKind::Input);
@@ -206,6 +278,9 @@ void Page3::setupConnections()
     connect(this, &Page3::loadChanged, vm, &Page3ViewModel::onLoadChanged);
     connect(this, &Page3::dyloadToggled, vm, &Page3ViewModel::onDyloadToggled);
     connect(this, &Page3::dyloadChanged, vm, &Page3ViewModel::onDyLoadChanged);
+    connect(this, &Page3::syncApplyRequested, vm, [this](bool includeInput, LoadKind loadKind) {
+        vm->handleSyncApply(includeInput, loadKind);
+    });
 
     connect(vm, &Page3ViewModel::forceOff, this, &Page3::forceButtonOff);
     connect(vm, &Page3ViewModel::page1ConfigChanged, this, &Page3::onPage1ConfigChanged);
@@ -213,6 +288,23 @@ void Page3::setupConnections()
     connect(vm, &Page3ViewModel::rowLabelsChanged, this, &Page3::onRowLabelsChanged);
     connect(vm, &Page3ViewModel::TitlesUpdated, this, &Page3::onTitlesUpdated);
     connect(vm, &Page3ViewModel::restoreSelections, this, &Page3::onRestoreSelections);
+    connect(vm, &Page3ViewModel::syncApplyFinished, this, &Page3::onSyncApplyFinished);
+
+    // 測試序列：Start 經 ViewModel 產生步驟，暫停 / 繼續 / 中止直接交給 SequenceRunner
+    SequenceRunner* runner = vm->sequenceRunner();
+    connect(btnSeqStart, &QPushButton::clicked, this, [this]() {
+        emit sequenceStartRequested(spnSeqDwell->value());
+    });
+    connect(this, &Page3::sequenceStartRequested, vm, &Page3ViewModel::startRecipeSequence);
+    connect(btnSeqPause, &QPushButton::toggled, runner, [runner](bool on) {
+        if (on) runner->pause();
+        else runner->resume();
+    });
+    connect(btnSeqAbort, &QPushButton::clicked, runner, &SequenceRunner::abort);
+    connect(runner, &SequenceRunner::stepStarted, this, &Page3::onSequenceStepStarted);
+    connect(runner, &SequenceRunner::stepFinished, this, &Page3::onSequenceStepFinished);
+    connect(runner, &SequenceRunner::pausedChanged, this, &Page3::onSequencePausedChanged);
+    connect(runner, &SequenceRunner::finished, this, &Page3::onSequenceFinished);
 
     // Trigger
     connect(this, &Page3::triggerWidgetCreated, vm, &Page3ViewModel::onTriggerWidgetCreated);
@@ -313,6 +405,19 @@ void Page3::loadLock()
     btnLoadChg->setEnabled(!btnDyloadOn->isChecked());
 }
 
+void Page3::setSequenceRunning(bool running)
+{
+    spnSeqDwell->setEnabled(!running);
+    btnSeqStart->setEnabled(!running);
+    btnSeqPause->setEnabled(running);
+    btnSeqAbort->setEnabled(running);
+    if (!running) {
+        QSignalBlocker blocker(btnSeqPause);
+        btnSeqPause->setChecked(false);
+        btnSeqPause->setText(tr("Pause"));
+    }
+}
+
 // ========== Slots ==========
 
 void Page3::onHeadersChanged(const QStringList &hdr)
@@ -416,6 +521,55 @@ void Page3::forceButtonOff(LoadKind type)
     }
 }
 
+void Page3::onSyncApplyFinished(bool success, const QString& report, qint64 completionSkewNs)
+{
+    // 完整的各台時間寫在 tooltip，標籤只顯示最大時間差
+    lblSync->setToolTip(report);
+    if (success) {
+        lblSync->setText(tr("Sync skew: %1 us").arg(completionSkewNs / 1000.0, 0, 'f', 1));
+        return;
+    }
+    lblSync->setText(tr("Sync: failed"));
+    forceButtonOff(LoadKind::DyLoad);
+    if (m_syncIncludesInput) forceButtonOff(LoadKind::Input);
+}
+
+void Page3::onSequenceStepStarted(int index, int total)
+{
+    if (index == 0) {
+        txtSeqLog->clear();
+        setSequenceRunning(true);
+    }
+    lblSeqStatus->setText(tr("Step %1 / %2").arg(index + 1).arg(total));
+}
+
+void Page3::onSequenceStepFinished(const SequenceStepResult& result)
+{
+    if (result.success) {
+        txtSeqLog->append(tr("%1: OK, apply %2 ms, dwell %3 ms")
+                              .arg(result.index + 1)
+                              .arg(result.applyNs / 1e6, 0, 'f', 1)
+                              .arg(result.dwellNs / 1e6, 0, 'f', 0));
+    } else {
+        txtSeqLog->append(tr("%1: FAILED, %2").arg(result.index + 1).arg(result.error));
+    }
+}
+
+void Page3::onSequencePausedChanged(bool paused)
+{
+    QSignalBlocker blocker(btnSeqPause);
+    btnSeqPause->setChecked(paused);
+    btnSeqPause->setText(paused ? tr("Resume") : tr("Pause"));
+}
+
+void Page3::onSequenceFinished(bool completed, const QString& report)
+{
+    setSequenceRunning(false);
+    lblSeqStatus->setText(completed ? tr("Completed") : tr("Stopped"));
+    // 報告第一行可能是錯誤原因，完整內容放進紀錄
+    txtSeqLog->append(report);
+}
+
 // ========== Trigger 相關 ==========
 
 void Page3::setTriggerModel(const QString& modelName)
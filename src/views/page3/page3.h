@@ -33,6 +33,13 @@ public slots:
     void onPage1ConfigChanged(const Page1Config &cfg);
     void onRestoreSelections(LoadKind type, int index, const QString& text);
     void forceButtonOff(LoadKind type);
+    void onSyncApplyFinished(bool success, const QString& report, qint64 completionSkewNs);
+
+    // 測試序列進度
+    void onSequenceStepStarted(int index, int total);
+    void onSequenceStepFinished(const SequenceStepResult& result);
+    void onSequencePausedChanged(bool paused);
+    void onSequenceFinished(bool completed, const QString& report);
 
 signals:
     // 輸入控制信號
@@ -47,6 +54,12 @@ signals:
     void dyloadToggled(bool on);
     void dyloadChanged();
 
+    // 同步開啟：Input 與 Dynamic Load 一起套用（Synchronous 勾選時由 DyLoad ON 發出）
+    void syncApplyRequested(bool includeInput, LoadKind loadKind);
+
+    // 測試序列：以 Page2 配方產生步驟並開始
+    void sequenceStartRequested(int dwellMs);
+
     // 選擇變更（統一信號）
     void selectedChanged(LoadKind type, int index, const QString& text);
 
@@ -69,6 +82,7 @@ private:
     // UI 輔助
     QPushButton* createPushButton(const QString &text, const QString &objectName = QString()) const;
     void loadLock();  // Load 和 DyLoad 互鎖
+    void setSequenceRunning(bool running);
 
     // Trigger 相關
     void setTriggerModel(const QString& modelName);
@@ -102,6 +116,8 @@ private:
     QPushButton *btnDyloadOn  = nullptr;
     QPushButton *btnDyloadChg = nullptr;
     QCheckBox   *chkDyload    = nullptr;
+    QLabel      *lblSync      = nullptr;   // 上次同步開啟的時間差
+    bool         m_syncIncludesInput = false;
 
     // UI 組件 - Relay Group
     QGroupBox   *grpRelay    = nullptr;
@@ -109,6 +125,15 @@ private:
     QPushButton *btnRelayOn  = nullptr;
     QPushButton *btnRelayChg = nullptr;
 
+    // UI 組件 - Sequence Group
+    QGroupBox   *grpSeq       = nullptr;
+    QSpinBox    *spnSeqDwell  = nullptr;
+    QPushButton *btnSeqStart  = nullptr;
+    QPushButton *btnSeqPause  = nullptr;
+    QPushButton *btnSeqAbort  = nullptr;
+    QLabel      *lblSeqStatus = nullptr;
+    QTextEdit   *txtSeqLog    = nullptr;   // 每步結果
+
     // UI 組件 - Capture Group
     QGroupBox   *grpCap     = nullptr;
     QPushButton *btnPic     = nullptr;